@@ -1,10 +1,18 @@
+#include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "driver/rmt_rx.h"
 #include "driver/rmt_tx.h"
 #include "driver/rmt_encoder.h"
+#include "soc/soc_caps.h"
+#include "esp_idf_version.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "ir_proto.h"
+#include "ir_raw_encoder.h"
 #include "ir.h"
+#include "ir_db.h"
 
 
 #define NEC_LEADING_CODE_DURATION_0                 9000
@@ -15,12 +23,30 @@
 #define NEC_DATA_ONE_DURATION_1                     1690
 #define NEC_ENDING_CODE_DURATION_0                  560
 #define NEC_ENDING_CODE_DURATION_1                  0x7FFF
-#define NEC_REPEAT_CODE_DURATION_0                  9000
-#define NEC_REPEAT_CODE_DURATION_1                  2250
-#define NEC_DECODE_MARGIN_DURATION                  200
-#define NEC_FRAME_LEN                               4
+#define NEC_FRAME_LEN                               IR_FRAME_LEN
 
 #define CONFIG_IR_RESOLUTION_HZ                     1000000 // 1MHz, 1 tick = 1us
+#define IR_LEARN_SYMBOLS_MIN                        8       // shorter captures are repeat codes or noise
+#define IR_LEARN_CLUSTER_MAX                        8
+#define IR_LEARN_JITTER_US                          150
+#define IR_LEARN_SYMBOLS                            512     // air conditioner frames run to 100-300 symbols, longer captures are refused
+#define IR_RX_IDLE_US                               10000   // ends a capture, above the 9ms NEC leader, the longest level inside a frame
+#define IR_RX_SYMBOLS                               64
+
+#define IR_RX_QUEUE_LEN                             8       // a held key and a burst from the cloud remote, back to back frames
+#define IR_RX_BUFFERS                               (IR_RX_QUEUE_LEN + 2) // the queued ones, the one being parsed and the one being filled
+
+// chips with rx ping-pong hand over a capture in chunks while it goes on, the decoder follows the frame across them
+#if SOC_RMT_SUPPORT_RX_PINGPONG && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0)
+#define IR_RX_PARTIAL                               1
+#else
+#define IR_RX_PARTIAL                               0
+#endif
+#define IR_TX_QUEUE_LEN                             16
+#define IR_TX_RAW_SLOTS                             4       // raw commands waiting at once, each holds a copy of its packed frame
+#define IR_TX_NEC_PERIOD_US                         108000  // NEC frames and repeat codes start this far apart
+#define IR_TX_RAW_GAP_US                            40000   // silence after a raw frame, it has no known period
+#define IR_TX_REPEAT_WINDOW_US                      150000  // the same NEC code again within this after the last start holds the key
 
 
 typedef struct {
@@ -31,90 +57,61 @@ typedef struct {
     rmt_symbol_word_t symbol_ending;    // NEC ending code with RMT representation
 } ir_nec_encoder;
 
-typedef struct  {
-    uint8_t channel_id;
-    uint8_t channel_frame[NEC_FRAME_LEN];
-} ir_channel_info_t;
+typedef struct {
+    rmt_rx_done_event_data_t edata;
+    int64_t time;                       // us, when the symbols were handed over
+} ir_rx_event_t;
+
+// a copy of the code, learning the key again while the command waits does not change what is sent
+typedef struct {
+    ir_code_t code;
+    int64_t queued;                     // us
+    uint8_t priority;
+    uint8_t raw_slot;                   // s_tx_raw holding the packed frame of an IR_PROTO_RAW code
+    uint16_t raw_len;
+} ir_tx_item_t;
 
 typedef struct {
     uint8_t rmt_id;
-    ir_channel_info_t rmt_channels[CHANNELID_MAX];
-} ir_rmt_info_t;
-
-static ir_rmt_info_t rmt_infos[RMTID_MAX] = {
-    {
-        RMTID_TV, {
-            {CHANNELID_0,           {0x4C, 0x65, 0x45, 0xBA}},
-            {CHANNELID_1,           {0x4C, 0x65, 0x01, 0xFE}},
-            {CHANNELID_2,           {0x4C, 0x65, 0x02, 0xFD}},
-            {CHANNELID_3,           {0x4C, 0x65, 0x03, 0xFC}},
-            {CHANNELID_4,           {0x4C, 0x65, 0x04, 0xFB}},
-            {CHANNELID_5,           {0x4C, 0x65, 0x05, 0xFA}},
-            {CHANNELID_6,           {0x4C, 0x65, 0x06, 0xF9}},
-            {CHANNELID_7,           {0x4C, 0x65, 0x07, 0xF8}},
-            {CHANNELID_8,           {0x4C, 0x65, 0x08, 0xF7}},
-            {CHANNELID_9,           {0x4C, 0x65, 0x09, 0xF6}},
-            {CHANNELID_UP,          {0x4C, 0x65, 0x0B, 0xF4}},
-            {CHANNELID_DOWN,        {0x4C, 0x65, 0x0E, 0xF1}},
-            {CHANNELID_LEFT,        {0x4C, 0x65, 0x10, 0xEF}},
-            {CHANNELID_RIGHT,       {0x4C, 0x65, 0x11, 0xEE}},
-            {CHANNELID_OK,          {0x4C, 0x65, 0x0D, 0xF2}},
-            {CHANNELID_VOLUME_ADD,  {0x4C, 0x65, 0x15, 0xEA}},
-            {CHANNELID_VOLUME_SUB,  {0x4C, 0x65, 0x1C, 0xE3}},
-            {CHANNELID_CHANNEL_ADD, {0x4C, 0x65, 0x1F, 0xE0}},
-            {CHANNELID_CHANNEL_SUB, {0x4C, 0x65, 0x1E, 0xE1}},
-            {CHANNELID_POWER,       {0x4C, 0x65, 0x0A, 0xF5}},
-            {CHANNELID_HOME,        {0x4C, 0x65, 0x16, 0xE9}},
-            {CHANNELID_SIGNAL,      {0x4C, 0x65, 0x0C, 0xF3}},
-            {CHANNELID_MUTE,        {0x4C, 0x65, 0x0F, 0xF0}},
-            {CHANNELID_BACK,        {0x4C, 0x65, 0x1D, 0xE2}},
-            {CHANNELID_MENU,        {0x4C, 0x65, 0x37, 0xC8}},
-            {CHANNELID_SETTING,     {0x4C, 0x65, 0x00, 0xFF}}
-        }
-    },
-    {
-        RMTID_SETTOPBOX, {
-            {CHANNELID_0,           {0x22, 0xDD, 0x87, 0x78}},
-            {CHANNELID_1,           {0x22, 0xDD, 0x92, 0x6D}},
-            {CHANNELID_2,           {0x22, 0xDD, 0x93, 0x6C}},
-            {CHANNELID_3,           {0x22, 0xDD, 0xCC, 0x33}},
-            {CHANNELID_4,           {0x22, 0xDD, 0x8E, 0x71}},
-            {CHANNELID_5,           {0x22, 0xDD, 0x8F, 0x70}},
-            {CHANNELID_6,           {0x22, 0xDD, 0xC8, 0x37}},
-            {CHANNELID_7,           {0x22, 0xDD, 0x8A, 0x75}},
-            {CHANNELID_8,           {0x22, 0xDD, 0x8B, 0x74}},
-            {CHANNELID_9,           {0x22, 0xDD, 0xC4, 0x3B}},
-            {CHANNELID_UP,          {0x22, 0xDD, 0xCA, 0x35}},
-            {CHANNELID_DOWN,        {0x22, 0xDD, 0xD2, 0x2D}},
-            {CHANNELID_LEFT,        {0x22, 0xDD, 0x99, 0x66}},
-            {CHANNELID_RIGHT,       {0x22, 0xDD, 0xC1, 0x3E}},
-            {CHANNELID_OK,          {0x22, 0xDD, 0xCE, 0x31}},
-            {CHANNELID_VOLUME_ADD,  {0x22, 0xDD, 0x80, 0x7F}},
-            {CHANNELID_VOLUME_SUB,  {0x22, 0xDD, 0x81, 0x7E}},
-            {CHANNELID_CHANNEL_ADD, {0x22, 0xDD, 0x85, 0x7A}},
-            {CHANNELID_CHANNEL_SUB, {0x22, 0xDD, 0x86, 0x79}},
-            {CHANNELID_POWER,       {0x22, 0xDD, 0xDC, 0x23}},
-            {CHANNELID_HOME,        {0x22, 0xDD, 0x88, 0x77}},
-            {CHANNELID_SIGNAL,      {0x4C, 0x65, 0x0C, 0xF3}},
-            {CHANNELID_MUTE,        {0x22, 0xDD, 0x9C, 0x63}},
-            {CHANNELID_BACK,        {0x22, 0xDD, 0x95, 0x6A}},
-            {CHANNELID_MENU,        {0x22, 0xDD, 0x82, 0x7D}},
-            {CHANNELID_SETTING,     {0x22, 0xDD, 0x8D, 0x72}}
-        }
-    }, 
-    {
-        RMTID_LIGHT_BEDROOM, {
-            {CHANNELID_VOLUME_ADD,  {0x00, 0xFF, 0x40, 0xBF}},
-            {CHANNELID_VOLUME_SUB,  {0x00, 0xFF, 0x19, 0xE6}},
-            {CHANNELID_POWER,       {0x00, 0xFF, 0x0D, 0xF2}}
-        }
-    }
-};
+    uint8_t channel_id;
+    int64_t deadline;                   // us, 0 - not learning
+} ir_learn_t;
 
 static QueueHandle_t s_hd_queue = NULL;
+static QueueHandle_t s_hd_tx_queue = NULL;
+static QueueHandle_t s_hd_learn_queue = NULL;  // one request, the rx task owns the learning state
+static SemaphoreHandle_t s_hd_tx_gap = NULL;
+static esp_timer_handle_t s_hd_tx_timer = NULL;
+static ir_tx_stats_t s_tx_stats = {0};
+static portMUX_TYPE s_tx_stats_lock = portMUX_INITIALIZER_UNLOCKED; // ir_recv counts the drops, the send task the rest
+static ir_tx_item_t s_tx_pending[IR_TX_QUEUE_LEN] = {0}; // the send task's, by priority, too large for its stack
+// the frames of the raw commands, a slot is taken by ir_recv and given back by the send task once the frame is out
+static uint8_t s_tx_raw[IR_TX_RAW_SLOTS][IR_RAW_MAX] = {0};
+static uint8_t s_tx_raw_used = 0;      // a bit per slot
+static portMUX_TYPE s_tx_raw_lock = portMUX_INITIALIZER_UNLOCKED;
 static rmt_channel_handle_t s_hd_rx_channel = NULL;
 static rmt_channel_handle_t s_hd_tx_channel = NULL;
 static rmt_encoder_handle_t s_hd_nec_encoder = NULL;
+static rmt_encoder_handle_t s_hd_raw_encoder = NULL;
+static rmt_symbol_word_t s_learn_symbols[IR_LEARN_SYMBOLS] = {0}; // the chunks of a capture being learned
+static uint16_t s_learn_durations[IR_LEARN_SYMBOLS * 2] = {0};
+// captures, or chunks of them, wait in the pool for the task, so the channel is armed again at once
+static rmt_symbol_word_t s_rx_buffers[IR_RX_BUFFERS][IR_RX_SYMBOLS] = {0};
+static uint8_t s_rx_next = 0;
+#if IR_RX_PARTIAL
+static rmt_symbol_word_t s_rx_symbols[IR_RX_SYMBOLS] = {0}; // the driver writes the next chunk over it, it is copied out
+#endif
+static volatile uint32_t s_rx_captures = 0;
+static volatile uint32_t s_rx_dropped = 0;
+static const rmt_receive_config_t s_rx_cfg = {
+    .signal_range_min_ns = 1250,                    // the shortest duration for NEC signal is 560us, valid signal won't be treated as noise
+    .signal_range_max_ns = IR_RX_IDLE_US * 1000,    // every frame is only reported after this much idle, unless it ends in an earlier chunk
+#if IR_RX_PARTIAL
+    .flags.en_partial_rx = 1,                       // frames longer than the buffer go through in chunks
+#endif
+};
+// 9ms leader, 2.25ms space and the stop mark, the widths are 9000, 2250, 560 and 0 little endian
+static const uint8_t s_nec_repeat[] = {4, 0x28, 0x23, 0xCA, 0x08, 0x30, 0x02, 0x00, 0x00, 0x01, 0x23};
 static const char *TAG = "ir";
 
 static size_t encode_nec_encoder(rmt_encoder_t *encoder, rmt_channel_handle_t tx_channel, const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state)
@@ -209,82 +206,357 @@ static esp_err_t create_nec_encoder()
     return ESP_OK;
 }
 
-static inline bool check_nec_range(uint32_t signal, uint32_t spec)
+static void report_frame(const ir_proto_frame_t *frame, int64_t latency)
 {
-    return ((signal < (spec + NEC_DECODE_MARGIN_DURATION)) && (signal > (spec - NEC_DECODE_MARGIN_DURATION)));
-}
+    const ir_code_t *code = NULL;
+    uint8_t protocol = 0;
 
-static bool parse_nec_logic0(rmt_symbol_word_t symbol)
-{
-    return (check_nec_range(symbol.duration0, NEC_DATA_ZERO_DURATION_0) && check_nec_range(symbol.duration1, NEC_DATA_ZERO_DURATION_1));
+    if (frame->repeat) {
+        ESP_LOGI(TAG, "repeat frame, %lld us after the last bit", latency);
+        return;
+    }
+    // extended NEC only differs in the meaning of the address bytes, the codes are kept as NEC
+    protocol = IR_PROTO_NEC_EXT == frame->protocol ? IR_PROTO_NEC : frame->protocol;
+    code = ir_db_find_frame(protocol, (const uint8_t *)&frame->data);
+    if (code) {
+        ESP_LOGI(TAG, "recv %s frame:%08lX, address:%04X command:%04X toggle:%u, rmt_id:%u channel_id:%u, %lld us after the last bit",
+                 ir_proto_name(frame->protocol), frame->data, frame->address, frame->command, frame->toggle, code->rmt_id, code->channel_id, latency);
+    } else {
+        ESP_LOGI(TAG, "recv %s frame:%08lX, address:%04X command:%04X toggle:%u, unknown code, %lld us after the last bit",
+                 ir_proto_name(frame->protocol), frame->data, frame->address, frame->command, frame->toggle, latency);
+    }
 }
 
-static bool parse_nec_logic1(rmt_symbol_word_t symbol)
+// feed the decoder, each frame is reported with the symbol completing it, the symbol ends are counted back
+// from the hand over, the idle that ended the capture included, to tell how long after its last bit that is
+static uint32_t parse_symbols(ir_proto_stream_t *stream, const ir_rx_event_t *event, bool last, esp_err_t *err)
 {
-    return (check_nec_range(symbol.duration0, NEC_DATA_ONE_DURATION_0) && check_nec_range(symbol.duration1, NEC_DATA_ONE_DURATION_1));
+    const rmt_symbol_word_t *symbols = event->edata.received_symbols;
+    ir_proto_frame_t frame = {0};
+    int64_t end = event->time - (last ? IR_RX_IDLE_US : 0);
+    uint32_t frames = 0;
+    size_t i = 0;
+    esp_err_t ret = ESP_OK;
+
+    for (i = 0; i < event->edata.num_symbols; i++) {
+        end -= symbols[i].duration0 + symbols[i].duration1;
+    }
+    for (i = 0; i < event->edata.num_symbols; i++) {
+        end += symbols[i].duration0 + symbols[i].duration1;
+        ret = ir_proto_stream_feed(stream, symbols[i], &frame);
+        if (ESP_OK == ret) {
+            report_frame(&frame, esp_timer_get_time() - end);
+            frames++;
+        } else if (ESP_ERR_NOT_FOUND != ret && ESP_ERR_NOT_FINISHED != ret) {
+            *err = ret;
+        }
+    }
+    return frames;
 }
 
-static void parse_nec_frame(rmt_symbol_word_t *symbols, uint32_t num)
+// the receiver moves each edge by up to ~100us, durations within IR_LEARN_JITTER_US or an eighth of each other
+// are taken as the same width and replaced by their mean, so the frame packs into a few widths
+static uint32_t normalize_symbols(const rmt_symbol_word_t *symbols, uint32_t num, uint16_t *durations)
 {
-    uint32_t i = 0, j = 0, k = 0;
-    uint8_t frame[NEC_FRAME_LEN] = {0};
-
-    // for (k = 0; k < num; k++) {
-    //     ESP_LOGI(TAG, "%02lu: {%u:%u},{%u:%u}", k, symbols[k].level0, symbols[k].duration0, symbols[k].level1, symbols[k].duration1);
-    // }
-
-    if (34 == num) {
-        if (!(check_nec_range(symbols[0].duration0, NEC_LEADING_CODE_DURATION_0) && check_nec_range(symbols[0].duration1, NEC_LEADING_CODE_DURATION_1))) {
-            ESP_LOGE(TAG, "invalid leading symbol");
-            return;
+    uint32_t sum[IR_LEARN_CLUSTER_MAX] = {0};
+    uint16_t count[IR_LEARN_CLUSTER_MAX] = {0};
+    uint32_t duration = 0, mean = 0, diff = 0, best = 0, len = 0, i = 0;
+    uint8_t clusters = 0, k = 0, nearest = 0;
+
+    for (i = 0; i < num * 2; i++) {
+        duration = (i & 1) ? symbols[i / 2].duration1 : symbols[i / 2].duration0;
+        if (0 == duration) {
+            break; // end of the capture
         }
-
-        k = 1;
-        for (i = 0; i < NEC_FRAME_LEN; i++) {
-            for (j = 0; j < 8; j++) {
-                if (parse_nec_logic1(symbols[k])) {
-                    frame[i] |= 1 << j;
-                } else if (parse_nec_logic0(symbols[k])) {
-                    frame[i] &= ~(1 << j);
-                } else {
-                    ESP_LOGE(TAG, "invalid symbol, k:%lu", k);
-                    return;
-                }
-                k++;
-            }            
+        best = UINT32_MAX;
+        for (k = 0; k < clusters; k++) {
+            mean = sum[k] / count[k];
+            diff = duration > mean ? duration - mean : mean - duration;
+            if (diff < best) {
+                best = diff;
+                nearest = k;
+            }
         }
-        ESP_LOGI(TAG, "recv frame:%02X %02X %02X %02X", frame[0], frame[1], frame[2], frame[3]);
-    } else if (2 == num) {
-        if (check_nec_range(symbols[0].duration0, NEC_REPEAT_CODE_DURATION_0) && check_nec_range(symbols[0].duration1, NEC_REPEAT_CODE_DURATION_1)) {
-            ESP_LOGI(TAG, "repeat frame");
-        } else {
-            ESP_LOGE(TAG, "unknown frame");
+        if (clusters < IR_LEARN_CLUSTER_MAX && (0 == clusters || (best > IR_LEARN_JITTER_US && best * 8 > sum[nearest] / count[nearest]))) {
+            nearest = clusters++;
         }
+        sum[nearest] += duration;
+        count[nearest]++;
+        durations[len++] = nearest; // the cluster until its mean is known
+    }
+    for (i = 0; i < len; i++) {
+        durations[i] = sum[durations[i]] / count[durations[i]];
+    }
+    return len;
+}
+
+// false if the capture is too short to be the frame and learning goes on
+static bool learn_frame(const ir_learn_t *learn, rmt_symbol_word_t *symbols, uint32_t num, int64_t captured)
+{
+    ir_code_t code = {
+        .rmt_id = learn->rmt_id,
+        .channel_id = learn->channel_id,
+        .protocol = IR_PROTO_NEC,
+    };
+    ir_proto_frame_t frame = {0};
+    uint8_t raw[IR_RAW_MAX] = {0};
+    uint16_t raw_len = 0;
+
+    if (num < IR_LEARN_SYMBOLS_MIN) {
+        return false; // repeat codes and noise, keep waiting for a full frame
+    }
+    if (num > IR_LEARN_SYMBOLS) {
+        ESP_LOGE(TAG, "learn error, %lu symbols, over %u, press the key again", num, IR_LEARN_SYMBOLS);
+        return false;
+    }
+    // a capture ends on a zero duration, without it the rx buffer filled up and the rest of the frame is lost
+    if (symbols[num - 1].duration0 && symbols[num - 1].duration1) {
+        ESP_LOGE(TAG, "learn error, capture cut at %lu symbols, press the key again", num);
+        return false;
+    }
+    // only the NEC family has an encoder here, other protocols are replayed from their durations
+    if (ESP_OK == ir_proto_decode(symbols, num, &frame) && (IR_PROTO_NEC == frame.protocol || IR_PROTO_NEC_EXT == frame.protocol)) {
+        memcpy(code.frame, &frame.data, IR_FRAME_LEN);
     } else {
-        ESP_LOGE(TAG, "unknown frame");
+        code.protocol = IR_PROTO_RAW;
+        raw_len = ir_raw_pack(s_learn_durations, normalize_symbols(symbols, num, s_learn_durations), raw, sizeof(raw));
+        if (0 == raw_len) {
+            ESP_LOGE(TAG, "learn error, %lu symbols do not pack into %u bytes, press the key again", num, IR_RAW_MAX);
+            return false;
+        }
+    }
+    if (ESP_OK == ir_db_learn(&code, raw, raw_len)) {
+        ESP_LOGI(TAG, "learn done, rmt_id:%u channel_id:%u, %lu symbols, %lld us to store",
+                 code.rmt_id, code.channel_id, num, esp_timer_get_time() - captured);
     }
+    return true;
 }
 
+static inline bool capture_done(const rmt_rx_done_event_data_t *edata)
+{
+#if IR_RX_PARTIAL
+    return edata->flags.is_last;
+#else
+    return true;
+#endif
+}
+
+// a chunk dropped since the capture began leaves a hole in it, without ping-pong captures are dropped whole
+static inline bool capture_lost(uint32_t dropped)
+{
+#if IR_RX_PARTIAL
+    return dropped != s_rx_dropped;
+#else
+    return false;
+#endif
+}
+
+// a full queue drops the capture and keeps its buffer, the pool always has a free one for the next capture
 static bool ir_recv_done_cb(rmt_channel_handle_t channel, const rmt_rx_done_event_data_t *edata, void *user_data)
 {
     BaseType_t high_task_wakeup = pdFALSE;
-    xQueueSendFromISR(s_hd_queue, edata, &high_task_wakeup);
+    ir_rx_event_t event = {
+        .edata = *edata,
+        .time = esp_timer_get_time(),
+    };
+
+#if IR_RX_PARTIAL
+    // the driver copies the next symbols over the buffer as soon as this returns
+    event.edata.received_symbols = s_rx_buffers[s_rx_next];
+    memcpy(event.edata.received_symbols, edata->received_symbols, edata->num_symbols * sizeof(rmt_symbol_word_t));
+#endif
+    if (pdTRUE == xQueueSendFromISR(s_hd_queue, &event, &high_task_wakeup)) {
+        s_rx_next = (s_rx_next + 1) % IR_RX_BUFFERS;
+    } else {
+        s_rx_dropped++;
+    }
+    if (capture_done(edata)) {
+        s_rx_captures++;
+#if IR_RX_PARTIAL
+        rmt_receive(channel, s_rx_symbols, sizeof(s_rx_symbols), &s_rx_cfg);
+#else
+        rmt_receive(channel, s_rx_buffers[s_rx_next], sizeof(s_rx_buffers[0]), &s_rx_cfg);
+#endif
+    }
     return high_task_wakeup == pdTRUE;
 }
 
 static void ir_recv_task(void* parameter) {
-    rmt_receive_config_t receive_cfg = {
-        .signal_range_min_ns = 1250,     // the shortest duration for NEC signal is 560us, valid signal won't be treated as noise
-        .signal_range_max_ns = 12000000, // the longest duration for NEC signal is 9000us, the receive won't stop early
-    };
-    rmt_symbol_word_t raw_symbols[64] = {0}; // standard NEC frame 34 symbols
-    rmt_rx_done_event_data_t rx_data = {0};
+    ir_rx_event_t event = {0};
+    ir_proto_stream_t stream = {0};
+    ir_learn_t learn = {0};
+    uint32_t num = 0, learn_num = 0, frames = 0, dropped = 0, capture_dropped = 0;
+    bool received = false;
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+
+#if IR_RX_PARTIAL
+    rmt_receive(s_hd_rx_channel, s_rx_symbols, sizeof(s_rx_symbols), &s_rx_cfg);
+#else
+    rmt_receive(s_hd_rx_channel, s_rx_buffers[s_rx_next], sizeof(s_rx_buffers[0]), &s_rx_cfg);
+#endif
+    while (1) {
+        received = xQueueReceive(s_hd_queue, &event, (1000 / portTICK_PERIOD_MS)) == pdPASS;
+        // a request is taken between captures only, one capture is never learned for two keys
+        if (0 == num) {
+            xQueueReceive(s_hd_learn_queue, &learn, 0);
+        }
+        if (received) {
+            if (0 == num) {
+                capture_dropped = s_rx_dropped;
+            }
+            num += event.edata.num_symbols;
+            if (learn.deadline) {
+                // counted past IR_LEARN_SYMBOLS without a copy, learn_frame refuses the capture when it is over
+                if (learn_num + event.edata.num_symbols <= IR_LEARN_SYMBOLS) {
+                    memcpy(s_learn_symbols + learn_num, event.edata.received_symbols, event.edata.num_symbols * sizeof(rmt_symbol_word_t));
+                }
+                learn_num += event.edata.num_symbols;
+            } else {
+                frames += parse_symbols(&stream, &event, capture_done(&event.edata), &err);
+            }
+            if (capture_done(&event.edata)) {
+                if (learn_num) {
+                    if (capture_lost(capture_dropped)) {
+                        ESP_LOGE(TAG, "learn error, chunks of the capture dropped, press the key again");
+                    } else if (learn_frame(&learn, s_learn_symbols, learn_num, esp_timer_get_time())) {
+                        learn.deadline = 0;
+                    }
+                } else if (0 == frames) {
+                    ESP_LOGE(TAG, "unknown frame, %lu symbols, err:%d", num, stream.timing ? ESP_ERR_INVALID_SIZE : err);
+                }
+                ir_proto_stream_reset(&stream);
+                num = learn_num = frames = 0;
+                err = ESP_ERR_NOT_FOUND;
+            }
+        }
+        if (dropped != s_rx_dropped) {
+            dropped = s_rx_dropped;
+            ESP_LOGW(TAG, "rx queue full, %lu captures dropped since boot", dropped);
+        }
+        if (learn.deadline && esp_timer_get_time() > learn.deadline) {
+            learn.deadline = 0;
+            ESP_LOGW(TAG, "learn timeout, rmt_id:%u channel_id:%u", learn.rmt_id, learn.channel_id);
+        }
+    }
+}
+
+static void ir_tx_gap_cb(void *arg)
+{
+    xSemaphoreGive(s_hd_tx_gap);
+}
+
+// the ticks are 10ms, a one shot timer ends the gap to the microsecond
+static void wait_until(int64_t time)
+{
+    int64_t now = esp_timer_get_time();
+
+    if (time <= now) {
+        return;
+    }
+    esp_timer_start_once(s_hd_tx_timer, time - now);
+    xSemaphoreTake(s_hd_tx_gap, portMAX_DELAY);
+}
+
+// by priority, then in the order queued, returns the new count
+static uint8_t insert_pending(ir_tx_item_t *pending, uint8_t count, const ir_tx_item_t *item)
+{
+    uint8_t i = count;
+
+    while (i && pending[i - 1].priority < item->priority) {
+        pending[i] = pending[i - 1];
+        i--;
+    }
+    pending[i] = *item;
+    return count + 1;
+}
+
+// IR_TX_RAW_SLOTS if every slot holds a frame waiting to be sent
+static uint8_t tx_raw_take(void)
+{
+    uint8_t i = 0;
+
+    taskENTER_CRITICAL(&s_tx_raw_lock);
+    while (i < IR_TX_RAW_SLOTS && (s_tx_raw_used & (1 << i))) {
+        i++;
+    }
+    if (i < IR_TX_RAW_SLOTS) {
+        s_tx_raw_used |= 1 << i;
+    }
+    taskEXIT_CRITICAL(&s_tx_raw_lock);
+    return i;
+}
+
+static void tx_raw_give(uint8_t slot)
+{
+    taskENTER_CRITICAL(&s_tx_raw_lock);
+    s_tx_raw_used &= ~(1 << slot);
+    taskEXIT_CRITICAL(&s_tx_raw_lock);
+}
+
+static void send_code(const ir_tx_item_t *item)
+{
+    if (IR_PROTO_RAW == item->code.protocol) {
+        ir_send_packed(s_tx_raw[item->raw_slot], item->raw_len);
+        return;
+    }
+    ir_send(item->code.frame, NEC_FRAME_LEN);
+}
+
+// one frame at a time, a higher priority command waiting goes next, a held NEC key goes as repeat codes
+static void ir_send_task(void* parameter) {
+    ir_tx_item_t *pending = s_tx_pending;
+    ir_tx_item_t item = {0};
+    uint8_t count = 0, depth = 0, last_frame[IR_FRAME_LEN] = {0};
+    int64_t start = 0, next = 0, last_start = 0, latency = 0;
+    bool held = false, repeat = false;
 
-    rmt_receive(s_hd_rx_channel, raw_symbols, sizeof(raw_symbols), &receive_cfg);
     while (1) {
-        if (xQueueReceive(s_hd_queue, &rx_data, (1000 / portTICK_PERIOD_MS)) == pdPASS) {
-            parse_nec_frame(rx_data.received_symbols, rx_data.num_symbols);
-            rmt_receive(s_hd_rx_channel, raw_symbols, sizeof(raw_symbols), &receive_cfg);
+        if (0 == count && pdPASS == xQueueReceive(s_hd_tx_queue, &item, portMAX_DELAY)) {
+            count = insert_pending(pending, count, &item);
+        }
+        wait_until(next);
+        // whatever came in during the gap competes for this slot
+        while (count < IR_TX_QUEUE_LEN && pdPASS == xQueueReceive(s_hd_tx_queue, &item, 0)) {
+            count = insert_pending(pending, count, &item);
+        }
+        depth = count + uxQueueMessagesWaiting(s_hd_tx_queue);
+        item = pending[0];
+        memmove(pending, pending + 1, --count * sizeof(ir_tx_item_t));
+
+        start = esp_timer_get_time();
+        repeat = held && IR_PROTO_RAW != item.code.protocol && start - last_start < IR_TX_REPEAT_WINDOW_US
+                 && 0 == memcmp(last_frame, item.code.frame, IR_FRAME_LEN);
+        if (repeat) {
+            ir_send_packed(s_nec_repeat, sizeof(s_nec_repeat));
+        } else {
+            send_code(&item);
+        }
+        latency = start - item.queued;
+        taskENTER_CRITICAL(&s_tx_stats_lock);
+        s_tx_stats.sent++;
+        s_tx_stats.repeats += repeat;
+        if (depth > s_tx_stats.depth_max) {
+            s_tx_stats.depth_max = depth;
+        }
+        if (latency > s_tx_stats.latency_max) {
+            s_tx_stats.latency_max = latency;
+        }
+        taskEXIT_CRITICAL(&s_tx_stats_lock);
+        ESP_LOGI(TAG, "send %s %02X %02X %02X %02X, %lld us after the command, %u queued",
+                 repeat ? "repeat" : ir_proto_name(item.code.protocol),
+                 item.code.frame[0], item.code.frame[1], item.code.frame[2], item.code.frame[3], latency, depth - 1);
+
+        // the NEC encoder ends with its own 32ms space, a raw frame only is known to be over when it is sent
+        if (IR_PROTO_RAW == item.code.protocol) {
+            rmt_tx_wait_all_done(s_hd_tx_channel, 1000 / portTICK_PERIOD_MS);
+            tx_raw_give(item.raw_slot); // the encoder has read the last of it
+            next = esp_timer_get_time() + IR_TX_RAW_GAP_US;
+            held = false;
+        } else {
+            next = start + IR_TX_NEC_PERIOD_US;
+            held = true;
+            last_start = start;
+            memcpy(last_frame, item.code.frame, IR_FRAME_LEN);
         }
     }
 }
@@ -310,8 +582,16 @@ void ir_init() {
         .duty_cycle = 0.33,
         .frequency_hz = 38000,
     };
+    esp_timer_create_args_t tx_timer_cfg = {
+        .callback = ir_tx_gap_cb,
+        .name = "ir_tx_gap",
+    };
 
-    s_hd_queue = xQueueCreate(1, sizeof(rmt_rx_done_event_data_t));
+    ir_db_init();
+    s_hd_queue = xQueueCreate(IR_RX_QUEUE_LEN, sizeof(ir_rx_event_t));
+    s_hd_tx_queue = xQueueCreate(IR_TX_QUEUE_LEN, sizeof(ir_tx_item_t));
+    s_hd_learn_queue = xQueueCreate(1, sizeof(ir_learn_t));
+    s_hd_tx_gap = xSemaphoreCreateBinary();
 
     rmt_new_rx_channel(&rx_channel_cfg, &s_hd_rx_channel);
     rmt_rx_register_event_callbacks(s_hd_rx_channel, &rx_cbs, NULL);
@@ -321,10 +601,13 @@ void ir_init() {
     rmt_enable(s_hd_tx_channel);
 
     create_nec_encoder();
-    xTaskCreate(ir_recv_task, "ir_recv_task", 2048, NULL, 1, NULL);
+    rmt_new_ir_raw_encoder(CONFIG_IR_RESOLUTION_HZ, &s_hd_raw_encoder);
+    esp_timer_create(&tx_timer_cfg, &s_hd_tx_timer);
+    xTaskCreate(ir_recv_task, "ir_recv_task", 4096, NULL, 1, NULL); // learning writes nvs from this task
+    xTaskCreate(ir_send_task, "ir_send_task", 4096, NULL, 2, NULL);
 }
 
-void ir_send(uint8_t *data, uint32_t len) {
+void ir_send(const uint8_t *data, uint32_t len) {
     rmt_transmit_config_t transmit_cfg = {
         .loop_count = 0, // no loop
     };
@@ -332,21 +615,64 @@ void ir_send(uint8_t *data, uint32_t len) {
     rmt_transmit(s_hd_tx_channel, s_hd_nec_encoder, data, len, &transmit_cfg);
 }
 
-void ir_recv(uint8_t rmt_id, uint8_t channel_id) {
-    uint8_t i = 0, j = 0;
-
-    for (i = 0; i < RMTID_MAX; i++) {
-        if (rmt_id == rmt_infos[i].rmt_id) {
-            for (j = 0; j < CHANNELID_MAX; j++) {
-                if (channel_id == rmt_infos[i].rmt_channels[j].channel_id) {
-                    ESP_LOGI(TAG, "send frame:%02X %02X %02X %02X",
-                             rmt_infos[i].rmt_channels[j].channel_frame[0], rmt_infos[i].rmt_channels[j].channel_frame[1],
-                             rmt_infos[i].rmt_channels[j].channel_frame[2], rmt_infos[i].rmt_channels[j].channel_frame[3]);
-                    ir_send(rmt_infos[i].rmt_channels[j].channel_frame, NEC_FRAME_LEN);
-                    return;                    
-                }
-            }
-        }
+void ir_send_packed(const uint8_t *packed, uint32_t size) {
+    rmt_transmit_config_t transmit_cfg = {
+        .loop_count = 0, // no loop
+    };
+
+    rmt_transmit(s_hd_tx_channel, s_hd_raw_encoder, packed, size, &transmit_cfg);
+}
+
+void ir_recv(uint8_t rmt_id, uint8_t channel_id, uint8_t priority) {
+    ir_tx_item_t item = {
+        .queued = esp_timer_get_time(),
+        .priority = priority,
+        .raw_slot = tx_raw_take(),
+    };
+    bool raw = false;
+    esp_err_t err = ESP_OK;
+
+    // the slot is taken before the copy, the lock of the db is not held across the one of the slots
+    err = ir_db_copy_channel(rmt_id, channel_id, &item.code, item.raw_slot < IR_TX_RAW_SLOTS ? s_tx_raw[item.raw_slot] : NULL, &item.raw_len);
+    raw = ESP_OK == err && IR_PROTO_RAW == item.code.protocol;
+    if (item.raw_slot < IR_TX_RAW_SLOTS && !raw) {
+        tx_raw_give(item.raw_slot);
+    }
+    if (ESP_ERR_NOT_FOUND == err) {
+        ESP_LOGE(TAG, "no code, rmt_id:%u channel_id:%u", rmt_id, channel_id);
+        return;
+    }
+    if (ESP_OK == err && pdPASS == xQueueSend(s_hd_tx_queue, &item, 0)) {
+        return;
+    }
+    if (raw) {
+        tx_raw_give(item.raw_slot);
     }
+    taskENTER_CRITICAL(&s_tx_stats_lock);
+    s_tx_stats.dropped++;
+    taskEXIT_CRITICAL(&s_tx_stats_lock);
+    ESP_LOGE(TAG, "tx %s full, rmt_id:%u channel_id:%u", ESP_OK == err ? "queue" : "raw slots", rmt_id, channel_id);
 }
 
+void ir_get_tx_stats(ir_tx_stats_t *stats) {
+    taskENTER_CRITICAL(&s_tx_stats_lock);
+    *stats = s_tx_stats;
+    taskEXIT_CRITICAL(&s_tx_stats_lock);
+}
+
+void ir_get_rx_stats(uint32_t *captures, uint32_t *dropped) {
+    *captures = s_rx_captures;
+    *dropped = s_rx_dropped;
+}
+
+// the request replaces one the rx task has not taken yet
+void ir_learn_start(uint8_t rmt_id, uint8_t channel_id, uint32_t timeout_ms) {
+    ir_learn_t learn = {
+        .rmt_id = rmt_id,
+        .channel_id = channel_id,
+        .deadline = esp_timer_get_time() + timeout_ms * 1000LL,
+    };
+
+    xQueueOverwrite(s_hd_learn_queue, &learn);
+    ESP_LOGI(TAG, "learn start, rmt_id:%u channel_id:%u, press the key in %lu ms", rmt_id, channel_id, timeout_ms);
+}
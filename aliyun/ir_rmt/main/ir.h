@@ -41,9 +41,34 @@
 #define CONFIG_GPIO_NUM_IR_TX               18
 #define CONFIG_GPIO_NUM_IR_RX               19
 
+#define IR_TX_PRIO_NORMAL                   0
+#define IR_TX_PRIO_HIGH                     1   // power and the like, sent before the normal commands waiting
+
+typedef struct {
+    uint32_t sent;                      // frames, repeat codes included
+    uint32_t repeats;                   // NEC repeat codes sent for a held key
+    uint32_t dropped;                   // commands refused with the queue or the raw slots full
+    uint32_t depth_max;                 // commands waiting at most
+    uint32_t latency_max;               // us, command to the start of its frame
+} ir_tx_stats_t;
+
 
 void ir_init();
-void ir_send(uint8_t *data, uint32_t len);
-void ir_recv(uint8_t rmt_id, uint8_t channel_id);
+// ir_send and ir_send_packed go straight to the rmt, the commands go through ir_recv
+void ir_send(const uint8_t *data, uint32_t len);
+// a frame packed as in ir_raw_encoder.h, any length, packed must stay valid until it is sent,
+// learned raw codes are kept in this form, up to IR_RAW_MAX bytes
+void ir_send_packed(const uint8_t *packed, uint32_t size);
+// queue the code of the channel, the frames go out one by one with the gap their protocol needs,
+// a raw code also needs one of the few slots for its frame, it is dropped like with the queue full otherwise
+void ir_recv(uint8_t rmt_id, uint8_t channel_id, uint8_t priority);
+// since boot
+void ir_get_tx_stats(ir_tx_stats_t *stats);
+// since boot, dropped - captures or chunks of them lost with the rx queue full
+void ir_get_rx_stats(uint32_t *captures, uint32_t *dropped);
+// the next frame received within timeout_ms is stored as the code of the channel,
+// a capture over 512 symbols or cut by the rx buffer is refused and learning goes on,
+// chips without rx ping-pong (the ESP32) receive 64 symbols at most, so longer frames are never learned there
+void ir_learn_start(uint8_t rmt_id, uint8_t channel_id, uint32_t timeout_ms);
 
 #endif
@@ -0,0 +1,363 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "nvs.h"
+#include "esp_log.h"
+#include "ir.h"
+#include "ir_db.h"
+#include "ir_raw_encoder.h"
+
+
+#define IR_DB_SLOTS_BITS                    7
+#define IR_DB_SLOTS                         (1 << IR_DB_SLOTS_BITS) // open addressing, keep it twice the codes at least
+#define IR_DB_EMPTY                         0xFF
+#define IR_DB_LEARN_MAX                     16
+#define IR_DB_NVS_NAMESPACE                 "ir_learn"
+#define IR_DB_NVS_HEAD                      (1 + IR_FRAME_LEN) // protocol and frame, the packed raw frame follows
+#define IR_DB_BUILTIN_NUM                   (sizeof(s_codes) / sizeof(s_codes[0]))
+
+typedef struct {
+    ir_code_t code;
+    uint16_t raw_len;
+    uint8_t *raw;                       // IR_RAW_MAX bytes, allocated by the first raw code of the slot
+} ir_learned_t;
+
+// dense table in flash, one entry for each code the remotes really have
+static const ir_code_t s_codes[] = {
+    {RMTID_TV,            CHANNELID_0,            {0x4C, 0x65, 0x45, 0xBA}},
+    {RMTID_TV,            CHANNELID_1,            {0x4C, 0x65, 0x01, 0xFE}},
+    {RMTID_TV,            CHANNELID_2,            {0x4C, 0x65, 0x02, 0xFD}},
+    {RMTID_TV,            CHANNELID_3,            {0x4C, 0x65, 0x03, 0xFC}},
+    {RMTID_TV,            CHANNELID_4,            {0x4C, 0x65, 0x04, 0xFB}},
+    {RMTID_TV,            CHANNELID_5,            {0x4C, 0x65, 0x05, 0xFA}},
+    {RMTID_TV,            CHANNELID_6,            {0x4C, 0x65, 0x06, 0xF9}},
+    {RMTID_TV,            CHANNELID_7,            {0x4C, 0x65, 0x07, 0xF8}},
+    {RMTID_TV,            CHANNELID_8,            {0x4C, 0x65, 0x08, 0xF7}},
+    {RMTID_TV,            CHANNELID_9,            {0x4C, 0x65, 0x09, 0xF6}},
+    {RMTID_TV,            CHANNELID_UP,           {0x4C, 0x65, 0x0B, 0xF4}},
+    {RMTID_TV,            CHANNELID_DOWN,         {0x4C, 0x65, 0x0E, 0xF1}},
+    {RMTID_TV,            CHANNELID_LEFT,         {0x4C, 0x65, 0x10, 0xEF}},
+    {RMTID_TV,            CHANNELID_RIGHT,        {0x4C, 0x65, 0x11, 0xEE}},
+    {RMTID_TV,            CHANNELID_OK,           {0x4C, 0x65, 0x0D, 0xF2}},
+    {RMTID_TV,            CHANNELID_VOLUME_ADD,   {0x4C, 0x65, 0x15, 0xEA}},
+    {RMTID_TV,            CHANNELID_VOLUME_SUB,   {0x4C, 0x65, 0x1C, 0xE3}},
+    {RMTID_TV,            CHANNELID_CHANNEL_ADD,  {0x4C, 0x65, 0x1F, 0xE0}},
+    {RMTID_TV,            CHANNELID_CHANNEL_SUB,  {0x4C, 0x65, 0x1E, 0xE1}},
+    {RMTID_TV,            CHANNELID_POWER,        {0x4C, 0x65, 0x0A, 0xF5}},
+    {RMTID_TV,            CHANNELID_HOME,         {0x4C, 0x65, 0x16, 0xE9}},
+    {RMTID_TV,            CHANNELID_SIGNAL,       {0x4C, 0x65, 0x0C, 0xF3}},
+    {RMTID_TV,            CHANNELID_MUTE,         {0x4C, 0x65, 0x0F, 0xF0}},
+    {RMTID_TV,            CHANNELID_BACK,         {0x4C, 0x65, 0x1D, 0xE2}},
+    {RMTID_TV,            CHANNELID_MENU,         {0x4C, 0x65, 0x37, 0xC8}},
+    {RMTID_TV,            CHANNELID_SETTING,      {0x4C, 0x65, 0x00, 0xFF}},
+    {RMTID_SETTOPBOX,     CHANNELID_0,            {0x22, 0xDD, 0x87, 0x78}},
+    {RMTID_SETTOPBOX,     CHANNELID_1,            {0x22, 0xDD, 0x92, 0x6D}},
+    {RMTID_SETTOPBOX,     CHANNELID_2,            {0x22, 0xDD, 0x93, 0x6C}},
+    {RMTID_SETTOPBOX,     CHANNELID_3,            {0x22, 0xDD, 0xCC, 0x33}},
+    {RMTID_SETTOPBOX,     CHANNELID_4,            {0x22, 0xDD, 0x8E, 0x71}},
+    {RMTID_SETTOPBOX,     CHANNELID_5,            {0x22, 0xDD, 0x8F, 0x70}},
+    {RMTID_SETTOPBOX,     CHANNELID_6,            {0x22, 0xDD, 0xC8, 0x37}},
+    {RMTID_SETTOPBOX,     CHANNELID_7,            {0x22, 0xDD, 0x8A, 0x75}},
+    {RMTID_SETTOPBOX,     CHANNELID_8,            {0x22, 0xDD, 0x8B, 0x74}},
+    {RMTID_SETTOPBOX,     CHANNELID_9,            {0x22, 0xDD, 0xC4, 0x3B}},
+    {RMTID_SETTOPBOX,     CHANNELID_UP,           {0x22, 0xDD, 0xCA, 0x35}},
+    {RMTID_SETTOPBOX,     CHANNELID_DOWN,         {0x22, 0xDD, 0xD2, 0x2D}},
+    {RMTID_SETTOPBOX,     CHANNELID_LEFT,         {0x22, 0xDD, 0x99, 0x66}},
+    {RMTID_SETTOPBOX,     CHANNELID_RIGHT,        {0x22, 0xDD, 0xC1, 0x3E}},
+    {RMTID_SETTOPBOX,     CHANNELID_OK,           {0x22, 0xDD, 0xCE, 0x31}},
+    {RMTID_SETTOPBOX,     CHANNELID_VOLUME_ADD,   {0x22, 0xDD, 0x80, 0x7F}},
+    {RMTID_SETTOPBOX,     CHANNELID_VOLUME_SUB,   {0x22, 0xDD, 0x81, 0x7E}},
+    {RMTID_SETTOPBOX,     CHANNELID_CHANNEL_ADD,  {0x22, 0xDD, 0x85, 0x7A}},
+    {RMTID_SETTOPBOX,     CHANNELID_CHANNEL_SUB,  {0x22, 0xDD, 0x86, 0x79}},
+    {RMTID_SETTOPBOX,     CHANNELID_POWER,        {0x22, 0xDD, 0xDC, 0x23}},
+    {RMTID_SETTOPBOX,     CHANNELID_HOME,         {0x22, 0xDD, 0x88, 0x77}},
+    {RMTID_SETTOPBOX,     CHANNELID_SIGNAL,       {0x4C, 0x65, 0x0C, 0xF3}},
+    {RMTID_SETTOPBOX,     CHANNELID_MUTE,         {0x22, 0xDD, 0x9C, 0x63}},
+    {RMTID_SETTOPBOX,     CHANNELID_BACK,         {0x22, 0xDD, 0x95, 0x6A}},
+    {RMTID_SETTOPBOX,     CHANNELID_MENU,         {0x22, 0xDD, 0x82, 0x7D}},
+    {RMTID_SETTOPBOX,     CHANNELID_SETTING,      {0x22, 0xDD, 0x8D, 0x72}},
+    {RMTID_LIGHT_BEDROOM, CHANNELID_VOLUME_ADD,   {0x00, 0xFF, 0x40, 0xBF}},
+    {RMTID_LIGHT_BEDROOM, CHANNELID_VOLUME_SUB,   {0x00, 0xFF, 0x19, 0xE6}},
+    {RMTID_LIGHT_BEDROOM, CHANNELID_POWER,        {0x00, 0xFF, 0x0D, 0xF2}}
+};
+
+_Static_assert(IR_DB_BUILTIN_NUM + IR_DB_LEARN_MAX <= IR_DB_SLOTS * 3 / 4, "ir db index too small");
+
+// index slots hold the position in s_codes, then in s_learned, the whole index costs 2 * IR_DB_SLOTS bytes of ram
+static uint8_t s_channel_index[IR_DB_SLOTS] = {0};
+static uint8_t s_frame_index[IR_DB_SLOTS] = {0};
+static ir_learned_t s_learned[IR_DB_LEARN_MAX] = {0};
+static uint8_t s_learned_num = 0;
+static SemaphoreHandle_t s_db_lock = NULL;
+static const char *TAG = "ir_db";
+
+static inline const ir_code_t *code_at(uint8_t pos)
+{
+    return pos < IR_DB_BUILTIN_NUM ? &s_codes[pos] : &s_learned[pos - IR_DB_BUILTIN_NUM].code;
+}
+
+static inline uint64_t channel_key(uint8_t rmt_id, uint8_t channel_id)
+{
+    return (rmt_id << 8) | channel_id;
+}
+
+// the same payload in two protocols is two different codes
+static inline uint64_t frame_key(uint8_t protocol, const uint8_t *frame)
+{
+    return ((uint64_t)protocol << 32) | frame[0] | (frame[1] << 8) | (frame[2] << 16) | ((uint32_t)frame[3] << 24);
+}
+
+// fibonacci hashing, the top bits of the product are well mixed even for the small sequential channel keys
+static inline uint32_t hash_slot(uint64_t key)
+{
+    return (key * 0x9E3779B97F4A7C15ULL) >> (64 - IR_DB_SLOTS_BITS);
+}
+
+static void insert_index(uint8_t *index, uint64_t key, uint8_t pos, uint64_t (*get_key)(uint8_t pos))
+{
+    uint32_t slot = hash_slot(key);
+
+    while (IR_DB_EMPTY != index[slot]) {
+        if (get_key(index[slot]) == key) {
+            ESP_LOGD(TAG, "code %u shadowed by code %u", pos, index[slot]);
+            return;
+        }
+        slot = (slot + 1) & (IR_DB_SLOTS - 1);
+    }
+    index[slot] = pos;
+}
+
+static const ir_code_t *find_index(const uint8_t *index, uint64_t key, uint64_t (*get_key)(uint8_t pos))
+{
+    uint32_t slot = hash_slot(key);
+
+    while (IR_DB_EMPTY != index[slot]) {
+        if (get_key(index[slot]) == key) {
+            return code_at(index[slot]);
+        }
+        slot = (slot + 1) & (IR_DB_SLOTS - 1);
+    }
+    return NULL;
+}
+
+static uint64_t code_channel_key(uint8_t pos)
+{
+    return channel_key(code_at(pos)->rmt_id, code_at(pos)->channel_id);
+}
+
+static uint64_t code_frame_key(uint8_t pos)
+{
+    return frame_key(code_at(pos)->protocol, code_at(pos)->frame);
+}
+
+// learned codes go in first, so they replace the built in code of the same key
+static void build_index()
+{
+    uint8_t i = 0;
+
+    memset(s_channel_index, IR_DB_EMPTY, sizeof(s_channel_index));
+    memset(s_frame_index, IR_DB_EMPTY, sizeof(s_frame_index));
+    for (i = 0; i < s_learned_num; i++) {
+        insert_index(s_channel_index, code_channel_key(IR_DB_BUILTIN_NUM + i), IR_DB_BUILTIN_NUM + i, code_channel_key);
+        if (IR_PROTO_RAW != s_learned[i].code.protocol) {
+            insert_index(s_frame_index, code_frame_key(IR_DB_BUILTIN_NUM + i), IR_DB_BUILTIN_NUM + i, code_frame_key);
+        }
+    }
+    for (i = 0; i < IR_DB_BUILTIN_NUM; i++) {
+        insert_index(s_channel_index, code_channel_key(i), i, code_channel_key);
+        insert_index(s_frame_index, code_frame_key(i), i, code_frame_key);
+    }
+}
+
+// the slot the code goes to, its own if the key was learned before, the caller holds s_db_lock
+static esp_err_t find_learned(const ir_code_t *code, const uint8_t *raw, uint16_t raw_len, uint8_t *pos)
+{
+    uint8_t i = 0;
+
+    if (IR_PROTO_RAW == code->protocol && (0 == raw_len || raw_len > IR_RAW_MAX)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    // the send task hands the frame to the raw encoder as it is, the ticks of older builds end here too
+    if (IR_PROTO_RAW == code->protocol && 0 == ir_raw_count(raw, raw_len)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (i = 0; i < s_learned_num; i++) {
+        if (s_learned[i].code.rmt_id == code->rmt_id && s_learned[i].code.channel_id == code->channel_id) {
+            break;
+        }
+    }
+    if (i == IR_DB_LEARN_MAX) {
+        ESP_LOGE(TAG, "learned codes full");
+        return ESP_ERR_NO_MEM;
+    }
+    *pos = i;
+    return ESP_OK;
+}
+
+// only touches ram, the caller holds s_db_lock
+static esp_err_t add_learned(const ir_code_t *code, const uint8_t *raw, uint16_t raw_len)
+{
+    ir_learned_t *learned = NULL;
+    uint8_t i = 0;
+    esp_err_t err = find_learned(code, raw, raw_len, &i);
+
+    if (ESP_OK != err) {
+        return err;
+    }
+    learned = &s_learned[i];
+    if (IR_PROTO_RAW == code->protocol) {
+        if (NULL == learned->raw) {
+            learned->raw = malloc(IR_RAW_MAX);
+            if (NULL == learned->raw) {
+                return ESP_ERR_NO_MEM;
+            }
+        }
+        memcpy(learned->raw, raw, raw_len);
+        learned->raw_len = raw_len;
+    } else {
+        learned->raw_len = 0;
+    }
+    learned->code = *code;
+    if (i == s_learned_num) {
+        s_learned_num++;
+    }
+    build_index();
+    return ESP_OK;
+}
+
+static void load_learned()
+{
+    nvs_handle_t hd_nvs = 0;
+    nvs_iterator_t it = NULL;
+    nvs_entry_info_t info = {0};
+    uint8_t blob[IR_DB_NVS_HEAD + IR_RAW_MAX] = {0};
+    size_t len = 0;
+    unsigned int rmt_id = 0, channel_id = 0;
+    ir_code_t code = {0};
+    esp_err_t err = ESP_OK;
+
+    if (ESP_OK != nvs_open(IR_DB_NVS_NAMESPACE, NVS_READONLY, &hd_nvs)) {
+        return; // nothing learned yet
+    }
+    err = nvs_entry_find(NVS_DEFAULT_PART_NAME, IR_DB_NVS_NAMESPACE, NVS_TYPE_BLOB, &it);
+    while (ESP_OK == err) {
+        nvs_entry_info(it, &info);
+        len = sizeof(blob);
+        if (2 == sscanf(info.key, "c%02X%02X", &rmt_id, &channel_id)
+            && ESP_OK == nvs_get_blob(hd_nvs, info.key, blob, &len) && len >= IR_DB_NVS_HEAD) {
+            code.rmt_id = rmt_id;
+            code.channel_id = channel_id;
+            code.protocol = blob[0];
+            memcpy(code.frame, blob + 1, IR_FRAME_LEN);
+            if (ESP_OK != add_learned(&code, blob + IR_DB_NVS_HEAD, len - IR_DB_NVS_HEAD)) {
+                ESP_LOGE(TAG, "learned code %s error", info.key);
+            }
+        }
+        err = nvs_entry_next(&it);
+    }
+    nvs_release_iterator(it);
+    nvs_close(hd_nvs);
+}
+
+void ir_db_init() {
+    s_db_lock = xSemaphoreCreateMutex();
+    build_index();
+    load_learned();
+    ESP_LOGI(TAG, "%u codes, %u learned, %u bytes flash, %u bytes index",
+             IR_DB_BUILTIN_NUM, s_learned_num, sizeof(s_codes), sizeof(s_channel_index) + sizeof(s_frame_index));
+}
+
+const ir_code_t *ir_db_find_frame(uint8_t protocol, const uint8_t *frame) {
+    const ir_code_t *code = NULL;
+
+    xSemaphoreTake(s_db_lock, portMAX_DELAY);
+    code = find_index(s_frame_index, frame_key(protocol, frame), code_frame_key);
+    xSemaphoreGive(s_db_lock);
+    return code;
+}
+
+esp_err_t ir_db_copy_channel(uint8_t rmt_id, uint8_t channel_id, ir_code_t *code, uint8_t *raw, uint16_t *raw_len) {
+    const ir_code_t *found = NULL;
+    const ir_learned_t *learned = NULL;
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+
+    *raw_len = 0;
+    // a learn may rewrite the slot as soon as the lock is given back
+    xSemaphoreTake(s_db_lock, portMAX_DELAY);
+    found = find_index(s_channel_index, channel_key(rmt_id, channel_id), code_channel_key);
+    if (found) {
+        *code = *found;
+        err = ESP_OK;
+    }
+    if (found && IR_PROTO_RAW == found->protocol) {
+        learned = __containerof(found, ir_learned_t, code);
+        if (raw) {
+            memcpy(raw, learned->raw, learned->raw_len);
+            *raw_len = learned->raw_len;
+        } else {
+            err = ESP_ERR_NO_MEM;
+        }
+    }
+    xSemaphoreGive(s_db_lock);
+    return err;
+}
+
+esp_err_t ir_db_learn(const ir_code_t *code, const uint8_t *raw, uint16_t raw_len) {
+    nvs_handle_t hd_nvs = 0;
+    nvs_stats_t stats = {0};
+    size_t used = 0;
+    uint8_t blob[IR_DB_NVS_HEAD + IR_RAW_MAX] = {0};
+    uint16_t len = IR_DB_NVS_HEAD;
+    char key[8] = {0};
+    uint8_t pos = 0;
+    esp_err_t err = ESP_OK;
+
+    // checked before the write, nvs never gets a code the ram table would refuse at boot
+    xSemaphoreTake(s_db_lock, portMAX_DELAY);
+    err = find_learned(code, raw, raw_len, &pos);
+    xSemaphoreGive(s_db_lock);
+    if (ESP_OK != err) {
+        return err;
+    }
+
+    blob[0] = code->protocol;
+    memcpy(blob + 1, code->frame, IR_FRAME_LEN);
+    if (IR_PROTO_RAW == code->protocol) {
+        memcpy(blob + IR_DB_NVS_HEAD, raw, raw_len);
+        len += raw_len;
+    }
+    snprintf(key, sizeof(key), "c%02X%02X", code->rmt_id, code->channel_id);
+    nvs_get_stats(NULL, &stats);
+    used = stats.used_entries;
+
+    err = nvs_open(IR_DB_NVS_NAMESPACE, NVS_READWRITE, &hd_nvs);
+    if (ESP_OK != err) {
+        ESP_LOGE(TAG, "nvs open error:%d", err);
+        return err;
+    }
+    err = nvs_set_blob(hd_nvs, key, blob, len);
+    if (ESP_OK == err) {
+        err = nvs_commit(hd_nvs);
+    }
+    nvs_close(hd_nvs);
+    if (ESP_OK != err) {
+        ESP_LOGE(TAG, "nvs save %s error:%d", key, err);
+        return err; // the lookups keep the code they had
+    }
+
+    // only the rx task learns, the slot found above is still free or still this key
+    xSemaphoreTake(s_db_lock, portMAX_DELAY);
+    err = add_learned(code, raw, raw_len);
+    xSemaphoreGive(s_db_lock);
+    if (ESP_OK != err) {
+        ESP_LOGE(TAG, "learned %s saved, in use from the next boot, err:%d", key, err);
+        return err;
+    }
+
+    // a replaced code frees its old entries, so this is the growth of the nvs, one entry is 32 bytes
+    nvs_get_stats(NULL, &stats);
+    ESP_LOGI(TAG, "learned %s, protocol:%u, %u bytes, %d bytes nvs", key, code->protocol, len, ((int)stats.used_entries - (int)used) * 32);
+    return ESP_OK;
+}
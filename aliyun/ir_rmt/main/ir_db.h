@@ -0,0 +1,30 @@
+#ifndef IR_DB_H_
+#define IR_DB_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "ir_proto.h"
+
+#define IR_FRAME_LEN                        4
+#define IR_RAW_MAX                          320 // bytes of a packed raw frame, see ir_raw_encoder.h, 289 symbols without a run
+
+typedef struct {
+    uint8_t rmt_id;
+    uint8_t channel_id;
+    uint8_t frame[IR_FRAME_LEN];        // ir_proto_frame_t data, little endian
+    uint8_t protocol;                   // ir_proto_t, extended NEC is kept as IR_PROTO_NEC
+} ir_code_t;
+
+// builds the indexes and loads the learned codes from nvs, nvs_flash_init() first
+void ir_db_init();
+// NULL if the frame is unknown, when two keys share a frame a learned code wins, then the first in the table
+// the code is only stable in the task that learns, the rx task, a learn may rewrite it under anybody else
+const ir_code_t *ir_db_find_frame(uint8_t protocol, const uint8_t *frame);
+// the code of the channel and its packed raw frame copied under the lock, raw - IR_RAW_MAX bytes, raw_len 0 if not raw
+// ESP_ERR_NOT_FOUND if the remote has no such channel, ESP_ERR_NO_MEM if the code is raw and raw is NULL
+esp_err_t ir_db_copy_channel(uint8_t rmt_id, uint8_t channel_id, ir_code_t *code, uint8_t *raw, uint16_t *raw_len);
+// save a learned code in nvs, then add it or replace the code of its key, raw - the packed frame of an IR_PROTO_RAW code,
+// ESP_ERR_INVALID_ARG if it does not unpack, nothing changes if the nvs write fails
+esp_err_t ir_db_learn(const ir_code_t *code, const uint8_t *raw, uint16_t raw_len);
+
+#endif
@@ -7,6 +7,8 @@
 #include "ir.h"
 
 
+#define CONFIG_TSL_LEARN_TIMEOUT_MS                 10000
+
 static uint8_t rmt_id = 0;
 static uint8_t channel_id = 0;
 static const char *TAG = "tsl";
@@ -17,7 +19,9 @@ void tsl_recv_set(uint8_t *payload, uint32_t len) {
     cJSON *param_json = cJSON_GetObjectItem(root, "params");
     cJSON *rmtId_json = cJSON_GetObjectItem(param_json, "rmtId");
     cJSON *channelId_json = cJSON_GetObjectItem(param_json, "channelId");
+    cJSON *learn_json = cJSON_GetObjectItem(param_json, "learn");
     uint8_t has_channelId = 0;
+    uint8_t learn = 0;
     // char set_reply[256] = {0};
 
     // sprintf(set_reply, "{\"code\":200, \"data\":{}, \"id\":\"%s\", \"message\":\"success\", \"version\":\"1.0.0\"}", id_json->valuestring);
@@ -30,13 +34,20 @@ void tsl_recv_set(uint8_t *payload, uint32_t len) {
         channel_id = channelId_json->valueint;
         has_channelId = 1;
     }
+    if (learn_json) {
+        learn = learn_json->valueint;
+    }
     cJSON_Delete(root);
 
     if (!has_channelId) {
         ESP_LOGI(TAG, "rmt_id:%u", rmt_id);
     } else {
-        ESP_LOGI(TAG, "rmt_id:%u, channel_id:%u", rmt_id, channel_id);
-        ir_recv(rmt_id, channel_id);
+        ESP_LOGI(TAG, "rmt_id:%u, channel_id:%u, learn:%u", rmt_id, channel_id, learn);
+        if (learn) {
+            ir_learn_start(rmt_id, channel_id, CONFIG_TSL_LEARN_TIMEOUT_MS);
+        } else {
+            ir_recv(rmt_id, channel_id, CHANNELID_POWER == channel_id ? IR_TX_PRIO_HIGH : IR_TX_PRIO_NORMAL);
+        }
     }
 }
 
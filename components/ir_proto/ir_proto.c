@@ -0,0 +1,325 @@
+#include <stdbool.h>
+#include <string.h>
+#include "ir_proto.h"
+
+#define IR_PROTO_UNITS_MAX                  64  // manchester halves of the longest frame, rc6 mode 0 has 44
+
+typedef struct ir_proto_timing_t ir_proto_timing_t;
+
+// takes the symbols after the leader one at a time, ESP_ERR_NOT_FINISHED until the last bit is in
+typedef esp_err_t (*ir_proto_feed_t)(ir_proto_stream_t *stream, const ir_proto_timing_t *timing, rmt_symbol_word_t symbol, ir_proto_frame_t *frame);
+
+// the leader picks the entry, then its feed function follows the frame symbol by symbol
+struct ir_proto_timing_t {
+    ir_proto_t protocol;
+    uint16_t leader_mark;   // us
+    uint16_t leader_space;  // us, 0 - the space depends on the first bit and is left to the feed function
+    uint16_t unit;          // us, the short mark, or one manchester half
+    uint16_t margin;        // us, how far any duration of the frame may be off
+    uint8_t length;         // bits, the most for SIRC, manchester halves for rc5 and rc6, 0 - the leader is the whole frame
+    ir_proto_feed_t feed;
+};
+
+static esp_err_t feed_pulse_distance(ir_proto_stream_t *stream, const ir_proto_timing_t *timing, rmt_symbol_word_t symbol, ir_proto_frame_t *frame);
+static esp_err_t feed_pulse_width(ir_proto_stream_t *stream, const ir_proto_timing_t *timing, rmt_symbol_word_t symbol, ir_proto_frame_t *frame);
+static esp_err_t feed_rc5(ir_proto_stream_t *stream, const ir_proto_timing_t *timing, rmt_symbol_word_t symbol, ir_proto_frame_t *frame);
+static esp_err_t feed_rc6(ir_proto_stream_t *stream, const ir_proto_timing_t *timing, rmt_symbol_word_t symbol, ir_proto_frame_t *frame);
+
+static const ir_proto_timing_t s_timings[] = {
+    {IR_PROTO_NEC,      9000,   4500,   560,    200,    32,     feed_pulse_distance},
+    {IR_PROTO_NEC,      9000,   2250,   560,    200,    0,      NULL},          // repeat code
+    {IR_PROTO_SAMSUNG,  4500,   4500,   560,    200,    32,     feed_pulse_distance},
+    {IR_PROTO_SIRC,     2400,   600,    600,    200,    20,     feed_pulse_width},
+    {IR_PROTO_RC6,      2666,   889,    444,    150,    44,     feed_rc6},
+    {IR_PROTO_RC5,      889,    0,      889,    250,    28,     feed_rc5},      // S2 = 1, the mark of S1 alone
+    {IR_PROTO_RC5,      1778,   0,      889,    250,    28,     feed_rc5},      // S2 = 0 (rc5x), joined with the first half of S2
+};
+
+static const char *s_names[IR_PROTO_MAX] = {
+    "NEC", "RAW", "NEC-EXT", "Samsung", "SIRC", "RC5", "RC6",
+};
+
+static inline bool in_range(uint32_t duration, uint32_t spec, uint32_t margin)
+{
+    return (duration + margin > spec) && (duration < spec + margin);
+}
+
+static inline uint32_t distance(uint32_t duration, uint32_t spec)
+{
+    return duration > spec ? duration - spec : spec - duration;
+}
+
+// the entry with the closest leader, the SIRC and RC6 ones overlap at the edges of their margins
+static const ir_proto_timing_t *find_leader(rmt_symbol_word_t symbol)
+{
+    const ir_proto_timing_t *timing = NULL, *found = NULL;
+    uint32_t diff = 0, found_diff = UINT32_MAX;
+    uint8_t i = 0;
+
+    for (i = 0; i < sizeof(s_timings) / sizeof(s_timings[0]); i++) {
+        timing = &s_timings[i];
+        if (!in_range(symbol.duration0, timing->leader_mark, timing->margin)
+            || (timing->leader_space && !in_range(symbol.duration1, timing->leader_space, timing->margin))) {
+            continue;
+        }
+        diff = distance(symbol.duration0, timing->leader_mark);
+        if (timing->leader_space) {
+            diff += distance(symbol.duration1, timing->leader_space);
+        }
+        if (diff < found_diff) {
+            found = timing;
+            found_diff = diff;
+        }
+    }
+    return found;
+}
+
+// NEC and Samsung, a short mark and a short (0) or long (1) space for each bit, lsb first
+// done with the space of bit 31, the stop mark after it carries nothing
+static esp_err_t feed_pulse_distance(ir_proto_stream_t *stream, const ir_proto_timing_t *timing, rmt_symbol_word_t symbol, ir_proto_frame_t *frame)
+{
+    uint32_t data = 0;
+
+    if (!in_range(symbol.duration0, timing->unit, timing->margin)) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    if (in_range(symbol.duration1, timing->unit * 3, timing->margin)) {
+        stream->data |= 1UL << stream->count;
+    } else if (!in_range(symbol.duration1, timing->unit, timing->margin)) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    if (++stream->count < timing->length) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+    data = stream->data;
+    // both send the command with its inverse, the address is what tells NEC, extended NEC and Samsung apart
+    if (((data >> 16) & 0xFF) != (~data >> 24 & 0xFF)) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    memset(frame, 0, sizeof(ir_proto_frame_t));
+    frame->protocol = timing->protocol;
+    frame->bits = 32;
+    frame->data = data;
+    frame->command = (data >> 16) & 0xFF;
+    frame->address = data & 0xFFFF;
+    if (IR_PROTO_NEC == timing->protocol) {
+        if ((data & 0xFF) == (~data >> 8 & 0xFF)) {
+            frame->address = data & 0xFF;
+        } else {
+            frame->protocol = IR_PROTO_NEC_EXT;
+        }
+    }
+    return ESP_OK;
+}
+
+// SIRC, a short (0) or double (1) mark and a short space for each bit, lsb first, 7 bits command then the address
+// the length is only known from the gap after the last bit, 20 bits end the frame at once
+static esp_err_t feed_pulse_width(ir_proto_stream_t *stream, const ir_proto_timing_t *timing, rmt_symbol_word_t symbol, ir_proto_frame_t *frame)
+{
+    uint32_t data = 0;
+    uint8_t bits = 0;
+
+    if (in_range(symbol.duration0, timing->unit * 2, timing->margin)) {
+        stream->data |= 1UL << stream->count;
+    } else if (!in_range(symbol.duration0, timing->unit, timing->margin)) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    bits = ++stream->count;
+    if (bits < timing->length && in_range(symbol.duration1, timing->unit, timing->margin)) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+    if (12 != bits && 15 != bits && 20 != bits) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    data = stream->data;
+    memset(frame, 0, sizeof(ir_proto_frame_t));
+    frame->protocol = IR_PROTO_SIRC;
+    frame->bits = bits;
+    frame->data = data;
+    frame->command = data & 0x7F;
+    frame->address = data >> 7;
+    return ESP_OK;
+}
+
+// spread a mark or a space into manchester halves after the ones taken, 1 - mark
+static bool add_halves(ir_proto_stream_t *stream, const ir_proto_timing_t *timing, uint32_t duration, bool mark)
+{
+    uint32_t n = (duration + timing->unit / 2) / timing->unit;
+
+    if (0 == n || n > 4 || !in_range(duration, n * timing->unit, timing->margin) || stream->count + n > IR_PROTO_UNITS_MAX) {
+        return false;
+    }
+    if (mark) {
+        stream->levels |= ((1ULL << n) - 1) << stream->count;
+    }
+    stream->count += n;
+    return true;
+}
+
+// ESP_OK once the halves of all bits are in, the gap after the frame or the end of the capture
+// stands for the idle half after a last mark
+static esp_err_t take_halves(ir_proto_stream_t *stream, const ir_proto_timing_t *timing, rmt_symbol_word_t symbol)
+{
+    if (!add_halves(stream, timing, symbol.duration0, true)) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    if (stream->count >= timing->length) {
+        return ESP_OK;
+    }
+    if (0 == symbol.duration1 || (symbol.duration1 + timing->unit / 2) / timing->unit > 4) {
+        return stream->count + 1 >= timing->length ? ESP_OK : ESP_ERR_INVALID_SIZE;
+    }
+    if (!add_halves(stream, timing, symbol.duration1, false)) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    return stream->count >= timing->length ? ESP_OK : ESP_ERR_NOT_FINISHED;
+}
+
+// one manchester bit from halves 'pos' and 'pos + 1', rc5 sends 1 as space then mark, rc6 the other way round
+static inline int manchester_bit(uint64_t levels, int pos, int one_is_mark_first)
+{
+    uint8_t halves = (levels >> pos) & 3;
+
+    if (1 != halves && 2 != halves) {
+        return -1;
+    }
+    return (1 == halves) == !!one_is_mark_first;
+}
+
+// RC5, S1 S2 T A4..A0 C5..C0, msb first, the first half of S1 is the idle space before the frame
+static esp_err_t feed_rc5(ir_proto_stream_t *stream, const ir_proto_timing_t *timing, rmt_symbol_word_t symbol, ir_proto_frame_t *frame)
+{
+    uint32_t data = 0;
+    int i = 0, bit = 0;
+    esp_err_t ret = take_halves(stream, timing, symbol);
+
+    if (ESP_OK != ret) {
+        return ret;
+    }
+    for (i = 0; i < 14; i++) {
+        bit = manchester_bit(stream->levels, i * 2, 0);
+        if (bit < 0) {
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        data = (data << 1) | bit;
+    }
+    if (!(data & (1 << 13))) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    memset(frame, 0, sizeof(ir_proto_frame_t));
+    frame->protocol = IR_PROTO_RC5;
+    frame->bits = 14;
+    frame->toggle = (data >> 11) & 1;
+    frame->data = data & ~(1UL << 11);
+    frame->address = (data >> 6) & 0x1F;
+    frame->command = (data & 0x3F) | (((data >> 12) & 1) ? 0 : 0x40); // S2 is the inverted 7th command bit
+    return ESP_OK;
+}
+
+// RC6 mode 0, leader, start bit 1, mode 000, a double length trailer bit as toggle, 8 bit address and command, msb first
+static esp_err_t feed_rc6(ir_proto_stream_t *stream, const ir_proto_timing_t *timing, rmt_symbol_word_t symbol, ir_proto_frame_t *frame)
+{
+    uint64_t levels = 0;
+    uint32_t data = 0;
+    uint8_t toggle = 0;
+    int i = 0, bit = 0;
+    esp_err_t ret = take_halves(stream, timing, symbol);
+
+    if (ESP_OK != ret) {
+        return ret;
+    }
+    levels = stream->levels;
+    // start bit and mode
+    for (i = 0; i < 4; i++) {
+        bit = manchester_bit(levels, i * 2, 1);
+        if (bit != (0 == i)) {
+            return bit < 0 ? ESP_ERR_INVALID_RESPONSE : ESP_ERR_NOT_SUPPORTED;
+        }
+    }
+    // the trailer halves are two units each
+    if (0x3 == ((levels >> 8) & 0xF)) {
+        toggle = 1;
+    } else if (0xC != ((levels >> 8) & 0xF)) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    for (i = 0; i < 16; i++) {
+        bit = manchester_bit(levels, 12 + i * 2, 1);
+        if (bit < 0) {
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+        data = (data << 1) | bit;
+    }
+    memset(frame, 0, sizeof(ir_proto_frame_t));
+    frame->protocol = IR_PROTO_RC6;
+    frame->bits = 16;
+    frame->toggle = toggle;
+    frame->data = data;
+    frame->address = data >> 8;
+    frame->command = data & 0xFF;
+    return ESP_OK;
+}
+
+void ir_proto_stream_reset(ir_proto_stream_t *stream)
+{
+    memset(stream, 0, sizeof(ir_proto_stream_t));
+}
+
+esp_err_t ir_proto_stream_feed(ir_proto_stream_t *stream, rmt_symbol_word_t symbol, ir_proto_frame_t *frame)
+{
+    const ir_proto_timing_t *timing = stream->timing;
+    bool running = NULL != timing;
+    esp_err_t ret = ESP_OK;
+
+    if (!running) {
+        timing = find_leader(symbol);
+        if (NULL == timing) {
+            return ESP_ERR_NOT_FOUND;
+        }
+        if (0 == timing->length) {
+            memset(frame, 0, sizeof(ir_proto_frame_t));
+            frame->protocol = timing->protocol;
+            frame->repeat = 1;
+            return ESP_OK;
+        }
+        ir_proto_stream_reset(stream);
+        stream->timing = timing;
+        if (timing->leader_space) {
+            return ESP_ERR_NOT_FINISHED;
+        }
+        stream->count = 1; // rc5, the leader is the mark of S1, its idle half came before it
+    }
+    ret = timing->feed(stream, timing, symbol, frame);
+    if (ESP_ERR_NOT_FINISHED == ret) {
+        return ret;
+    }
+    stream->timing = NULL;
+    // a frame cut short, the symbol may already be the leader of the next one
+    if (ESP_OK != ret && running && NULL != find_leader(symbol) && ESP_OK == ir_proto_stream_feed(stream, symbol, frame)) {
+        return ESP_OK;
+    }
+    return ret;
+}
+
+esp_err_t ir_proto_decode(const rmt_symbol_word_t *symbols, size_t num, ir_proto_frame_t *frame)
+{
+    ir_proto_stream_t stream = {0};
+    esp_err_t ret = ESP_ERR_NOT_FOUND;
+    size_t i = 0;
+
+    if (NULL == symbols || 0 == num || NULL == frame) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // the frame has to start with the capture, the first one in it is returned
+    for (i = 0; i < num; i++) {
+        ret = ir_proto_stream_feed(&stream, symbols[i], frame);
+        if (ESP_ERR_NOT_FINISHED != ret) {
+            break;
+        }
+    }
+    return ESP_ERR_NOT_FINISHED == ret ? ESP_ERR_INVALID_SIZE : ret;
+}
+
+const char *ir_proto_name(ir_proto_t protocol)
+{
+    return protocol < IR_PROTO_MAX ? s_names[protocol] : "?";
+}
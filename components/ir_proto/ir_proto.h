@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/rmt_types.h"
+
+// the values are kept in nvs by the learning code, only append
+typedef enum {
+    IR_PROTO_NEC,       // 9ms leader, 8 bit address and command, each followed by its inverse
+    IR_PROTO_RAW,       // no decoder understood it, kept as durations
+    IR_PROTO_NEC_EXT,   // NEC timing with a 16 bit address, only the command inverse is checked
+    IR_PROTO_SAMSUNG,   // 4.5ms leader, NEC bits, 16 bit custom code, command and its inverse
+    IR_PROTO_SIRC,      // Sony, 2.4ms leader, mark width coded, 12, 15 or 20 bits
+    IR_PROTO_RC5,       // Philips, 889us Manchester halves, no leader, 14 bits
+    IR_PROTO_RC6,       // Philips mode 0, 2.67ms leader, 444us Manchester halves
+    IR_PROTO_MAX,
+} ir_proto_t;
+
+typedef struct {
+    ir_proto_t protocol;
+    uint8_t bits;       // payload bits, 0 for a repeat code
+    uint8_t toggle;     // rc5 and rc6, flips with every key press
+    uint8_t repeat;     // NEC repeat code, the key of the last frame is still held
+    uint16_t address;
+    uint16_t command;
+    uint32_t data;      // payload in the order it is sent, NEC/Samsung/SIRC lsb first, RC5/RC6 msb first, toggle cleared
+} ir_proto_frame_t;
+
+struct ir_proto_timing_t;
+
+// a frame followed across symbols, captures and partial receive chunks
+typedef struct {
+    const struct ir_proto_timing_t *timing; // protocol of the frame in progress, NULL - waiting for a leader
+    uint8_t count;      // bits, or manchester halves, taken so far
+    uint32_t data;
+    uint64_t levels;    // manchester halves, 1 - mark
+} ir_proto_stream_t;
+
+// symbols from an rmt rx channel at 1MHz, mark first, the capture may end with a 0 duration
+// the frame has to start with the first symbol, the first one complete is returned
+// ESP_ERR_NOT_FOUND if no protocol has this leader, ESP_ERR_INVALID_RESPONSE if the bits do not fit it
+esp_err_t ir_proto_decode(const rmt_symbol_word_t *symbols, size_t num, ir_proto_frame_t *frame);
+// drop a frame in progress, at the end of a capture that may have been cut short
+void ir_proto_stream_reset(ir_proto_stream_t *stream);
+// take the next symbol, the frame is returned with the symbol that completes its last bit
+// NEC and Samsung do not wait for the stop mark, SIRC, RC5 and RC6 end at the gap or after their longest length
+// ESP_OK - frame complete, ESP_ERR_NOT_FINISHED - inside a frame, ESP_ERR_NOT_FOUND - not a leader, noise between frames
+// other errors - the frame broke off, the symbol is tried again as the leader of the next one
+esp_err_t ir_proto_stream_feed(ir_proto_stream_t *stream, rmt_symbol_word_t symbol, ir_proto_frame_t *frame);
+const char *ir_proto_name(ir_proto_t protocol);
@@ -0,0 +1,269 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ir_raw_encoder.h"
+
+#define IR_RAW_CHUNK                        16      // symbols unpacked per round, half of a 64 symbol rmt block takes two
+#define IR_RAW_TICKS_MAX                    0x7FFF  // 15 bit duration of an rmt symbol
+
+// walks the durations of a packed frame
+typedef struct {
+    size_t pos;         // next symbol byte, 0 - the header is not read yet
+    uint8_t symbol;     // symbol byte being sent, 0xFF - none, its indexes are out of any table
+    uint8_t run;        // repeats of symbol left
+    uint8_t half;       // 0 - the mark of symbol is next, 1 - its space
+} ir_raw_iter_t;
+
+typedef struct {
+    rmt_encoder_t base;                 // the base "class", declares the standard encoder interface
+    rmt_encoder_t *copy_encoder;        // writes the unpacked chunk into the rmt memory
+    uint32_t resolution;
+    ir_raw_iter_t iter;
+    uint32_t pending;                   // ticks of the current duration left, long ones go out in pieces
+    uint8_t level;                      // of the current duration, 1 - mark
+    bool end;
+    size_t chunk_len;                   // symbols in chunk still to be copied, 0 - unpack the next ones
+    rmt_symbol_word_t chunk[IR_RAW_CHUNK];
+} rmt_ir_raw_encoder_t;
+
+static bool iter_init(ir_raw_iter_t *iter, const uint8_t *packed, size_t size)
+{
+    memset(iter, 0, sizeof(ir_raw_iter_t));
+    iter->symbol = 0xFF;
+    if (NULL == packed || 0 == size || 0 == packed[0] || packed[0] > IR_RAW_WIDTHS_MAX || size < 1 + (size_t)packed[0] * 2) {
+        return false;
+    }
+    iter->pos = 1 + packed[0] * 2;
+    return true;
+}
+
+// next duration in us, 0 at the end of the frame
+static uint32_t next_duration(ir_raw_iter_t *iter, const uint8_t *packed, size_t size)
+{
+    uint8_t index = 0;
+
+    if (0 == iter->half) {
+        if (iter->run) {
+            iter->run--;
+        } else if (iter->pos >= size) {
+            return 0;
+        } else if (IR_RAW_RUN == packed[iter->pos] >> 4) {
+            iter->run = packed[iter->pos++] & 0xF;
+        } else {
+            iter->symbol = packed[iter->pos++];
+        }
+        index = iter->symbol >> 4;
+    } else {
+        index = iter->symbol & 0xF;
+    }
+    iter->half ^= 1;
+    if (index >= packed[0]) {
+        return 0;
+    }
+    return packed[1 + index * 2] | (packed[2 + index * 2] << 8);
+}
+
+static uint8_t width_index(const uint16_t *widths, uint8_t n, uint16_t duration)
+{
+    uint8_t i = 0;
+
+    while (i < n && widths[i] != duration) {
+        i++;
+    }
+    return i;
+}
+
+static inline bool put_byte(uint8_t *out, size_t size, size_t *pos, uint8_t byte)
+{
+    if (*pos >= size) {
+        return false;
+    }
+    out[(*pos)++] = byte;
+    return true;
+}
+
+size_t ir_raw_pack(const uint16_t *durations, size_t num, uint8_t *out, size_t size)
+{
+    uint16_t widths[IR_RAW_WIDTHS_MAX] = {0};
+    uint16_t duration = 0;
+    uint8_t n = 0, symbol = 0, last = 0xFF, run = 0;
+    size_t i = 0, pos = 0;
+
+    // an odd count ends with a 0 space
+    for (i = 0; i < num + (num & 1); i++) {
+        duration = i < num ? durations[i] : 0;
+        if (width_index(widths, n, duration) < n) {
+            continue;
+        }
+        if (IR_RAW_WIDTHS_MAX == n) {
+            return 0;
+        }
+        widths[n++] = duration;
+    }
+    if (0 == n || size < 1 + (size_t)n * 2) {
+        return 0;
+    }
+    out[pos++] = n;
+    for (i = 0; i < n; i++) {
+        out[pos++] = widths[i] & 0xFF;
+        out[pos++] = widths[i] >> 8;
+    }
+    for (i = 0; i < num; i += 2) {
+        symbol = (width_index(widths, n, durations[i]) << 4) | width_index(widths, n, i + 1 < num ? durations[i + 1] : 0);
+        if (symbol == last) {
+            if (16 == ++run) {
+                if (!put_byte(out, size, &pos, (IR_RAW_RUN << 4) | 15)) {
+                    return 0;
+                }
+                run = 0;
+            }
+            continue;
+        }
+        if (run && !put_byte(out, size, &pos, (IR_RAW_RUN << 4) | (run - 1))) {
+            return 0;
+        }
+        if (!put_byte(out, size, &pos, symbol)) {
+            return 0;
+        }
+        run = 0;
+        last = symbol;
+    }
+    if (run && !put_byte(out, size, &pos, (IR_RAW_RUN << 4) | (run - 1))) {
+        return 0;
+    }
+    return pos;
+}
+
+size_t ir_raw_count(const uint8_t *packed, size_t size)
+{
+    ir_raw_iter_t iter = {0};
+    size_t count = 0;
+
+    if (!iter_init(&iter, packed, size)) {
+        return 0;
+    }
+    while (next_duration(&iter, packed, size)) {
+        count++;
+    }
+    return count;
+}
+
+static bool next_half(rmt_ir_raw_encoder_t *raw_encoder, const uint8_t *packed, size_t size, rmt_symbol_word_t *symbol, int half)
+{
+    uint32_t ticks = 0;
+
+    if (0 == raw_encoder->pending && !raw_encoder->end) {
+        raw_encoder->level = 0 == raw_encoder->iter.half;
+        raw_encoder->pending = ((uint64_t)next_duration(&raw_encoder->iter, packed, size) * raw_encoder->resolution + 500000) / 1000000;
+        raw_encoder->end = 0 == raw_encoder->pending;
+    }
+    if (raw_encoder->end) {
+        return false;
+    }
+    ticks = raw_encoder->pending > IR_RAW_TICKS_MAX ? IR_RAW_TICKS_MAX : raw_encoder->pending;
+    raw_encoder->pending -= ticks;
+    if (0 == half) {
+        symbol->level0 = raw_encoder->level;
+        symbol->duration0 = ticks;
+    } else {
+        symbol->level1 = raw_encoder->level;
+        symbol->duration1 = ticks;
+    }
+    return true;
+}
+
+// unpack up to IR_RAW_CHUNK symbols, the last one of the frame may only have its first half
+static size_t fill_chunk(rmt_ir_raw_encoder_t *raw_encoder, const uint8_t *packed, size_t size)
+{
+    size_t len = 0;
+
+    memset(raw_encoder->chunk, 0, sizeof(raw_encoder->chunk));
+    for (len = 0; len < IR_RAW_CHUNK; len++) {
+        if (!next_half(raw_encoder, packed, size, &raw_encoder->chunk[len], 0)) {
+            break;
+        }
+        if (!next_half(raw_encoder, packed, size, &raw_encoder->chunk[len], 1)) {
+            return len + 1;
+        }
+    }
+    return len;
+}
+
+static size_t rmt_encode_ir_raw(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state)
+{
+    rmt_ir_raw_encoder_t *raw_encoder = __containerof(encoder, rmt_ir_raw_encoder_t, base);
+    rmt_encode_state_t session_state = RMT_ENCODING_RESET;
+    rmt_encode_state_t state = RMT_ENCODING_RESET;
+    rmt_encoder_handle_t copy_encoder = raw_encoder->copy_encoder;
+    size_t encoded_symbols = 0;
+
+    if (0 == raw_encoder->iter.pos) {
+        raw_encoder->end = !iter_init(&raw_encoder->iter, primary_data, data_size);
+    }
+    while (1) {
+        if (0 == raw_encoder->chunk_len) {
+            raw_encoder->chunk_len = fill_chunk(raw_encoder, primary_data, data_size);
+            if (0 == raw_encoder->chunk_len) {
+                encoder->reset(encoder); // back to the initial encoding session
+                state |= RMT_ENCODING_COMPLETE;
+                break;
+            }
+        }
+        encoded_symbols += copy_encoder->encode(copy_encoder, channel, raw_encoder->chunk,
+                                                raw_encoder->chunk_len * sizeof(rmt_symbol_word_t), &session_state);
+        if (session_state & RMT_ENCODING_COMPLETE) {
+            raw_encoder->chunk_len = 0; // the chunk is in the rmt memory, unpack the next one
+        }
+        if (session_state & RMT_ENCODING_MEM_FULL) {
+            state |= RMT_ENCODING_MEM_FULL;
+            break; // yield, called again when the rmt has sent half of its memory
+        }
+    }
+    *ret_state = state;
+    return encoded_symbols;
+}
+
+static esp_err_t rmt_del_ir_raw_encoder(rmt_encoder_t *encoder)
+{
+    rmt_ir_raw_encoder_t *raw_encoder = __containerof(encoder, rmt_ir_raw_encoder_t, base);
+    rmt_del_encoder(raw_encoder->copy_encoder);
+    free(raw_encoder);
+    return ESP_OK;
+}
+
+static esp_err_t rmt_ir_raw_encoder_reset(rmt_encoder_t *encoder)
+{
+    rmt_ir_raw_encoder_t *raw_encoder = __containerof(encoder, rmt_ir_raw_encoder_t, base);
+    rmt_encoder_reset(raw_encoder->copy_encoder);
+    memset(&raw_encoder->iter, 0, sizeof(ir_raw_iter_t));
+    raw_encoder->pending = 0;
+    raw_encoder->end = false;
+    raw_encoder->chunk_len = 0;
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_ir_raw_encoder(uint32_t resolution, rmt_encoder_handle_t *ret_encoder)
+{
+    rmt_ir_raw_encoder_t *raw_encoder = NULL;
+    rmt_copy_encoder_config_t copy_encoder_config = {};
+    esp_err_t ret = ESP_OK;
+
+    if (0 == resolution || NULL == ret_encoder) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    raw_encoder = rmt_alloc_encoder_mem(sizeof(rmt_ir_raw_encoder_t));
+    if (NULL == raw_encoder) {
+        return ESP_ERR_NO_MEM;
+    }
+    raw_encoder->base.encode = rmt_encode_ir_raw;
+    raw_encoder->base.del = rmt_del_ir_raw_encoder;
+    raw_encoder->base.reset = rmt_ir_raw_encoder_reset;
+    raw_encoder->resolution = resolution;
+    ret = rmt_new_copy_encoder(&copy_encoder_config, &raw_encoder->copy_encoder);
+    if (ESP_OK != ret) {
+        free(raw_encoder);
+        return ret;
+    }
+    *ret_encoder = &raw_encoder->base;
+    return ESP_OK;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/rmt_encoder.h"
+
+#define IR_RAW_WIDTHS_MAX                   15
+#define IR_RAW_RUN                          0xF // mark index of a run byte
+
+// raw frame packed as a width table and one byte per mark and space, durations in us, mark first
+// 0        - n, count of widths, 1..IR_RAW_WIDTHS_MAX
+// 1        - n * uint16 le widths, a width of 0 ends the frame
+// 1 + 2n   - one byte per symbol, bit[7:4] - mark width index, bit[3:0] - space width index
+//            IR_RAW_RUN in bit[7:4], the previous symbol again bit[3:0] + 1 more times
+// a learned frame only has a few widths and its bits repeat, 300 symbols of an air conditioner take ~150 bytes
+
+// durations in us, mark first, each different value takes a slot of the width table
+// returns the packed size, 0 if there are more than IR_RAW_WIDTHS_MAX different ones or out is too small
+size_t ir_raw_pack(const uint16_t *durations, size_t num, uint8_t *out, size_t size);
+// marks and spaces in a packed frame
+size_t ir_raw_count(const uint8_t *packed, size_t size);
+
+// primary data is a packed frame, it is unpacked a few symbols at a time while the rmt sends the other half
+// of its memory, so the frame length only costs the packed bytes, durations over 32767 ticks are split
+esp_err_t rmt_new_ir_raw_encoder(uint32_t resolution, rmt_encoder_handle_t *ret_encoder);
@@ -0,0 +1,1048 @@
+#include <stdio.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "esp_log.h"
+#include "ssd1306.h"
+#include "ssd1306_io_interface.h"
+
+#define PANEL_MAGIC 0x13060040 // bump when the init table changes, a kept panel must match it
+
+const static char *TAG = "ssd1306";
+#if !CONFIG_IDF_TARGET_LINUX
+// survives a soft reset, random after power-on, PANEL_MAGIC once the panel was initialized
+static RTC_NOINIT_ATTR uint32_t panel_magic;
+#endif
+uint8_t pixel[128 * 8] = {0}; // ssd1306 not support read operation, so use ram to save every pixel value
+// column range of every page changed since the last flush, start > end if the page is clean
+static uint8_t dirty_start[8] = {128, 128, 128, 128, 128, 128, 128, 128};
+static uint8_t dirty_end[8] = {0};
+static ssd1306_io_t *oled_io = NULL;
+static uint8_t window_cmds[8][6] = {0}; // column/page window of every burst, kept until the queued transfers are done
+static uint8_t window_buf[128 * 8] = {0}; // windows narrower than the screen, gathered into one continuous burst
+// window the panel is set to, every burst fills its window, so the address wraps back to the start and is reused as is
+static uint8_t window_now[4] = {0xFF, 0xFF, 0xFF, 0xFF};
+// front buffer of the flush task, pixel[] is the back buffer the application draws into
+static uint8_t front[128 * 8] = {0};
+static uint8_t front_start[8] = {128, 128, 128, 128, 128, 128, 128, 128};
+static uint8_t front_end[8] = {0};
+static SemaphoreHandle_t front_free = NULL;  // given by the flush task when the front buffer is on the panel
+static SemaphoreHandle_t frame_ready = NULL; // given by oled_swap when a new frame is in the front buffer
+static uint32_t frame_period = 0;            // ticks, 0 - no pacing
+static uint8_t scroll_start = 8;             // pages moved by the running hardware scroll, start > end if none
+static uint8_t scroll_end = 0;
+static uint8_t start_line = 0;
+static uint8_t display_off = 0;              // 1 - turned on by the next flush, the whole ram is written by then
+
+const uint8_t F6x8[][6] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // sp
+    {0x00, 0x00, 0x00, 0x2f, 0x00, 0x00}, // !
+    {0x00, 0x00, 0x07, 0x00, 0x07, 0x00}, // "
+    {0x00, 0x14, 0x7f, 0x14, 0x7f, 0x14}, // #
+    {0x00, 0x24, 0x2a, 0x7f, 0x2a, 0x12}, // $
+    {0x00, 0x62, 0x64, 0x08, 0x13, 0x23}, // %
+    {0x00, 0x36, 0x49, 0x55, 0x22, 0x50}, // &
+    {0x00, 0x00, 0x05, 0x03, 0x00, 0x00}, // '
+    {0x00, 0x00, 0x1c, 0x22, 0x41, 0x00}, // (
+    {0x00, 0x00, 0x41, 0x22, 0x1c, 0x00}, // )
+    {0x00, 0x14, 0x08, 0x3E, 0x08, 0x14}, // *
+    {0x00, 0x08, 0x08, 0x3E, 0x08, 0x08}, // +
+    {0x00, 0x00, 0x00, 0xA0, 0x60, 0x00}, // ,
+    {0x00, 0x08, 0x08, 0x08, 0x08, 0x08}, // -
+    {0x00, 0x00, 0x60, 0x60, 0x00, 0x00}, // .
+    {0x00, 0x20, 0x10, 0x08, 0x04, 0x02}, // /
+    {0x00, 0x3E, 0x51, 0x49, 0x45, 0x3E}, // 0
+    {0x00, 0x00, 0x42, 0x7F, 0x40, 0x00}, // 1
+    {0x00, 0x42, 0x61, 0x51, 0x49, 0x46}, // 2
+    {0x00, 0x21, 0x41, 0x45, 0x4B, 0x31}, // 3
+    {0x00, 0x18, 0x14, 0x12, 0x7F, 0x10}, // 4
+    {0x00, 0x27, 0x45, 0x45, 0x45, 0x39}, // 5
+    {0x00, 0x3C, 0x4A, 0x49, 0x49, 0x30}, // 6
+    {0x00, 0x01, 0x71, 0x09, 0x05, 0x03}, // 7
+    {0x00, 0x36, 0x49, 0x49, 0x49, 0x36}, // 8
+    {0x00, 0x06, 0x49, 0x49, 0x29, 0x1E}, // 9
+    {0x00, 0x00, 0x36, 0x36, 0x00, 0x00}, // :
+    {0x00, 0x00, 0x56, 0x36, 0x00, 0x00}, // ;
+    {0x00, 0x08, 0x14, 0x22, 0x41, 0x00}, // <
+    {0x00, 0x14, 0x14, 0x14, 0x14, 0x14}, // =
+    {0x00, 0x00, 0x41, 0x22, 0x14, 0x08}, // >
+    {0x00, 0x02, 0x01, 0x51, 0x09, 0x06}, // ?
+    {0x00, 0x32, 0x49, 0x59, 0x51, 0x3E}, // @
+    {0x00, 0x7C, 0x12, 0x11, 0x12, 0x7C}, // A
+    {0x00, 0x7F, 0x49, 0x49, 0x49, 0x36}, // B
+    {0x00, 0x3E, 0x41, 0x41, 0x41, 0x22}, // C
+    {0x00, 0x7F, 0x41, 0x41, 0x22, 0x1C}, // D
+    {0x00, 0x7F, 0x49, 0x49, 0x49, 0x41}, // E
+    {0x00, 0x7F, 0x09, 0x09, 0x09, 0x01}, // F
+    {0x00, 0x3E, 0x41, 0x49, 0x49, 0x7A}, // G
+    {0x00, 0x7F, 0x08, 0x08, 0x08, 0x7F}, // H
+    {0x00, 0x00, 0x41, 0x7F, 0x41, 0x00}, // I
+    {0x00, 0x20, 0x40, 0x41, 0x3F, 0x01}, // J
+    {0x00, 0x7F, 0x08, 0x14, 0x22, 0x41}, // K
+    {0x00, 0x7F, 0x40, 0x40, 0x40, 0x40}, // L
+    {0x00, 0x7F, 0x02, 0x0C, 0x02, 0x7F}, // M
+    {0x00, 0x7F, 0x04, 0x08, 0x10, 0x7F}, // N
+    {0x00, 0x3E, 0x41, 0x41, 0x41, 0x3E}, // O
+    {0x00, 0x7F, 0x09, 0x09, 0x09, 0x06}, // P
+    {0x00, 0x3E, 0x41, 0x51, 0x21, 0x5E}, // Q
+    {0x00, 0x7F, 0x09, 0x19, 0x29, 0x46}, // R
+    {0x00, 0x46, 0x49, 0x49, 0x49, 0x31}, // S
+    {0x00, 0x01, 0x01, 0x7F, 0x01, 0x01}, // T
+    {0x00, 0x3F, 0x40, 0x40, 0x40, 0x3F}, // U
+    {0x00, 0x1F, 0x20, 0x40, 0x20, 0x1F}, // V
+    {0x00, 0x3F, 0x40, 0x38, 0x40, 0x3F}, // W
+    {0x00, 0x63, 0x14, 0x08, 0x14, 0x63}, // X
+    {0x00, 0x07, 0x08, 0x70, 0x08, 0x07}, // Y
+    {0x00, 0x61, 0x51, 0x49, 0x45, 0x43}, // Z
+    {0x00, 0x00, 0x7F, 0x41, 0x41, 0x00}, // [
+    {0x00, 0x55, 0x2A, 0x55, 0x2A, 0x55}, // 55
+    {0x00, 0x00, 0x41, 0x41, 0x7F, 0x00}, // ]
+    {0x00, 0x04, 0x02, 0x01, 0x02, 0x04}, // ^
+    {0x00, 0x40, 0x40, 0x40, 0x40, 0x40}, // _
+    {0x00, 0x00, 0x01, 0x02, 0x04, 0x00}, // '
+    {0x00, 0x20, 0x54, 0x54, 0x54, 0x78}, // a
+    {0x00, 0x7F, 0x48, 0x44, 0x44, 0x38}, // b
+    {0x00, 0x38, 0x44, 0x44, 0x44, 0x20}, // c
+    {0x00, 0x38, 0x44, 0x44, 0x48, 0x7F}, // d
+    {0x00, 0x38, 0x54, 0x54, 0x54, 0x18}, // e
+    {0x00, 0x08, 0x7E, 0x09, 0x01, 0x02}, // f
+    {0x00, 0x18, 0xA4, 0xA4, 0xA4, 0x7C}, // g
+    {0x00, 0x7F, 0x08, 0x04, 0x04, 0x78}, // h
+    {0x00, 0x00, 0x44, 0x7D, 0x40, 0x00}, // i
+    {0x00, 0x40, 0x80, 0x84, 0x7D, 0x00}, // j
+    {0x00, 0x7F, 0x10, 0x28, 0x44, 0x00}, // k
+    {0x00, 0x00, 0x41, 0x7F, 0x40, 0x00}, // l
+    {0x00, 0x7C, 0x04, 0x18, 0x04, 0x78}, // m
+    {0x00, 0x7C, 0x08, 0x04, 0x04, 0x78}, // n
+    {0x00, 0x38, 0x44, 0x44, 0x44, 0x38}, // o
+    {0x00, 0xFC, 0x24, 0x24, 0x24, 0x18}, // p
+    {0x00, 0x18, 0x24, 0x24, 0x18, 0xFC}, // q
+    {0x00, 0x7C, 0x08, 0x04, 0x04, 0x08}, // r
+    {0x00, 0x48, 0x54, 0x54, 0x54, 0x20}, // s
+    {0x00, 0x04, 0x3F, 0x44, 0x40, 0x20}, // t
+    {0x00, 0x3C, 0x40, 0x40, 0x20, 0x7C}, // u
+    {0x00, 0x1C, 0x20, 0x40, 0x20, 0x1C}, // v
+    {0x00, 0x3C, 0x40, 0x30, 0x40, 0x3C}, // w
+    {0x00, 0x44, 0x28, 0x10, 0x28, 0x44}, // x
+    {0x00, 0x1C, 0xA0, 0xA0, 0xA0, 0x7C}, // y
+    {0x00, 0x44, 0x64, 0x54, 0x4C, 0x44}, // z
+    {0x14, 0x14, 0x14, 0x14, 0x14, 0x14}, // horiz lines
+};
+
+const uint8_t F8X16[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0
+    0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x33, 0x30, 0x00, 0x00, 0x00, //! 1
+    0x00, 0x10, 0x0C, 0x06, 0x10, 0x0C, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //" 2
+    0x40, 0xC0, 0x78, 0x40, 0xC0, 0x78, 0x40, 0x00, 0x04, 0x3F, 0x04, 0x04, 0x3F, 0x04, 0x04, 0x00, //# 3
+    0x00, 0x70, 0x88, 0xFC, 0x08, 0x30, 0x00, 0x00, 0x00, 0x18, 0x20, 0xFF, 0x21, 0x1E, 0x00, 0x00, //$ 4
+    0xF0, 0x08, 0xF0, 0x00, 0xE0, 0x18, 0x00, 0x00, 0x00, 0x21, 0x1C, 0x03, 0x1E, 0x21, 0x1E, 0x00, //% 5
+    0x00, 0xF0, 0x08, 0x88, 0x70, 0x00, 0x00, 0x00, 0x1E, 0x21, 0x23, 0x24, 0x19, 0x27, 0x21, 0x10, //& 6
+    0x10, 0x16, 0x0E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //' 7
+    0x00, 0x00, 0x00, 0xE0, 0x18, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00, 0x07, 0x18, 0x20, 0x40, 0x00, //( 8
+    0x00, 0x02, 0x04, 0x18, 0xE0, 0x00, 0x00, 0x00, 0x00, 0x40, 0x20, 0x18, 0x07, 0x00, 0x00, 0x00, //) 9
+    0x40, 0x40, 0x80, 0xF0, 0x80, 0x40, 0x40, 0x00, 0x02, 0x02, 0x01, 0x0F, 0x01, 0x02, 0x02, 0x00, //* 10
+    0x00, 0x00, 0x00, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x1F, 0x01, 0x01, 0x01, 0x00, //+ 11
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xB0, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00, //, 12
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, //- 13
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, //. 14
+    0x00, 0x00, 0x00, 0x00, 0x80, 0x60, 0x18, 0x04, 0x00, 0x60, 0x18, 0x06, 0x01, 0x00, 0x00, 0x00, /// 15
+    0x00, 0xE0, 0x10, 0x08, 0x08, 0x10, 0xE0, 0x00, 0x00, 0x0F, 0x10, 0x20, 0x20, 0x10, 0x0F, 0x00, // 0 16
+    0x00, 0x10, 0x10, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x20, 0x3F, 0x20, 0x20, 0x00, 0x00, // 1 17
+    0x00, 0x70, 0x08, 0x08, 0x08, 0x88, 0x70, 0x00, 0x00, 0x30, 0x28, 0x24, 0x22, 0x21, 0x30, 0x00, // 2 18
+    0x00, 0x30, 0x08, 0x88, 0x88, 0x48, 0x30, 0x00, 0x00, 0x18, 0x20, 0x20, 0x20, 0x11, 0x0E, 0x00, // 3 19
+    0x00, 0x00, 0xC0, 0x20, 0x10, 0xF8, 0x00, 0x00, 0x00, 0x07, 0x04, 0x24, 0x24, 0x3F, 0x24, 0x00, // 4 20
+    0x00, 0xF8, 0x08, 0x88, 0x88, 0x08, 0x08, 0x00, 0x00, 0x19, 0x21, 0x20, 0x20, 0x11, 0x0E, 0x00, // 5 21
+    0x00, 0xE0, 0x10, 0x88, 0x88, 0x18, 0x00, 0x00, 0x00, 0x0F, 0x11, 0x20, 0x20, 0x11, 0x0E, 0x00, // 6 22
+    0x00, 0x38, 0x08, 0x08, 0xC8, 0x38, 0x08, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00, // 7 23
+    0x00, 0x70, 0x88, 0x08, 0x08, 0x88, 0x70, 0x00, 0x00, 0x1C, 0x22, 0x21, 0x21, 0x22, 0x1C, 0x00, // 8 24
+    0x00, 0xE0, 0x10, 0x08, 0x08, 0x10, 0xE0, 0x00, 0x00, 0x00, 0x31, 0x22, 0x22, 0x11, 0x0F, 0x00, // 9 25
+    0x00, 0x00, 0x00, 0xC0, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x00, 0x00, 0x00, //: 26
+    0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x60, 0x00, 0x00, 0x00, 0x00, //; 27
+    0x00, 0x00, 0x80, 0x40, 0x20, 0x10, 0x08, 0x00, 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x00, //< 28
+    0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x00, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, //= 29
+    0x00, 0x08, 0x10, 0x20, 0x40, 0x80, 0x00, 0x00, 0x00, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, //> 30
+    0x00, 0x70, 0x48, 0x08, 0x08, 0x08, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x30, 0x36, 0x01, 0x00, 0x00, //? 31
+    0xC0, 0x30, 0xC8, 0x28, 0xE8, 0x10, 0xE0, 0x00, 0x07, 0x18, 0x27, 0x24, 0x23, 0x14, 0x0B, 0x00, //@ 32
+    0x00, 0x00, 0xC0, 0x38, 0xE0, 0x00, 0x00, 0x00, 0x20, 0x3C, 0x23, 0x02, 0x02, 0x27, 0x38, 0x20, // A 33
+    0x08, 0xF8, 0x88, 0x88, 0x88, 0x70, 0x00, 0x00, 0x20, 0x3F, 0x20, 0x20, 0x20, 0x11, 0x0E, 0x00, // B 34
+    0xC0, 0x30, 0x08, 0x08, 0x08, 0x08, 0x38, 0x00, 0x07, 0x18, 0x20, 0x20, 0x20, 0x10, 0x08, 0x00, // C 35
+    0x08, 0xF8, 0x08, 0x08, 0x08, 0x10, 0xE0, 0x00, 0x20, 0x3F, 0x20, 0x20, 0x20, 0x10, 0x0F, 0x00, // D 36
+    0x08, 0xF8, 0x88, 0x88, 0xE8, 0x08, 0x10, 0x00, 0x20, 0x3F, 0x20, 0x20, 0x23, 0x20, 0x18, 0x00, // E 37
+    0x08, 0xF8, 0x88, 0x88, 0xE8, 0x08, 0x10, 0x00, 0x20, 0x3F, 0x20, 0x00, 0x03, 0x00, 0x00, 0x00, // F 38
+    0xC0, 0x30, 0x08, 0x08, 0x08, 0x38, 0x00, 0x00, 0x07, 0x18, 0x20, 0x20, 0x22, 0x1E, 0x02, 0x00, // G 39
+    0x08, 0xF8, 0x08, 0x00, 0x00, 0x08, 0xF8, 0x08, 0x20, 0x3F, 0x21, 0x01, 0x01, 0x21, 0x3F, 0x20, // H 40
+    0x00, 0x08, 0x08, 0xF8, 0x08, 0x08, 0x00, 0x00, 0x00, 0x20, 0x20, 0x3F, 0x20, 0x20, 0x00, 0x00, // I 41
+    0x00, 0x00, 0x08, 0x08, 0xF8, 0x08, 0x08, 0x00, 0xC0, 0x80, 0x80, 0x80, 0x7F, 0x00, 0x00, 0x00, // J 42
+    0x08, 0xF8, 0x88, 0xC0, 0x28, 0x18, 0x08, 0x00, 0x20, 0x3F, 0x20, 0x01, 0x26, 0x38, 0x20, 0x00, // K 43
+    0x08, 0xF8, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x3F, 0x20, 0x20, 0x20, 0x20, 0x30, 0x00, // L 44
+    0x08, 0xF8, 0xF8, 0x00, 0xF8, 0xF8, 0x08, 0x00, 0x20, 0x3F, 0x00, 0x3F, 0x00, 0x3F, 0x20, 0x00, // M 45
+    0x08, 0xF8, 0x30, 0xC0, 0x00, 0x08, 0xF8, 0x08, 0x20, 0x3F, 0x20, 0x00, 0x07, 0x18, 0x3F, 0x00, // N 46
+    0xE0, 0x10, 0x08, 0x08, 0x08, 0x10, 0xE0, 0x00, 0x0F, 0x10, 0x20, 0x20, 0x20, 0x10, 0x0F, 0x00, // O 47
+    0x08, 0xF8, 0x08, 0x08, 0x08, 0x08, 0xF0, 0x00, 0x20, 0x3F, 0x21, 0x01, 0x01, 0x01, 0x00, 0x00, // P 48
+    0xE0, 0x10, 0x08, 0x08, 0x08, 0x10, 0xE0, 0x00, 0x0F, 0x18, 0x24, 0x24, 0x38, 0x50, 0x4F, 0x00, // Q 49
+    0x08, 0xF8, 0x88, 0x88, 0x88, 0x88, 0x70, 0x00, 0x20, 0x3F, 0x20, 0x00, 0x03, 0x0C, 0x30, 0x20, // R 50
+    0x00, 0x70, 0x88, 0x08, 0x08, 0x08, 0x38, 0x00, 0x00, 0x38, 0x20, 0x21, 0x21, 0x22, 0x1C, 0x00, // S 51
+    0x18, 0x08, 0x08, 0xF8, 0x08, 0x08, 0x18, 0x00, 0x00, 0x00, 0x20, 0x3F, 0x20, 0x00, 0x00, 0x00, // T 52
+    0x08, 0xF8, 0x08, 0x00, 0x00, 0x08, 0xF8, 0x08, 0x00, 0x1F, 0x20, 0x20, 0x20, 0x20, 0x1F, 0x00, // U 53
+    0x08, 0x78, 0x88, 0x00, 0x00, 0xC8, 0x38, 0x08, 0x00, 0x00, 0x07, 0x38, 0x0E, 0x01, 0x00, 0x00, // V 54
+    0xF8, 0x08, 0x00, 0xF8, 0x00, 0x08, 0xF8, 0x00, 0x03, 0x3C, 0x07, 0x00, 0x07, 0x3C, 0x03, 0x00, // W 55
+    0x08, 0x18, 0x68, 0x80, 0x80, 0x68, 0x18, 0x08, 0x20, 0x30, 0x2C, 0x03, 0x03, 0x2C, 0x30, 0x20, // X 56
+    0x08, 0x38, 0xC8, 0x00, 0xC8, 0x38, 0x08, 0x00, 0x00, 0x00, 0x20, 0x3F, 0x20, 0x00, 0x00, 0x00, // Y 57
+    0x10, 0x08, 0x08, 0x08, 0xC8, 0x38, 0x08, 0x00, 0x20, 0x38, 0x26, 0x21, 0x20, 0x20, 0x18, 0x00, // Z 58
+    0x00, 0x00, 0x00, 0xFE, 0x02, 0x02, 0x02, 0x00, 0x00, 0x00, 0x00, 0x7F, 0x40, 0x40, 0x40, 0x00, //[ 59
+    0x00, 0x0C, 0x30, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x06, 0x38, 0xC0, 0x00, //\ 60
+    0x00, 0x02, 0x02, 0x02, 0xFE, 0x00, 0x00, 0x00, 0x00, 0x40, 0x40, 0x40, 0x7F, 0x00, 0x00, 0x00, //] 61
+    0x00, 0x00, 0x04, 0x02, 0x02, 0x02, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //^ 62
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, //_ 63
+    0x00, 0x02, 0x02, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //` 64
+    0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x19, 0x24, 0x22, 0x22, 0x22, 0x3F, 0x20, // a 65
+    0x08, 0xF8, 0x00, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x11, 0x20, 0x20, 0x11, 0x0E, 0x00, // b 66
+    0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x0E, 0x11, 0x20, 0x20, 0x20, 0x11, 0x00, // c 67
+    0x00, 0x00, 0x00, 0x80, 0x80, 0x88, 0xF8, 0x00, 0x00, 0x0E, 0x11, 0x20, 0x20, 0x10, 0x3F, 0x20, // d 68
+    0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x1F, 0x22, 0x22, 0x22, 0x22, 0x13, 0x00, // e 69
+    0x00, 0x80, 0x80, 0xF0, 0x88, 0x88, 0x88, 0x18, 0x00, 0x20, 0x20, 0x3F, 0x20, 0x20, 0x00, 0x00, // f 70
+    0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x6B, 0x94, 0x94, 0x94, 0x93, 0x60, 0x00, // g 71
+    0x08, 0xF8, 0x00, 0x80, 0x80, 0x80, 0x00, 0x00, 0x20, 0x3F, 0x21, 0x00, 0x00, 0x20, 0x3F, 0x20, // h 72
+    0x00, 0x80, 0x98, 0x98, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x20, 0x3F, 0x20, 0x20, 0x00, 0x00, // i 73
+    0x00, 0x00, 0x00, 0x80, 0x98, 0x98, 0x00, 0x00, 0x00, 0xC0, 0x80, 0x80, 0x80, 0x7F, 0x00, 0x00, // j 74
+    0x08, 0xF8, 0x00, 0x00, 0x80, 0x80, 0x80, 0x00, 0x20, 0x3F, 0x24, 0x02, 0x2D, 0x30, 0x20, 0x00, // k 75
+    0x00, 0x08, 0x08, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x20, 0x3F, 0x20, 0x20, 0x00, 0x00, // l 76
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x20, 0x3F, 0x20, 0x00, 0x3F, 0x20, 0x00, 0x3F, // m 77
+    0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0x00, 0x00, 0x20, 0x3F, 0x21, 0x00, 0x00, 0x20, 0x3F, 0x20, // n 78
+    0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x1F, 0x20, 0x20, 0x20, 0x20, 0x1F, 0x00, // o 79
+    0x80, 0x80, 0x00, 0x80, 0x80, 0x00, 0x00, 0x00, 0x80, 0xFF, 0xA1, 0x20, 0x20, 0x11, 0x0E, 0x00, // p 80
+    0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x0E, 0x11, 0x20, 0x20, 0xA0, 0xFF, 0x80, // q 81
+    0x80, 0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0x00, 0x20, 0x20, 0x3F, 0x21, 0x20, 0x00, 0x01, 0x00, // r 82
+    0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x33, 0x24, 0x24, 0x24, 0x24, 0x19, 0x00, // s 83
+    0x00, 0x80, 0x80, 0xE0, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x20, 0x20, 0x00, 0x00, // t 84
+    0x80, 0x80, 0x00, 0x00, 0x00, 0x80, 0x80, 0x00, 0x00, 0x1F, 0x20, 0x20, 0x20, 0x10, 0x3F, 0x20, // u 85
+    0x80, 0x80, 0x80, 0x00, 0x00, 0x80, 0x80, 0x80, 0x00, 0x01, 0x0E, 0x30, 0x08, 0x06, 0x01, 0x00, // v 86
+    0x80, 0x80, 0x00, 0x80, 0x00, 0x80, 0x80, 0x80, 0x0F, 0x30, 0x0C, 0x03, 0x0C, 0x30, 0x0F, 0x00, // w 87
+    0x00, 0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0x00, 0x00, 0x20, 0x31, 0x2E, 0x0E, 0x31, 0x20, 0x00, // x 88
+    0x80, 0x80, 0x80, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x81, 0x8E, 0x70, 0x18, 0x06, 0x01, 0x00, // y 89
+    0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x21, 0x30, 0x2C, 0x22, 0x21, 0x30, 0x00, // z 90
+    0x00, 0x00, 0x00, 0x00, 0x80, 0x7C, 0x02, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x40, 0x40, //{ 91
+    0x00, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, //| 92
+    0x00, 0x02, 0x02, 0x7C, 0x80, 0x00, 0x00, 0x00, 0x00, 0x40, 0x40, 0x3F, 0x00, 0x00, 0x00, 0x00, //} 93
+    0x00, 0x06, 0x01, 0x01, 0x02, 0x02, 0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //~ 94
+};
+
+const uint8_t Hzk[][32] = {
+    {0x00,0xFE,0x22,0x5A,0x86,0x08,0x88,0x68,0x18,0x0F,0xE8,0x08,0x08,0x08,0x08,0x00},
+    {0x00,0xFF,0x04,0x08,0x07,0x20,0x11,0x0D,0x41,0x81,0x7F,0x01,0x05,0x09,0x30,0x00},/*"陈",0*/
+
+    {0x80,0x90,0x8C,0x84,0x84,0x84,0xF5,0x86,0x84,0x84,0x84,0x84,0x94,0x8C,0x80,0x00},
+    {0x00,0x80,0x80,0x84,0x46,0x49,0x28,0x10,0x10,0x2C,0x23,0x40,0x80,0x00,0x00,0x00},/*"安",1*/
+
+    {0x00,0xFC,0x84,0x84,0xFC,0x00,0x44,0x54,0x54,0x54,0x7F,0x54,0x54,0x54,0x44,0x00},
+    {0x00,0x3F,0x10,0x10,0x3F,0x00,0x00,0xFF,0x15,0x15,0x15,0x55,0x95,0x7F,0x00,0x00},/*"晴",2*/
+
+    {0x00,0x00,0x00,0xE0,0x00,0x00,0x00,0xFF,0x00,0x00,0x00,0x20,0x40,0x80,0x00,0x00},
+    {0x08,0x04,0x03,0x00,0x00,0x40,0x80,0x7F,0x00,0x00,0x00,0x00,0x00,0x01,0x0E,0x00},/*"小",3*/
+
+    {0x00,0x40,0x42,0x44,0x58,0x40,0xC0,0xFF,0xC0,0x40,0x50,0x48,0x46,0x40,0x00,0x00},
+    {0x20,0x20,0x10,0x08,0x04,0x03,0x00,0xFF,0x00,0x03,0x04,0x08,0x10,0x20,0x20,0x00},/*"米",4*/
+
+    {0x40,0x44,0x58,0xC0,0xFF,0x50,0x4C,0x10,0x90,0x10,0x11,0x16,0x10,0xD0,0x10,0x00},
+    {0x10,0x08,0x06,0x01,0xFF,0x01,0x06,0x40,0x41,0x5E,0x40,0x70,0x4E,0x41,0x40,0x00},/*"粒",5*/
+
+    {0x00,0x00,0xE2,0x24,0x28,0x20,0x20,0x3F,0x20,0x20,0x28,0x24,0xE2,0x00,0x00,0x00},
+    {0x00,0x00,0xFF,0x00,0x00,0x1F,0x11,0x11,0x11,0x1F,0x40,0x80,0x7F,0x00,0x00,0x00},/*"尚",6*/
+
+    {0x10,0x60,0x02,0x0C,0xC0,0x10,0x08,0xF7,0x14,0x54,0x94,0x14,0xF4,0x04,0x00,0x00},
+    {0x04,0x04,0x7C,0x03,0x00,0x01,0x1D,0x13,0x11,0x55,0x99,0x51,0x3F,0x11,0x01,0x00},/*"海",7*/
+
+    {0x10,0x60,0x02,0x8C,0x24,0x94,0x84,0xBD,0x86,0x84,0xBC,0x84,0x14,0x24,0x00,0x00},
+    {0x04,0x04,0x7E,0x01,0x00,0x0E,0x0A,0x0A,0x0A,0x4A,0x8A,0x4B,0x38,0x00,0x00,0x00},/*"湾",8*/
+
+    {0x40,0x70,0x4C,0x43,0xC0,0x30,0x00,0x10,0x10,0xFF,0x10,0x10,0x10,0xF0,0x00,0x00},
+    {0x10,0x38,0x14,0x13,0x14,0xB8,0x40,0x30,0x0E,0x01,0x40,0x80,0x40,0x3F,0x00,0x00},/*"幼",9*/
+
+    {0x00,0x00,0x00,0x00,0xFF,0x00,0x00,0x00,0x00,0xFF,0x00,0x00,0x00,0x00,0x00,0x00},
+    {0x80,0x40,0x20,0x18,0x07,0x00,0x00,0x00,0x00,0x3F,0x40,0x40,0x40,0x40,0x78,0x00},/*"儿",10*/
+
+    {0x00,0xFE,0x02,0x42,0x4A,0xCA,0x4A,0x4A,0xCA,0x4A,0x4A,0x42,0x02,0xFE,0x00,0x00},
+    {0x00,0xFF,0x40,0x50,0x4C,0x43,0x40,0x40,0x4F,0x50,0x50,0x5C,0x40,0xFF,0x00,0x00},/*"园",11*/
+};
+
+
+esp_err_t ssd1306_del_io(ssd1306_io_handle_t io)
+{
+    return io->del(io);
+}
+
+// x - 0~127, y - 0~7, width - columns changed from x
+static void oled_set_dirty(uint8_t x, uint8_t y, uint8_t width)
+{
+    uint8_t end = (x + width - 1 > 127) ? 127 : x + width - 1;
+
+    if (x > 127 || y > 7) {
+        return;
+    }
+    if (x < dirty_start[y]) {
+        dirty_start[y] = x;
+    }
+    if (end > dirty_end[y]) {
+        dirty_end[y] = end;
+    }
+}
+
+uint8_t oled_panel_kept(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    return 0;
+#else
+    esp_reset_reason_t reason = esp_reset_reason();
+
+    if (PANEL_MAGIC != panel_magic) {
+        return 0;
+    }
+    // only the chip was reset, the panel kept its power, settings and ram
+    return ESP_RST_SW == reason || ESP_RST_PANIC == reason || ESP_RST_INT_WDT == reason
+           || ESP_RST_TASK_WDT == reason || ESP_RST_WDT == reason;
+#endif
+}
+
+esp_err_t oled_init(ssd1306_io_handle_t io)
+{
+    esp_err_t ret = ESP_OK;
+    uint8_t i = 0;
+    const uint8_t init_cmds[] = {
+        0xAE, // display on/off, 0xAE - off, 0xAF - on
+        0xA8, // set multiplex ratio, 0xA8 + bit[5:0]
+        0x3F, // bit[5:0]
+        0xD3, // set display offset, 0xD3 + bit[5:0]
+        0x00, // bit[5:0]
+        0x40, // set display RAM start line address, 0x40 + bit[5:0]
+        0xA1, // set segment remap, 0xA0 + bit[0], 0xA0 - column 0 map to SEG0, 0xA1 - column 127 map to SEG0
+        0xC8, // set Com output scan direction, 0xC0 + bit[3], 0xC0 - normal mode, 0xC8 - inverse mode
+        0xDA, // set com pin configuartion, 0xDA + bit[5:4] + 0x02
+        0x12, // bit[5:4] + 0x02
+        0x81, // set contract control, 0x81 + bit[7:0]
+        0x7F, // bit[7:0]
+        0xA4, // set Entire Display ON, 0xA4 + bit[0], 0xA4 - resume RAM content, 0xA5 - ignore RAM content
+        0xA6, // set normal/inverse display, 0xA6 + bit[0], 0xA6 - normal, 0xA7 - inverse
+        0xD5, // set clk divide ratio/osc freq, 0xD5 + bit[7:0]
+        0x80, // bit[7:0]
+        0x8D, // set Charge Pump, 0x8D + 0x10 + bit[2]
+        0x14, // 0x10 + bit[2]
+        0xD9, // set Pre-Charge Period, 0xD9 + bit[7:0]
+        0x22, // bit[7:0]
+        0xDB, // set Vcomh deselect level, 0xDB + bit[6:4]
+        0x20, // bit[6:4]
+        0x20, // set memory addressing mode, 0x20 + bit[1:0]
+        0x00, // 0x00 - horizontal, the column wraps to the next page inside the 0x21/0x22 window
+    };
+    const uint8_t resync_cmds[] = {
+        0x2E, // deactivate scroll, the reset may have come in the middle of one
+        0x40, // set display RAM start line address, 0x40 + bit[5:0]
+    };
+    uint8_t kept = oled_panel_kept();
+
+    oled_io = io;
+    memset(window_now, 0xFF, sizeof(window_now));
+    scroll_start = 8;
+    scroll_end = 0;
+    start_line = 0;
+#if !CONFIG_IDF_TARGET_LINUX
+    if (!kept) {
+        panel_magic = 0;
+    }
+#endif
+
+    // the whole table in one burst, a kept panel only needs what a reset in the middle of the app could leave behind
+    ret = oled_io->tx(oled_io, kept ? resync_cmds : init_cmds, kept ? sizeof(resync_cmds) : sizeof(init_cmds), NULL, 0);
+    if (ESP_OK == ret) {
+        ret = oled_io->wait(oled_io);
+    }
+    if (ESP_OK == ret) {
+        // no separate clear, the first flush writes the whole ram in one burst and turns the display on after it,
+        // so the random power-on ram never shows up, a kept panel shows the last picture until then
+        for (i = 0; i < 8; i++) {
+            oled_set_dirty(0, i, 128);
+        }
+        display_off = 1;
+#if !CONFIG_IDF_TARGET_LINUX
+        panel_magic = PANEL_MAGIC;
+#endif
+        if (kept) {
+            ESP_LOGI(TAG, "panel kept across reset, init skipped");
+        }
+    }
+    if (ESP_OK != ret) {
+        ESP_LOGE(TAG, "oled init error:%d", ret);
+    }
+    return ret;
+}
+
+// buf - 128*8 bytes, start/end - dirty columns of every page, cleared here, sync - wait for every burst before the next one
+// neighbouring dirty pages share one window when the extra columns cost less than another 6 byte window command,
+// the window then covers clean columns too, so buf must hold the whole picture and not only the dirty columns
+static void oled_flush_pages(const uint8_t *buf, uint8_t *start, uint8_t *end, uint8_t sync)
+{
+    uint8_t i = 0, n = 0, page = 0, last = 0, x1 = 0, x2 = 0, width = 0, cmd_start = 0, cmd_len = 0;
+    uint32_t used = 0, merged = 0, apart = 0;
+    const uint8_t *data = NULL;
+    const static uint8_t display_on = 0xAF; // display on/off, 0xAE - off, 0xAF - on
+
+    if (scroll_start <= scroll_end) {
+        return; // the panel is moving its ram, keep the changes for the flush after oled_scroll_stop
+    }
+    while (page < 8) {
+        if (start[page] > end[page]) {
+            page++;
+            continue;
+        }
+        x1 = start[page];
+        x2 = end[page];
+        last = page;
+        while (last < 7 && start[last + 1] <= end[last + 1]) {
+            merged = ((x2 > end[last + 1] ? x2 : end[last + 1]) - (x1 < start[last + 1] ? x1 : start[last + 1]) + 1) * (last - page + 2);
+            apart = (x2 - x1 + 1) * (last - page + 1) + (end[last + 1] - start[last + 1] + 1) + 6;
+            if (merged > apart) {
+                break;
+            }
+            last++;
+            x1 = x1 < start[last] ? x1 : start[last];
+            x2 = x2 > end[last] ? x2 : end[last];
+        }
+        width = x2 - x1 + 1;
+        window_cmds[n][0] = 0x21; // set column address, start and end
+        window_cmds[n][1] = x1;
+        window_cmds[n][2] = x2;
+        window_cmds[n][3] = 0x22; // set page address, start and end
+        window_cmds[n][4] = page;
+        window_cmds[n][5] = last;
+        cmd_start = (x1 == window_now[0] && x2 == window_now[1]) ? 3 : 0;
+        cmd_len = (page == window_now[2] && last == window_now[3]) ? 3 - cmd_start : 6 - cmd_start;
+        window_now[0] = x1;
+        window_now[1] = x2;
+        window_now[2] = page;
+        window_now[3] = last;
+        if (page == last || 128 == width) {
+            data = &buf[page * 128 + x1]; // already continuous
+        } else {
+            data = &window_buf[used];
+            for (i = page; i <= last; i++) {
+                memcpy(&window_buf[used], &buf[i * 128 + x1], width);
+                used += width;
+            }
+        }
+        oled_io->tx(oled_io, &window_cmds[n][cmd_start], cmd_len, data, width * (last - page + 1));
+        if (sync) {
+            oled_io->wait(oled_io);
+        }
+        for (i = page; i <= last; i++) {
+            start[i] = 128;
+            end[i] = 0;
+        }
+        n++;
+        page = last + 1;
+    }
+    if (display_off) {
+        oled_io->tx(oled_io, &display_on, 1, NULL, 0);
+        display_off = 0;
+    }
+    oled_io->wait(oled_io); // the transfers read buf directly, it must not change before they are done
+}
+
+void oled_flush(void)
+{
+    oled_flush_pages(pixel, dirty_start, dirty_end, 0);
+}
+
+void oled_flush_polling(void)
+{
+    oled_flush_pages(pixel, dirty_start, dirty_end, 1);
+}
+
+static void oled_flush_task(void *arg)
+{
+    TickType_t last = xTaskGetTickCount();
+    TickType_t now = 0;
+
+    while (1) {
+        xSemaphoreTake(frame_ready, portMAX_DELAY);
+        if (frame_period) {
+            // start at most one frame every period, a late frame goes out at once instead of catching up
+            now = xTaskGetTickCount();
+            if (now - last < frame_period) {
+                vTaskDelay(frame_period - (now - last));
+            }
+            last = xTaskGetTickCount();
+        }
+        oled_flush_pages(front, front_start, front_end, 0);
+        xSemaphoreGive(front_free);
+    }
+}
+
+esp_err_t oled_start_flush_task(uint32_t frame_ms, uint32_t priority)
+{
+    uint8_t i = 0, pending = 0;
+
+    if (NULL != front_free) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    front_free = xSemaphoreCreateBinary();
+    frame_ready = xSemaphoreCreateBinary();
+    if (NULL == front_free || NULL == frame_ready) {
+        ESP_LOGE(TAG, "flush semaphore create error");
+        goto exit;
+    }
+    frame_period = pdMS_TO_TICKS(frame_ms);
+    if (pdPASS != xTaskCreate(oled_flush_task, "oled_flush", 2048, NULL, priority, NULL)) {
+        ESP_LOGE(TAG, "flush task create error");
+        goto exit;
+    }
+    // oled_swap copies only the dirty columns, so the front buffer starts as the whole picture,
+    // and what was drawn but not flushed yet becomes the first frame of the task
+    memcpy(front, pixel, sizeof(front));
+    for (i = 0; i < 8; i++) {
+        front_start[i] = dirty_start[i];
+        front_end[i] = dirty_end[i];
+        pending |= dirty_start[i] <= dirty_end[i];
+        dirty_start[i] = 128;
+        dirty_end[i] = 0;
+    }
+    xSemaphoreGive(pending ? frame_ready : front_free);
+    return ESP_OK;
+exit:
+    if (NULL != front_free) {
+        vSemaphoreDelete(front_free);
+        front_free = NULL;
+    }
+    if (NULL != frame_ready) {
+        vSemaphoreDelete(frame_ready);
+        frame_ready = NULL;
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t oled_swap(uint32_t timeout_ms)
+{
+    uint8_t i = 0;
+
+    if (NULL == front_free) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // the previous frame is still being sent, the back buffer keeps its changes for the next swap
+    if (pdTRUE != xSemaphoreTake(front_free, pdMS_TO_TICKS(timeout_ms))) {
+        return ESP_ERR_TIMEOUT;
+    }
+    // only the changed columns are copied, the rest of the front buffer already matches pixel[]
+    for (i = 0; i < 8; i++) {
+        if (dirty_start[i] > dirty_end[i]) {
+            continue;
+        }
+        memcpy(&front[i * 128 + dirty_start[i]], &pixel[i * 128 + dirty_start[i]], dirty_end[i] - dirty_start[i] + 1);
+        // a frame held back by a hardware scroll is still pending, merge with it
+        if (dirty_start[i] < front_start[i]) {
+            front_start[i] = dirty_start[i];
+        }
+        if (dirty_end[i] > front_end[i]) {
+            front_end[i] = dirty_end[i];
+        }
+        dirty_start[i] = 128;
+        dirty_end[i] = 0;
+    }
+    xSemaphoreGive(frame_ready);
+    return ESP_OK;
+}
+
+// the flush task holds front_free while it sends a frame, taking it keeps the bus and the scroll state to the caller
+static void oled_front_take(void)
+{
+    if (NULL != front_free) {
+        xSemaphoreTake(front_free, portMAX_DELAY);
+    }
+}
+
+static void oled_front_give(void)
+{
+    if (NULL != front_free) {
+        xSemaphoreGive(front_free);
+    }
+}
+
+// commands outside a flush, the caller holds front_free
+static esp_err_t oled_send_cmds(const uint8_t *cmds, uint32_t len)
+{
+    esp_err_t ret = ESP_OK;
+
+    ret = oled_io->tx(oled_io, cmds, len, NULL, 0);
+    if (ESP_OK == ret) {
+        ret = oled_io->wait(oled_io);
+    }
+    if (ESP_OK != ret) {
+        ESP_LOGE(TAG, "oled cmd error:%d", ret);
+    }
+    return ret;
+}
+
+// commands outside a flush, waits for the frame the flush task may be sending
+static esp_err_t oled_write_cmds(const uint8_t *cmds, uint32_t len)
+{
+    esp_err_t ret = ESP_OK;
+
+    oled_front_take();
+    ret = oled_send_cmds(cmds, len);
+    oled_front_give();
+    return ret;
+}
+
+// a scroll the panel did not take must not hold back the flushes
+static esp_err_t oled_scroll_start(const uint8_t *cmds, uint32_t len, uint8_t start, uint8_t end)
+{
+    esp_err_t ret = ESP_OK;
+
+    oled_front_take();
+    ret = oled_send_cmds(cmds, len);
+    if (ESP_OK == ret) {
+        scroll_start = start;
+        scroll_end = end;
+    }
+    oled_front_give();
+    return ret;
+}
+
+esp_err_t oled_scroll_horizontal(uint8_t right, uint8_t start, uint8_t end, uint8_t interval)
+{
+    uint8_t cmds[] = {
+        0x2E,                   // deactivate scroll, a new setup is only taken while stopped
+        right ? 0x26 : 0x27,    // horizontal scroll, 0x26 - right, 0x27 - left
+        0x00,                   // dummy byte
+        start,                  // start page address, bit[2:0]
+        interval,               // frames between two steps, bit[2:0]
+        end,                    // end page address, bit[2:0]
+        0x00,                   // dummy byte
+        0xFF,                   // dummy byte
+        0x2F,                   // activate scroll
+    };
+
+    if (start > end || end > 7 || interval > 7) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (scroll_start <= scroll_end) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return oled_scroll_start(cmds, sizeof(cmds), start, end);
+}
+
+esp_err_t oled_scroll_diagonal(uint8_t right, uint8_t start, uint8_t end, uint8_t interval, uint8_t offset)
+{
+    uint8_t cmds[] = {
+        0x2E,                   // deactivate scroll
+        right ? 0x29 : 0x2A,    // vertical and horizontal scroll, 0x29 - right, 0x2A - left
+        0x00,                   // dummy byte
+        start,                  // start page address, bit[2:0]
+        interval,               // frames between two steps, bit[2:0]
+        end,                    // end page address, bit[2:0]
+        offset,                 // vertical offset rows of every step, bit[5:0]
+        0x2F,                   // activate scroll
+    };
+
+    if (start > end || end > 7 || interval > 7 || 0 == offset || offset > 63) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (scroll_start <= scroll_end) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return oled_scroll_start(cmds, sizeof(cmds), start, end);
+}
+
+esp_err_t oled_scroll_vertical_area(uint8_t fixed, uint8_t rows)
+{
+    uint8_t cmds[] = {
+        0xA3,   // set vertical scroll area
+        fixed,  // rows fixed at the top, bit[5:0]
+        rows,   // rows scrolled below them, bit[6:0]
+    };
+
+    if (fixed + rows > 64) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return oled_write_cmds(cmds, sizeof(cmds));
+}
+
+esp_err_t oled_scroll_stop(void)
+{
+    esp_err_t ret = ESP_OK;
+    uint8_t i = 0;
+    uint8_t cmds[] = {
+        0x2E,                       // deactivate scroll
+        0x40 | (start_line & 0x3F), // a diagonal scroll leaves its vertical offset behind
+    };
+
+    // the panel stops first, a flush let through earlier would land in ram that is still moving
+    oled_front_take();
+    ret = oled_send_cmds(cmds, sizeof(cmds));
+    if (ESP_OK == ret) {
+        // the scroll moved the GDDRAM content itself, pixel[] still has it where it was drawn
+        for (i = scroll_start; i <= scroll_end && i < 8; i++) {
+            oled_set_dirty(0, i, 128);
+        }
+        scroll_start = 8;
+        scroll_end = 0;
+    }
+    oled_front_give();
+    return ret;
+}
+
+esp_err_t oled_set_start_line(uint8_t line)
+{
+    uint8_t cmd = 0x40 | (line & 0x3F); // set display RAM start line address, 0x40 + bit[5:0]
+
+    start_line = line & 0x3F;
+    return oled_write_cmds(&cmd, 1);
+}
+
+void oled_clear(void)
+{
+    uint8_t i = 0, j = 0;
+
+    for (i = 0; i < 8; i++) {
+        for (j = 0; j < 128; j++) {
+            pixel[i * 128 + j] = 0x00;
+        }
+        oled_set_dirty(0, i, 128);
+    }
+}
+
+void oled_show_char(uint8_t x, uint8_t y, uint8_t ch, uint8_t size)
+{
+    uint8_t i = 0;
+
+    ch = ch - ' ';
+    if (1 == size) {
+        for (i = 0; i < 6; i++) {
+            pixel[y * 128 + x + i] = F6x8[ch][i];
+        }
+        oled_set_dirty(x, y, 6);
+    } else {
+        for (i = 0; i < 8; i++) {
+            pixel[y * 128 + x + i] = F8X16[ch * 16 + i];
+        }
+        for (i = 0; i < 8; i++) {
+            pixel[(y + 1) * 128 + x + i] = F8X16[ch * 16 + 8 + i];
+        }
+        oled_set_dirty(x, y, 8);
+        oled_set_dirty(x, y + 1, 8);
+    }
+}
+
+void oled_show_string(uint8_t x, uint8_t y, char *string, uint8_t size)
+{
+    uint8_t i = 0;
+
+    while (string[i] != '\0') {
+        oled_show_char(x, y, string[i], size);
+
+        if (1 == size) {
+            x += 6;
+            if (x > 122) {
+                x = 0;
+                y += 1;
+            }
+        } else {
+            x += 8;
+            if (x > 120) {
+                x = 0;
+                y += 2;
+            }
+        }
+        i++;
+    }
+}
+
+void oled_show_chinese(uint8_t x, uint8_t y, uint8_t* index, uint8_t num)
+{
+    uint8_t i = 0, j = 0;
+
+    for (j = 0; j < num; j++) {
+        for (i = 0; i < 16; i++) {
+            pixel[y * 128 + x + i] = Hzk[2 * index[j]][i];
+        }
+        for (i = 0; i < 16; i++) {
+            pixel[(y + 1) * 128 + x + i] = Hzk[2 * index[j] + 1][i];
+        }
+        oled_set_dirty(x, y, 16);
+        oled_set_dirty(x, y + 1, 16);
+
+        x += 16;
+        if (x > 112) {
+            x = 0;
+            y += 2;
+        }
+    }
+}
+
+void oled_show_text(uint8_t x, uint8_t y, const char *text, const oled_font_t *font)
+{
+    oled_glyph_t glyph = {0};
+    uint32_t codepoint = 0;
+    uint8_t i = 0;
+
+    while (*text && y + font->pages <= 8) {
+        text += oled_utf8_decode(text, &codepoint);
+        if (ESP_OK != oled_font_get_glyph(font, codepoint, &glyph) && ESP_OK != oled_font_get_glyph(font, '?', &glyph)) {
+            continue;
+        }
+        if (glyph.width > 128) {
+            continue;
+        }
+        if (x + glyph.width > 128) {
+            x = 0;
+            y += font->pages;
+            if (y + font->pages > 8) {
+                break;
+            }
+        }
+        for (i = 0; i < glyph.pages; i++) {
+            memcpy(&pixel[(y + i) * 128 + x], &glyph.bitmap[i * glyph.width], glyph.width);
+            oled_set_dirty(x, y + i, glyph.width);
+        }
+        x += glyph.width;
+    }
+}
+
+void oled_show_point(uint8_t x, uint8_t y, uint8_t value)
+{
+    uint8_t row = y / 8;
+    uint8_t bit = y % 8;
+    uint8_t mask = 0;
+
+    if (x > 127 || y > 63) {
+        return;
+    }
+
+    if (0 == value) {
+        mask = ~(1 << bit);
+        pixel[row * 128 + x] &= mask;
+    } else {
+        mask = 1 << bit;
+        pixel[row * 128 + x] |= mask;
+    }
+
+    oled_set_dirty(x, row, 1);
+}
+
+// signed coordinates, the part outside the screen is dropped
+static void oled_plot(int x, int y, uint8_t value)
+{
+    if (x < 0 || x > 127 || y < 0 || y > 63) {
+        return;
+    }
+    oled_show_point(x, y, value);
+}
+
+// rows y~y+h-1 of columns x~x+w-1, whole bytes where a page is fully covered
+static void oled_fill_area(int x, int y, int w, int h, uint8_t value)
+{
+    int page = 0, page_end = 0, top = 0, bottom = 0, i = 0;
+    uint8_t mask = 0;
+    uint8_t *buf = NULL;
+
+    if (x < 0) {
+        w += x;
+        x = 0;
+    }
+    if (y < 0) {
+        h += y;
+        y = 0;
+    }
+    w = (x + w > 128) ? 128 - x : w;
+    h = (y + h > 64) ? 64 - y : h;
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+
+    page_end = (y + h - 1) / 8;
+    for (page = y / 8; page <= page_end; page++) {
+        top = (page == y / 8) ? y % 8 : 0;
+        bottom = (page == page_end) ? (y + h - 1) % 8 : 7;
+        mask = (0xFF << top) & (0xFF >> (7 - bottom));
+        buf = &pixel[page * 128 + x];
+        if (0xFF == mask) {
+            memset(buf, value ? 0xFF : 0x00, w);
+        } else if (value) {
+            for (i = 0; i < w; i++) {
+                buf[i] |= mask;
+            }
+        } else {
+            for (i = 0; i < w; i++) {
+                buf[i] &= ~mask;
+            }
+        }
+        oled_set_dirty(x, page, w);
+    }
+}
+
+void oled_show_line(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t value)
+{
+    int x = x1, y = y1;
+    int dx = x2 > x1 ? x2 - x1 : x1 - x2, sx = x1 < x2 ? 1 : -1;
+    int dy = y2 > y1 ? y1 - y2 : y2 - y1, sy = y1 < y2 ? 1 : -1; // dy <= 0
+    int err = dx + dy, e2 = 0;
+
+    if (y1 == y2) {
+        oled_fill_area(x1 < x2 ? x1 : x2, y1, dx + 1, 1, value);
+        return;
+    }
+    if (x1 == x2) {
+        oled_fill_area(x1, y1 < y2 ? y1 : y2, 1, 1 - dy, value);
+        return;
+    }
+
+    // bresenham, integer error term for any slope and direction
+    while (1) {
+        oled_plot(x, y, value);
+        if (x == x2 && y == y2) {
+            break;
+        }
+        e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y += sy;
+        }
+    }
+}
+
+void oled_show_hline(uint8_t x, uint8_t y, uint8_t w, uint8_t value)
+{
+    oled_fill_area(x, y, w, 1, value);
+}
+
+void oled_show_vline(uint8_t x, uint8_t y, uint8_t h, uint8_t value)
+{
+    oled_fill_area(x, y, 1, h, value);
+}
+
+void oled_show_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t value)
+{
+    if (!w || !h) {
+        return;
+    }
+    oled_fill_area(x, y, w, 1, value);
+    oled_fill_area(x, y + h - 1, w, 1, value);
+    oled_fill_area(x, y, 1, h, value);
+    oled_fill_area(x + w - 1, y, 1, h, value);
+}
+
+void oled_fill_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t value)
+{
+    oled_fill_area(x, y, w, h, value);
+}
+
+// midpoint circle, fill - spans between the symmetric points instead of the outline
+static void oled_circle(int x0, int y0, int r, uint8_t value, uint8_t fill)
+{
+    int x = r, y = 0, err = 1 - r;
+
+    while (x >= y) {
+        if (fill) {
+            oled_fill_area(x0 - x, y0 + y, 2 * x + 1, 1, value);
+            oled_fill_area(x0 - x, y0 - y, 2 * x + 1, 1, value);
+            oled_fill_area(x0 - y, y0 + x, 2 * y + 1, 1, value);
+            oled_fill_area(x0 - y, y0 - x, 2 * y + 1, 1, value);
+        } else {
+            oled_plot(x0 + x, y0 + y, value);
+            oled_plot(x0 - x, y0 + y, value);
+            oled_plot(x0 + x, y0 - y, value);
+            oled_plot(x0 - x, y0 - y, value);
+            oled_plot(x0 + y, y0 + x, value);
+            oled_plot(x0 - y, y0 + x, value);
+            oled_plot(x0 + y, y0 - x, value);
+            oled_plot(x0 - y, y0 - x, value);
+        }
+        y++;
+        if (err < 0) {
+            err += 2 * y + 1;
+        } else {
+            x--;
+            err += 2 * (y - x) + 1;
+        }
+    }
+}
+
+void oled_show_circle(uint8_t x, uint8_t y, uint8_t r, uint8_t value)
+{
+    oled_circle(x, y, r, value, 0);
+}
+
+void oled_fill_circle(uint8_t x, uint8_t y, uint8_t r, uint8_t value)
+{
+    oled_circle(x, y, r, value, 1);
+}
+
+// n column bytes of a source page into a destination page, shifted down by shift rows, up by -shift rows,
+// mask - rows of the destination page they cover
+static void oled_blit_span(uint8_t *dst, const uint8_t *src, int n, int shift, uint8_t mask, oled_blit_mode_t mode)
+{
+    int i = 0;
+    uint8_t bits = 0;
+
+    // the mode is picked once per span, the loops stay small enough for the compiler to unroll
+    switch (mode) {
+    case OLED_BLIT_OR:
+        for (i = 0; i < n; i++) {
+            bits = (shift >= 0) ? src[i] << shift : src[i] >> -shift;
+            dst[i] |= bits & mask;
+        }
+        break;
+    case OLED_BLIT_AND:
+        for (i = 0; i < n; i++) {
+            bits = (shift >= 0) ? src[i] << shift : src[i] >> -shift;
+            dst[i] &= bits | ~mask;
+        }
+        break;
+    case OLED_BLIT_XOR:
+        for (i = 0; i < n; i++) {
+            bits = (shift >= 0) ? src[i] << shift : src[i] >> -shift;
+            dst[i] ^= bits & mask;
+        }
+        break;
+    default:
+        for (i = 0; i < n; i++) {
+            bits = (shift >= 0) ? src[i] << shift : src[i] >> -shift;
+            dst[i] = (dst[i] & ~mask) | (bits & mask);
+        }
+        break;
+    }
+}
+
+void oled_blit(int x, int y, const uint8_t *bitmap, uint8_t w, uint8_t h, oled_blit_mode_t mode)
+{
+    int page0 = (y >= 0) ? y / 8 : (y - 7) / 8; // page of the first row, rounded down for rows above the screen
+    int shift = y - page0 * 8;
+    int col = (x < 0) ? -x : 0;
+    int col_end = (x + w > 128) ? 128 - x : w;
+    int sp = 0, dp = 0;
+    uint8_t pages = (h + 7) / 8;
+    uint8_t mask = 0;
+
+    if (col >= col_end) {
+        return;
+    }
+    for (sp = 0; sp < pages; sp++) {
+        // the last source page may only be partly used
+        mask = (sp == pages - 1 && (h % 8)) ? 0xFF >> (8 - h % 8) : 0xFF;
+        dp = page0 + sp;
+        // the rows land in page dp shifted down, the ones pushed out go to the top of page dp + 1
+        if (dp >= 0 && dp < 8) {
+            oled_blit_span(&pixel[dp * 128 + x + col], &bitmap[sp * w + col], col_end - col, shift, mask << shift, mode);
+            oled_set_dirty(x + col, dp, col_end - col);
+        }
+        if (shift && dp + 1 >= 0 && dp + 1 < 8 && (mask >> (8 - shift))) {
+            oled_blit_span(&pixel[(dp + 1) * 128 + x + col], &bitmap[sp * w + col], col_end - col, shift - 8, mask >> (8 - shift), mode);
+            oled_set_dirty(x + col, dp + 1, col_end - col);
+        }
+    }
+}
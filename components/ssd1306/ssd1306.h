@@ -0,0 +1,109 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "ssd1306_font.h"
+
+typedef struct ssd1306_io_t *ssd1306_io_handle_t;
+
+typedef enum {
+    OLED_BLIT_COPY, // the bitmap replaces what was there
+    OLED_BLIT_OR,   // set pixels are drawn, clear ones are transparent
+    OLED_BLIT_AND,  // clear pixels are erased
+    OLED_BLIT_XOR,  // set pixels invert, drawing twice restores the screen
+} oled_blit_mode_t;
+
+typedef enum {
+    OLED_DITHER_NONE,   // threshold at 128
+    OLED_DITHER_BAYER,  // 8*8 ordered, stable pattern, good for animations
+    OLED_DITHER_FLOYD,  // Floyd-Steinberg error diffusion, best for photos
+} oled_dither_t;
+
+typedef struct {
+    int host;           // spi_host_device_t
+    int pin_mosi;
+    int pin_clk;
+    int pin_cs;
+    int pin_dc;
+    int pin_rst;        // -1 if not connected
+    int clock_hz;       // 10MHz at most
+} ssd1306_spi_config_t;
+
+typedef struct {
+    int port;           // i2c_port_t
+    int pin_sda;
+    int pin_scl;
+    uint8_t dev_addr;   // 0x3C or 0x3D
+    uint32_t clock_hz;  // 400kHz fast mode, most panels also work at 1MHz
+} ssd1306_i2c_config_t;
+
+// a panel over SPI, 4-wire with a D/C pin
+esp_err_t ssd1306_new_spi_io(const ssd1306_spi_config_t *config, ssd1306_io_handle_t *ret_io);
+// a panel over I2C
+esp_err_t ssd1306_new_i2c_io(const ssd1306_i2c_config_t *config, ssd1306_io_handle_t *ret_io);
+// no panel, the commands drive a GDDRAM copy in memory, for rendering tests and benchmarks on the host
+esp_err_t ssd1306_new_host_io(ssd1306_io_handle_t *ret_io);
+// 128*8 bytes, same layout as the panel GDDRAM
+const uint8_t *ssd1306_host_get_ram(ssd1306_io_handle_t io);
+// tx calls and bytes sent since the io was created
+void ssd1306_host_get_stats(ssd1306_io_handle_t io, uint32_t *tx_cnt, uint32_t *byte_cnt);
+// dump the GDDRAM as a 128*64 binary PGM image
+esp_err_t ssd1306_host_save_pgm(ssd1306_io_handle_t io, const char *path);
+esp_err_t ssd1306_del_io(ssd1306_io_handle_t io);
+
+// 1 - only the chip was reset, the panel stayed powered and set up, the transports skip the reset pulse
+uint8_t oled_panel_kept(void);
+// one command burst, only a resync of a kept panel, the first flush clears the rest of the ram and turns the display on
+esp_err_t oled_init(ssd1306_io_handle_t io);
+void oled_clear(void);
+// drawing only changes the ram copy, push the changed area to the panel
+void oled_flush(void);
+// same as oled_flush, but waits for every page before sending the next one, kept to compare with the queued transfers
+void oled_flush_polling(void);
+// push frames from a background task instead, frame_ms - shortest time between two frames, 0 - no pacing
+// after this, use oled_swap and not oled_flush, the task owns the bus
+esp_err_t oled_start_flush_task(uint32_t frame_ms, uint32_t priority);
+// hand the changes drawn since the last swap to the flush task and keep drawing at once,
+// ESP_ERR_TIMEOUT if the previous frame is still being sent after timeout_ms, the changes stay for the next swap
+esp_err_t oled_swap(uint32_t timeout_ms);
+// the panel scrolls on its own, no bus traffic until the content changes
+// start/end - pages 0~7, interval - frames between two 1 column steps:
+// 0 - 5, 1 - 64, 2 - 128, 3 - 256, 4 - 3, 5 - 4, 6 - 25, 7 - 2
+// changes drawn while scrolling are held back until oled_scroll_stop, ESP_ERR_INVALID_STATE if a scroll is running
+esp_err_t oled_scroll_horizontal(uint8_t right, uint8_t start, uint8_t end, uint8_t interval);
+// horizontal scroll of pages start~end plus offset rows up every step, inside the oled_scroll_vertical_area rows
+esp_err_t oled_scroll_diagonal(uint8_t right, uint8_t start, uint8_t end, uint8_t interval, uint8_t offset);
+// fixed rows at the top are left alone, the next rows scroll vertically, 0 and 64 after init
+esp_err_t oled_scroll_vertical_area(uint8_t fixed, uint8_t rows);
+// the scrolled pages are marked dirty, the next flush puts them back as drawn
+esp_err_t oled_scroll_stop(void);
+// 0~63, row of the ram shown at the top of the screen, a vertical ticker only writes the row that comes in
+esp_err_t oled_set_start_line(uint8_t line);
+// x - 0~127, y - 0~7, size: 1 - 6*8, 2 - 8*16
+void oled_show_char(uint8_t x, uint8_t y, uint8_t ch, uint8_t size);
+// x - 0~127, y - 0~7, size: 1 - 6*8, 2 - 8*16
+void oled_show_string(uint8_t x, uint8_t y, char *string, uint8_t size);
+// x - 0~127, y - 0~7, size: 16*16
+void oled_show_chinese(uint8_t x, uint8_t y, uint8_t* index, uint8_t num);
+// x - 0~127, y - 0~7, utf-8 text in a proportional font, wraps to the next line at the right edge
+void oled_show_text(uint8_t x, uint8_t y, const char *text, const oled_font_t *font);
+// x - 0~127, y - 0~63, value: 0 - off, 1 - on
+void oled_show_point(uint8_t x, uint8_t y, uint8_t value);
+// x - 0~127, y - 0~63, any direction, value: 0 - off, 1 - on
+void oled_show_line(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t value);
+// from (x, y) to the right, w pixels
+void oled_show_hline(uint8_t x, uint8_t y, uint8_t w, uint8_t value);
+// from (x, y) down, h pixels
+void oled_show_vline(uint8_t x, uint8_t y, uint8_t h, uint8_t value);
+// outline, (x, y) is the top left corner, clipped at the screen edge
+void oled_show_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t value);
+void oled_fill_rect(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t value);
+// (x, y) is the center, clipped at the screen edge
+void oled_show_circle(uint8_t x, uint8_t y, uint8_t r, uint8_t value);
+void oled_fill_circle(uint8_t x, uint8_t y, uint8_t r, uint8_t value);
+// bitmap in panel layout: w bytes for rows 0~7, w bytes for rows 8~15 ..., bit0 is the top row,
+// (x, y) is the top left corner at any pixel offset, clipped at the screen edge
+void oled_blit(int x, int y, const uint8_t *bitmap, uint8_t w, uint8_t h, oled_blit_mode_t mode);
+// gray - w*h bytes row by row, 0 black 255 white, out - w*((h+7)/8) bytes for oled_blit, w 128 at most
+esp_err_t oled_gray_to_mono(const uint8_t *gray, uint8_t w, uint8_t h, uint8_t *out, oled_dither_t dither);
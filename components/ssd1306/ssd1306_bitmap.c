@@ -0,0 +1,59 @@
+#include <string.h>
+#include "ssd1306.h"
+
+// 8*8 Bayer matrix, thresholds spread over 0~255
+static const uint8_t bayer8[8][8] = {
+    {  0, 128,  32, 160,   8, 136,  40, 168},
+    {192,  64, 224,  96, 200,  72, 232, 104},
+    { 48, 176,  16, 144,  56, 184,  24, 152},
+    {240, 112, 208,  80, 248, 120, 216,  88},
+    { 12, 140,  44, 172,   4, 132,  36, 164},
+    {204,  76, 236, 108, 196,  68, 228, 100},
+    { 60, 188,  28, 156,  52, 180,  20, 148},
+    {252, 124, 220,  92, 244, 116, 212,  84},
+};
+
+esp_err_t oled_gray_to_mono(const uint8_t *gray, uint8_t w, uint8_t h, uint8_t *out, oled_dither_t dither)
+{
+    int16_t err[2][128 + 2] = {0}; // error of this row and the next, one column of margin on both sides
+    int16_t *cur = err[0] + 1, *next = err[1] + 1;
+    int16_t *tmp = NULL;
+    int value = 0, q = 0, e = 0;
+    uint8_t x = 0, y = 0, on = 0;
+
+    if (NULL == gray || NULL == out || 0 == w || w > 128) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(out, 0, w * ((h + 7) / 8));
+
+    for (y = 0; y < h; y++) {
+        for (x = 0; x < w; x++) {
+            value = gray[y * w + x];
+            if (OLED_DITHER_BAYER == dither) {
+                on = value > bayer8[y & 7][x & 7];
+            } else if (OLED_DITHER_FLOYD == dither) {
+                value += cur[x];
+                q = (value >= 128) ? 255 : 0;
+                on = q != 0;
+                e = value - q;
+                // 7/16 right, 3/16 down left, 5/16 down, 1/16 down right
+                cur[x + 1] += e * 7 / 16;
+                next[x - 1] += e * 3 / 16;
+                next[x] += e * 5 / 16;
+                next[x + 1] += e / 16;
+            } else {
+                on = value >= 128;
+            }
+            if (on) {
+                out[(y / 8) * w + x] |= 1 << (y % 8);
+            }
+        }
+        if (OLED_DITHER_FLOYD == dither) {
+            tmp = cur;
+            cur = next;
+            next = tmp;
+            memset(next - 1, 0, (w + 2) * sizeof(int16_t));
+        }
+    }
+    return ESP_OK;
+}
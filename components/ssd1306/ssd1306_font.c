@@ -0,0 +1,227 @@
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "ssd1306_font.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_partition.h"
+#endif
+
+#define FONT_HEADER_SIZE    12
+#define FONT_CACHE_SETS     16 // a power of 2, 2 glyphs in each set
+#define FONT_CACHE_GLYPH    32 // bytes, 16*16 at most, bigger glyphs are always read from the font
+
+typedef struct {
+    const oled_font_t *font; // NULL - empty
+    uint32_t codepoint;
+    uint8_t width;
+    uint8_t bitmap[FONT_CACHE_GLYPH];
+} font_cache_t;
+
+typedef struct {
+    font_cache_t way[2];
+    uint8_t next; // way replaced on the next miss
+} font_cache_set_t;
+
+const static char *TAG = "ssd1306_font";
+// a string mostly repeats a few hot glyphs, the set mixes in bit 5 so upper and lower case ascii spread out
+static font_cache_set_t font_cache[FONT_CACHE_SETS] = {0};
+static uint32_t cache_hit = 0;
+static uint32_t cache_miss = 0;
+
+esp_err_t oled_font_load(const void *data, uint32_t size, oled_font_t *font)
+{
+    const uint8_t *p = data;
+    uint32_t i = 0, count = 0, offset = 0, width = 0;
+
+    if (NULL == p || NULL == font || ((uintptr_t)p & 3)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (size < FONT_HEADER_SIZE || memcmp(p, "OFNT", 4) || 1 != p[4] || 0 == p[5] || p[5] > 8) {
+        ESP_LOGE(TAG, "font header error");
+        return ESP_ERR_INVALID_ARG;
+    }
+    count = p[8] | (p[9] << 8) | (p[10] << 16) | ((uint32_t)p[11] << 24);
+    if (count > (size - FONT_HEADER_SIZE) / sizeof(oled_font_index_t)) {
+        ESP_LOGE(TAG, "font index size error");
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memset(font, 0, sizeof(oled_font_t));
+    font->pages = p[5];
+    font->count = count;
+    font->index = (const oled_font_index_t *)(p + FONT_HEADER_SIZE);
+    font->bitmap = p + FONT_HEADER_SIZE + count * sizeof(oled_font_index_t);
+    font->bitmap_size = size - FONT_HEADER_SIZE - count * sizeof(oled_font_index_t);
+
+    // checked once here, so the lookup can trust the index
+    for (i = 0; i < count; i++) {
+        offset = font->index[i].info >> 8;
+        width = font->index[i].info & 0xFF;
+        if ((i && font->index[i].codepoint <= font->index[i - 1].codepoint)
+            || offset + width * font->pages > font->bitmap_size) {
+            ESP_LOGE(TAG, "font glyph %lu error", i);
+            return ESP_ERR_INVALID_SIZE;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t oled_font_load_partition(const char *label, oled_font_t *font)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    return ESP_ERR_NOT_SUPPORTED;
+#else
+    esp_err_t ret = ESP_OK;
+    const esp_partition_t *partition = NULL;
+    const void *data = NULL;
+    esp_partition_mmap_handle_t handle = 0;
+
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (NULL == partition) {
+        ESP_LOGE(TAG, "font partition %s not found", label);
+        return ESP_ERR_NOT_FOUND;
+    }
+    ret = esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA, &data, &handle);
+    if (ESP_OK != ret) {
+        ESP_LOGE(TAG, "font partition mmap error:%d", ret);
+        return ret;
+    }
+    ret = oled_font_load(data, partition->size, font);
+    if (ESP_OK != ret) {
+        esp_partition_munmap(handle);
+        return ret;
+    }
+    font->mapped = 1;
+    font->map_handle = handle;
+    return ESP_OK;
+#endif
+}
+
+void oled_font_unload(oled_font_t *font)
+{
+    uint32_t i = 0;
+
+    for (i = 0; i < FONT_CACHE_SETS; i++) {
+        if (font_cache[i].way[0].font == font) {
+            font_cache[i].way[0].font = NULL;
+        }
+        if (font_cache[i].way[1].font == font) {
+            font_cache[i].way[1].font = NULL;
+        }
+    }
+#if !CONFIG_IDF_TARGET_LINUX
+    if (font->mapped) {
+        esp_partition_munmap(font->map_handle);
+    }
+#endif
+    memset(font, 0, sizeof(oled_font_t));
+}
+
+esp_err_t oled_font_get_glyph(const oled_font_t *font, uint32_t codepoint, oled_glyph_t *glyph)
+{
+    font_cache_set_t *set = &font_cache[(codepoint ^ (codepoint >> 5)) & (FONT_CACHE_SETS - 1)];
+    font_cache_t *cache = NULL;
+    const oled_font_index_t *index = NULL;
+    uint32_t low = 0, high = font->count, mid = 0, size = 0;
+    uint8_t i = 0;
+
+    for (i = 0; i < 2; i++) {
+        cache = &set->way[i];
+        if (cache->font == font && cache->codepoint == codepoint) {
+            cache_hit++;
+            glyph->width = cache->width;
+            glyph->pages = font->pages;
+            glyph->bitmap = cache->bitmap;
+            return ESP_OK;
+        }
+    }
+    cache_miss++;
+
+    while (low < high) {
+        mid = (low + high) / 2;
+        if (font->index[mid].codepoint < codepoint) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == font->count || font->index[low].codepoint != codepoint) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    index = &font->index[low];
+    glyph->width = index->info & 0xFF;
+    glyph->pages = font->pages;
+    glyph->bitmap = font->bitmap + (index->info >> 8);
+
+    size = glyph->width * glyph->pages;
+    if (size <= FONT_CACHE_GLYPH) {
+        cache = &set->way[set->next];
+        set->next ^= 1;
+        cache->font = font;
+        cache->codepoint = codepoint;
+        cache->width = glyph->width;
+        memcpy(cache->bitmap, glyph->bitmap, size);
+        glyph->bitmap = cache->bitmap;
+    }
+    return ESP_OK;
+}
+
+uint8_t oled_utf8_decode(const char *text, uint32_t *codepoint)
+{
+    const uint8_t *p = (const uint8_t *)text;
+    uint32_t cp = 0, min = 0;
+    uint8_t len = 0, i = 0;
+
+    if (p[0] < 0x80) {
+        *codepoint = p[0];
+        return 1;
+    } else if ((p[0] & 0xE0) == 0xC0) {
+        cp = p[0] & 0x1F;
+        len = 2;
+        min = 0x80;
+    } else if ((p[0] & 0xF0) == 0xE0) {
+        cp = p[0] & 0x0F;
+        len = 3;
+        min = 0x800;
+    } else if ((p[0] & 0xF8) == 0xF0) {
+        cp = p[0] & 0x07;
+        len = 4;
+        min = 0x10000;
+    } else {
+        *codepoint = 0xFFFD;
+        return 1;
+    }
+    for (i = 1; i < len; i++) {
+        if ((p[i] & 0xC0) != 0x80) { // also stops at the terminating 0
+            *codepoint = 0xFFFD;
+            return 1;
+        }
+        cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    // overlong forms, surrogates and values out of unicode
+    if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+        *codepoint = 0xFFFD;
+        return 1;
+    }
+    *codepoint = cp;
+    return len;
+}
+
+uint32_t oled_font_text_width(const oled_font_t *font, const char *text)
+{
+    oled_glyph_t glyph = {0};
+    uint32_t codepoint = 0, width = 0;
+
+    while (*text) {
+        text += oled_utf8_decode(text, &codepoint);
+        if (ESP_OK == oled_font_get_glyph(font, codepoint, &glyph) || ESP_OK == oled_font_get_glyph(font, '?', &glyph)) {
+            width += glyph.width;
+        }
+    }
+    return width;
+}
+
+void oled_font_get_cache_stats(uint32_t *hit, uint32_t *miss)
+{
+    *hit = cache_hit;
+    *miss = cache_miss;
+}
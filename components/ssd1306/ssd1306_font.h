@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// font image, little endian, the same bytes in a const array or a flash partition, tools/mkfont.py builds it
+// 0  - "OFNT"
+// 4  - version 1, pages - glyph height in 8 pixel pages, 2 bytes reserved
+// 8  - count of glyphs
+// 12 - count * oled_font_index_t, sorted by codepoint
+// then the bitmaps, width bytes for page 0, width bytes for page 1 ..., bit0 is the top row of a page
+typedef struct {
+    uint32_t codepoint;
+    uint32_t info;      // bit[31:8] - bitmap offset, bit[7:0] - width, blank columns after the glyph included
+} oled_font_index_t;
+
+typedef struct {
+    uint8_t pages;
+    uint32_t count;
+    const oled_font_index_t *index;
+    const uint8_t *bitmap;
+    uint32_t bitmap_size;
+    uint8_t mapped;     // 1 - mmap of a partition, release with oled_font_unload
+    uint32_t map_handle;
+} oled_font_t;
+
+typedef struct {
+    uint8_t width;
+    uint8_t pages;
+    const uint8_t *bitmap; // width * pages bytes, only valid until the next lookup
+} oled_glyph_t;
+
+// proportional ascii and the chinese glyphs of the demo, 16 pixels high
+extern const uint8_t oled_font16[];
+extern const uint32_t oled_font16_size;
+
+// data must stay valid as long as the font is used, 4 bytes aligned
+esp_err_t oled_font_load(const void *data, uint32_t size, oled_font_t *font);
+// map a data partition holding a font image, the glyphs are read from flash through the cache
+esp_err_t oled_font_load_partition(const char *label, oled_font_t *font);
+void oled_font_unload(oled_font_t *font);
+// ESP_ERR_NOT_FOUND if the font has no such glyph
+esp_err_t oled_font_get_glyph(const oled_font_t *font, uint32_t codepoint, oled_glyph_t *glyph);
+// decode one utf-8 character, returns the bytes used, invalid sequences give 0xFFFD and use 1 byte
+uint8_t oled_utf8_decode(const char *text, uint32_t *codepoint);
+// columns text takes in one line
+uint32_t oled_font_text_width(const oled_font_t *font, const char *text);
+// glyph cache hits and misses since boot
+void oled_font_get_cache_stats(uint32_t *hit, uint32_t *miss);
@@ -0,0 +1,169 @@
+// generated by tools/mkfont.py from the F8X16 and Hzk tables, proportional ascii and the demo chinese glyphs
+#include <stdint.h>
+
+__attribute__((aligned(4))) const uint8_t oled_font16[] = {
+    0x4F, 0x46, 0x4E, 0x54, 0x01, 0x02, 0x00, 0x00, 0x6B, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00,
+    0x04, 0x00, 0x00, 0x00, 0x21, 0x00, 0x00, 0x00, 0x03, 0x08, 0x00, 0x00, 0x22, 0x00, 0x00, 0x00,
+    0x07, 0x0E, 0x00, 0x00, 0x23, 0x00, 0x00, 0x00, 0x08, 0x1C, 0x00, 0x00, 0x24, 0x00, 0x00, 0x00,
+    0x06, 0x2C, 0x00, 0x00, 0x25, 0x00, 0x00, 0x00, 0x08, 0x38, 0x00, 0x00, 0x26, 0x00, 0x00, 0x00,
+    0x09, 0x48, 0x00, 0x00, 0x27, 0x00, 0x00, 0x00, 0x04, 0x5A, 0x00, 0x00, 0x28, 0x00, 0x00, 0x00,
+    0x05, 0x62, 0x00, 0x00, 0x29, 0x00, 0x00, 0x00, 0x05, 0x6C, 0x00, 0x00, 0x2A, 0x00, 0x00, 0x00,
+    0x08, 0x76, 0x00, 0x00, 0x2B, 0x00, 0x00, 0x00, 0x08, 0x86, 0x00, 0x00, 0x2C, 0x00, 0x00, 0x00,
+    0x04, 0x96, 0x00, 0x00, 0x2D, 0x00, 0x00, 0x00, 0x08, 0x9E, 0x00, 0x00, 0x2E, 0x00, 0x00, 0x00,
+    0x03, 0xAE, 0x00, 0x00, 0x2F, 0x00, 0x00, 0x00, 0x08, 0xB4, 0x00, 0x00, 0x30, 0x00, 0x00, 0x00,
+    0x07, 0xC4, 0x00, 0x00, 0x31, 0x00, 0x00, 0x00, 0x06, 0xD2, 0x00, 0x00, 0x32, 0x00, 0x00, 0x00,
+    0x07, 0xDE, 0x00, 0x00, 0x33, 0x00, 0x00, 0x00, 0x07, 0xEC, 0x00, 0x00, 0x34, 0x00, 0x00, 0x00,
+    0x07, 0xFA, 0x00, 0x00, 0x35, 0x00, 0x00, 0x00, 0x07, 0x08, 0x01, 0x00, 0x36, 0x00, 0x00, 0x00,
+    0x07, 0x16, 0x01, 0x00, 0x37, 0x00, 0x00, 0x00, 0x07, 0x24, 0x01, 0x00, 0x38, 0x00, 0x00, 0x00,
+    0x07, 0x32, 0x01, 0x00, 0x39, 0x00, 0x00, 0x00, 0x07, 0x40, 0x01, 0x00, 0x3A, 0x00, 0x00, 0x00,
+    0x03, 0x4E, 0x01, 0x00, 0x3B, 0x00, 0x00, 0x00, 0x03, 0x54, 0x01, 0x00, 0x3C, 0x00, 0x00, 0x00,
+    0x07, 0x5A, 0x01, 0x00, 0x3D, 0x00, 0x00, 0x00, 0x08, 0x68, 0x01, 0x00, 0x3E, 0x00, 0x00, 0x00,
+    0x07, 0x78, 0x01, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x07, 0x86, 0x01, 0x00, 0x40, 0x00, 0x00, 0x00,
+    0x08, 0x94, 0x01, 0x00, 0x41, 0x00, 0x00, 0x00, 0x09, 0xA4, 0x01, 0x00, 0x42, 0x00, 0x00, 0x00,
+    0x08, 0xB6, 0x01, 0x00, 0x43, 0x00, 0x00, 0x00, 0x08, 0xC6, 0x01, 0x00, 0x44, 0x00, 0x00, 0x00,
+    0x08, 0xD6, 0x01, 0x00, 0x45, 0x00, 0x00, 0x00, 0x08, 0xE6, 0x01, 0x00, 0x46, 0x00, 0x00, 0x00,
+    0x08, 0xF6, 0x01, 0x00, 0x47, 0x00, 0x00, 0x00, 0x08, 0x06, 0x02, 0x00, 0x48, 0x00, 0x00, 0x00,
+    0x09, 0x16, 0x02, 0x00, 0x49, 0x00, 0x00, 0x00, 0x06, 0x28, 0x02, 0x00, 0x4A, 0x00, 0x00, 0x00,
+    0x08, 0x34, 0x02, 0x00, 0x4B, 0x00, 0x00, 0x00, 0x08, 0x44, 0x02, 0x00, 0x4C, 0x00, 0x00, 0x00,
+    0x08, 0x54, 0x02, 0x00, 0x4D, 0x00, 0x00, 0x00, 0x08, 0x64, 0x02, 0x00, 0x4E, 0x00, 0x00, 0x00,
+    0x09, 0x74, 0x02, 0x00, 0x4F, 0x00, 0x00, 0x00, 0x08, 0x86, 0x02, 0x00, 0x50, 0x00, 0x00, 0x00,
+    0x08, 0x96, 0x02, 0x00, 0x51, 0x00, 0x00, 0x00, 0x08, 0xA6, 0x02, 0x00, 0x52, 0x00, 0x00, 0x00,
+    0x09, 0xB6, 0x02, 0x00, 0x53, 0x00, 0x00, 0x00, 0x07, 0xC8, 0x02, 0x00, 0x54, 0x00, 0x00, 0x00,
+    0x08, 0xD6, 0x02, 0x00, 0x55, 0x00, 0x00, 0x00, 0x09, 0xE6, 0x02, 0x00, 0x56, 0x00, 0x00, 0x00,
+    0x09, 0xF8, 0x02, 0x00, 0x57, 0x00, 0x00, 0x00, 0x08, 0x0A, 0x03, 0x00, 0x58, 0x00, 0x00, 0x00,
+    0x09, 0x1A, 0x03, 0x00, 0x59, 0x00, 0x00, 0x00, 0x08, 0x2C, 0x03, 0x00, 0x5A, 0x00, 0x00, 0x00,
+    0x08, 0x3C, 0x03, 0x00, 0x5B, 0x00, 0x00, 0x00, 0x05, 0x4C, 0x03, 0x00, 0x5C, 0x00, 0x00, 0x00,
+    0x07, 0x56, 0x03, 0x00, 0x5D, 0x00, 0x00, 0x00, 0x05, 0x64, 0x03, 0x00, 0x5E, 0x00, 0x00, 0x00,
+    0x06, 0x6E, 0x03, 0x00, 0x5F, 0x00, 0x00, 0x00, 0x09, 0x7A, 0x03, 0x00, 0x60, 0x00, 0x00, 0x00,
+    0x04, 0x8C, 0x03, 0x00, 0x61, 0x00, 0x00, 0x00, 0x08, 0x94, 0x03, 0x00, 0x62, 0x00, 0x00, 0x00,
+    0x08, 0xA4, 0x03, 0x00, 0x63, 0x00, 0x00, 0x00, 0x07, 0xB4, 0x03, 0x00, 0x64, 0x00, 0x00, 0x00,
+    0x08, 0xC2, 0x03, 0x00, 0x65, 0x00, 0x00, 0x00, 0x07, 0xD2, 0x03, 0x00, 0x66, 0x00, 0x00, 0x00,
+    0x08, 0xE0, 0x03, 0x00, 0x67, 0x00, 0x00, 0x00, 0x07, 0xF0, 0x03, 0x00, 0x68, 0x00, 0x00, 0x00,
+    0x09, 0xFE, 0x03, 0x00, 0x69, 0x00, 0x00, 0x00, 0x06, 0x10, 0x04, 0x00, 0x6A, 0x00, 0x00, 0x00,
+    0x06, 0x1C, 0x04, 0x00, 0x6B, 0x00, 0x00, 0x00, 0x08, 0x28, 0x04, 0x00, 0x6C, 0x00, 0x00, 0x00,
+    0x06, 0x38, 0x04, 0x00, 0x6D, 0x00, 0x00, 0x00, 0x09, 0x44, 0x04, 0x00, 0x6E, 0x00, 0x00, 0x00,
+    0x09, 0x56, 0x04, 0x00, 0x6F, 0x00, 0x00, 0x00, 0x07, 0x68, 0x04, 0x00, 0x70, 0x00, 0x00, 0x00,
+    0x08, 0x76, 0x04, 0x00, 0x71, 0x00, 0x00, 0x00, 0x08, 0x86, 0x04, 0x00, 0x72, 0x00, 0x00, 0x00,
+    0x08, 0x96, 0x04, 0x00, 0x73, 0x00, 0x00, 0x00, 0x07, 0xA6, 0x04, 0x00, 0x74, 0x00, 0x00, 0x00,
+    0x06, 0xB4, 0x04, 0x00, 0x75, 0x00, 0x00, 0x00, 0x09, 0xC0, 0x04, 0x00, 0x76, 0x00, 0x00, 0x00,
+    0x09, 0xD2, 0x04, 0x00, 0x77, 0x00, 0x00, 0x00, 0x09, 0xE4, 0x04, 0x00, 0x78, 0x00, 0x00, 0x00,
+    0x07, 0xF6, 0x04, 0x00, 0x79, 0x00, 0x00, 0x00, 0x09, 0x04, 0x05, 0x00, 0x7A, 0x00, 0x00, 0x00,
+    0x07, 0x16, 0x05, 0x00, 0x7B, 0x00, 0x00, 0x00, 0x05, 0x24, 0x05, 0x00, 0x7C, 0x00, 0x00, 0x00,
+    0x02, 0x2E, 0x05, 0x00, 0x7D, 0x00, 0x00, 0x00, 0x05, 0x32, 0x05, 0x00, 0x7E, 0x00, 0x00, 0x00,
+    0x08, 0x3C, 0x05, 0x00, 0x3F, 0x51, 0x00, 0x00, 0x10, 0x4C, 0x05, 0x00, 0xED, 0x56, 0x00, 0x00,
+    0x10, 0x6C, 0x05, 0x00, 0x89, 0x5B, 0x00, 0x00, 0x10, 0x8C, 0x05, 0x00, 0x0F, 0x5C, 0x00, 0x00,
+    0x10, 0xAC, 0x05, 0x00, 0x1A, 0x5C, 0x00, 0x00, 0x10, 0xCC, 0x05, 0x00, 0x7C, 0x5E, 0x00, 0x00,
+    0x10, 0xEC, 0x05, 0x00, 0x74, 0x66, 0x00, 0x00, 0x10, 0x0C, 0x06, 0x00, 0x77, 0x6D, 0x00, 0x00,
+    0x10, 0x2C, 0x06, 0x00, 0x7E, 0x6E, 0x00, 0x00, 0x10, 0x4C, 0x06, 0x00, 0x73, 0x7C, 0x00, 0x00,
+    0x10, 0x6C, 0x06, 0x00, 0x92, 0x7C, 0x00, 0x00, 0x10, 0x8C, 0x06, 0x00, 0x48, 0x96, 0x00, 0x00,
+    0x10, 0xAC, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x33,
+    0x30, 0x00, 0x10, 0x0C, 0x06, 0x10, 0x0C, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x40, 0xC0, 0x78, 0x40, 0xC0, 0x78, 0x40, 0x00, 0x04, 0x3F, 0x04, 0x04, 0x3F, 0x04, 0x04, 0x00,
+    0x70, 0x88, 0xFC, 0x08, 0x30, 0x00, 0x18, 0x20, 0xFF, 0x21, 0x1E, 0x00, 0xF0, 0x08, 0xF0, 0x00,
+    0xE0, 0x18, 0x00, 0x00, 0x00, 0x21, 0x1C, 0x03, 0x1E, 0x21, 0x1E, 0x00, 0x00, 0xF0, 0x08, 0x88,
+    0x70, 0x00, 0x00, 0x00, 0x00, 0x1E, 0x21, 0x23, 0x24, 0x19, 0x27, 0x21, 0x10, 0x00, 0x10, 0x16,
+    0x0E, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE0, 0x18, 0x04, 0x02, 0x00, 0x07, 0x18, 0x20, 0x40, 0x00,
+    0x02, 0x04, 0x18, 0xE0, 0x00, 0x40, 0x20, 0x18, 0x07, 0x00, 0x40, 0x40, 0x80, 0xF0, 0x80, 0x40,
+    0x40, 0x00, 0x02, 0x02, 0x01, 0x0F, 0x01, 0x02, 0x02, 0x00, 0x00, 0x00, 0x00, 0xF0, 0x00, 0x00,
+    0x00, 0x00, 0x01, 0x01, 0x01, 0x1F, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xB0,
+    0x70, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x00, 0x00, 0x00, 0x00, 0x80, 0x60, 0x18, 0x04, 0x00,
+    0x60, 0x18, 0x06, 0x01, 0x00, 0x00, 0x00, 0x00, 0xE0, 0x10, 0x08, 0x08, 0x10, 0xE0, 0x00, 0x0F,
+    0x10, 0x20, 0x20, 0x10, 0x0F, 0x00, 0x10, 0x10, 0xF8, 0x00, 0x00, 0x00, 0x20, 0x20, 0x3F, 0x20,
+    0x20, 0x00, 0x70, 0x08, 0x08, 0x08, 0x88, 0x70, 0x00, 0x30, 0x28, 0x24, 0x22, 0x21, 0x30, 0x00,
+    0x30, 0x08, 0x88, 0x88, 0x48, 0x30, 0x00, 0x18, 0x20, 0x20, 0x20, 0x11, 0x0E, 0x00, 0x00, 0xC0,
+    0x20, 0x10, 0xF8, 0x00, 0x00, 0x07, 0x04, 0x24, 0x24, 0x3F, 0x24, 0x00, 0xF8, 0x08, 0x88, 0x88,
+    0x08, 0x08, 0x00, 0x19, 0x21, 0x20, 0x20, 0x11, 0x0E, 0x00, 0xE0, 0x10, 0x88, 0x88, 0x18, 0x00,
+    0x00, 0x0F, 0x11, 0x20, 0x20, 0x11, 0x0E, 0x00, 0x38, 0x08, 0x08, 0xC8, 0x38, 0x08, 0x00, 0x00,
+    0x00, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x70, 0x88, 0x08, 0x08, 0x88, 0x70, 0x00, 0x1C, 0x22, 0x21,
+    0x21, 0x22, 0x1C, 0x00, 0xE0, 0x10, 0x08, 0x08, 0x10, 0xE0, 0x00, 0x00, 0x31, 0x22, 0x22, 0x11,
+    0x0F, 0x00, 0xC0, 0xC0, 0x00, 0x30, 0x30, 0x00, 0x00, 0x80, 0x00, 0x80, 0x60, 0x00, 0x00, 0x80,
+    0x40, 0x20, 0x10, 0x08, 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x00, 0x40, 0x40, 0x40, 0x40,
+    0x40, 0x40, 0x40, 0x00, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x08, 0x10, 0x20, 0x40,
+    0x80, 0x00, 0x00, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, 0x70, 0x48, 0x08, 0x08, 0x08, 0xF0,
+    0x00, 0x00, 0x00, 0x30, 0x36, 0x01, 0x00, 0x00, 0xC0, 0x30, 0xC8, 0x28, 0xE8, 0x10, 0xE0, 0x00,
+    0x07, 0x18, 0x27, 0x24, 0x23, 0x14, 0x0B, 0x00, 0x00, 0x00, 0xC0, 0x38, 0xE0, 0x00, 0x00, 0x00,
+    0x00, 0x20, 0x3C, 0x23, 0x02, 0x02, 0x27, 0x38, 0x20, 0x00, 0x08, 0xF8, 0x88, 0x88, 0x88, 0x70,
+    0x00, 0x00, 0x20, 0x3F, 0x20, 0x20, 0x20, 0x11, 0x0E, 0x00, 0xC0, 0x30, 0x08, 0x08, 0x08, 0x08,
+    0x38, 0x00, 0x07, 0x18, 0x20, 0x20, 0x20, 0x10, 0x08, 0x00, 0x08, 0xF8, 0x08, 0x08, 0x08, 0x10,
+    0xE0, 0x00, 0x20, 0x3F, 0x20, 0x20, 0x20, 0x10, 0x0F, 0x00, 0x08, 0xF8, 0x88, 0x88, 0xE8, 0x08,
+    0x10, 0x00, 0x20, 0x3F, 0x20, 0x20, 0x23, 0x20, 0x18, 0x00, 0x08, 0xF8, 0x88, 0x88, 0xE8, 0x08,
+    0x10, 0x00, 0x20, 0x3F, 0x20, 0x00, 0x03, 0x00, 0x00, 0x00, 0xC0, 0x30, 0x08, 0x08, 0x08, 0x38,
+    0x00, 0x00, 0x07, 0x18, 0x20, 0x20, 0x22, 0x1E, 0x02, 0x00, 0x08, 0xF8, 0x08, 0x00, 0x00, 0x08,
+    0xF8, 0x08, 0x00, 0x20, 0x3F, 0x21, 0x01, 0x01, 0x21, 0x3F, 0x20, 0x00, 0x08, 0x08, 0xF8, 0x08,
+    0x08, 0x00, 0x20, 0x20, 0x3F, 0x20, 0x20, 0x00, 0x00, 0x00, 0x08, 0x08, 0xF8, 0x08, 0x08, 0x00,
+    0xC0, 0x80, 0x80, 0x80, 0x7F, 0x00, 0x00, 0x00, 0x08, 0xF8, 0x88, 0xC0, 0x28, 0x18, 0x08, 0x00,
+    0x20, 0x3F, 0x20, 0x01, 0x26, 0x38, 0x20, 0x00, 0x08, 0xF8, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x20, 0x3F, 0x20, 0x20, 0x20, 0x20, 0x30, 0x00, 0x08, 0xF8, 0xF8, 0x00, 0xF8, 0xF8, 0x08, 0x00,
+    0x20, 0x3F, 0x00, 0x3F, 0x00, 0x3F, 0x20, 0x00, 0x08, 0xF8, 0x30, 0xC0, 0x00, 0x08, 0xF8, 0x08,
+    0x00, 0x20, 0x3F, 0x20, 0x00, 0x07, 0x18, 0x3F, 0x00, 0x00, 0xE0, 0x10, 0x08, 0x08, 0x08, 0x10,
+    0xE0, 0x00, 0x0F, 0x10, 0x20, 0x20, 0x20, 0x10, 0x0F, 0x00, 0x08, 0xF8, 0x08, 0x08, 0x08, 0x08,
+    0xF0, 0x00, 0x20, 0x3F, 0x21, 0x01, 0x01, 0x01, 0x00, 0x00, 0xE0, 0x10, 0x08, 0x08, 0x08, 0x10,
+    0xE0, 0x00, 0x0F, 0x18, 0x24, 0x24, 0x38, 0x50, 0x4F, 0x00, 0x08, 0xF8, 0x88, 0x88, 0x88, 0x88,
+    0x70, 0x00, 0x00, 0x20, 0x3F, 0x20, 0x00, 0x03, 0x0C, 0x30, 0x20, 0x00, 0x70, 0x88, 0x08, 0x08,
+    0x08, 0x38, 0x00, 0x38, 0x20, 0x21, 0x21, 0x22, 0x1C, 0x00, 0x18, 0x08, 0x08, 0xF8, 0x08, 0x08,
+    0x18, 0x00, 0x00, 0x00, 0x20, 0x3F, 0x20, 0x00, 0x00, 0x00, 0x08, 0xF8, 0x08, 0x00, 0x00, 0x08,
+    0xF8, 0x08, 0x00, 0x00, 0x1F, 0x20, 0x20, 0x20, 0x20, 0x1F, 0x00, 0x00, 0x08, 0x78, 0x88, 0x00,
+    0x00, 0xC8, 0x38, 0x08, 0x00, 0x00, 0x00, 0x07, 0x38, 0x0E, 0x01, 0x00, 0x00, 0x00, 0xF8, 0x08,
+    0x00, 0xF8, 0x00, 0x08, 0xF8, 0x00, 0x03, 0x3C, 0x07, 0x00, 0x07, 0x3C, 0x03, 0x00, 0x08, 0x18,
+    0x68, 0x80, 0x80, 0x68, 0x18, 0x08, 0x00, 0x20, 0x30, 0x2C, 0x03, 0x03, 0x2C, 0x30, 0x20, 0x00,
+    0x08, 0x38, 0xC8, 0x00, 0xC8, 0x38, 0x08, 0x00, 0x00, 0x00, 0x20, 0x3F, 0x20, 0x00, 0x00, 0x00,
+    0x10, 0x08, 0x08, 0x08, 0xC8, 0x38, 0x08, 0x00, 0x20, 0x38, 0x26, 0x21, 0x20, 0x20, 0x18, 0x00,
+    0xFE, 0x02, 0x02, 0x02, 0x00, 0x7F, 0x40, 0x40, 0x40, 0x00, 0x0C, 0x30, 0xC0, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x01, 0x06, 0x38, 0xC0, 0x00, 0x02, 0x02, 0x02, 0xFE, 0x00, 0x40, 0x40, 0x40,
+    0x7F, 0x00, 0x04, 0x02, 0x02, 0x02, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00,
+    0x02, 0x02, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00,
+    0x19, 0x24, 0x22, 0x22, 0x22, 0x3F, 0x20, 0x00, 0x08, 0xF8, 0x00, 0x80, 0x80, 0x00, 0x00, 0x00,
+    0x00, 0x3F, 0x11, 0x20, 0x20, 0x11, 0x0E, 0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x00, 0x00, 0x0E,
+    0x11, 0x20, 0x20, 0x20, 0x11, 0x00, 0x00, 0x00, 0x80, 0x80, 0x88, 0xF8, 0x00, 0x00, 0x0E, 0x11,
+    0x20, 0x20, 0x10, 0x3F, 0x20, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x1F, 0x22, 0x22,
+    0x22, 0x22, 0x13, 0x00, 0x80, 0x80, 0xF0, 0x88, 0x88, 0x88, 0x18, 0x00, 0x20, 0x20, 0x3F, 0x20,
+    0x20, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x6B, 0x94, 0x94, 0x94, 0x93,
+    0x60, 0x00, 0x08, 0xF8, 0x00, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x20, 0x3F, 0x21, 0x00, 0x00,
+    0x20, 0x3F, 0x20, 0x00, 0x80, 0x98, 0x98, 0x00, 0x00, 0x00, 0x20, 0x20, 0x3F, 0x20, 0x20, 0x00,
+    0x00, 0x00, 0x80, 0x98, 0x98, 0x00, 0xC0, 0x80, 0x80, 0x80, 0x7F, 0x00, 0x08, 0xF8, 0x00, 0x00,
+    0x80, 0x80, 0x80, 0x00, 0x20, 0x3F, 0x24, 0x02, 0x2D, 0x30, 0x20, 0x00, 0x08, 0x08, 0xF8, 0x00,
+    0x00, 0x00, 0x20, 0x20, 0x3F, 0x20, 0x20, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00,
+    0x00, 0x20, 0x3F, 0x20, 0x00, 0x3F, 0x20, 0x00, 0x3F, 0x00, 0x80, 0x80, 0x00, 0x80, 0x80, 0x80,
+    0x00, 0x00, 0x00, 0x20, 0x3F, 0x21, 0x00, 0x00, 0x20, 0x3F, 0x20, 0x00, 0x00, 0x80, 0x80, 0x80,
+    0x80, 0x00, 0x00, 0x1F, 0x20, 0x20, 0x20, 0x20, 0x1F, 0x00, 0x80, 0x80, 0x00, 0x80, 0x80, 0x00,
+    0x00, 0x00, 0x80, 0xFF, 0xA1, 0x20, 0x20, 0x11, 0x0E, 0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80,
+    0x00, 0x00, 0x0E, 0x11, 0x20, 0x20, 0xA0, 0xFF, 0x80, 0x00, 0x80, 0x80, 0x80, 0x00, 0x80, 0x80,
+    0x80, 0x00, 0x20, 0x20, 0x3F, 0x21, 0x20, 0x00, 0x01, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x00, 0x33, 0x24, 0x24, 0x24, 0x24, 0x19, 0x00, 0x80, 0x80, 0xE0, 0x80, 0x80, 0x00, 0x00, 0x00,
+    0x1F, 0x20, 0x20, 0x00, 0x80, 0x80, 0x00, 0x00, 0x00, 0x80, 0x80, 0x00, 0x00, 0x00, 0x1F, 0x20,
+    0x20, 0x20, 0x10, 0x3F, 0x20, 0x00, 0x80, 0x80, 0x80, 0x00, 0x00, 0x80, 0x80, 0x80, 0x00, 0x00,
+    0x01, 0x0E, 0x30, 0x08, 0x06, 0x01, 0x00, 0x00, 0x80, 0x80, 0x00, 0x80, 0x00, 0x80, 0x80, 0x80,
+    0x00, 0x0F, 0x30, 0x0C, 0x03, 0x0C, 0x30, 0x0F, 0x00, 0x00, 0x80, 0x80, 0x00, 0x80, 0x80, 0x80,
+    0x00, 0x20, 0x31, 0x2E, 0x0E, 0x31, 0x20, 0x00, 0x80, 0x80, 0x80, 0x00, 0x00, 0x80, 0x80, 0x80,
+    0x00, 0x80, 0x81, 0x8E, 0x70, 0x18, 0x06, 0x01, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x00, 0x21, 0x30, 0x2C, 0x22, 0x21, 0x30, 0x00, 0x80, 0x7C, 0x02, 0x02, 0x00, 0x00, 0x3F, 0x40,
+    0x40, 0x00, 0xFF, 0x00, 0xFF, 0x00, 0x02, 0x02, 0x7C, 0x80, 0x00, 0x40, 0x40, 0x3F, 0x00, 0x00,
+    0x06, 0x01, 0x01, 0x02, 0x02, 0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x80, 0x40, 0x20, 0x18, 0x07, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x40, 0x40, 0x40, 0x40, 0x78, 0x00,
+    0x00, 0xFE, 0x02, 0x42, 0x4A, 0xCA, 0x4A, 0x4A, 0xCA, 0x4A, 0x4A, 0x42, 0x02, 0xFE, 0x00, 0x00,
+    0x00, 0xFF, 0x40, 0x50, 0x4C, 0x43, 0x40, 0x40, 0x4F, 0x50, 0x50, 0x5C, 0x40, 0xFF, 0x00, 0x00,
+    0x80, 0x90, 0x8C, 0x84, 0x84, 0x84, 0xF5, 0x86, 0x84, 0x84, 0x84, 0x84, 0x94, 0x8C, 0x80, 0x00,
+    0x00, 0x80, 0x80, 0x84, 0x46, 0x49, 0x28, 0x10, 0x10, 0x2C, 0x23, 0x40, 0x80, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0xE0, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x20, 0x40, 0x80, 0x00, 0x00,
+    0x08, 0x04, 0x03, 0x00, 0x00, 0x40, 0x80, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x0E, 0x00,
+    0x00, 0x00, 0xE2, 0x24, 0x28, 0x20, 0x20, 0x3F, 0x20, 0x20, 0x28, 0x24, 0xE2, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0xFF, 0x00, 0x00, 0x1F, 0x11, 0x11, 0x11, 0x1F, 0x40, 0x80, 0x7F, 0x00, 0x00, 0x00,
+    0x40, 0x70, 0x4C, 0x43, 0xC0, 0x30, 0x00, 0x10, 0x10, 0xFF, 0x10, 0x10, 0x10, 0xF0, 0x00, 0x00,
+    0x10, 0x38, 0x14, 0x13, 0x14, 0xB8, 0x40, 0x30, 0x0E, 0x01, 0x40, 0x80, 0x40, 0x3F, 0x00, 0x00,
+    0x00, 0xFC, 0x84, 0x84, 0xFC, 0x00, 0x44, 0x54, 0x54, 0x54, 0x7F, 0x54, 0x54, 0x54, 0x44, 0x00,
+    0x00, 0x3F, 0x10, 0x10, 0x3F, 0x00, 0x00, 0xFF, 0x15, 0x15, 0x15, 0x55, 0x95, 0x7F, 0x00, 0x00,
+    0x10, 0x60, 0x02, 0x0C, 0xC0, 0x10, 0x08, 0xF7, 0x14, 0x54, 0x94, 0x14, 0xF4, 0x04, 0x00, 0x00,
+    0x04, 0x04, 0x7C, 0x03, 0x00, 0x01, 0x1D, 0x13, 0x11, 0x55, 0x99, 0x51, 0x3F, 0x11, 0x01, 0x00,
+    0x10, 0x60, 0x02, 0x8C, 0x24, 0x94, 0x84, 0xBD, 0x86, 0x84, 0xBC, 0x84, 0x14, 0x24, 0x00, 0x00,
+    0x04, 0x04, 0x7E, 0x01, 0x00, 0x0E, 0x0A, 0x0A, 0x0A, 0x4A, 0x8A, 0x4B, 0x38, 0x00, 0x00, 0x00,
+    0x00, 0x40, 0x42, 0x44, 0x58, 0x40, 0xC0, 0xFF, 0xC0, 0x40, 0x50, 0x48, 0x46, 0x40, 0x00, 0x00,
+    0x20, 0x20, 0x10, 0x08, 0x04, 0x03, 0x00, 0xFF, 0x00, 0x03, 0x04, 0x08, 0x10, 0x20, 0x20, 0x00,
+    0x40, 0x44, 0x58, 0xC0, 0xFF, 0x50, 0x4C, 0x10, 0x90, 0x10, 0x11, 0x16, 0x10, 0xD0, 0x10, 0x00,
+    0x10, 0x08, 0x06, 0x01, 0xFF, 0x01, 0x06, 0x40, 0x41, 0x5E, 0x40, 0x70, 0x4E, 0x41, 0x40, 0x00,
+    0x00, 0xFE, 0x22, 0x5A, 0x86, 0x08, 0x88, 0x68, 0x18, 0x0F, 0xE8, 0x08, 0x08, 0x08, 0x08, 0x00,
+    0x00, 0xFF, 0x04, 0x08, 0x07, 0x20, 0x11, 0x0D, 0x41, 0x81, 0x7F, 0x01, 0x05, 0x09, 0x30, 0x00,
+};
+const uint32_t oled_font16_size = sizeof(oled_font16);
@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ssd1306.h"
+#include "ssd1306_io_interface.h"
+
+// a GDDRAM model, commands move the address pointer the same way the panel does
+typedef struct {
+    ssd1306_io_t base;
+    uint8_t ram[128 * 8];
+    uint8_t mode;        // 0 - horizontal, 1 - vertical, 2 - page addressing
+    uint8_t col;
+    uint8_t page;
+    uint8_t col_start;
+    uint8_t col_end;
+    uint8_t page_start;
+    uint8_t page_end;
+    uint8_t start_line;  // ram row shown at the top
+    uint8_t scrolling;   // data writes are refused like the panel would garble them
+    uint8_t cmd[8];      // command waiting for its parameters
+    uint8_t cmd_len;
+    uint8_t cmd_need;
+    uint32_t tx_cnt;
+    uint32_t byte_cnt;
+} ssd1306_host_io_t;
+
+// parameter bytes after the command byte
+static uint8_t ssd1306_host_cmd_params(uint8_t cmd)
+{
+    switch (cmd) {
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        return 1;
+    case 0x21: case 0x22: case 0xA3:
+        return 2;
+    case 0x29: case 0x2A:
+        return 5;
+    case 0x26: case 0x27:
+        return 6;
+    default:
+        return 0;
+    }
+}
+
+static void ssd1306_host_run_cmd(ssd1306_host_io_t *host, const uint8_t *cmd)
+{
+    if (cmd[0] >= 0xB0 && cmd[0] <= 0xB7) {
+        host->page = cmd[0] & 0x07;
+    } else if (cmd[0] <= 0x0F) {
+        host->col = (host->col & 0xF0) | cmd[0];
+    } else if (cmd[0] >= 0x10 && cmd[0] <= 0x17) {
+        host->col = (host->col & 0x0F) | ((cmd[0] & 0x07) << 4);
+    } else if (cmd[0] >= 0x40 && cmd[0] <= 0x7F) {
+        host->start_line = cmd[0] & 0x3F;
+    } else if (0x2E == cmd[0] || 0x2F == cmd[0]) {
+        host->scrolling = cmd[0] & 0x01;
+    } else if (0x20 == cmd[0]) {
+        host->mode = cmd[1] & 0x03;
+    } else if (0x21 == cmd[0]) {
+        host->col_start = cmd[1] & 0x7F;
+        host->col_end = cmd[2] & 0x7F;
+        host->col = host->col_start;
+    } else if (0x22 == cmd[0]) {
+        host->page_start = cmd[1] & 0x07;
+        host->page_end = cmd[2] & 0x07;
+        host->page = host->page_start;
+    }
+}
+
+static void ssd1306_host_write_cmd(ssd1306_host_io_t *host, uint8_t value)
+{
+    host->cmd[host->cmd_len++] = value;
+    if (1 == host->cmd_len) {
+        host->cmd_need = ssd1306_host_cmd_params(value);
+    }
+    if (host->cmd_len > host->cmd_need) {
+        ssd1306_host_run_cmd(host, host->cmd);
+        host->cmd_len = 0;
+    }
+}
+
+static void ssd1306_host_write_data(ssd1306_host_io_t *host, uint8_t value)
+{
+    host->ram[host->page * 128 + host->col] = value;
+
+    if (2 == host->mode) { // page addressing, the column wraps inside the page
+        host->col = (host->col + 1) & 0x7F;
+    } else if (0 == host->mode) {
+        if (host->col++ >= host->col_end) {
+            host->col = host->col_start;
+            host->page = host->page >= host->page_end ? host->page_start : host->page + 1;
+        }
+    } else {
+        if (host->page++ >= host->page_end) {
+            host->page = host->page_start;
+            host->col = host->col >= host->col_end ? host->col_start : host->col + 1;
+        }
+    }
+}
+
+static esp_err_t ssd1306_host_tx(ssd1306_io_t *io, const uint8_t *cmds, uint32_t cmd_len, const uint8_t *data, uint32_t data_len)
+{
+    ssd1306_host_io_t *host = __containerof(io, ssd1306_host_io_t, base);
+    uint32_t i = 0;
+
+    for (i = 0; i < cmd_len; i++) {
+        ssd1306_host_write_cmd(host, cmds[i]);
+    }
+    if (host->scrolling && data && data_len) {
+        return ESP_ERR_INVALID_STATE; // the panel moves the ram while scrolling, writes get corrupted
+    }
+    for (i = 0; data && i < data_len; i++) {
+        ssd1306_host_write_data(host, data[i]);
+    }
+    host->tx_cnt++;
+    host->byte_cnt += cmd_len + (data ? data_len : 0);
+    return ESP_OK;
+}
+
+static esp_err_t ssd1306_host_wait(ssd1306_io_t *io)
+{
+    return ESP_OK;
+}
+
+static esp_err_t ssd1306_host_del(ssd1306_io_t *io)
+{
+    free(__containerof(io, ssd1306_host_io_t, base));
+    return ESP_OK;
+}
+
+esp_err_t ssd1306_new_host_io(ssd1306_io_handle_t *ret_io)
+{
+    ssd1306_host_io_t *host = calloc(1, sizeof(ssd1306_host_io_t));
+
+    if (!host) {
+        return ESP_ERR_NO_MEM;
+    }
+    host->mode = 2; // reset values of the panel
+    host->col_end = 127;
+    host->page_end = 7;
+    host->base.tx = ssd1306_host_tx;
+    host->base.wait = ssd1306_host_wait;
+    host->base.del = ssd1306_host_del;
+
+    *ret_io = &host->base;
+    return ESP_OK;
+}
+
+const uint8_t *ssd1306_host_get_ram(ssd1306_io_handle_t io)
+{
+    return __containerof(io, ssd1306_host_io_t, base)->ram;
+}
+
+void ssd1306_host_get_stats(ssd1306_io_handle_t io, uint32_t *tx_cnt, uint32_t *byte_cnt)
+{
+    ssd1306_host_io_t *host = __containerof(io, ssd1306_host_io_t, base);
+
+    *tx_cnt = host->tx_cnt;
+    *byte_cnt = host->byte_cnt;
+}
+
+esp_err_t ssd1306_host_save_pgm(ssd1306_io_handle_t io, const char *path)
+{
+    ssd1306_host_io_t *host = __containerof(io, ssd1306_host_io_t, base);
+    uint8_t line[128] = {0};
+    uint32_t x = 0, y = 0, row = 0;
+    FILE *fp = fopen(path, "wb");
+
+    if (!fp) {
+        return ESP_FAIL;
+    }
+    fprintf(fp, "P5\n128 64\n255\n");
+    for (y = 0; y < 64; y++) {
+        row = (y + host->start_line) & 0x3F; // as shown on the screen
+        for (x = 0; x < 128; x++) { // bit0 of a GDDRAM byte is the top row of its page
+            line[x] = (host->ram[(row / 8) * 128 + x] >> (row % 8)) & 0x01 ? 255 : 0;
+        }
+        fwrite(line, 1, sizeof(line), fp);
+    }
+    fclose(fp);
+    return ESP_OK;
+}
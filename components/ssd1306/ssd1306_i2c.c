@@ -0,0 +1,95 @@
+#include <stdlib.h>
+#include "driver/i2c.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "ssd1306.h"
+#include "ssd1306_io_interface.h"
+
+typedef struct {
+    ssd1306_io_t base;
+    int port;
+    uint8_t dev_addr;
+} ssd1306_i2c_io_t;
+
+const static char *TAG = "ssd1306_i2c";
+
+// with data, every command goes with 0x80 (one command follows), then 0x40 streams the data to the end of the transaction
+// without data, every byte after the 0x00 control byte is a command
+static esp_err_t ssd1306_i2c_tx(ssd1306_io_t *io, const uint8_t *cmds, uint32_t cmd_len, const uint8_t *data, uint32_t data_len)
+{
+    ssd1306_i2c_io_t *i2c_io = __containerof(io, ssd1306_i2c_io_t, base);
+    esp_err_t ret = ESP_OK;
+    uint32_t i = 0;
+
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (i2c_io->dev_addr << 1) | I2C_MASTER_WRITE, true);
+    if (data && data_len) {
+        for (i = 0; i < cmd_len; i++) {
+            i2c_master_write_byte(cmd, 0x80, true);
+            i2c_master_write_byte(cmd, cmds[i], true);
+        }
+        i2c_master_write_byte(cmd, 0x40, true);
+        i2c_master_write(cmd, data, data_len, true);
+    } else {
+        i2c_master_write_byte(cmd, 0x00, true);
+        i2c_master_write(cmd, cmds, cmd_len, true);
+    }
+    i2c_master_stop(cmd);
+    ret = i2c_master_cmd_begin(i2c_io->port, cmd, 1000 / portTICK_PERIOD_MS);
+    i2c_cmd_link_delete(cmd);
+    if (ESP_OK != ret) {
+        ESP_LOGE(TAG, "i2c write error:%d", ret);
+    }
+    return ret;
+}
+
+// every tx blocks until the transaction is done
+static esp_err_t ssd1306_i2c_wait(ssd1306_io_t *io)
+{
+    return ESP_OK;
+}
+
+static esp_err_t ssd1306_i2c_del(ssd1306_io_t *io)
+{
+    ssd1306_i2c_io_t *i2c_io = __containerof(io, ssd1306_i2c_io_t, base);
+
+    i2c_driver_delete(i2c_io->port);
+    free(i2c_io);
+    return ESP_OK;
+}
+
+esp_err_t ssd1306_new_i2c_io(const ssd1306_i2c_config_t *config, ssd1306_io_handle_t *ret_io)
+{
+    esp_err_t ret = ESP_OK;
+    ssd1306_i2c_io_t *i2c_io = NULL;
+    i2c_config_t conf = {
+        .mode = I2C_MODE_MASTER,
+        .sda_io_num = config->pin_sda,
+        .scl_io_num = config->pin_scl,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .master.clk_speed = config->clock_hz,
+    };
+
+    i2c_io = calloc(1, sizeof(ssd1306_i2c_io_t));
+    if (!i2c_io) {
+        return ESP_ERR_NO_MEM;
+    }
+    i2c_io->port = config->port;
+    i2c_io->dev_addr = config->dev_addr;
+    i2c_io->base.tx = ssd1306_i2c_tx;
+    i2c_io->base.wait = ssd1306_i2c_wait;
+    i2c_io->base.del = ssd1306_i2c_del;
+
+    i2c_param_config(config->port, &conf);
+    ret = i2c_driver_install(config->port, conf.mode, 0, 0, 0);
+    if (ESP_OK != ret) {
+        ESP_LOGE(TAG, "i2c bus init error");
+        free(i2c_io);
+        return ret;
+    }
+
+    *ret_io = &i2c_io->base;
+    return ESP_OK;
+}
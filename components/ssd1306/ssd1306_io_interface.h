@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifndef __containerof
+#define __containerof(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
+#endif
+
+typedef struct ssd1306_io_t ssd1306_io_t;
+
+// transport "class", every bus implements it, the drawing code only talks to the panel through it
+struct ssd1306_io_t {
+    // send cmd_len commands, then data_len bytes of GDDRAM data if data is not NULL
+    // may return before the bytes are on the wire, cmds and data must stay untouched until wait
+    esp_err_t (*tx)(ssd1306_io_t *io, const uint8_t *cmds, uint32_t cmd_len, const uint8_t *data, uint32_t data_len);
+    // block until every tx is done
+    esp_err_t (*wait)(ssd1306_io_t *io);
+    esp_err_t (*del)(ssd1306_io_t *io);
+};
@@ -0,0 +1,177 @@
+#include <stdlib.h>
+#include <string.h>
+#include "driver/spi_master.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "ssd1306.h"
+#include "ssd1306_io_interface.h"
+
+#define SSD1306_SPI_QUEUE_SIZE      16 // address command and data of every page
+
+typedef struct {
+    spi_transaction_t base;
+    int pin_dc;
+    uint32_t dc_level; // 0 - command, 1 - data
+} ssd1306_spi_trans_t;
+
+typedef struct {
+    ssd1306_io_t base;
+    spi_device_handle_t spi;
+    int host;
+    int pin_dc;
+    uint32_t queued; // transactions waiting for their result
+    ssd1306_spi_trans_t trans[SSD1306_SPI_QUEUE_SIZE];
+} ssd1306_spi_io_t;
+
+const static char *TAG = "ssd1306_spi";
+
+// D/C level is carried by the transaction, so commands and data can sit in one queue
+static void IRAM_ATTR ssd1306_spi_pre_transfer_cb(spi_transaction_t *t)
+{
+    ssd1306_spi_trans_t *trans = __containerof(t, ssd1306_spi_trans_t, base);
+    gpio_set_level(trans->pin_dc, trans->dc_level);
+}
+
+static esp_err_t ssd1306_spi_wait(ssd1306_io_t *io)
+{
+    ssd1306_spi_io_t *spi_io = __containerof(io, ssd1306_spi_io_t, base);
+    spi_transaction_t *t = NULL;
+    esp_err_t ret = ESP_OK;
+
+    for (; spi_io->queued > 0; spi_io->queued--) {
+        if (ESP_OK != spi_device_get_trans_result(spi_io->spi, &t, portMAX_DELAY)) {
+            ret = ESP_FAIL;
+        }
+    }
+    return ret;
+}
+
+static esp_err_t ssd1306_spi_queue(ssd1306_spi_io_t *spi_io, const uint8_t *buf, uint32_t len, uint32_t dc_level)
+{
+    ssd1306_spi_trans_t *trans = &spi_io->trans[spi_io->queued];
+    esp_err_t ret = ESP_OK;
+
+    memset(trans, 0, sizeof(ssd1306_spi_trans_t));
+    trans->pin_dc = spi_io->pin_dc;
+    trans->dc_level = dc_level;
+    trans->base.length = len * 8;
+    if (len <= sizeof(trans->base.tx_data)) { // short command sequences are copied, no need to keep them
+        trans->base.flags = SPI_TRANS_USE_TXDATA;
+        memcpy(trans->base.tx_data, buf, len);
+    } else {
+        trans->base.tx_buffer = buf; // DMA reads it directly
+    }
+
+    ret = spi_device_queue_trans(spi_io->spi, &trans->base, portMAX_DELAY);
+    if (ESP_OK != ret) {
+        ESP_LOGE(TAG, "spi queue trans error:%d", ret);
+        return ret;
+    }
+    spi_io->queued++;
+    return ESP_OK;
+}
+
+static esp_err_t ssd1306_spi_tx(ssd1306_io_t *io, const uint8_t *cmds, uint32_t cmd_len, const uint8_t *data, uint32_t data_len)
+{
+    ssd1306_spi_io_t *spi_io = __containerof(io, ssd1306_spi_io_t, base);
+    esp_err_t ret = ESP_OK;
+
+    if (spi_io->queued + 2 > SSD1306_SPI_QUEUE_SIZE) { // the descriptors are reused only after every result is back
+        ssd1306_spi_wait(io);
+    }
+    if (cmd_len) {
+        ret = ssd1306_spi_queue(spi_io, cmds, cmd_len, 0);
+    }
+    if (ESP_OK == ret && data && data_len) {
+        ret = ssd1306_spi_queue(spi_io, data, data_len, 1);
+    }
+    return ret;
+}
+
+static esp_err_t ssd1306_spi_del(ssd1306_io_t *io)
+{
+    ssd1306_spi_io_t *spi_io = __containerof(io, ssd1306_spi_io_t, base);
+
+    ssd1306_spi_wait(io);
+    spi_bus_remove_device(spi_io->spi);
+    spi_bus_free(spi_io->host);
+    free(spi_io);
+    return ESP_OK;
+}
+
+esp_err_t ssd1306_new_spi_io(const ssd1306_spi_config_t *config, ssd1306_io_handle_t *ret_io)
+{
+    esp_err_t ret = ESP_OK;
+    ssd1306_spi_io_t *spi_io = NULL;
+    gpio_config_t io_conf = {
+        .intr_type = GPIO_INTR_DISABLE,
+        .mode = GPIO_MODE_OUTPUT,
+        .pin_bit_mask = 1ULL << config->pin_dc,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+    };
+    spi_bus_config_t bus_conf = {
+        .miso_io_num = -1,
+        .mosi_io_num = config->pin_mosi,
+        .sclk_io_num = config->pin_clk,
+        .quadhd_io_num = -1,
+        .quadwp_io_num = -1,
+        .max_transfer_sz = 128 * 8,
+    };
+    spi_device_interface_config_t dev_conf = {
+        .clock_speed_hz = config->clock_hz,
+        .mode = 0,
+        .spics_io_num = config->pin_cs,
+        .queue_size = SSD1306_SPI_QUEUE_SIZE,
+        .pre_cb = ssd1306_spi_pre_transfer_cb,
+    };
+
+    spi_io = calloc(1, sizeof(ssd1306_spi_io_t));
+    if (!spi_io) {
+        return ESP_ERR_NO_MEM;
+    }
+    spi_io->host = config->host;
+    spi_io->pin_dc = config->pin_dc;
+    spi_io->base.tx = ssd1306_spi_tx;
+    spi_io->base.wait = ssd1306_spi_wait;
+    spi_io->base.del = ssd1306_spi_del;
+
+    if (config->pin_rst >= 0) {
+        io_conf.pin_bit_mask |= 1ULL << config->pin_rst;
+        gpio_set_level(config->pin_rst, 1); // latched before the pin turns to output, no reset unless asked for
+    }
+    ret = gpio_config(&io_conf);
+    if (ESP_OK != ret) {
+        ESP_LOGE(TAG, "gpio conf error");
+        goto exit;
+    }
+
+    if (config->pin_rst >= 0 && !oled_panel_kept()) {
+        gpio_set_level(config->pin_rst, 0);
+        esp_rom_delay_us(10); // RES# low 3us at least
+        gpio_set_level(config->pin_rst, 1);
+        esp_rom_delay_us(10);
+    }
+
+    ret = spi_bus_initialize(config->host, &bus_conf, SPI_DMA_CH_AUTO);
+    if (ESP_OK != ret) {
+        ESP_LOGE(TAG, "spi bus init error");
+        goto exit;
+    }
+
+    ret = spi_bus_add_device(config->host, &dev_conf, &spi_io->spi);
+    if (ESP_OK != ret) {
+        ESP_LOGE(TAG, "spi bus add dev error");
+        spi_bus_free(config->host);
+        goto exit;
+    }
+
+    *ret_io = &spi_io->base;
+    return ESP_OK;
+
+exit:
+    free(spi_io);
+    return ret;
+}
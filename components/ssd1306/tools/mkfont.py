@@ -0,0 +1,108 @@
+#!/usr/bin/python3
+# convert a BDF bitmap font to the ssd1306 font format, see ssd1306_font.h
+# python3 mkfont.py font.bdf font.bin [--chars chars.txt]
+# python3 mkfont.py font.bdf font.c --c-array oled_font_xxx [--chars chars.txt]
+# flash font.bin to a data partition and open it with oled_font_load_partition()
+import struct
+import sys
+
+MAGIC = b'OFNT'
+VERSION = 1
+
+
+def parse_bdf(path, wanted=None):
+    glyphs = {}
+    ascent = descent = 0
+    lines = open(path, encoding='latin-1').read().splitlines()
+    i = 0
+    while i < len(lines):
+        words = lines[i].split()
+        if not words:
+            i += 1
+            continue
+        if words[0] == 'FONT_ASCENT':
+            ascent = int(words[1])
+        elif words[0] == 'FONT_DESCENT':
+            descent = int(words[1])
+        elif words[0] == 'STARTCHAR':
+            cp, dwidth, bbx, rows = -1, 0, (0, 0, 0, 0), []
+            i += 1
+            while not lines[i].startswith('ENDCHAR'):
+                words = lines[i].split()
+                if words[0] == 'ENCODING':
+                    cp = int(words[1])
+                elif words[0] == 'DWIDTH':
+                    dwidth = int(words[1])
+                elif words[0] == 'BBX':
+                    bbx = tuple(int(w) for w in words[1:5])
+                elif words[0] == 'BITMAP':
+                    i += 1
+                    while not lines[i].startswith('ENDCHAR'):
+                        rows.append(int(lines[i], 16) >> (len(lines[i]) * 4 - bbx[0]))
+                        i += 1
+                    break
+                i += 1
+            if cp >= 0 and (wanted is None or cp in wanted):
+                glyphs[cp] = (dwidth, bbx, rows)
+        i += 1
+    return glyphs, ascent, descent
+
+
+# bdf rows to column bytes, page by page, bit0 is the top row of a page
+def render(glyph, ascent, pages):
+    dwidth, (w, h, xoff, yoff), rows = glyph
+    width = max(dwidth, w + xoff, 1)
+    cols = bytearray(width * pages)
+    for r, bits in enumerate(rows):
+        y = ascent - yoff - h + r
+        if y < 0 or y >= pages * 8:
+            continue
+        for c in range(w):
+            if bits & (1 << (w - 1 - c)) and 0 <= c + xoff < width:
+                cols[(y // 8) * width + c + xoff] |= 1 << (y % 8)
+    return width, bytes(cols)
+
+
+# glyphs - {codepoint: (width, bytes)}, each bitmap is width * pages bytes
+def pack(glyphs, pages):
+    index = b''
+    bitmap = b''
+    for cp in sorted(glyphs):
+        width, cols = glyphs[cp]
+        if width > 255 or len(cols) != width * pages:
+            raise ValueError('bad glyph U+%04X' % cp)
+        index += struct.pack('<II', cp, (len(bitmap) << 8) | width)
+        bitmap += cols
+    return MAGIC + struct.pack('<BBHI', VERSION, pages, 0, len(glyphs)) + index + bitmap
+
+
+def to_c_array(data, name, comment):
+    out = '// %s\n' % comment
+    out += '#include <stdint.h>\n\n'
+    out += '__attribute__((aligned(4))) const uint8_t %s[] = {\n' % name
+    for i in range(0, len(data), 16):
+        out += '    ' + ' '.join('0x%02X,' % b for b in data[i:i + 16]) + '\n'
+    out += '};\n'
+    out += 'const uint32_t %s_size = sizeof(%s);\n' % (name, name)
+    return out
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 3:
+        print('usage: mkfont.py font.bdf out.bin|out.c [--c-array name] [--chars chars.txt]')
+        sys.exit(1)
+    args = sys.argv[3:]
+    c_name = args[args.index('--c-array') + 1] if '--c-array' in args else None
+    wanted = None
+    if '--chars' in args:
+        wanted = set(ord(ch) for ch in open(args[args.index('--chars') + 1], encoding='utf-8').read() if ch >= ' ')
+    bdf, ascent, descent = parse_bdf(sys.argv[1], wanted)
+    pages = (ascent + descent + 7) // 8
+    data = pack({cp: render(g, ascent, pages) for cp, g in bdf.items()}, pages)
+    if c_name:
+        with open(sys.argv[2], 'w') as f:
+            f.write(to_c_array(data, c_name, 'generated by tools/mkfont.py from ' + sys.argv[1].split('/')[-1]))
+    else:
+        with open(sys.argv[2], 'wb') as f:
+            f.write(data)
+    print('%d glyphs, %d pages high, %d bytes' % (len(bdf), pages, len(data)))
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include "esp_timer.h"
+
+// a failed check is printed and counted, the test goes on so one run shows every difference
+static int s_test_failures = 0;
+
+#define TEST_CHECK(cond, format, ...) do { \
+        if (!(cond)) { \
+            s_test_failures++; \
+            printf("FAIL %s:%d %s, " format "\n", __FILE__, __LINE__, #cond, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+// exit code of the test, 0 - every check passed
+static inline int test_result(const char *name)
+{
+    printf("%s: %s, %d failed checks\n", name, s_test_failures ? "FAILED" : "OK", s_test_failures);
+    return s_test_failures ? 1 : 0;
+}
+
+// count operations done since start, per second
+static inline void bench_report(const char *name, uint32_t count, int64_t start)
+{
+    int64_t cost = esp_timer_get_time() - start;
+
+    printf("bench %-24s %10lld /s  %8.3f us each\n", name, count * 1000000LL / (cost ? cost : 1), (double)cost / count);
+}
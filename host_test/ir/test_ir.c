@@ -0,0 +1,418 @@
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/rmt_rx.h"
+#include "driver/rmt_tx.h"
+#include "soc/soc_caps.h"
+#include "esp_idf_version.h"
+#include "nvs.h"
+#include "ir.h"
+#include "ir_db.h"
+#include "ir_raw_encoder.h"
+#include "host_test.h"
+
+#define NEC_SYMBOLS         34
+#define AC_SYMBOLS          200     // an air conditioner frame, over the 64 symbols of the rx buffer
+#define LONG_SYMBOLS        400     // more than IR_RAW_MAX packs without a run, in fewer chunks than the rx queue holds
+#define LEARN_RACE_CNT      200
+#define RX_QUEUE_LEN        8       // IR_RX_QUEUE_LEN of ir.c
+#define RX_BURST_CNT        20
+#define TX_QUEUE_LEN        16      // IR_TX_QUEUE_LEN of ir.c
+#define TX_BURST_CNT        40      // more than the tx queue and the pending commands of the send task hold
+#define TX_NEC_PERIOD_US    108000
+#define TX_JITTER_US        20000   // the host scheduler under a parallel ctest, the device runs the gap off a one shot timer
+
+// a NEC frame as the receiver hands it over, leader, 32 bits lsb first and the stop mark
+static size_t nec_symbols(const uint8_t *frame, rmt_symbol_word_t *symbols)
+{
+    size_t n = 0;
+    int i = 0;
+
+    symbols[n++] = (rmt_symbol_word_t) {.level0 = 0, .duration0 = 9000, .level1 = 1, .duration1 = 4500};
+    for (i = 0; i < 32; i++) {
+        symbols[n++] = (rmt_symbol_word_t) {.level0 = 0, .duration0 = 560, .level1 = 1, .duration1 = (frame[i / 8] >> (i % 8)) & 1 ? 1690 : 560};
+    }
+    symbols[n++] = (rmt_symbol_word_t) {.level0 = 0, .duration0 = 560, .level1 = 1, .duration1 = 0};
+    return n;
+}
+
+static void capture_nec(const uint8_t *frame)
+{
+    rmt_symbol_word_t symbols[NEC_SYMBOLS] = {0};
+
+    TEST_CHECK(NULL != host_rmt_rx_capture(symbols, nec_symbols(frame, symbols)), "rx not armed");
+}
+
+// copies the code of the key once it has this frame, false if it did not within ms
+static bool wait_code(uint8_t rmt_id, uint8_t channel_id, const uint8_t *frame, int ms, ir_code_t *code)
+{
+    uint8_t raw[IR_RAW_MAX] = {0};
+    uint16_t raw_len = 0;
+
+    for (; ms > 0; ms--) {
+        if (ESP_OK == ir_db_copy_channel(rmt_id, channel_id, code, raw, &raw_len) && 0 == memcmp(code->frame, frame, IR_FRAME_LEN)) {
+            return true;
+        }
+        vTaskDelay(1);
+    }
+    return false;
+}
+
+// the width of a packed frame at index
+static uint16_t packed_width(const uint8_t *packed, uint8_t index)
+{
+    return packed[1 + index * 2] | packed[2 + index * 2] << 8;
+}
+
+// the rx task has taken every capture handed over
+static void wait_rx_idle(void)
+{
+    vTaskDelay(50);
+}
+
+static void test_learn(void)
+{
+    const uint8_t frame[IR_FRAME_LEN] = {0x10, 0xEF, 0x0A, 0xF5};
+    const uint8_t repeat_frame[IR_FRAME_LEN] = {0x10, 0xEF, 0x0B, 0xF4};
+    const rmt_symbol_word_t repeat[] = {{.duration0 = 9000, .duration1 = 2250}, {.duration0 = 560, .duration1 = 0}};
+    rmt_symbol_word_t raw_symbols[40] = {0};
+    uint8_t raw[IR_RAW_MAX] = {0};
+    ir_code_t code = {0};
+    uint16_t len = 0;
+    int i = 0;
+
+    ir_learn_start(RMTID_AC_LIVING, CHANNELID_POWER, 2000);
+    TEST_CHECK(NULL != host_rmt_rx_capture(repeat, 2), "repeat code");
+    wait_rx_idle();
+    TEST_CHECK(ESP_ERR_NOT_FOUND == ir_db_copy_channel(RMTID_AC_LIVING, CHANNELID_POWER, &code, raw, &len), "a repeat code is not learned");
+    capture_nec(frame);
+    TEST_CHECK(wait_code(RMTID_AC_LIVING, CHANNELID_POWER, frame, 1000, &code) && IR_PROTO_NEC == code.protocol, "NEC frame learned");
+    // learning is over, the same key again is a received frame
+    capture_nec(repeat_frame);
+    wait_rx_idle();
+    TEST_CHECK(!wait_code(RMTID_AC_LIVING, CHANNELID_POWER, repeat_frame, 1, &code), "learned once");
+
+    // no decoder knows a 3ms leader, the durations are kept packed
+    raw_symbols[0] = (rmt_symbol_word_t) {.duration0 = 3010, .duration1 = 1490};
+    for (i = 1; i < 39; i++) {
+        raw_symbols[i] = (rmt_symbol_word_t) {.duration0 = 420 + i % 3 * 20, .duration1 = i % 4 ? 380 : 1210};
+    }
+    raw_symbols[39] = (rmt_symbol_word_t) {.duration0 = 440, .duration1 = 0};
+    ir_learn_start(RMTID_AC_LIVING, CHANNELID_0, 2000);
+    TEST_CHECK(NULL != host_rmt_rx_capture(raw_symbols, 40), "raw capture");
+    for (i = 0; i < 1000 && IR_PROTO_RAW != code.protocol; i++) {
+        vTaskDelay(1);
+        ir_db_copy_channel(RMTID_AC_LIVING, CHANNELID_0, &code, raw, &len);
+    }
+    TEST_CHECK(IR_PROTO_RAW == code.protocol, "raw frame learned");
+    // the leader, the marks and the short spaces as one width within the jitter, the long space
+    TEST_CHECK(79 == ir_raw_count(raw, len) && 5 == raw[0], "%u durations, %u widths", ir_raw_count(raw, len), raw[0]);
+    TEST_CHECK(3010 == packed_width(raw, raw[1 + raw[0] * 2] >> 4) && 1490 == packed_width(raw, raw[1 + raw[0] * 2] & 0xF),
+               "leader %u/%u us", packed_width(raw, raw[1 + raw[0] * 2] >> 4), packed_width(raw, raw[1 + raw[0] * 2] & 0xF));
+    TEST_CHECK(raw[2 + raw[0] * 2] >> 4 == (raw[2 + raw[0] * 2] & 0xF) && 1210 == packed_width(raw, 3),
+               "first bit 0x%02X, long space %u us", raw[2 + raw[0] * 2], packed_width(raw, 3));
+}
+
+// an air conditioner frame of num symbols, leader, bits and the end, 0 and 1 in turn so the frame packs without a run
+static void ac_symbols(rmt_symbol_word_t *symbols, size_t num)
+{
+    size_t i = 0;
+
+    symbols[0] = (rmt_symbol_word_t) {.duration0 = 3400, .duration1 = 1700};
+    for (i = 1; i < num; i++) {
+        symbols[i] = (rmt_symbol_word_t) {.duration0 = 430, .duration1 = i % 2 ? 430 : 1300};
+    }
+    symbols[num - 1].duration1 = 0;
+}
+
+// a frame too long to be learned is refused, learning goes on and takes the next one
+static void test_learn_long(void)
+{
+    static rmt_symbol_word_t symbols[LONG_SYMBOLS] = {0};
+    uint8_t raw[IR_RAW_MAX] = {0};
+    ir_code_t code = {0};
+    uint16_t len = 0;
+    // the capture ends with the rx buffer, the rest of the frame is lost
+    size_t refused = AC_SYMBOLS, learned = 40;
+    int i = 0;
+
+#if SOC_RMT_SUPPORT_RX_PINGPONG && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0)
+    // the capture comes in chunks, the frame is learned whole as long as it packs
+    refused = LONG_SYMBOLS;
+    learned = AC_SYMBOLS;
+#endif
+    ir_learn_start(RMTID_AC_BEDROOM, CHANNELID_2, 5000);
+    ac_symbols(symbols, refused);
+    TEST_CHECK(NULL != host_rmt_rx_capture(symbols, refused), "long capture");
+    wait_rx_idle();
+    TEST_CHECK(ESP_ERR_NOT_FOUND == ir_db_copy_channel(RMTID_AC_BEDROOM, CHANNELID_2, &code, raw, &len), "%zu symbols refused", refused);
+    ac_symbols(symbols, learned);
+    TEST_CHECK(NULL != host_rmt_rx_capture(symbols, learned), "capture");
+    for (i = 0; i < 1000 && IR_PROTO_RAW != code.protocol; i++) {
+        vTaskDelay(1);
+        ir_db_copy_channel(RMTID_AC_BEDROOM, CHANNELID_2, &code, raw, &len);
+    }
+    TEST_CHECK(IR_PROTO_RAW == code.protocol && learned * 2 - 1 == ir_raw_count(raw, len), "%zu symbols learned after it, %u durations",
+               learned, ir_raw_count(raw, len));
+}
+
+static void test_learn_timeout(void)
+{
+    const uint8_t frame[IR_FRAME_LEN] = {0x10, 0xEF, 0x0C, 0xF3};
+    uint8_t raw[IR_RAW_MAX] = {0};
+    ir_code_t code = {0};
+    uint16_t len = 0;
+
+    ir_learn_start(RMTID_AC_LIVING, CHANNELID_MUTE, 50);
+    // the rx task looks at the deadline at least once a second
+    vTaskDelay(1100);
+    capture_nec(frame);
+    wait_rx_idle();
+    TEST_CHECK(ESP_ERR_NOT_FOUND == ir_db_copy_channel(RMTID_AC_LIVING, CHANNELID_MUTE, &code, raw, &len), "learned after the timeout");
+}
+
+static volatile bool s_race_done = false;
+
+static void *learn_requests(void *arg)
+{
+    int i = 0;
+
+    for (i = 0; !s_race_done; i++) {
+        if (i & 1) {
+            ir_learn_start(RMTID_AC_BEDROOM, CHANNELID_CHANNEL_ADD, 1000);
+        } else {
+            ir_learn_start(RMTID_AC_LIVING, CHANNELID_UP, 1000);
+        }
+        usleep(100);
+    }
+    return NULL;
+}
+
+// requests from the cloud task while frames come in, every code lands on one of the two keys asked for
+static void test_learn_race(void)
+{
+    uint8_t frame[IR_FRAME_LEN] = {0x20, 0xDF, 0x00, 0xFF};
+    nvs_iterator_t it = NULL;
+    nvs_entry_info_t info = {0};
+    pthread_t thread = 0;
+    int i = 0, keys = 0, bad = 0;
+    esp_err_t err = ESP_OK;
+
+    host_nvs_erase_all();
+    pthread_create(&thread, NULL, learn_requests, NULL);
+    for (i = 0; i < LEARN_RACE_CNT; i++) {
+        frame[2] = i;
+        frame[3] = ~i;
+        capture_nec(frame);
+        vTaskDelay(1);
+    }
+    s_race_done = true;
+    pthread_join(thread, NULL);
+    wait_rx_idle();
+
+    err = nvs_entry_find(NVS_DEFAULT_PART_NAME, "ir_learn", NVS_TYPE_BLOB, &it);
+    while (ESP_OK == err) {
+        nvs_entry_info(it, &info);
+        keys++;
+        if (strcmp(info.key, "c020A") && strcmp(info.key, "c0311")) {
+            bad++;
+            printf("learned as %s\n", info.key);
+        }
+        err = nvs_entry_next(&it);
+    }
+    nvs_release_iterator(it);
+    TEST_CHECK(keys > 0 && 0 == bad, "%d keys learned, %d of them never asked for", keys, bad);
+}
+
+// captures back to back while the rx task is stuck in a learn's nvs write: the queue takes RX_QUEUE_LEN of them,
+// the rest are dropped into the one buffer being filled, and no buffer queued or being parsed is written over
+static void test_rx_burst(void)
+{
+    const uint8_t learn_frame[IR_FRAME_LEN] = {0x30, 0xCF, 0x01, 0xFE};
+    rmt_symbol_word_t symbols[RX_BURST_CNT][NEC_SYMBOLS] = {0};
+    rmt_symbol_word_t *buffers[RX_BURST_CNT] = {0};
+    rmt_symbol_word_t *parsed = NULL, *filling = NULL;
+    uint8_t frame[IR_FRAME_LEN] = {0x30, 0xCF, 0x00, 0xFF};
+    ir_code_t code = {0};
+    uint32_t captures = 0, dropped = 0, captures_after = 0, dropped_after = 0;
+    int i = 0, j = 0, reused = 0, changed = 0;
+
+    ir_get_rx_stats(&captures, &dropped);
+    host_nvs_hold_writes(true);
+    ir_learn_start(RMTID_AC_BEDROOM, CHANNELID_OK, 2000);
+    nec_symbols(learn_frame, symbols[0]);
+    parsed = host_rmt_rx_capture(symbols[0], NEC_SYMBOLS);
+    wait_rx_idle();
+
+    for (i = 0; i < RX_BURST_CNT; i++) {
+        frame[2] = 0x40 + i;
+        frame[3] = ~frame[2];
+        nec_symbols(frame, symbols[i]);
+        buffers[i] = host_rmt_rx_capture(symbols[i], NEC_SYMBOLS);
+    }
+    // each queued one has its own buffer, the dropped ones all go to the next
+    filling = buffers[RX_QUEUE_LEN];
+    for (i = 0; i < RX_BURST_CNT; i++) {
+        reused += NULL == buffers[i] || buffers[i] == parsed;
+        for (j = 0; j < i && i < RX_QUEUE_LEN; j++) {
+            reused += buffers[i] == buffers[j];
+        }
+        reused += i < RX_QUEUE_LEN ? buffers[i] == filling : buffers[i] != filling;
+    }
+    TEST_CHECK(parsed && 0 == reused, "%d captures written over a queued or parsed buffer", reused);
+    // the queued captures are intact until the task gets to them
+    for (i = 0; i < RX_QUEUE_LEN; i++) {
+        changed += buffers[i] && 0 != memcmp(buffers[i], symbols[i], sizeof(symbols[i]));
+    }
+    TEST_CHECK(0 == changed, "%d queued captures changed", changed);
+    ir_get_rx_stats(&captures_after, &dropped_after);
+    TEST_CHECK(RX_BURST_CNT + 1 == captures_after - captures && RX_BURST_CNT - RX_QUEUE_LEN == dropped_after - dropped,
+               "%u captures, %u dropped", captures_after - captures, dropped_after - dropped);
+
+    host_nvs_hold_writes(false);
+    TEST_CHECK(wait_code(RMTID_AC_BEDROOM, CHANNELID_OK, learn_frame, 1000, &code), "learned behind the burst");
+    wait_rx_idle();
+    // drained, the next capture goes to the buffer the dropped ones were written to and is queued
+    nec_symbols(frame, symbols[0]);
+    TEST_CHECK(filling == host_rmt_rx_capture(symbols[0], NEC_SYMBOLS), "next capture into the buffer being filled");
+    wait_rx_idle();
+    ir_get_rx_stats(&captures, &dropped);
+    TEST_CHECK(dropped == dropped_after, "%u dropped after the queue drained", dropped - dropped_after);
+}
+
+// the line idle and the tx log cleared, the send task may still hold the gap after its last frame
+static void wait_tx_idle(void)
+{
+    vTaskDelay(TX_NEC_PERIOD_US / 1000);
+    host_rmt_tx_reset();
+}
+
+static uint32_t wait_tx_frames(uint32_t num, int ms)
+{
+    const host_rmt_tx_frame_t *frames = NULL;
+
+    for (; ms > 0 && host_rmt_tx_frames(&frames, NULL) < num; ms--) {
+        vTaskDelay(1);
+    }
+    return host_rmt_tx_frames(&frames, NULL);
+}
+
+// a command waiting in the tx queue goes out with the code it was queued with, not the one learned after
+static void test_send_relearn(void)
+{
+    const uint8_t frame[IR_FRAME_LEN] = {0x00, 0xFF, 0x45, 0xBA};
+    ir_code_t code = {.rmt_id = RMTID_AC_BEDROOM, .channel_id = CHANNELID_POWER, .protocol = IR_PROTO_RAW};
+    const host_rmt_tx_frame_t *frames = NULL;
+    const rmt_symbol_word_t *symbols = NULL;
+    uint16_t durations[39] = {3000, 1500};
+    uint8_t raw[IR_RAW_MAX] = {0};
+    uint32_t num = 0;
+    int i = 0;
+
+    for (i = 2; i < sizeof(durations) / sizeof(durations[0]); i++) {
+        durations[i] = i % 4 == 3 ? 1200 : 400;
+    }
+    TEST_CHECK(ESP_OK == ir_db_learn(&code, raw, ir_raw_pack(durations, sizeof(durations) / sizeof(durations[0]), raw, sizeof(raw))),
+               "raw code learned");
+    wait_tx_idle();
+    // the first goes out at once, the raw code waits for the end of its NEC period
+    ir_recv(RMTID_TV, CHANNELID_VOLUME_ADD, IR_TX_PRIO_NORMAL);
+    vTaskDelay(10);
+    ir_recv(RMTID_AC_BEDROOM, CHANNELID_POWER, IR_TX_PRIO_NORMAL);
+    code.protocol = IR_PROTO_NEC;
+    memcpy(code.frame, frame, IR_FRAME_LEN);
+    TEST_CHECK(ESP_OK == ir_db_learn(&code, NULL, 0), "learned again as NEC");
+
+    num = wait_tx_frames(2, 1000);
+    host_rmt_tx_frames(&frames, &symbols);
+    TEST_CHECK(2 == num, "%u frames sent", num);
+    if (2 == num) {
+        TEST_CHECK(9000 == symbols[frames[0].first].duration0, "NEC leader %u us", symbols[frames[0].first].duration0);
+        TEST_CHECK(20 == frames[1].num && 3000 == symbols[frames[1].first].duration0,
+                   "the queued raw code, %u symbols, leader %u us", frames[1].num, symbols[frames[1].first].duration0);
+    }
+}
+
+static volatile bool s_stats_done = false;
+
+// every snapshot is one the send task and ir_recv could have left together
+static void *read_tx_stats(void *arg)
+{
+    ir_tx_stats_t stats = {0}, last = {0};
+    int *bad = arg;
+
+    while (!s_stats_done) {
+        ir_get_tx_stats(&stats);
+        if (stats.repeats > stats.sent || stats.sent < last.sent || stats.dropped < last.dropped
+            || stats.depth_max < last.depth_max || stats.latency_max < last.latency_max) {
+            (*bad)++;
+        }
+        last = stats;
+        usleep(50);
+    }
+    return NULL;
+}
+
+// a held key, commands from the cloud faster than the frames can go: full frame, then repeat codes one period apart
+static void test_tx_burst(void)
+{
+    const host_rmt_tx_frame_t *frames = NULL;
+    const rmt_symbol_word_t *symbols = NULL;
+    ir_tx_stats_t before = {0}, after = {0};
+    pthread_t thread = 0;
+    uint32_t sent = 0, dropped = 0, num = 0, i = 0, late = 0;
+    int64_t gap = 0;
+    int bad = 0, ms = 0;
+
+    wait_tx_idle();
+    ir_get_tx_stats(&before);
+    pthread_create(&thread, NULL, read_tx_stats, &bad);
+    for (i = 0; i < TX_BURST_CNT; i++) {
+        ir_recv(RMTID_TV, CHANNELID_VOLUME_ADD, IR_TX_PRIO_NORMAL);
+    }
+    for (ms = 0; ms < 2 * TX_BURST_CNT * TX_NEC_PERIOD_US / 1000 && sent + dropped < TX_BURST_CNT; ms += 10) {
+        vTaskDelay(10);
+        ir_get_tx_stats(&after);
+        sent = after.sent - before.sent;
+        dropped = after.dropped - before.dropped;
+    }
+    s_stats_done = true;
+    pthread_join(thread, NULL);
+
+    TEST_CHECK(TX_BURST_CNT == sent + dropped && dropped > 0, "%u sent, %u dropped", sent, dropped);
+    TEST_CHECK(sent - 1 == after.repeats - before.repeats, "%u repeat codes for %u frames", after.repeats - before.repeats, sent);
+    TEST_CHECK(after.depth_max >= TX_QUEUE_LEN, "depth %u", after.depth_max);
+    TEST_CHECK(0 == bad, "%d inconsistent stats snapshots", bad);
+
+    num = wait_tx_frames(sent, 1000);
+    host_rmt_tx_frames(&frames, &symbols);
+    TEST_CHECK(num == sent, "%u frames logged, %u sent", num, sent);
+    TEST_CHECK(num && 9000 == symbols[frames[0].first].duration0 && 4500 == symbols[frames[0].first].duration1, "full frame first");
+    for (i = 1; i < num; i++) {
+        gap = frames[i].start - frames[i - 1].start;
+        if (2250 != symbols[frames[i].first].duration1 || gap < TX_NEC_PERIOD_US || gap > TX_NEC_PERIOD_US + TX_JITTER_US) {
+            if (late++ < 4) {
+                printf("frame %u: space %u us, %lld us after the one before\n", i, symbols[frames[i].first].duration1, gap);
+            }
+        }
+    }
+    TEST_CHECK(0 == late, "%u repeat codes off", late);
+}
+
+int main(int argc, char **argv)
+{
+    host_nvs_erase_all();
+    ir_init();
+    vTaskDelay(10); // the rx task arms the channel when it starts
+    test_learn();
+    test_learn_long();
+    test_learn_timeout();
+    test_learn_race();
+    test_rx_burst();
+    test_send_relearn();
+    test_tx_burst();
+    return test_result("ir");
+}
@@ -0,0 +1,326 @@
+#include <stdio.h>
+#include <string.h>
+#include "nvs.h"
+#include "ir.h"
+#include "ir_db.h"
+#include "ir_raw_encoder.h"
+#include "host_test.h"
+
+#define BENCH_CNT           1000000
+
+// the codes as ir.c had them before ir_db, one slot per remote and channel, all zero - no code
+static const uint8_t s_ref[RMTID_MAX][CHANNELID_MAX][IR_FRAME_LEN] = {
+    [RMTID_TV] = {
+        [CHANNELID_0] = {0x4C, 0x65, 0x45, 0xBA}, [CHANNELID_1] = {0x4C, 0x65, 0x01, 0xFE},
+        [CHANNELID_2] = {0x4C, 0x65, 0x02, 0xFD}, [CHANNELID_3] = {0x4C, 0x65, 0x03, 0xFC},
+        [CHANNELID_4] = {0x4C, 0x65, 0x04, 0xFB}, [CHANNELID_5] = {0x4C, 0x65, 0x05, 0xFA},
+        [CHANNELID_6] = {0x4C, 0x65, 0x06, 0xF9}, [CHANNELID_7] = {0x4C, 0x65, 0x07, 0xF8},
+        [CHANNELID_8] = {0x4C, 0x65, 0x08, 0xF7}, [CHANNELID_9] = {0x4C, 0x65, 0x09, 0xF6},
+        [CHANNELID_UP] = {0x4C, 0x65, 0x0B, 0xF4}, [CHANNELID_DOWN] = {0x4C, 0x65, 0x0E, 0xF1},
+        [CHANNELID_LEFT] = {0x4C, 0x65, 0x10, 0xEF}, [CHANNELID_RIGHT] = {0x4C, 0x65, 0x11, 0xEE},
+        [CHANNELID_OK] = {0x4C, 0x65, 0x0D, 0xF2}, [CHANNELID_VOLUME_ADD] = {0x4C, 0x65, 0x15, 0xEA},
+        [CHANNELID_VOLUME_SUB] = {0x4C, 0x65, 0x1C, 0xE3}, [CHANNELID_CHANNEL_ADD] = {0x4C, 0x65, 0x1F, 0xE0},
+        [CHANNELID_CHANNEL_SUB] = {0x4C, 0x65, 0x1E, 0xE1}, [CHANNELID_POWER] = {0x4C, 0x65, 0x0A, 0xF5},
+        [CHANNELID_HOME] = {0x4C, 0x65, 0x16, 0xE9}, [CHANNELID_SIGNAL] = {0x4C, 0x65, 0x0C, 0xF3},
+        [CHANNELID_MUTE] = {0x4C, 0x65, 0x0F, 0xF0}, [CHANNELID_BACK] = {0x4C, 0x65, 0x1D, 0xE2},
+        [CHANNELID_MENU] = {0x4C, 0x65, 0x37, 0xC8}, [CHANNELID_SETTING] = {0x4C, 0x65, 0x00, 0xFF},
+    },
+    [RMTID_SETTOPBOX] = {
+        [CHANNELID_0] = {0x22, 0xDD, 0x87, 0x78}, [CHANNELID_1] = {0x22, 0xDD, 0x92, 0x6D},
+        [CHANNELID_2] = {0x22, 0xDD, 0x93, 0x6C}, [CHANNELID_3] = {0x22, 0xDD, 0xCC, 0x33},
+        [CHANNELID_4] = {0x22, 0xDD, 0x8E, 0x71}, [CHANNELID_5] = {0x22, 0xDD, 0x8F, 0x70},
+        [CHANNELID_6] = {0x22, 0xDD, 0xC8, 0x37}, [CHANNELID_7] = {0x22, 0xDD, 0x8A, 0x75},
+        [CHANNELID_8] = {0x22, 0xDD, 0x8B, 0x74}, [CHANNELID_9] = {0x22, 0xDD, 0xC4, 0x3B},
+        [CHANNELID_UP] = {0x22, 0xDD, 0xCA, 0x35}, [CHANNELID_DOWN] = {0x22, 0xDD, 0xD2, 0x2D},
+        [CHANNELID_LEFT] = {0x22, 0xDD, 0x99, 0x66}, [CHANNELID_RIGHT] = {0x22, 0xDD, 0xC1, 0x3E},
+        [CHANNELID_OK] = {0x22, 0xDD, 0xCE, 0x31}, [CHANNELID_VOLUME_ADD] = {0x22, 0xDD, 0x80, 0x7F},
+        [CHANNELID_VOLUME_SUB] = {0x22, 0xDD, 0x81, 0x7E}, [CHANNELID_CHANNEL_ADD] = {0x22, 0xDD, 0x85, 0x7A},
+        [CHANNELID_CHANNEL_SUB] = {0x22, 0xDD, 0x86, 0x79}, [CHANNELID_POWER] = {0x22, 0xDD, 0xDC, 0x23},
+        [CHANNELID_HOME] = {0x22, 0xDD, 0x88, 0x77}, [CHANNELID_SIGNAL] = {0x4C, 0x65, 0x0C, 0xF3},
+        [CHANNELID_MUTE] = {0x22, 0xDD, 0x9C, 0x63}, [CHANNELID_BACK] = {0x22, 0xDD, 0x95, 0x6A},
+        [CHANNELID_MENU] = {0x22, 0xDD, 0x82, 0x7D}, [CHANNELID_SETTING] = {0x22, 0xDD, 0x8D, 0x72},
+    },
+    [RMTID_LIGHT_BEDROOM] = {
+        [CHANNELID_VOLUME_ADD] = {0x00, 0xFF, 0x40, 0xBF}, [CHANNELID_VOLUME_SUB] = {0x00, 0xFF, 0x19, 0xE6},
+        [CHANNELID_POWER] = {0x00, 0xFF, 0x0D, 0xF2},
+    },
+};
+
+static const uint8_t s_no_code[IR_FRAME_LEN] = {0};
+
+// the first remote and channel in s_ref sending this frame, the one a received frame is reported as
+static bool ref_first(const uint8_t *frame, uint8_t *rmt_id, uint8_t *channel_id)
+{
+    int i = 0, j = 0;
+
+    for (i = 0; i < RMTID_MAX; i++) {
+        for (j = 0; j < CHANNELID_MAX; j++) {
+            if (0 == memcmp(s_ref[i][j], frame, IR_FRAME_LEN)) {
+                *rmt_id = i;
+                *channel_id = j;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// the code of the channel copied out under the lock, false if the remote has no such channel
+static bool find_channel(uint8_t rmt_id, uint8_t channel_id, ir_code_t *code)
+{
+    uint8_t raw[IR_RAW_MAX] = {0};
+    uint16_t raw_len = 0;
+
+    return ESP_OK == ir_db_copy_channel(rmt_id, channel_id, code, raw, &raw_len);
+}
+
+// a short frame of an air conditioner remote, packed the way the rx task learns it
+static size_t ac_packed(uint8_t *packed, size_t size)
+{
+    const uint16_t durations[] = {9000, 4500, 560, 560, 560, 1690, 560, 560, 560, 1690};
+
+    return ir_raw_pack(durations, sizeof(durations) / sizeof(durations[0]), packed, size);
+}
+
+// a code learned on an earlier boot, as ir_db_learn() leaves it in nvs
+static void nvs_put(uint8_t rmt_id, uint8_t channel_id, const uint8_t *blob, size_t len)
+{
+    nvs_handle_t hd_nvs = 0;
+    char key[8] = {0};
+
+    snprintf(key, sizeof(key), "c%02X%02X", rmt_id, channel_id);
+    nvs_open("ir_learn", NVS_READWRITE, &hd_nvs);
+    nvs_set_blob(hd_nvs, key, blob, len);
+    nvs_close(hd_nvs);
+}
+
+static size_t nvs_get(uint8_t rmt_id, uint8_t channel_id, uint8_t *blob, size_t size)
+{
+    nvs_handle_t hd_nvs = 0;
+    char key[8] = {0};
+
+    snprintf(key, sizeof(key), "c%02X%02X", rmt_id, channel_id);
+    if (ESP_OK != nvs_open("ir_learn", NVS_READONLY, &hd_nvs) || ESP_OK != nvs_get_blob(hd_nvs, key, blob, &size)) {
+        return 0;
+    }
+    return size;
+}
+
+// every slot of the old table, hits and misses, then every code back from its frame
+static void test_builtin(void)
+{
+    const ir_code_t *code = NULL;
+    ir_code_t copy = {0};
+    uint8_t rmt_id = 0, channel_id = 0;
+    uint8_t frame[IR_FRAME_LEN] = {0x4C, 0x65, 0x0A, 0xF5};
+    int i = 0, j = 0, codes = 0;
+
+    for (i = 0; i < RMTID_MAX; i++) {
+        for (j = 0; j < CHANNELID_MAX; j++) {
+            if (0 == memcmp(s_ref[i][j], s_no_code, IR_FRAME_LEN)) {
+                TEST_CHECK(!find_channel(i, j, &copy), "rmt %d channel %d has no code", i, j);
+                continue;
+            }
+            codes++;
+            TEST_CHECK(find_channel(i, j, &copy) && copy.rmt_id == i && copy.channel_id == j && IR_PROTO_NEC == copy.protocol
+                       && 0 == memcmp(copy.frame, s_ref[i][j], IR_FRAME_LEN), "rmt %d channel %d", i, j);
+            code = ir_db_find_frame(IR_PROTO_NEC, s_ref[i][j]);
+            ref_first(s_ref[i][j], &rmt_id, &channel_id);
+            TEST_CHECK(code && code->rmt_id == rmt_id && code->channel_id == channel_id,
+                       "frame of rmt %d channel %d is rmt %u channel %u", i, j, code ? code->rmt_id : 0xFF, code ? code->channel_id : 0xFF);
+        }
+    }
+    TEST_CHECK(55 == codes, "%d codes", codes);
+    // the settop box SIGNAL key sends the TV code, the TV is the first in the table
+    code = ir_db_find_frame(IR_PROTO_NEC, s_ref[RMTID_SETTOPBOX][CHANNELID_SIGNAL]);
+    TEST_CHECK(code && RMTID_TV == code->rmt_id, "shared frame");
+    TEST_CHECK(!find_channel(RMTID_MAX, CHANNELID_0, &copy), "rmt out of range");
+    TEST_CHECK(!find_channel(RMTID_TV, 0xFF, &copy), "channel out of range");
+    TEST_CHECK(NULL == ir_db_find_frame(IR_PROTO_SAMSUNG, frame), "the same payload in another protocol");
+    frame[3] = 0;
+    TEST_CHECK(NULL == ir_db_find_frame(IR_PROTO_NEC, frame), "unknown frame");
+}
+
+// nvs holds what the last boot learned, init has to load it over the built in codes
+static void seed_nvs(void)
+{
+    const uint8_t power[] = {IR_PROTO_NEC, 0x22, 0xDD, 0x01, 0xFE};
+    const uint8_t ticks[] = {IR_PROTO_RAW, 0, 0, 0, 0, 180, 90, 11, 11, 11, 34, 11, 11, 11, 34}; // 50us ticks of older builds
+    const uint8_t short_blob[] = {IR_PROTO_NEC, 0x22};
+    uint8_t ac[IR_FRAME_LEN + 1 + IR_RAW_MAX] = {IR_PROTO_RAW};
+
+    host_nvs_erase_all();
+    nvs_put(RMTID_SETTOPBOX, CHANNELID_POWER, power, sizeof(power));
+    nvs_put(RMTID_AC_LIVING, CHANNELID_POWER, ac, IR_FRAME_LEN + 1 + ac_packed(ac + IR_FRAME_LEN + 1, IR_RAW_MAX));
+    nvs_put(RMTID_AC_LIVING, CHANNELID_1, ticks, sizeof(ticks));
+    nvs_put(RMTID_AC_LIVING, CHANNELID_MUTE, short_blob, sizeof(short_blob));
+}
+
+static void test_loaded(void)
+{
+    const uint8_t power[IR_FRAME_LEN] = {0x22, 0xDD, 0x01, 0xFE};
+    const ir_code_t *code = NULL;
+    ir_code_t copy = {0};
+    uint8_t raw[IR_RAW_MAX] = {0}, ac[IR_RAW_MAX] = {0};
+    uint16_t len = 0;
+
+    TEST_CHECK(find_channel(RMTID_SETTOPBOX, CHANNELID_POWER, &copy) && 0 == memcmp(copy.frame, power, IR_FRAME_LEN),
+               "learned code replaces the built in one");
+    code = ir_db_find_frame(IR_PROTO_NEC, power);
+    TEST_CHECK(code && RMTID_SETTOPBOX == code->rmt_id && CHANNELID_POWER == code->channel_id, "learned frame");
+    code = ir_db_find_frame(IR_PROTO_NEC, s_ref[RMTID_SETTOPBOX][CHANNELID_POWER]);
+    TEST_CHECK(code && RMTID_SETTOPBOX == code->rmt_id && CHANNELID_POWER == code->channel_id, "the old frame still names the key");
+    TEST_CHECK(ESP_OK == ir_db_copy_channel(RMTID_AC_LIVING, CHANNELID_POWER, &copy, raw, &len) && IR_PROTO_RAW == copy.protocol,
+               "raw code");
+    TEST_CHECK(ac_packed(ac, sizeof(ac)) == len && 0 == memcmp(raw, ac, len), "packed frame, %u bytes", len);
+    TEST_CHECK(!find_channel(RMTID_AC_LIVING, CHANNELID_1, &copy), "ticks of an older build are skipped");
+    TEST_CHECK(!find_channel(RMTID_AC_LIVING, CHANNELID_MUTE, &copy), "a blob shorter than its head is skipped");
+    TEST_CHECK(ESP_OK == ir_db_copy_channel(RMTID_TV, CHANNELID_POWER, &copy, raw, &len) && 0 == len, "a built in code has no frame");
+    TEST_CHECK(ESP_ERR_NO_MEM == ir_db_copy_channel(RMTID_AC_LIVING, CHANNELID_POWER, &copy, NULL, &len), "raw code, no room for it");
+    TEST_CHECK(ESP_OK == ir_db_copy_channel(RMTID_TV, CHANNELID_POWER, &copy, NULL, &len), "NEC code, no room needed");
+}
+
+static void test_learn(void)
+{
+    ir_code_t code = {.rmt_id = RMTID_LIGHT_BEDROOM, .channel_id = CHANNELID_OK, .frame = {0x00, 0xFF, 0x1C, 0xE3}};
+    uint8_t raw[IR_RAW_MAX + 1] = {0};
+    uint8_t blob[IR_RAW_MAX + 8] = {0};
+    uint8_t copy_raw[IR_RAW_MAX] = {0};
+    const ir_code_t *found = NULL;
+    ir_code_t copy = {0};
+    nvs_stats_t stats = {0};
+    size_t used = 0, len = 0;
+    uint16_t copy_len = 0xFF;
+    int i = 0;
+
+    TEST_CHECK(ESP_OK == ir_db_learn(&code, NULL, 0), "learn a NEC code");
+    found = ir_db_find_frame(IR_PROTO_NEC, code.frame);
+    TEST_CHECK(found && code.rmt_id == found->rmt_id && code.channel_id == found->channel_id, "learned frame");
+    TEST_CHECK(ESP_OK == ir_db_copy_channel(code.rmt_id, code.channel_id, &copy, copy_raw, &copy_len)
+               && 0 == memcmp(&copy, &code, sizeof(copy)) && 0 == copy_len, "copy of the NEC code");
+    len = nvs_get(code.rmt_id, code.channel_id, blob, sizeof(blob));
+    TEST_CHECK(5 == len && IR_PROTO_NEC == blob[0] && 0 == memcmp(blob + 1, code.frame, IR_FRAME_LEN), "nvs blob, %u bytes", len);
+
+    // learned again as raw, the same slot and the same key, a frame of IR_RAW_MAX bytes without a run:
+    // widths 560 and 1690, then symbols of a 0 bit and a 1 bit in turn
+    nvs_get_stats(NULL, &stats);
+    used = stats.used_entries;
+    memcpy(raw, (uint8_t []){2, 560 & 0xFF, 560 >> 8, 1690 & 0xFF, 1690 >> 8}, 5);
+    for (i = 5; i < IR_RAW_MAX; i++) {
+        raw[i] = i & 1;
+    }
+    TEST_CHECK((IR_RAW_MAX - 5) * 2 == ir_raw_count(raw, IR_RAW_MAX), "%u durations", ir_raw_count(raw, IR_RAW_MAX));
+    code.protocol = IR_PROTO_RAW;
+    TEST_CHECK(ESP_OK == ir_db_learn(&code, raw, IR_RAW_MAX), "relearn as raw");
+    TEST_CHECK(NULL == ir_db_find_frame(IR_PROTO_NEC, (uint8_t []){0x00, 0xFF, 0x1C, 0xE3}), "the old frame is gone");
+    TEST_CHECK(ESP_OK == ir_db_copy_channel(code.rmt_id, code.channel_id, &copy, copy_raw, &copy_len) && IR_PROTO_RAW == copy.protocol
+               && IR_RAW_MAX == copy_len && 0 == memcmp(copy_raw, raw, IR_RAW_MAX), "copy of the raw code, %u bytes", copy_len);
+    TEST_CHECK(ESP_ERR_NOT_FOUND == ir_db_copy_channel(RMTID_LIGHT_BEDROOM, CHANNELID_MENU, &copy, copy_raw, &copy_len)
+               && 0 == copy_len, "copy of a channel with no code");
+    len = nvs_get(code.rmt_id, code.channel_id, blob, sizeof(blob));
+    TEST_CHECK(5 + IR_RAW_MAX == len && IR_PROTO_RAW == blob[0] && 0 == memcmp(blob + 5, raw, IR_RAW_MAX), "raw blob, %u bytes", len);
+    nvs_get_stats(NULL, &stats);
+    TEST_CHECK(stats.used_entries - used == (5 + IR_RAW_MAX + 31) / 32 - 1, "the NEC entry is replaced, %u entries more", stats.used_entries - used);
+
+    TEST_CHECK(ESP_ERR_INVALID_SIZE == ir_db_learn(&code, raw, 0), "raw without a frame");
+    TEST_CHECK(ESP_ERR_INVALID_SIZE == ir_db_learn(&code, raw, IR_RAW_MAX + 1), "raw over IR_RAW_MAX");
+    raw[0] = IR_RAW_WIDTHS_MAX + 1;
+    TEST_CHECK(ESP_ERR_INVALID_ARG == ir_db_learn(&code, raw, IR_RAW_MAX), "a frame that does not unpack");
+}
+
+// a failed write leaves ram as it was, the lookups never give a code the next boot would not have
+static void test_learn_nvs_error(void)
+{
+    ir_code_t code = {.rmt_id = RMTID_TV, .channel_id = CHANNELID_MUTE, .protocol = IR_PROTO_NEC, .frame = {0x4C, 0x65, 0x50, 0xAF}};
+    ir_code_t found = {0};
+    uint8_t blob[8] = {0};
+
+    host_nvs_fail_writes(ESP_ERR_NVS_NO_FREE_PAGES);
+    TEST_CHECK(ESP_ERR_NVS_NO_FREE_PAGES == ir_db_learn(&code, NULL, 0), "learn with nvs full");
+    TEST_CHECK(find_channel(code.rmt_id, code.channel_id, &found) && 0 == memcmp(found.frame, s_ref[RMTID_TV][CHANNELID_MUTE], IR_FRAME_LEN),
+               "built in code kept");
+    TEST_CHECK(NULL == ir_db_find_frame(IR_PROTO_NEC, code.frame), "new frame not indexed");
+    // a learned key keeps its learned code
+    code.rmt_id = RMTID_SETTOPBOX;
+    code.channel_id = CHANNELID_POWER;
+    TEST_CHECK(ESP_OK != ir_db_learn(&code, NULL, 0), "relearn with nvs full");
+    TEST_CHECK(find_channel(code.rmt_id, code.channel_id, &found) && 0x01 == found.frame[2], "learned code kept");
+    TEST_CHECK(5 == nvs_get(code.rmt_id, code.channel_id, blob, sizeof(blob)) && 0x01 == blob[3], "nvs entry kept");
+    host_nvs_fail_writes(ESP_OK);
+}
+
+// the table holds IR_DB_LEARN_MAX codes, the next new key is refused and not saved
+static void test_learn_full(void)
+{
+    ir_code_t code = {.rmt_id = RMTID_AC_BEDROOM, .protocol = IR_PROTO_NEC, .frame = {0x10, 0xEF, 0x00, 0xFF}};
+    ir_code_t found = {0};
+    uint8_t blob[8] = {0};
+    int learned = 0;
+    esp_err_t err = ESP_OK;
+
+    for (code.channel_id = 0; code.channel_id < CHANNELID_MAX; code.channel_id++) {
+        code.frame[2] = code.channel_id;
+        code.frame[3] = ~code.channel_id;
+        err = ir_db_learn(&code, NULL, 0);
+        if (ESP_OK != err) {
+            break;
+        }
+        learned++;
+    }
+    // three codes came from the earlier tests
+    TEST_CHECK(ESP_ERR_NO_MEM == err && 16 - 3 == learned, "%d codes learned, err:%d", learned, err);
+    TEST_CHECK(!find_channel(code.rmt_id, code.channel_id, &found), "refused code is not found");
+    TEST_CHECK(0 == nvs_get(code.rmt_id, code.channel_id, blob, sizeof(blob)), "refused code is not saved");
+    code.channel_id = 0;
+    code.frame[2] = 0x80;
+    TEST_CHECK(ESP_OK == ir_db_learn(&code, NULL, 0), "a full table still replaces its codes");
+    // every index lookup still ends, on the learned codes and on the misses
+    TEST_CHECK(find_channel(RMTID_AC_BEDROOM, 12, &found) && !find_channel(RMTID_AC_BEDROOM, 13, &found), "full index");
+}
+
+static void bench_lookup(void)
+{
+    const ir_code_t *code = NULL;
+    ir_code_t copy = {0};
+    uint32_t i = 0, found = 0;
+    int64_t start = 0;
+
+    start = esp_timer_get_time();
+    for (i = 0; i < BENCH_CNT; i++) {
+        found += find_channel(i & 1, CHANNELID_0 + i % 26, &copy);
+    }
+    bench_report("channel hit", BENCH_CNT, start);
+    start = esp_timer_get_time();
+    for (i = 0; i < BENCH_CNT; i++) {
+        found += find_channel(RMTID_LIGHT_BEDROOM, CHANNELID_0 + i % 10, &copy);
+    }
+    bench_report("channel miss", BENCH_CNT, start);
+    start = esp_timer_get_time();
+    for (i = 0; i < BENCH_CNT; i++) {
+        code = ir_db_find_frame(IR_PROTO_NEC, s_ref[i & 1][i % 26]);
+        found += NULL != code;
+    }
+    bench_report("frame hit", BENCH_CNT, start);
+    printf("bench %-24s %10u of %u found\n", "lookups", found, 3 * BENCH_CNT);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && 0 == strcmp(argv[1], "bench")) {
+        host_nvs_erase_all();
+        ir_db_init();
+        bench_lookup();
+        return 0;
+    }
+    host_nvs_erase_all();
+    ir_db_init();
+    test_builtin();
+    // the next boot, with codes learned before it
+    seed_nvs();
+    ir_db_init();
+    test_loaded();
+    test_learn();
+    test_learn_nvs_error();
+    test_learn_full();
+    return test_result("ir_db");
+}
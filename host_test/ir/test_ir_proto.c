@@ -0,0 +1,416 @@
+#include <stdio.h>
+#include <string.h>
+#include "driver/rmt_tx.h"
+#include "ir_proto.h"
+#include "ir_raw_encoder.h"
+#include "host_test.h"
+
+#define BENCH_CNT           200000
+#define SYMBOLS_MAX         64
+#define AC_BITS             64
+#define AC_DURATIONS        (2 * (2 + AC_BITS) + 2 * (1 + AC_BITS) - 1)
+#define AC_HALVES_MAX       (AC_DURATIONS + 16) // the leader and the gap split at 10MHz
+#define TX_MEM_SYMBOLS      64
+
+// captures the way a TSOP receiver hands them to the rx channel at 1MHz, mark and space in us, a 0 space ends the capture
+// the receiver stretches marks and shortens spaces by about 60us, each duration is off by up to 40us more
+// 34 symbols
+static const uint16_t s_nec[] = {
+    9045, 4442, 588, 518, 644, 529, 594, 1618, 587, 539, 614, 492,
+    653, 483, 649, 525, 586, 490, 596, 1604, 589, 1665, 608, 537,
+    607, 1660, 644, 1598, 592, 1652, 580, 1599, 651, 1603, 601, 471,
+    660, 534, 585, 532, 584, 1633, 650, 474, 617, 472, 652, 467,
+    590, 518, 646, 1619, 640, 1652, 645, 1645, 646, 485, 583, 1653,
+    653, 1615, 605, 1592, 597, 1657, 595, 0,
+};
+// 2 symbols
+static const uint16_t s_nec_repeat[] = {
+    9059, 2201, 605, 0,
+};
+// 34 symbols
+static const uint16_t s_nec_ext[] = {
+    9024, 4401, 627, 1637, 637, 486, 594, 1665, 589, 539, 609, 1609,
+    604, 524, 658, 470, 647, 505, 652, 1617, 632, 1655, 631, 482,
+    656, 1648, 637, 484, 650, 1622, 628, 1650, 620, 1599, 582, 489,
+    610, 1595, 645, 533, 650, 501, 597, 1624, 629, 465, 643, 528,
+    630, 528, 632, 1638, 644, 489, 624, 1603, 650, 1647, 608, 479,
+    597, 1603, 634, 1615, 598, 1611, 658, 0,
+};
+// 34 symbols
+static const uint16_t s_samsung[] = {
+    4524, 4475, 586, 1667, 630, 1611, 615, 1668, 658, 492, 659, 508,
+    615, 508, 623, 531, 653, 509, 605, 1597, 653, 1612, 652, 1668,
+    620, 539, 617, 465, 647, 501, 586, 518, 605, 486, 596, 489,
+    655, 1635, 630, 466, 599, 492, 614, 500, 619, 517, 587, 492,
+    650, 529, 583, 1618, 598, 525, 659, 1597, 584, 1663, 591, 1590,
+    657, 1656, 614, 1622, 596, 1602, 628, 0,
+};
+// 13 symbols
+static const uint16_t s_sirc12[] = {
+    2496, 550, 1271, 579, 642, 519, 1247, 568, 669, 523, 1290, 580,
+    637, 577, 637, 573, 1222, 557, 633, 580, 682, 505, 635, 546,
+    684, 0,
+};
+// 16 symbols
+static const uint16_t s_sirc15[] = {
+    2442, 514, 665, 575, 1259, 529, 634, 565, 1267, 512, 676, 555,
+    1222, 562, 693, 524, 1241, 532, 1232, 579, 1238, 537, 661, 579,
+    1227, 520, 643, 500, 632, 549, 1298, 0,
+};
+// 21 symbols
+static const uint16_t s_sirc20[] = {
+    2425, 520, 1254, 519, 688, 556, 632, 523, 1249, 551, 1233, 502,
+    1286, 547, 647, 501, 623, 538, 1276, 503, 694, 556, 1221, 518,
+    1288, 558, 1264, 520, 671, 502, 640, 536, 625, 557, 1255, 549,
+    627, 548, 1259, 511, 1272, 0,
+};
+// 10 symbols
+static const uint16_t s_rc5[] = {
+    948, 823, 969, 867, 1798, 826, 928, 1747, 1831, 1721, 927, 815,
+    961, 869, 1866, 1706, 1846, 1751, 928, 0,
+};
+// 11 symbols
+static const uint16_t s_rc5x[] = {
+    1875, 845, 935, 1687, 1861, 868, 980, 837, 987, 817, 969, 842,
+    945, 807, 964, 1742, 1821, 1707, 966, 830, 955, 0,
+};
+// 21 symbols
+static const uint16_t s_rc6[] = {
+    2724, 819, 469, 790, 516, 393, 480, 394, 523, 812, 943, 389,
+    529, 411, 464, 407, 490, 371, 482, 375, 496, 345, 472, 357,
+    511, 408, 544, 347, 487, 384, 506, 412, 505, 372, 958, 347,
+    465, 788, 478, 374, 466, 0,
+};
+// 18 symbols
+static const uint16_t s_rc6_toggle[] = {
+    2695, 806, 537, 821, 515, 385, 511, 375, 1427, 1289, 503, 364,
+    530, 368, 465, 369, 535, 418, 965, 862, 527, 392, 504, 408,
+    947, 813, 972, 361, 537, 371, 526, 866, 543, 361, 468, 0,
+};
+
+typedef struct {
+    const char *name;
+    const uint16_t *durations;
+    size_t num;
+    ir_proto_t protocol;
+    uint8_t bits;
+    uint8_t toggle;
+    uint8_t repeat;
+    uint16_t address;
+    uint16_t command;
+} recorded_t;
+
+#define RECORDED(durations) durations, sizeof(durations) / sizeof(durations[0]) / 2
+
+static const recorded_t s_recorded[] = {
+    {"nec",         RECORDED(s_nec),        IR_PROTO_NEC,       32, 0, 0, 0x04,     0x08},
+    {"nec repeat",  RECORDED(s_nec_repeat), IR_PROTO_NEC,       0,  0, 1, 0,        0},
+    {"nec ext",     RECORDED(s_nec_ext),    IR_PROTO_NEC_EXT,   32, 0, 0, 0xEB15,   0x12},
+    {"samsung",     RECORDED(s_samsung),    IR_PROTO_SAMSUNG,   32, 0, 0, 0x0707,   0x02},
+    {"sirc12",      RECORDED(s_sirc12),     IR_PROTO_SIRC,      12, 0, 0, 0x01,     0x15},
+    {"sirc15",      RECORDED(s_sirc15),     IR_PROTO_SIRC,      15, 0, 0, 0x97,     0x2A},
+    {"sirc20",      RECORDED(s_sirc20),     IR_PROTO_SIRC,      20, 0, 0, 0x1A3A,   0x39},
+    {"rc5",         RECORDED(s_rc5),        IR_PROTO_RC5,       14, 1, 0, 0x05,     0x35},
+    {"rc5x",        RECORDED(s_rc5x),       IR_PROTO_RC5,       14, 0, 0, 0x10,     0x4B},
+    {"rc6",         RECORDED(s_rc6),        IR_PROTO_RC6,       16, 0, 0, 0x00,     0x0C},
+    {"rc6 toggle",  RECORDED(s_rc6_toggle), IR_PROTO_RC6,       16, 1, 0, 0x04,     0x5C},
+};
+
+#define RECORDED_CNT        (sizeof(s_recorded) / sizeof(s_recorded[0]))
+
+// as the rx channel of the receiver hands them over, the output idles high so a mark is level 0
+static size_t recorded_symbols(const recorded_t *recorded, rmt_symbol_word_t *symbols)
+{
+    size_t i = 0;
+
+    for (i = 0; i < recorded->num; i++) {
+        symbols[i] = (rmt_symbol_word_t) {
+            .level0 = 0, .duration0 = recorded->durations[2 * i], .level1 = 1, .duration1 = recorded->durations[2 * i + 1],
+        };
+    }
+    return recorded->num;
+}
+
+static bool frame_matches(const recorded_t *recorded, const ir_proto_frame_t *frame)
+{
+    return frame->protocol == recorded->protocol && frame->bits == recorded->bits && frame->toggle == recorded->toggle
+           && frame->repeat == recorded->repeat && frame->address == recorded->address && frame->command == recorded->command;
+}
+
+static void test_recorded(void)
+{
+    rmt_symbol_word_t symbols[SYMBOLS_MAX] = {0};
+    ir_proto_frame_t frame = {0};
+    size_t i = 0, num = 0;
+    esp_err_t err = ESP_OK;
+
+    for (i = 0; i < RECORDED_CNT; i++) {
+        num = recorded_symbols(&s_recorded[i], symbols);
+        memset(&frame, 0, sizeof(frame));
+        err = ir_proto_decode(symbols, num, &frame);
+        TEST_CHECK(ESP_OK == err && frame_matches(&s_recorded[i], &frame),
+                   "%s: err 0x%x, %s %u bits, toggle %u, repeat %u, address 0x%X, command 0x%X", s_recorded[i].name, err,
+                   ir_proto_name(frame.protocol), frame.bits, frame.toggle, frame.repeat, frame.address, frame.command);
+    }
+}
+
+// every capture one after the other through one stream, reset at the end of each capture as the rx task does
+static void test_stream(void)
+{
+    rmt_symbol_word_t symbols[SYMBOLS_MAX] = {0};
+    ir_proto_stream_t stream = {0};
+    ir_proto_frame_t frame = {0};
+    size_t i = 0, j = 0, num = 0;
+    int frames = 0;
+
+    for (i = 0; i < RECORDED_CNT; i++) {
+        num = recorded_symbols(&s_recorded[i], symbols);
+        frames = 0;
+        for (j = 0; j < num; j++) {
+            if (ESP_OK == ir_proto_stream_feed(&stream, symbols[j], &frame)) {
+                frames++;
+                TEST_CHECK(frame_matches(&s_recorded[i], &frame), "%s: streamed as %s, address 0x%X, command 0x%X",
+                           s_recorded[i].name, ir_proto_name(frame.protocol), frame.address, frame.command);
+            }
+        }
+        ir_proto_stream_reset(&stream);
+        TEST_CHECK(1 == frames, "%s: %d frames streamed", s_recorded[i].name, frames);
+    }
+
+    // a capture cut short by the end of a partial rx buffer, the next one starts clean after the reset
+    num = recorded_symbols(&s_recorded[0], symbols);
+    for (j = 0; j < num / 2; j++) {
+        TEST_CHECK(ESP_ERR_NOT_FINISHED == ir_proto_stream_feed(&stream, symbols[j], &frame), "nec cut at %zu", j);
+    }
+    ir_proto_stream_reset(&stream);
+    num = recorded_symbols(&s_recorded[9], symbols);
+    frames = 0;
+    for (j = 0; j < num; j++) {
+        frames += ESP_OK == ir_proto_stream_feed(&stream, symbols[j], &frame);
+    }
+    TEST_CHECK(1 == frames && frame_matches(&s_recorded[9], &frame), "rc6 after a cut nec frame");
+}
+
+// a capture that is off somewhere is not returned as a frame
+static void test_damaged(void)
+{
+    rmt_symbol_word_t symbols[SYMBOLS_MAX] = {0};
+    const rmt_symbol_word_t noise[] = {{.duration0 = 310, .duration1 = 290}, {.duration0 = 330, .duration1 = 0}};
+    ir_proto_frame_t frame = {0};
+    size_t i = 0, num = 0;
+    esp_err_t err = ESP_OK;
+
+    TEST_CHECK(ESP_ERR_NOT_FOUND == ir_proto_decode(noise, 2, &frame), "noise");
+
+    // bit 16, the lowest command bit, flipped, its inverse no longer fits
+    num = recorded_symbols(&s_recorded[0], symbols);
+    symbols[17].duration1 = symbols[17].duration1 > 1000 ? 520 : 1640;
+    TEST_CHECK(ESP_ERR_INVALID_RESPONSE == ir_proto_decode(symbols, num, &frame), "nec command inverse");
+
+    // a space right between a 0 and a 1
+    num = recorded_symbols(&s_recorded[0], symbols);
+    symbols[5].duration1 = 1120;
+    TEST_CHECK(ESP_ERR_INVALID_RESPONSE == ir_proto_decode(symbols, num, &frame), "nec space of no bit");
+
+    // the leader outside every margin
+    num = recorded_symbols(&s_recorded[3], symbols);
+    symbols[0].duration0 = 5200;
+    TEST_CHECK(ESP_ERR_NOT_FOUND == ir_proto_decode(symbols, num, &frame), "samsung leader too long");
+
+    // a manchester half of a length no unit has
+    num = recorded_symbols(&s_recorded[9], symbols);
+    symbols[6].duration0 = 680;
+    err = ir_proto_decode(symbols, num, &frame);
+    TEST_CHECK(ESP_OK != err, "rc6 half of 680us decoded");
+
+    // every recorded capture cut in half
+    for (i = 0; i < RECORDED_CNT; i++) {
+        num = recorded_symbols(&s_recorded[i], symbols);
+        if (num < 4) {
+            continue;
+        }
+        symbols[num / 2 - 1].duration1 = 0;
+        memset(&frame, 0, sizeof(frame));
+        err = ir_proto_decode(symbols, num / 2, &frame);
+        TEST_CHECK(ESP_OK != err, "%s: half a capture decoded as %s, address 0x%X, command 0x%X", s_recorded[i].name,
+                   ir_proto_name(frame.protocol), frame.address, frame.command);
+    }
+}
+
+// an air conditioner sends its state twice, a 40ms gap between the copies, longer than one rmt duration at 1MHz
+// 3400/1700 leader, 420 marks, 430 and 1270 spaces, the run of 0 bits in the middle packs into run bytes
+static size_t ac_durations(uint16_t *durations)
+{
+    const uint8_t state[AC_BITS / 8] = {0xC4, 0xD3, 0x64, 0x80, 0x00, 0x00, 0x00, 0x24};
+    size_t n = 0;
+    int copy = 0, i = 0;
+
+    for (copy = 0; copy < 2; copy++) {
+        if (0 == copy) {
+            durations[n++] = 3400;
+            durations[n++] = 1700;
+        }
+        for (i = 0; i < AC_BITS; i++) {
+            durations[n++] = 420;
+            durations[n++] = (state[i / 8] >> (7 - i % 8)) & 1 ? 1270 : 430;
+        }
+        durations[n++] = 420;
+        if (0 == copy) {
+            durations[n++] = 40000;
+        }
+    }
+    return n; // the last mark ends the frame, the packed frame gives it a 0 space
+}
+
+static void test_raw_pack(void)
+{
+    uint16_t durations[AC_DURATIONS] = {0};
+    uint16_t widths[IR_RAW_WIDTHS_MAX + 1] = {0};
+    uint8_t packed[256] = {0};
+    size_t num = ac_durations(durations), len = 0;
+    int i = 0;
+
+    TEST_CHECK(AC_DURATIONS == num, "%zu durations", num);
+    len = ir_raw_pack(durations, num, packed, sizeof(packed));
+    // 7 widths, a byte for each of the 129 symbols less the runs
+    TEST_CHECK(len > 0 && len < 1 + 7 * 2 + num / 2, "packed into %zu bytes", len);
+    TEST_CHECK(7 == packed[0], "%u widths", packed[0]);
+    TEST_CHECK(num == ir_raw_count(packed, len), "%zu durations unpacked", ir_raw_count(packed, len));
+    TEST_CHECK(0 == ir_raw_pack(durations, num, packed, len - 1), "packed into one byte less");
+    TEST_CHECK(0 == ir_raw_pack(durations, num, packed, 1 + 7 * 2), "packed into the width table alone");
+    TEST_CHECK(0 == ir_raw_count(packed, 1 + 7 * 2 - 1), "width table cut");
+    TEST_CHECK(0 == ir_raw_count((const uint8_t[]) {0}, 1), "no widths");
+    TEST_CHECK(0 == ir_raw_count((const uint8_t[]) {IR_RAW_WIDTHS_MAX + 1}, 1 + 2 * (IR_RAW_WIDTHS_MAX + 1)), "16 widths");
+
+    // 15 widths fit with the 0 space of an odd count, 16 do not
+    for (i = 0; i < IR_RAW_WIDTHS_MAX; i++) {
+        widths[i] = 500 + 10 * i;
+    }
+    TEST_CHECK(0 == ir_raw_pack(widths, IR_RAW_WIDTHS_MAX, packed, sizeof(packed)), "15 widths and the 0 space");
+    len = ir_raw_pack(widths, IR_RAW_WIDTHS_MAX - 1, packed, sizeof(packed));
+    TEST_CHECK(IR_RAW_WIDTHS_MAX - 1 == ir_raw_count(packed, len), "14 widths unpacked");
+    widths[IR_RAW_WIDTHS_MAX] = 700;
+    TEST_CHECK(0 == ir_raw_pack(widths, IR_RAW_WIDTHS_MAX + 1, packed, sizeof(packed)), "16 widths");
+}
+
+// the halves the rmt has to send for these durations, level 1 - mark, long ones split at 0x7FFF ticks
+static size_t expected_halves(const uint16_t *durations, size_t num, uint32_t resolution, rmt_symbol_word_t *halves)
+{
+    uint32_t ticks = 0;
+    size_t i = 0, n = 0;
+
+    for (i = 0; i < num; i++) {
+        ticks = ((uint64_t)durations[i] * resolution + 500000) / 1000000;
+        while (ticks) {
+            halves[n].level0 = !(i & 1);
+            halves[n].duration0 = ticks > 0x7FFF ? 0x7FFF : ticks;
+            ticks -= halves[n++].duration0;
+        }
+    }
+    return n;
+}
+
+// a packed frame sent through the raw encoder comes out of the rmt with the durations it was packed from
+static void test_raw_encoder(uint32_t resolution)
+{
+    rmt_tx_channel_config_t config = {
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = resolution,
+        .mem_block_symbols = TX_MEM_SYMBOLS,
+        .trans_queue_depth = 4,
+    };
+    rmt_transmit_config_t transmit_config = {0};
+    rmt_channel_handle_t channel = NULL;
+    rmt_encoder_handle_t encoder = NULL;
+    const host_rmt_tx_frame_t *frames = NULL;
+    const rmt_symbol_word_t *symbols = NULL;
+    rmt_symbol_word_t expected[AC_HALVES_MAX] = {0};
+    rmt_symbol_word_t half = {0};
+    uint16_t durations[AC_DURATIONS] = {0};
+    uint8_t packed[256] = {0};
+    size_t num = ac_durations(durations), len = 0, halves = 0, i = 0, j = 0, bad = 0;
+    uint32_t frame_num = 0, send = 0, refills = 0;
+
+    TEST_CHECK(ESP_OK == rmt_new_tx_channel(&config, &channel), "tx channel");
+    TEST_CHECK(ESP_OK == rmt_new_ir_raw_encoder(resolution, &encoder), "raw encoder");
+    if (NULL == channel || NULL == encoder) {
+        return;
+    }
+    len = ir_raw_pack(durations, num, packed, sizeof(packed));
+    halves = expected_halves(durations, num, resolution, expected);
+    host_rmt_tx_reset();
+    // twice, the encoder starts over after a complete frame
+    for (send = 0; send < 2; send++) {
+        rmt_transmit(channel, encoder, packed, len, &transmit_config);
+    }
+    rmt_tx_wait_all_done(channel, -1);
+
+    frame_num = host_rmt_tx_frames(&frames, &symbols);
+    TEST_CHECK(2 == frame_num, "%u frames", frame_num);
+    for (send = 0; send < frame_num && send < 2; send++) {
+        // the whole memory first, then half of it after each refill
+        refills = (frames[send].num - TX_MEM_SYMBOLS + TX_MEM_SYMBOLS / 2 - 1) / (TX_MEM_SYMBOLS / 2);
+        TEST_CHECK(frames[send].num == (halves + 1) / 2, "%u MHz frame %u: %u symbols for %zu halves", resolution / 1000000, send,
+                   frames[send].num, halves);
+        TEST_CHECK(refills > 0 && frames[send].refills == refills, "%u MHz frame %u: %u refills, %u expected",
+                   resolution / 1000000, send, frames[send].refills, refills);
+        bad = 0;
+        for (i = 0; i < 2 * (size_t)frames[send].num; i++) {
+            j = frames[send].first + i / 2;
+            half.level0 = i & 1 ? symbols[j].level1 : symbols[j].level0;
+            half.duration0 = i & 1 ? symbols[j].duration1 : symbols[j].duration0;
+            if (i < halves ? half.val != expected[i].val : 0 != half.duration0) {
+                if (bad++ < 4) {
+                    printf("%u MHz frame %u half %zu: level %u %u ticks, expected level %u %u\n", resolution / 1000000, send,
+                           i, half.level0, half.duration0, expected[i].level0, expected[i].duration0);
+                }
+            }
+        }
+        TEST_CHECK(0 == bad, "%u MHz frame %u: %zu halves off", resolution / 1000000, send, bad);
+    }
+    rmt_del_encoder(encoder);
+    rmt_del_channel(channel);
+}
+
+static void bench_decode(void)
+{
+    rmt_symbol_word_t symbols[SYMBOLS_MAX] = {0};
+    const rmt_symbol_word_t noise[] = {{.duration0 = 310, .duration1 = 290}, {.duration0 = 330, .duration1 = 0}};
+    ir_proto_frame_t frame = {0};
+    int64_t start = 0;
+    size_t i = 0, num = 0;
+    uint32_t j = 0, decoded = 0;
+
+    for (i = 0; i < RECORDED_CNT; i++) {
+        num = recorded_symbols(&s_recorded[i], symbols);
+        decoded = 0;
+        start = esp_timer_get_time();
+        for (j = 0; j < BENCH_CNT; j++) {
+            decoded += ESP_OK == ir_proto_decode(symbols, num, &frame);
+        }
+        bench_report(s_recorded[i].name, BENCH_CNT, start);
+        TEST_CHECK(BENCH_CNT == decoded, "%s: %u of %u decoded", s_recorded[i].name, decoded, BENCH_CNT);
+    }
+    decoded = 0;
+    start = esp_timer_get_time();
+    for (j = 0; j < BENCH_CNT; j++) {
+        decoded += ESP_ERR_NOT_FOUND == ir_proto_decode(noise, 2, &frame);
+    }
+    bench_report("noise", BENCH_CNT, start);
+    TEST_CHECK(BENCH_CNT == decoded, "noise: %u of %u turned away", decoded, BENCH_CNT);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && 0 == strcmp(argv[1], "bench")) {
+        bench_decode();
+        return test_result("ir_proto_bench");
+    }
+    test_recorded();
+    test_stream();
+    test_damaged();
+    test_raw_pack();
+    test_raw_encoder(1000000);
+    test_raw_encoder(10000000);
+    return test_result("ir_proto");
+}
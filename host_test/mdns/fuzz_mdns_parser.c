@@ -0,0 +1,287 @@
+// mdns_parser.c against untrusted packets, every entry point on every name, the way mdns.c walks a message
+//
+//   fuzz_mdns_parser                 one message from stdin, for afl-fuzz without @@
+//   fuzz_mdns_parser <file>...       every file once, for afl-fuzz with @@ and for replaying a crash
+//   fuzz_mdns_parser mutate <n>      the seeds, then n random mutations of them, HOST_FUZZ_SEED picks the sequence
+//   fuzz_mdns_parser corpus <dir>    writes the seeds as the starting corpus of afl-fuzz or libFuzzer
+//   fuzz_mdns_parser bench           parse throughput of a typical response
+//
+// with -DHOST_TEST_LIBFUZZER=ON and clang only LLVMFuzzerTestOneInput is built, libFuzzer brings main
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mdns.h"
+#include "mdns_parser.h"
+#include "host_test.h"
+
+#define FUZZ_MAX_LEN        1500 // an ethernet frame, the mdns sockets never read more
+#define BENCH_CNT           100000
+
+typedef struct {
+    const char *name;
+    const uint8_t *buf;
+    uint16_t len;
+} fuzz_seed_t;
+
+// query PTR _http._tcp.local, unicast response requested
+static const uint8_t s_query_ptr[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x05, 0x5f, 0x68, 0x74, 0x74, 0x70, 0x04, 0x5f, 0x74, 0x63, 0x70, 0x05,
+    0x6c, 0x6f, 0x63, 0x61, 0x6c, 0x00, 0x00, 0x0c, 0x80, 0x01,
+};
+
+// PTR, SRV, TXT and A of esp32._http._tcp.local, every name after the first compressed
+static const uint8_t s_response[] = {
+    0x00, 0x00, 0x84, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x03,
+    0x05, 0x5f, 0x68, 0x74, 0x74, 0x70, 0x04, 0x5f, 0x74, 0x63, 0x70, 0x05,
+    0x6c, 0x6f, 0x63, 0x61, 0x6c, 0x00, 0x00, 0x0c, 0x00, 0x01, 0x00, 0x00,
+    0x11, 0x94, 0x00, 0x08, 0x05, 0x65, 0x73, 0x70, 0x33, 0x32, 0xc0, 0x0c,
+    0xc0, 0x28, 0x00, 0x21, 0x80, 0x01, 0x00, 0x00, 0x00, 0x78, 0x00, 0x13,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x50, 0x05, 0x65, 0x73, 0x70, 0x33, 0x32,
+    0x05, 0x6c, 0x6f, 0x63, 0x61, 0x6c, 0x00, 0xc0, 0x28, 0x00, 0x10, 0x80,
+    0x01, 0x00, 0x00, 0x11, 0x94, 0x00, 0x10, 0x06, 0x70, 0x61, 0x74, 0x68,
+    0x3d, 0x2f, 0x07, 0x76, 0x65, 0x72, 0x73, 0x69, 0x6f, 0x6e, 0x00, 0xc0,
+    0x42, 0x00, 0x01, 0x80, 0x01, 0x00, 0x00, 0x00, 0x78, 0x00, 0x04, 0xc0,
+    0xa8, 0x00, 0x8b,
+};
+
+// AAAA esp32.local and ANY host.esp32.local, the second name ends in a pointer to the first
+static const uint8_t s_query_two[] = {
+    0x12, 0x34, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x05, 0x65, 0x73, 0x70, 0x33, 0x32, 0x05, 0x6c, 0x6f, 0x63, 0x61, 0x6c,
+    0x00, 0x00, 0x1c, 0x00, 0x01, 0x04, 0x68, 0x6f, 0x73, 0x74, 0xc0, 0x0c,
+    0x00, 0xff, 0x00, 0x01,
+};
+
+// a record whose name points at itself
+static const uint8_t s_loop[] = {
+    0x00, 0x00, 0x84, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+    0xc0, 0x0c, 0x00, 0x0c, 0x00, 0x01, 0x00, 0x00, 0x00, 0x78, 0x00, 0x00,
+};
+
+static const fuzz_seed_t s_seeds[] = {
+    {"query_ptr", s_query_ptr, sizeof(s_query_ptr)},
+    {"response", s_response, sizeof(s_response)},
+    {"query_two", s_query_two, sizeof(s_query_two)},
+    {"loop", s_loop, sizeof(s_loop)},
+};
+
+// every accessor on a validated name, a short buffer too so the truncation path runs
+static void fuzz_name(const mdns_name_t *name, char *str, uint32_t size)
+{
+    static const char *labels[] = {"_http", "_tcp", "local"};
+    const uint8_t *label = NULL;
+    uint8_t label_len = 0;
+    char shortstr[8] = {0};
+
+    mdns_name_to_str(name, str, size);
+    mdns_name_to_str(name, shortstr, sizeof(shortstr));
+    mdns_name_equal_str(name, "_http._tcp.local");
+    mdns_name_equal_str(name, "");
+    mdns_name_equal_labels(name, labels, 3);
+    mdns_name_first_label(name, &label, &label_len);
+}
+
+// returns the number of records decoded, the checks on the seeds use it
+static uint32_t fuzz_message(const uint8_t *buf, uint16_t len, char *last, uint32_t size)
+{
+    mdns_cursor_t cur = {0};
+    mdns_header_t header = {0};
+    mdns_question_t question = {0};
+    mdns_name_t target = {0};
+    mdns_rr_t rr = {0};
+    uint32_t i = 0, cnt = 0;
+
+    if (ESP_OK != mdns_parse_header(&cur, buf, len, &header)) {
+        return 0;
+    }
+    for (i = 0; i < header.question_cnt; i++) {
+        if (ESP_OK != mdns_parse_question(&cur, &question)) {
+            return cnt;
+        }
+        fuzz_name(&question.name, last, size);
+        cnt++;
+    }
+    for (i = 0; i < (uint32_t)header.answer_cnt + header.authority_cnt + header.additional_cnt; i++) {
+        if (ESP_OK != mdns_parse_rr(&cur, &rr)) {
+            return cnt;
+        }
+        fuzz_name(&rr.name, last, size);
+        if (MDNS_QUERY_TYPE_PTR == rr.type && ESP_OK == mdns_parse_rdata_name(&cur, &rr, 0, &target)) {
+            fuzz_name(&target, last, size);
+        }
+        if (MDNS_QUERY_TYPE_SRV == rr.type && rr.rdata_len >= 7 && ESP_OK == mdns_parse_rdata_name(&cur, &rr, 6, &target)) {
+            fuzz_name(&target, last, size);
+        }
+        mdns_parse_rdata_name(&cur, &rr, rr.rdata_len / 2, &target); // any offset inside rdata must be safe
+        cnt++;
+    }
+    return cnt;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    char str[MDNS_NAME_MAX_WIRE_LEN + 1] = {0};
+    uint8_t *buf = NULL;
+
+    if (size > FUZZ_MAX_LEN) {
+        return 0;
+    }
+    // a copy of the exact length, so AddressSanitizer sees the first byte read past the end
+    buf = malloc(size ? size : 1);
+    memcpy(buf, data, size);
+    fuzz_message(buf, size, str, sizeof(str));
+    free(buf);
+    return 0;
+}
+
+#ifndef HOST_LIBFUZZER
+// the seeds must decode as written, otherwise the mutations start from garbage
+static void check_seeds(void)
+{
+    char str[MDNS_NAME_MAX_WIRE_LEN + 1] = {0};
+
+    TEST_CHECK(1 == fuzz_message(s_query_ptr, sizeof(s_query_ptr), str, sizeof(str)) &&
+               0 == strcmp(str, "_http._tcp.local"), "query_ptr: %s", str);
+    TEST_CHECK(4 == fuzz_message(s_response, sizeof(s_response), str, sizeof(str)) &&
+               0 == strcmp(str, "esp32.local"), "response: %s", str);
+    TEST_CHECK(2 == fuzz_message(s_query_two, sizeof(s_query_two), str, sizeof(str)) &&
+               0 == strcmp(str, "host.esp32.local"), "query_two: %s", str);
+    TEST_CHECK(0 == fuzz_message(s_loop, sizeof(s_loop), str, sizeof(str)), "pointer loop accepted");
+}
+
+// bit flips, random and boundary bytes, compression pointers, cuts and repeated chunks
+static uint16_t mutate(uint8_t *buf, uint16_t len)
+{
+    static const uint8_t special[] = {0x00, 0x01, 0x3f, 0x40, 0x7f, 0x80, 0xc0, 0xff};
+    uint32_t n = 1 + rand() % 4, pos = 0, chunk = 0;
+
+    while (n-- && len) {
+        pos = rand() % len;
+        switch (rand() % 6) {
+        case 0:
+            buf[pos] ^= 1 << (rand() % 8);
+            break;
+        case 1:
+            buf[pos] = rand();
+            break;
+        case 2:
+            buf[pos] = special[rand() % sizeof(special)];
+            break;
+        case 3:
+            if (pos + 1 < len) { // pointer anywhere in the message
+                buf[pos] = 0xc0 | (rand() % 2);
+                buf[pos + 1] = rand() % len;
+            }
+            break;
+        case 4:
+            len = pos;
+            break;
+        default:
+            chunk = 1 + rand() % 16;
+            if (chunk > len - pos) {
+                chunk = len - pos;
+            }
+            if (len + chunk <= FUZZ_MAX_LEN) {
+                memmove(&buf[pos + chunk], &buf[pos], len - pos);
+                len += chunk;
+            }
+            break;
+        }
+    }
+    return len;
+}
+
+static void fuzz_mutate(uint32_t runs)
+{
+    static uint8_t buf[FUZZ_MAX_LEN];
+    const char *env = getenv("HOST_FUZZ_SEED");
+    unsigned int seed = env ? strtoul(env, NULL, 0) : 1;
+    const fuzz_seed_t *from = NULL;
+    uint16_t len = 0;
+    uint32_t i = 0;
+
+    srand(seed);
+    for (i = 0; i < runs; i++) {
+        from = &s_seeds[rand() % (sizeof(s_seeds) / sizeof(s_seeds[0]))];
+        memcpy(buf, from->buf, from->len);
+        len = mutate(buf, from->len);
+        LLVMFuzzerTestOneInput(buf, len);
+    }
+    printf("%lu mutated messages, HOST_FUZZ_SEED=%u\n", runs, seed);
+}
+
+static int write_corpus(const char *dir)
+{
+    char path[256] = {0};
+    FILE *fp = NULL;
+    uint32_t i = 0;
+
+    for (i = 0; i < sizeof(s_seeds) / sizeof(s_seeds[0]); i++) {
+        snprintf(path, sizeof(path), "%s/%s", dir, s_seeds[i].name);
+        fp = fopen(path, "wb");
+        if (!fp) {
+            printf("cannot write %s\n", path);
+            return 1;
+        }
+        fwrite(s_seeds[i].buf, 1, s_seeds[i].len, fp);
+        fclose(fp);
+    }
+    return 0;
+}
+
+static int run_file(FILE *fp)
+{
+    static uint8_t buf[FUZZ_MAX_LEN + 1];
+    size_t len = fread(buf, 1, sizeof(buf), fp);
+
+    return LLVMFuzzerTestOneInput(buf, len);
+}
+
+// the whole walk of the response the cache sees most, header, four records and their names
+static void bench_parser(void)
+{
+    char str[MDNS_NAME_MAX_WIRE_LEN + 1] = {0};
+    int64_t start = esp_timer_get_time(), cost = 0;
+    uint32_t i = 0;
+
+    for (i = 0; i < BENCH_CNT; i++) {
+        fuzz_message(s_response, sizeof(s_response), str, sizeof(str));
+    }
+    cost = esp_timer_get_time() - start;
+    bench_report("parse response", BENCH_CNT, start);
+    printf("bench %-24s %10.1f MB/s\n", "parse response", (double)BENCH_CNT * sizeof(s_response) / (cost ? cost : 1));
+}
+
+int main(int argc, char **argv)
+{
+    FILE *fp = NULL;
+    int i = 0;
+
+    if (argc < 2) {
+        return run_file(stdin);
+    }
+    if (0 == strcmp(argv[1], "mutate")) {
+        check_seeds();
+        fuzz_mutate(argc > 2 ? strtoul(argv[2], NULL, 0) : 100000);
+        return test_result("mdns_parser_fuzz");
+    }
+    if (0 == strcmp(argv[1], "corpus")) {
+        return write_corpus(argc > 2 ? argv[2] : ".");
+    }
+    if (0 == strcmp(argv[1], "bench")) {
+        bench_parser();
+        return 0;
+    }
+    for (i = 1; i < argc; i++) {
+        fp = fopen(argv[i], "rb");
+        if (!fp) {
+            printf("cannot read %s\n", argv[i]);
+            return 1;
+        }
+        run_file(fp);
+        fclose(fp);
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,707 @@
+// mdns/main/mdns.c on lo, the test plays the other hosts of the link from 127.0.0.2
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "mdns.h"
+#include "mdns_parser.h"
+#include "host_test.h"
+
+#define PEER_IP             "127.0.0.2"
+#define STATS_THREADS       4
+#define STATS_QUERIES       5000
+#define ASYNC_QUERIES       4
+#define BROWSE_TYPE         "_hosttest._tcp.local"
+#define BROWSE_TTL          2 // seconds, shorter than the second backoff step
+#define BROWSE_REFRESHES    4 // maintenance queries at 80%, 85%, 90% and 95% of the TTL
+#define REPLAY_TYPE         "_replay._tcp.local"
+#define REPLAY_INS          "replay._replay._tcp.local"
+#define LEGACY_TTL          2 // seconds, stands in for the 10s cap of legacy unicast answers (RFC 6762 6.7)
+#define LEGACY_NAMES        3
+#define STORM_CLIENTS       4
+#define STORM_CLIENT_QUERIES 50
+#define STORM_QU_QUERIES    1000
+
+typedef struct {
+    uint8_t buf[1024];
+    uint32_t len;
+} msg_t;
+
+typedef struct {
+    uint32_t cnt;
+    uint32_t id;
+    esp_err_t err;
+    int64_t done_time;
+    mdns_result_t result;
+} query_ctx_t;
+
+static int s_peer_rx = -1; // 0.0.0.0:5353 in the group, every multicast of the link
+static int s_peer_tx = -1; // 127.0.0.2:5353, its own packets are told apart by the address
+
+static void msg_u16(msg_t *msg, uint16_t value)
+{
+    msg->buf[msg->len++] = value >> 8;
+    msg->buf[msg->len++] = value;
+}
+
+static void msg_header(msg_t *msg, uint16_t flags, uint16_t question_cnt, uint16_t answer_cnt)
+{
+    msg->len = 0;
+    msg_u16(msg, 0);
+    msg_u16(msg, flags);
+    msg_u16(msg, question_cnt);
+    msg_u16(msg, answer_cnt);
+    msg_u16(msg, 0);
+    msg_u16(msg, 0);
+}
+
+static void msg_name(msg_t *msg, const char *name)
+{
+    const char *dot = NULL;
+
+    while (*name) {
+        dot = strchr(name, '.');
+        if (!dot) {
+            dot = name + strlen(name);
+        }
+        msg->buf[msg->len++] = dot - name;
+        memcpy(&msg->buf[msg->len], name, dot - name);
+        msg->len += dot - name;
+        name = *dot ? dot + 1 : dot;
+    }
+    msg->buf[msg->len++] = 0;
+}
+
+static void msg_rr(msg_t *msg, const char *name, uint16_t type, uint32_t ttl, const void *rdata, uint16_t rdata_len)
+{
+    msg_name(msg, name);
+    msg_u16(msg, type);
+    msg_u16(msg, 0x8001); // class IN, cache flush
+    msg_u16(msg, ttl >> 16);
+    msg_u16(msg, ttl);
+    msg_u16(msg, rdata_len);
+    memcpy(&msg->buf[msg->len], rdata, rdata_len);
+    msg->len += rdata_len;
+}
+
+static int peer_socket(const char *ip, uint8_t join_group)
+{
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(MDNS_UPD_PORT)};
+    struct ip_mreq mreq = {0};
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    addr.sin_addr.s_addr = inet_addr(ip);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr))) {
+        printf("peer bind %s error:%d\n", ip, errno);
+        exit(1);
+    }
+    if (join_group) {
+        mreq.imr_multiaddr.s_addr = inet_addr(MDNS_UPD_IP);
+        setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq));
+    }
+    return fd;
+}
+
+static void peer_send(const msg_t *msg)
+{
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(MDNS_UPD_PORT)};
+
+    addr.sin_addr.s_addr = inet_addr(MDNS_UPD_IP);
+    sendto(s_peer_tx, msg->buf, msg->len, 0, (struct sockaddr *)&addr, sizeof(addr));
+}
+
+static void peer_send_to(const msg_t *msg, const struct sockaddr_in *addr)
+{
+    sendto(s_peer_tx, msg->buf, msg->len, 0, (const struct sockaddr *)addr, sizeof(*addr));
+}
+
+// next packet of somebody else within timeout_ms, 0 on timeout, from - sender, may be NULL
+static int peer_recv_from(msg_t *msg, int64_t timeout_ms, struct sockaddr_in *from)
+{
+    int64_t deadline = esp_timer_get_time() + timeout_ms * 1000, remain = 0;
+    struct sockaddr_in addr = {0};
+    socklen_t addr_len = 0;
+    struct timeval tv = {0};
+    fd_set rfds;
+    int fd = 0, len = 0;
+
+    while ((remain = deadline - esp_timer_get_time()) > 0) {
+        tv.tv_sec = remain / 1000000;
+        tv.tv_usec = remain % 1000000;
+        FD_ZERO(&rfds);
+        FD_SET(s_peer_rx, &rfds);
+        FD_SET(s_peer_tx, &rfds);
+        if (select(MAX(s_peer_rx, s_peer_tx) + 1, &rfds, NULL, NULL, &tv) <= 0) {
+            continue;
+        }
+        fd = FD_ISSET(s_peer_rx, &rfds) ? s_peer_rx : s_peer_tx;
+        addr_len = sizeof(addr);
+        len = recvfrom(fd, msg->buf, sizeof(msg->buf), 0, (struct sockaddr *)&addr, &addr_len);
+        if (len > 0 && addr.sin_addr.s_addr != inet_addr(PEER_IP)) {
+            msg->len = len;
+            if (from) {
+                memcpy(from, &addr, sizeof(addr));
+            }
+            return len;
+        }
+    }
+    return 0;
+}
+
+static int peer_recv(msg_t *msg, int64_t timeout_ms)
+{
+    return peer_recv_from(msg, timeout_ms, NULL);
+}
+
+// 1 if msg is a query asking for name and type
+static uint8_t msg_asks(const msg_t *msg, const char *name, uint16_t type)
+{
+    mdns_cursor_t cur = {0};
+    mdns_header_t header = {0};
+    mdns_question_t question = {0};
+    uint32_t i = 0;
+
+    if (ESP_OK != mdns_parse_header(&cur, msg->buf, msg->len, &header) || (header.flags & 0x8000)) {
+        return 0;
+    }
+    for (i = 0; i < header.question_cnt && ESP_OK == mdns_parse_question(&cur, &question); i++) {
+        if (type == question.type && mdns_name_equal_str(&question.name, name)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 1 if msg lists instance ins of its PTR question as a known answer with more than min_ttl left
+static uint8_t msg_knows(const msg_t *msg, const char *ins, uint32_t min_ttl)
+{
+    mdns_cursor_t cur = {0};
+    mdns_header_t header = {0};
+    mdns_question_t question = {0};
+    mdns_name_t target = {0};
+    mdns_rr_t rr = {0};
+    const uint8_t *label = NULL;
+    uint8_t label_len = 0;
+    uint32_t i = 0;
+
+    if (ESP_OK != mdns_parse_header(&cur, msg->buf, msg->len, &header)) {
+        return 0;
+    }
+    for (i = 0; i < header.question_cnt; i++) {
+        if (ESP_OK != mdns_parse_question(&cur, &question)) {
+            return 0;
+        }
+    }
+    for (i = 0; i < header.answer_cnt && ESP_OK == mdns_parse_rr(&cur, &rr); i++) {
+        if (MDNS_QUERY_TYPE_PTR != rr.type || rr.ttl <= min_ttl || ESP_OK != mdns_parse_rdata_name(&cur, &rr, 0, &target)) {
+            continue;
+        }
+        mdns_name_first_label(&target, &label, &label_len);
+        if (label_len == strlen(ins) && 0 == memcmp(label, ins, label_len)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void query_cb(uint32_t query_id, esp_err_t err, mdns_result_t *result, void *arg)
+{
+    query_ctx_t *ctx = (query_ctx_t *)arg;
+
+    ctx->err = err;
+    ctx->id = query_id;
+    ctx->done_time = esp_timer_get_time();
+    if (result) {
+        memcpy(&ctx->result, result, sizeof(mdns_result_t));
+    }
+    ctx->cnt++;
+}
+
+static void peer_announce_a(const char *name, uint32_t ttl, const uint8_t *ip)
+{
+    msg_t msg = {0};
+
+    msg_header(&msg, 0x8400, 0, 1);
+    msg_rr(&msg, name, MDNS_QUERY_TYPE_A, ttl, ip, 4);
+    peer_send(&msg);
+}
+
+// a record read from the cache is queried again at 80% of its TTL without another lookup, one never read is not
+static void test_cache_refresh(void)
+{
+    const uint8_t ip[4] = {192, 168, 0, 7};
+    char name[] = "refresh-host.local";
+    query_ctx_t ctx = {0};
+    msg_t msg = {0};
+    int64_t start = esp_timer_get_time(), refresh = 0, now = 0;
+    uint8_t cold = 0;
+
+    peer_announce_a(name, 2, ip);
+    peer_announce_a("cold-host.local", 2, ip);
+    vTaskDelay(pdMS_TO_TICKS(100));
+    TEST_CHECK(ESP_OK == mdns_query_async(name, MDNS_QUERY_TYPE_A, query_cb, &ctx, NULL), "query error");
+    TEST_CHECK(1 == ctx.cnt && ESP_OK == ctx.err && 0 == memcmp(ctx.result.data.a.ip, ip, 4), "announced record not cached");
+
+    while ((now = esp_timer_get_time()) - start < 2100 * 1000 && peer_recv(&msg, 2100 - (now - start) / 1000)) {
+        if (!refresh && msg_asks(&msg, name, MDNS_QUERY_TYPE_A)) {
+            refresh = esp_timer_get_time() - start;
+        }
+        cold |= msg_asks(&msg, "cold-host.local", MDNS_QUERY_TYPE_A);
+    }
+    TEST_CHECK(refresh >= 1500 * 1000 && refresh < 1900 * 1000, "refresh query %lld ms after the announcement, 1600 expected",
+               refresh / 1000);
+    TEST_CHECK(!cold, "a record nobody read was refreshed");
+}
+
+static void *stats_thread(void *arg)
+{
+    char name[] = "stats-host.local";
+    query_ctx_t ctx = {0};
+    uint32_t i = 0;
+
+    for (i = 0; i < STATS_QUERIES; i++) {
+        mdns_query_async(name, MDNS_QUERY_TYPE_A, query_cb, &ctx, NULL);
+    }
+    return NULL;
+}
+
+// hits counted from several tasks at once, none may be lost
+static void test_cache_stats(void)
+{
+    const uint8_t ip[4] = {192, 168, 0, 8};
+    pthread_t threads[STATS_THREADS];
+    uint32_t hit = 0, miss = 0, hit_now = 0, miss_now = 0, i = 0;
+
+    peer_announce_a("stats-host.local", 60, ip);
+    vTaskDelay(pdMS_TO_TICKS(100));
+    mdns_cache_get_stats(&hit, &miss);
+    for (i = 0; i < STATS_THREADS; i++) {
+        pthread_create(&threads[i], NULL, stats_thread, NULL);
+    }
+    for (i = 0; i < STATS_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    mdns_cache_get_stats(&hit_now, &miss_now);
+    TEST_CHECK(STATS_THREADS * STATS_QUERIES == hit_now - hit && miss_now == miss, "%u hits %u misses, %u hits expected",
+               hit_now - hit, miss_now - miss, STATS_THREADS * STATS_QUERIES);
+}
+
+// several names in flight at once: one response answers all of them in a single round trip,
+// and the unanswered ones time out together instead of one timeout after the other
+static void test_async_queries(void)
+{
+    char names[ASYNC_QUERIES][32] = {0};
+    char lost[2][32] = {"lost-1.local", "lost-2.local"};
+    query_ctx_t ctx[ASYNC_QUERIES] = {0}, lost_ctx[2] = {0};
+    uint32_t ids[ASYNC_QUERIES] = {0}, asked = 0, i = 0, j = 0;
+    struct sockaddr_in querier = {0};
+    uint8_t ip[4] = {10, 0, 0, 0};
+    msg_t msg = {0}, resp = {0};
+    int64_t start = esp_timer_get_time();
+
+    for (i = 0; i < 2; i++) {
+        TEST_CHECK(ESP_OK == mdns_query_async(lost[i], MDNS_QUERY_TYPE_A, query_cb, &lost_ctx[i], NULL), "query error");
+    }
+    for (i = 0; i < ASYNC_QUERIES; i++) {
+        snprintf(names[i], sizeof(names[i]), "async-%u.local", i);
+        TEST_CHECK(ESP_OK == mdns_query_async(names[i], MDNS_QUERY_TYPE_A, query_cb, &ctx[i], &ids[i]), "query error");
+        for (j = 0; j < i; j++) {
+            TEST_CHECK(ids[i] != ids[j], "query %u and %u share id %u", i, j, ids[i]);
+        }
+    }
+    // every query goes out on the link, the answer goes back to the port it came from
+    while (asked != (1 << ASYNC_QUERIES) - 1 && peer_recv_from(&msg, 500, &querier)) {
+        for (i = 0; i < ASYNC_QUERIES; i++) {
+            asked |= msg_asks(&msg, names[i], MDNS_QUERY_TYPE_A) << i;
+        }
+    }
+    TEST_CHECK((1 << ASYNC_QUERIES) - 1 == asked, "queries seen on the link:0x%x", asked);
+    msg_header(&resp, 0x8400, 0, ASYNC_QUERIES);
+    for (i = 0; i < ASYNC_QUERIES; i++) {
+        ip[3] = i + 1;
+        msg_rr(&resp, names[i], MDNS_QUERY_TYPE_A, 120, ip, 4);
+    }
+    peer_send_to(&resp, &querier);
+
+    vTaskDelay(pdMS_TO_TICKS(200));
+    for (i = 0; i < ASYNC_QUERIES; i++) {
+        TEST_CHECK(1 == ctx[i].cnt && ESP_OK == ctx[i].err && ids[i] == ctx[i].id && i + 1 == ctx[i].result.data.a.ip[3],
+                   "%s: %u callbacks, err:0x%x, ip .%u", names[i], ctx[i].cnt, ctx[i].err, ctx[i].result.data.a.ip[3]);
+        TEST_CHECK(ctx[i].done_time - start < 200 * 1000, "%s answered %lld ms after the first query", names[i],
+                   (ctx[i].done_time - start) / 1000);
+    }
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_MDNS_RECV_TIMEOUT));
+    for (i = 0; i < 2; i++) {
+        TEST_CHECK(1 == lost_ctx[i].cnt && ESP_ERR_TIMEOUT == lost_ctx[i].err, "%s: %u callbacks, err:0x%x", lost[i],
+                   lost_ctx[i].cnt, lost_ctx[i].err);
+        TEST_CHECK(lost_ctx[i].done_time - start < (CONFIG_MDNS_RECV_TIMEOUT + 200) * 1000, "%s timed out after %lld ms",
+                   lost[i], (lost_ctx[i].done_time - start) / 1000);
+    }
+}
+
+static volatile uint32_t s_browse_added = 0;
+static volatile uint32_t s_browse_removed = 0;
+
+static void browse_add_cb(mdns_ptr_t *instance, void *arg)
+{
+    s_browse_added++;
+}
+
+static void browse_remove_cb(mdns_ptr_t *instance, void *arg)
+{
+    s_browse_removed++;
+}
+
+// the peer is a responder of BROWSE_TYPE that answers a query unless it lists the instance with more than half TTL
+// left (RFC 6762 7.1), for run_ms, and counts the queries that reached it
+static uint32_t peer_browse_responder(const char *ins, uint32_t run_ms, uint8_t answer)
+{
+    char target[64] = {0};
+    msg_t msg = {0}, resp = {0}, rdata = {0};
+    int64_t start = esp_timer_get_time(), now = 0;
+    uint32_t queries = 0;
+
+    snprintf(target, sizeof(target), "%s.%s", ins, BROWSE_TYPE);
+    while ((now = esp_timer_get_time()) - start < run_ms * 1000LL && peer_recv(&msg, run_ms - (now - start) / 1000)) {
+        if (!msg_asks(&msg, BROWSE_TYPE, MDNS_QUERY_TYPE_PTR)) {
+            continue;
+        }
+        queries++;
+        if (!answer || msg_knows(&msg, ins, BROWSE_TTL / 2)) {
+            continue;
+        }
+        msg_header(&resp, 0x8400, 0, 1);
+        rdata.len = 0;
+        msg_name(&rdata, target);
+        msg_rr(&resp, BROWSE_TYPE, MDNS_QUERY_TYPE_PTR, BROWSE_TTL, rdata.buf, rdata.len);
+        peer_send(&resp);
+    }
+    return queries;
+}
+
+// a live instance is queried before its TTL runs out even when the backoff has stretched the query interval,
+// and it is removed once it stops answering its maintenance queries
+static void test_browse_maintenance(void)
+{
+    uint32_t queries = 0;
+
+    TEST_CHECK(ESP_OK == mdns_browse_start("_hosttest", "_tcp", browse_add_cb, browse_remove_cb, NULL), "browse start error");
+    peer_browse_responder("dev1", 5000, 1);
+    TEST_CHECK(1 == s_browse_added && 0 == s_browse_removed, "answering instance, %u added %u removed",
+               s_browse_added, s_browse_removed);
+    queries = peer_browse_responder("dev1", BROWSE_TTL * 1000 + 500, 0);
+    TEST_CHECK(1 == s_browse_removed, "silent instance, %u removed", s_browse_removed);
+    TEST_CHECK(queries >= BROWSE_REFRESHES, "silent instance, %u queries before its removal", queries);
+    mdns_browse_stop("_hosttest", "_tcp");
+}
+
+// query from port 5353, known - an instance of name to list as a known answer with a full TTL, or NULL
+static void peer_query(const char *name, uint16_t type, const char *known)
+{
+    char target[64] = {0};
+    msg_t msg = {0}, rdata = {0};
+
+    msg_header(&msg, 0, 1, known ? 1 : 0);
+    msg_name(&msg, name);
+    msg_u16(&msg, type);
+    msg_u16(&msg, 0x0001); // class IN, multicast response
+    if (known) {
+        snprintf(target, sizeof(target), "%s.%s", known, name);
+        msg_name(&rdata, target);
+        msg_rr(&msg, name, MDNS_QUERY_TYPE_PTR, CONFIG_MDNS_TTL, rdata.buf, rdata.len);
+    }
+    peer_send(&msg);
+}
+
+// responses of the component within ms, first - ms from start to the first one, answers - answers in the first one
+static uint32_t peer_count_responses(int64_t start, uint32_t ms, int64_t *first, uint32_t *answers)
+{
+    mdns_cursor_t cur = {0};
+    mdns_header_t header = {0};
+    msg_t msg = {0};
+    int64_t now = 0, end = esp_timer_get_time() + ms * 1000LL;
+    uint32_t cnt = 0;
+
+    while ((now = esp_timer_get_time()) < end && peer_recv(&msg, (end - now + 999) / 1000)) {
+        if (ESP_OK != mdns_parse_header(&cur, msg.buf, msg.len, &header) || !(header.flags & 0x8000)) {
+            continue;
+        }
+        if (!cnt++) {
+            *first = (esp_timer_get_time() - start) / 1000;
+            *answers = header.answer_cnt;
+        }
+    }
+    return cnt;
+}
+
+// one record of a recorded burst, ms after the first query
+typedef struct {
+    uint32_t at_ms;
+    uint16_t type;
+    const char *name;
+} replay_query_t;
+
+// a burst of queries recorded on a busy link: hosts waking up together all browse for the same type
+static const replay_query_t s_burst[] = {
+    {0, MDNS_QUERY_TYPE_PTR, REPLAY_TYPE},
+    {3, MDNS_QUERY_TYPE_PTR, REPLAY_TYPE},
+    {7, MDNS_QUERY_TYPE_PTR, REPLAY_TYPE},
+    {10, MDNS_QUERY_TYPE_SRV, REPLAY_INS},
+    {12, MDNS_QUERY_TYPE_PTR, REPLAY_TYPE},
+    {20, MDNS_QUERY_TYPE_PTR, REPLAY_TYPE},
+    {35, MDNS_QUERY_TYPE_PTR, REPLAY_TYPE},
+};
+
+// the responder delays shared answers by 20~120ms and merges the queries of that window into one response,
+// multicasts a record at most once a second, and stays quiet for answers the querier or another responder has
+static void test_responder_replay(void)
+{
+    mdns_server_stats_t before = {0}, after = {0};
+    mdns_a_t ip = {{7, 0, 168, 192}};
+    mdns_txt_t txt = {"path", "/"};
+    uint32_t cnt = 0, answers = 0, i = 0, burst_cnt = sizeof(s_burst) / sizeof(s_burst[0]);
+    int64_t start = 0, first = 0;
+    msg_t msg = {0}, rdata = {0};
+
+    TEST_CHECK(ESP_OK == mdns_add_srv("replay", "_replay", "_tcp", 80, &ip, NULL, &txt, 1), "add service error");
+    mdns_start_server();
+    mdns_server_get_stats(&before);
+
+    start = esp_timer_get_time();
+    for (i = 0; i < burst_cnt; i++) {
+        while (esp_timer_get_time() - start < s_burst[i].at_ms * 1000LL) {
+            vTaskDelay(1);
+        }
+        peer_query(s_burst[i].name, s_burst[i].type, NULL);
+    }
+    cnt = peer_count_responses(start, 300, &first, &answers);
+    mdns_server_get_stats(&after);
+    TEST_CHECK(1 == cnt && 2 == answers, "burst, %u responses, %u answers in the first", cnt, answers);
+    TEST_CHECK(first >= CONFIG_MDNS_RESP_DELAY_MIN && first < CONFIG_MDNS_RESP_DELAY_MAX + 40, "burst answered after %lld ms",
+               first);
+    TEST_CHECK(burst_cnt - 1 == after.query_aggregated - before.query_aggregated, "burst, %u queries aggregated",
+               after.query_aggregated - before.query_aggregated);
+
+    // the PTR went out less than a second ago
+    before = after;
+    peer_query(REPLAY_TYPE, MDNS_QUERY_TYPE_PTR, NULL);
+    cnt = peer_count_responses(esp_timer_get_time(), 300, &first, &answers);
+    mdns_server_get_stats(&after);
+    TEST_CHECK(0 == cnt && 1 == after.record_rate_limited - before.record_rate_limited, "repeat, %u responses, %u rate limited",
+               cnt, after.record_rate_limited - before.record_rate_limited);
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_MDNS_MULTICAST_INTERVAL));
+
+    // the querier has it already
+    before = after;
+    peer_query(REPLAY_TYPE, MDNS_QUERY_TYPE_PTR, "replay");
+    cnt = peer_count_responses(esp_timer_get_time(), 300, &first, &answers);
+    mdns_server_get_stats(&after);
+    TEST_CHECK(0 == cnt && 1 == after.record_suppressed - before.record_suppressed, "known answer, %u responses, %u suppressed",
+               cnt, after.record_suppressed - before.record_suppressed);
+
+    // another responder multicasts the same answer during the delay
+    before = after;
+    peer_query(REPLAY_TYPE, MDNS_QUERY_TYPE_PTR, NULL);
+    vTaskDelay(pdMS_TO_TICKS(5));
+    msg_header(&msg, 0x8400, 0, 1);
+    msg_name(&rdata, REPLAY_INS);
+    msg_rr(&msg, REPLAY_TYPE, MDNS_QUERY_TYPE_PTR, CONFIG_MDNS_TTL, rdata.buf, rdata.len);
+    peer_send(&msg);
+    cnt = peer_count_responses(esp_timer_get_time(), 300, &first, &answers);
+    mdns_server_get_stats(&after);
+    TEST_CHECK(0 == cnt && 1 == after.record_suppressed - before.record_suppressed, "answered by another, %u responses, %u suppressed",
+               cnt, after.record_suppressed - before.record_suppressed);
+
+    // and a plain query once the second is over
+    before = after;
+    peer_query(REPLAY_TYPE, MDNS_QUERY_TYPE_PTR, NULL);
+    cnt = peer_count_responses(esp_timer_get_time(), 300, &first, &answers);
+    mdns_server_get_stats(&after);
+    TEST_CHECK(1 == cnt && 1 == after.resp_sent - before.resp_sent, "plain query, %u responses", cnt);
+}
+
+// a one-shot query gets a legacy unicast answer with a capped TTL and extra records, nothing is asked again until
+// they are read, then the read ones go out together in one multicast query from port 5353 at 80% of the capped TTL
+static void test_legacy_ttl(void)
+{
+    char names[LEGACY_NAMES][32] = {"legacy-1.local", "legacy-2.local", "legacy-3.local"};
+    uint8_t ip[4] = {192, 168, 0, 9};
+    struct sockaddr_in querier = {0};
+    query_ctx_t ctx = {0};
+    msg_t msg = {0}, resp = {0};
+    int64_t start = esp_timer_get_time(), now = 0, legacy_time = 0, refresh = 0;
+    uint32_t queries = 0, i = 0;
+    uint8_t asked = 0;
+
+    TEST_CHECK(ESP_OK == mdns_query_async(names[0], MDNS_QUERY_TYPE_A, query_cb, &ctx, NULL), "query error");
+    while (!legacy_time && (now = esp_timer_get_time()) - start < 1000 * 1000 &&
+           peer_recv_from(&msg, 1000 - (now - start) / 1000, &querier)) {
+        if (!msg_asks(&msg, names[0], MDNS_QUERY_TYPE_A) || MDNS_UPD_PORT == ntohs(querier.sin_port)) {
+            continue;
+        }
+        msg_header(&resp, 0x8400, 0, LEGACY_NAMES);
+        for (i = 0; i < LEGACY_NAMES; i++) {
+            ip[3] = 9 + i;
+            msg_rr(&resp, names[i], MDNS_QUERY_TYPE_A, LEGACY_TTL, ip, 4);
+        }
+        peer_send_to(&resp, &querier);
+        legacy_time = esp_timer_get_time();
+    }
+    vTaskDelay(pdMS_TO_TICKS(100));
+    TEST_CHECK(1 == ctx.cnt && ESP_OK == ctx.err, "legacy query, %u callbacks, err:0x%x", ctx.cnt, ctx.err);
+
+    // read the first two again, the third one stays cold
+    for (i = 0; i < 2; i++) {
+        memset(&ctx, 0, sizeof(ctx));
+        TEST_CHECK(ESP_OK == mdns_query_async(names[i], MDNS_QUERY_TYPE_A, query_cb, &ctx, NULL) && 1 == ctx.cnt &&
+                   ESP_OK == ctx.err && 9 + i == ctx.result.data.a.ip[3], "%s not cached", names[i]);
+    }
+    while ((now = esp_timer_get_time()) - legacy_time < LEGACY_TTL * 1000 * 1000 &&
+           peer_recv(&msg, LEGACY_TTL * 1000 - (now - legacy_time) / 1000)) {
+        for (i = 0, asked = 0; i < LEGACY_NAMES; i++) {
+            asked |= msg_asks(&msg, names[i], MDNS_QUERY_TYPE_A) << i;
+        }
+        if (asked) {
+            queries++;
+            refresh = refresh ? refresh : esp_timer_get_time() - legacy_time;
+            TEST_CHECK(0x3 == asked, "refresh query asks 0x%x, 0x3 expected", asked);
+        }
+    }
+    TEST_CHECK(1 == queries, "%u refresh queries for the legacy answer, 1 expected", queries);
+    TEST_CHECK(refresh >= (LEGACY_TTL * 800 - 100) * 1000LL && refresh < (LEGACY_TTL * 800 + 300) * 1000LL,
+               "refresh query %lld ms after the legacy answer, %u expected", refresh / 1000, LEGACY_TTL * 800);
+}
+
+static volatile uint32_t s_storm_ok = 0;
+static volatile uint32_t s_storm_done = 0;
+
+// blocking queries, at most one in flight per client like an application task
+static void *storm_client(void *arg)
+{
+    uint32_t client = (uintptr_t)arg, i = 0;
+    char ins[32] = {0};
+    mdns_a_t a = {0};
+
+    for (i = 0; i < STORM_CLIENT_QUERIES; i++) {
+        snprintf(ins, sizeof(ins), "storm-%u-%u", client, i);
+        if (ESP_OK == mdns_query_a(ins, "_storm", "_udp", &a) && client == a.ip[2] && i == a.ip[3]) {
+            __atomic_add_fetch(&s_storm_ok, 1, __ATOMIC_RELAXED);
+        }
+    }
+    __atomic_add_fetch(&s_storm_done, 1, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+// QU queries from port 5353 for the service of the responder, each is answered by unicast at once
+static void *storm_querier(void *arg)
+{
+    msg_t msg = {0};
+    uint32_t i = 0;
+
+    msg_header(&msg, 0, 1, 0);
+    msg_name(&msg, REPLAY_INS);
+    msg_u16(&msg, MDNS_QUERY_TYPE_SRV);
+    msg_u16(&msg, 0x8001); // class IN, unicast response
+    for (i = 0; i < STORM_QU_QUERIES; i++) {
+        peer_send(&msg);
+        usleep(500);
+    }
+    __atomic_add_fetch(&s_storm_done, 1, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+// the stats read while mdns_srv counts, no field ever goes back
+static void *storm_stats_reader(void *arg)
+{
+    mdns_server_stats_t stats = {0}, last = {0};
+    uint32_t *bad = arg;
+
+    while (s_storm_done < STORM_CLIENTS + 1) {
+        mdns_server_get_stats(&stats);
+        if (stats.resp_sent < last.resp_sent || stats.query_aggregated < last.query_aggregated
+            || stats.record_rate_limited < last.record_rate_limited || stats.record_suppressed < last.record_suppressed) {
+            (*bad)++;
+        }
+        last = stats;
+        usleep(50);
+    }
+    return NULL;
+}
+
+// the responder and the client at full rate together: every client query gets its own answer,
+// and every query to the responder is answered, nothing is lost between the two sockets
+static void test_query_storm(void)
+{
+    pthread_t threads[STORM_CLIENTS + 1], reader = 0;
+    mdns_server_stats_t before = {0}, after = {0};
+    mdns_cursor_t cur = {0};
+    mdns_header_t header = {0};
+    mdns_question_t question = {0};
+    struct sockaddr_in querier = {0};
+    char name[MDNS_NAME_MAX_WIRE_LEN + 1] = {0};
+    uint32_t client = 0, i = 0, answered = 0, torn = 0;
+    uint8_t ip[4] = {10, 1, 0, 0};
+    msg_t msg = {0}, resp = {0};
+
+    mdns_server_get_stats(&before);
+    pthread_create(&reader, NULL, storm_stats_reader, &torn);
+    pthread_create(&threads[STORM_CLIENTS], NULL, storm_querier, NULL);
+    for (i = 0; i < STORM_CLIENTS; i++) {
+        pthread_create(&threads[i], NULL, storm_client, (void *)(uintptr_t)i);
+    }
+    // answers the legacy queries of the clients, counts the unicast answers of the responder
+    while (s_storm_done < STORM_CLIENTS + 1 || peer_recv_from(&msg, 300, &querier)) {
+        if (s_storm_done < STORM_CLIENTS + 1 && !peer_recv_from(&msg, 100, &querier)) {
+            continue;
+        }
+        if (ESP_OK != mdns_parse_header(&cur, msg.buf, msg.len, &header)) {
+            continue;
+        }
+        if (header.flags & 0x8000) {
+            answered += MDNS_UPD_PORT == ntohs(querier.sin_port) && 1 == header.answer_cnt;
+            continue;
+        }
+        if (MDNS_UPD_PORT == ntohs(querier.sin_port) || ESP_OK != mdns_parse_question(&cur, &question) ||
+            ESP_OK != mdns_name_to_str(&question.name, name, sizeof(name)) || 2 != sscanf(name, "storm-%u-%u", &client, &i)) {
+            continue;
+        }
+        ip[2] = client;
+        ip[3] = i;
+        msg_header(&resp, 0x8400, 0, 1);
+        msg_rr(&resp, name, MDNS_QUERY_TYPE_A, 10, ip, 4);
+        peer_send_to(&resp, &querier);
+    }
+    for (i = 0; i < STORM_CLIENTS + 1; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_join(reader, NULL);
+    mdns_server_get_stats(&after);
+    TEST_CHECK(STORM_CLIENTS * STORM_CLIENT_QUERIES == s_storm_ok, "%u of %u client queries resolved", s_storm_ok,
+               STORM_CLIENTS * STORM_CLIENT_QUERIES);
+    TEST_CHECK(STORM_QU_QUERIES == answered && STORM_QU_QUERIES <= after.resp_sent - before.resp_sent,
+               "%u of %u responder queries answered, %u responses sent", answered, STORM_QU_QUERIES,
+               after.resp_sent - before.resp_sent);
+    TEST_CHECK(0 == torn, "%u stats snapshots went back", torn);
+}
+
+int main(int argc, char **argv)
+{
+    s_peer_rx = peer_socket("0.0.0.0", 1);
+    s_peer_tx = peer_socket(PEER_IP, 0);
+    if (ESP_OK != mdns_init()) {
+        printf("mdns init error\n");
+        return 1;
+    }
+    test_cache_refresh();
+    test_cache_stats();
+    test_async_queries();
+    test_browse_maintenance();
+    test_legacy_ttl();
+    test_responder_replay(); // the server runs from here on
+    test_query_storm();
+    return test_result("mdns");
+}
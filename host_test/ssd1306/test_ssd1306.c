@@ -0,0 +1,418 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "ssd1306.h"
+#include "ssd1306_io_interface.h"
+#include "host_test.h"
+
+#define PGM_HEADER          14 // "P5\n128 64\n255\n"
+#define PGM_SIZE            (PGM_HEADER + 128 * 64)
+#define BENCH_CNT           1000
+#define SCROLL_CYCLES       200
+
+extern uint8_t pixel[128 * 8];
+
+static ssd1306_io_handle_t s_io = NULL;
+static ssd1306_io_t s_bus = {0};             // the driver talks to s_io through this, to fail and count transfers
+static volatile uint8_t s_bus_fail = 0;      // every transfer fails, like a panel that does not ack
+static volatile uint32_t s_bus_refused = 0;  // data sent while the panel was scrolling
+static volatile uint8_t s_swap_stop = 0;
+
+static long read_file(const char *path, uint8_t *buf, long size)
+{
+    FILE *fp = fopen(path, "rb");
+    long len = 0;
+
+    if (!fp) {
+        return -1;
+    }
+    len = fread(buf, 1, size, fp);
+    fclose(fp);
+    return len;
+}
+
+// flush, the panel ram must match pixel[], then the picture must match golden/<name>.pgm
+// HOST_TEST_UPDATE_GOLDEN=1 writes the golden image instead, check it by eye before committing it
+static void check_golden(const char *name)
+{
+    static uint8_t got[PGM_SIZE + 1], want[PGM_SIZE + 1];
+    char path[256] = {0};
+    long got_len = 0, want_len = 0, i = 0;
+
+    oled_flush();
+    TEST_CHECK(0 == memcmp(ssd1306_host_get_ram(s_io), pixel, sizeof(pixel)), "%s: panel ram differs from pixel[]", name);
+    if (getenv("HOST_TEST_UPDATE_GOLDEN")) {
+        snprintf(path, sizeof(path), "%s/%s.pgm", GOLDEN_DIR, name);
+        TEST_CHECK(ESP_OK == ssd1306_host_save_pgm(s_io, path), "%s: cannot write", path);
+        return;
+    }
+    snprintf(path, sizeof(path), "%s.pgm", name);
+    ssd1306_host_save_pgm(s_io, path);
+    got_len = read_file(path, got, sizeof(got));
+    snprintf(path, sizeof(path), "%s/%s.pgm", GOLDEN_DIR, name);
+    want_len = read_file(path, want, sizeof(want));
+    TEST_CHECK(PGM_SIZE == want_len, "%s: golden image missing or truncated", path);
+    if (got_len != want_len) {
+        return;
+    }
+    for (i = PGM_HEADER; i < got_len; i++) {
+        if (got[i] != want[i]) {
+            TEST_CHECK(got[i] == want[i], "%s: first difference at x:%ld y:%ld, see %s.pgm in the build directory",
+                       name, (i - PGM_HEADER) % 128, (i - PGM_HEADER) / 128, name);
+            break;
+        }
+    }
+}
+
+// every direction and length of line, the edges and the clipping of rectangles and circles
+static void test_primitives(void)
+{
+    oled_clear();
+    oled_show_line(0, 0, 127, 63, 1);
+    oled_show_line(127, 0, 0, 63, 1);
+    oled_show_line(10, 60, 20, 2, 1);   // steep
+    oled_show_line(30, 5, 90, 12, 1);   // shallow
+    oled_show_line(64, 40, 64, 40, 1);  // a single point
+    oled_show_hline(0, 0, 128, 1);
+    oled_show_hline(100, 50, 60, 1);    // clipped at the right edge
+    oled_show_vline(127, 0, 64, 1);
+    oled_show_vline(5, 3, 13, 1);       // across a page boundary
+    oled_show_rect(2, 2, 40, 20, 1);
+    oled_fill_rect(45, 9, 20, 15, 1);   // rows 9~23, partial bytes at both ends
+    oled_fill_rect(50, 12, 10, 5, 0);   // a hole inside it
+    oled_show_rect(110, 40, 40, 40, 1); // clipped
+    oled_show_circle(80, 40, 20, 1);
+    oled_fill_circle(30, 45, 12, 1);
+    oled_fill_circle(120, 5, 10, 1);    // clipped at the corner
+    oled_show_point(64, 32, 0);
+    check_golden("primitives");
+}
+
+// fixed size ascii and chinese tables, and utf-8 through the proportional font, wrapped at the right edge
+static void test_text(void)
+{
+    const char *wrapped = "ab 陈安晴, \xE2\x82\xAC"; // the font has no euro sign, it becomes '?'
+    uint8_t hz[] = {0, 1, 2};
+    oled_font_t font = {0};
+    uint32_t hit = 0, miss = 0, hit2 = 0, miss2 = 0;
+
+    oled_clear();
+    oled_show_string(0, 0, "abc XYZ 0123!", 1);
+    oled_show_char(122, 0, 'Z', 1);     // the last column
+    oled_show_string(0, 1, "8x16 ~", 2);
+    oled_show_chinese(64, 1, hz, sizeof(hz));
+    TEST_CHECK(ESP_OK == oled_font_load(oled_font16, oled_font16_size, &font), "font16 load error");
+    oled_show_text(90, 3, wrapped, &font); // goes on at pages 5~6
+    oled_font_get_cache_stats(&hit, &miss);
+    oled_show_text(90, 3, wrapped, &font);
+    oled_font_get_cache_stats(&hit2, &miss2);
+    // only the glyph the font lacks is looked up again
+    TEST_CHECK(1 == miss2 - miss, "glyph cache missed %u times on a repeated string", miss2 - miss);
+    TEST_CHECK(oled_font_text_width(&font, "i") < oled_font_text_width(&font, "m"), "widths are not proportional");
+    TEST_CHECK(oled_font_text_width(&font, "ab") == oled_font_text_width(&font, "a") + oled_font_text_width(&font, "b"), "text width");
+    oled_font_unload(&font);
+    oled_show_string(0, 7, "end", 1);
+    check_golden("text");
+}
+
+// 16*12 arrow in panel layout, rows 0~7 then rows 8~11, h is not a multiple of 8
+static void make_arrow(uint8_t *bitmap)
+{
+    uint8_t x = 0, y = 0;
+
+    memset(bitmap, 0, 16 * 2);
+    for (y = 0; y < 12; y++) {
+        for (x = 0; x < 16; x++) {
+            if ((x >= 4 && x < 12 && y >= 6) || (y < 6 && x >= 6 - y + 2 && x < 10 + y - 2 + 2) || 0 == x) {
+                bitmap[(y / 8) * 16 + x] |= 1 << (y % 8);
+            }
+        }
+    }
+}
+
+// every mode at unaligned rows, over a background so the modes differ, and clipped on all four sides
+static void test_blit(void)
+{
+    uint8_t arrow[16 * 2] = {0};
+    uint8_t before[128 * 8] = {0};
+    uint8_t i = 0;
+
+    make_arrow(arrow);
+    oled_clear();
+    oled_fill_rect(0, 20, 128, 24, 1);
+    for (i = 0; i < 4; i++) {
+        oled_blit(4 + i * 20, 3 + i, arrow, 16, 12, OLED_BLIT_COPY + i);  // on the clear top
+        oled_blit(4 + i * 20, 26 + i, arrow, 16, 12, OLED_BLIT_COPY + i); // on the filled band
+    }
+    oled_blit(-5, 50, arrow, 16, 12, OLED_BLIT_OR);
+    oled_blit(120, 55, arrow, 16, 12, OLED_BLIT_OR);
+    oled_blit(100, -7, arrow, 16, 12, OLED_BLIT_OR);
+    oled_blit(60, 60, arrow, 16, 12, OLED_BLIT_OR);
+    oled_blit(200, 10, arrow, 16, 12, OLED_BLIT_OR); // nothing on the screen
+    memcpy(before, pixel, sizeof(before));
+    oled_blit(33, 17, arrow, 16, 12, OLED_BLIT_XOR);
+    oled_blit(33, 17, arrow, 16, 12, OLED_BLIT_XOR);
+    TEST_CHECK(0 == memcmp(before, pixel, sizeof(before)), "xor twice does not restore the screen");
+    check_golden("blit");
+}
+
+// a horizontal and a vertical gradient, Bayer on the left half, Floyd-Steinberg on the right
+static void test_dither(void)
+{
+    static uint8_t gray[64 * 64] = {0};
+    static uint8_t mono[64 * 8] = {0};
+    uint32_t i = 0;
+
+    for (i = 0; i < sizeof(gray); i++) {
+        gray[i] = (i / 64) < 32 ? (i % 64) * 4 : ((i / 64) - 32) * 8;
+    }
+    oled_clear();
+    TEST_CHECK(ESP_OK == oled_gray_to_mono(gray, 64, 64, mono, OLED_DITHER_BAYER), "bayer error");
+    oled_blit(0, 0, mono, 64, 64, OLED_BLIT_COPY);
+    TEST_CHECK(ESP_OK == oled_gray_to_mono(gray, 64, 64, mono, OLED_DITHER_FLOYD), "floyd error");
+    oled_blit(64, 0, mono, 64, 64, OLED_BLIT_COPY);
+    TEST_CHECK(ESP_ERR_INVALID_ARG == oled_gray_to_mono(gray, 129, 8, mono, OLED_DITHER_NONE), "129 columns accepted");
+    check_golden("dither");
+}
+
+// neighbouring pages share a window when the extra columns are cheaper than another window command
+static void test_window_merge(void)
+{
+    uint32_t tx = 0, bytes = 0, tx_now = 0, bytes_now = 0;
+
+    oled_clear();
+    oled_flush();
+    ssd1306_host_get_stats(s_io, &tx, &bytes);
+    oled_show_hline(40, 18, 11, 1); // page 2 columns 40~50
+    oled_show_hline(42, 26, 11, 1); // page 3 columns 42~52
+    oled_flush();
+    ssd1306_host_get_stats(s_io, &tx_now, &bytes_now);
+    TEST_CHECK(1 == tx_now - tx && 6 + 13 * 2 == bytes_now - bytes, "close windows: %u transfers, %u bytes",
+               tx_now - tx, bytes_now - bytes);
+    TEST_CHECK(0 == memcmp(ssd1306_host_get_ram(s_io), pixel, sizeof(pixel)), "merged window");
+    tx = tx_now;
+    bytes = bytes_now;
+    oled_show_hline(0, 20, 6, 1);    // page 2 columns 0~5
+    oled_show_hline(100, 28, 11, 1); // page 3 columns 100~110
+    oled_flush();
+    ssd1306_host_get_stats(s_io, &tx_now, &bytes_now);
+    TEST_CHECK(2 == tx_now - tx && 6 + 6 + 6 + 11 == bytes_now - bytes, "far windows: %u transfers, %u bytes",
+               tx_now - tx, bytes_now - bytes);
+    TEST_CHECK(0 == memcmp(ssd1306_host_get_ram(s_io), pixel, sizeof(pixel)), "separate windows");
+}
+
+static esp_err_t bus_tx(ssd1306_io_t *io, const uint8_t *cmds, uint32_t cmd_len, const uint8_t *data, uint32_t data_len)
+{
+    esp_err_t ret = ESP_OK;
+
+    if (s_bus_fail) {
+        return ESP_FAIL;
+    }
+    ret = s_io->tx(s_io, cmds, cmd_len, data, data_len);
+    if (ESP_ERR_INVALID_STATE == ret) {
+        s_bus_refused++;
+    }
+    return ret;
+}
+
+static esp_err_t bus_wait(ssd1306_io_t *io)
+{
+    return s_io->wait(s_io);
+}
+
+static esp_err_t bus_del(ssd1306_io_t *io)
+{
+    return ESP_OK;
+}
+
+// after a swap, a second swap returns once the flush task has sent the first one
+static void swap_and_wait(void)
+{
+    TEST_CHECK(ESP_OK == oled_swap(1000), "swap timeout");
+    TEST_CHECK(ESP_OK == oled_swap(1000), "flush task stuck");
+}
+
+// the flush task must start from the whole picture, a frame flushed before it and one drawn but not flushed,
+// then partial updates on neighbouring pages share a window that also covers columns nobody swapped
+// oled_flush is not used once the task owns the bus, only test_scroll runs after it
+static void test_flush_task(void)
+{
+    oled_clear();
+    oled_fill_rect(0, 16, 128, 16, 1);   // pages 2 and 3 full
+    oled_flush();
+    oled_show_string(0, 6, "pending", 1); // drawn before the task, not flushed
+    TEST_CHECK(ESP_OK == oled_start_flush_task(0, 5), "flush task start error");
+    swap_and_wait();
+    TEST_CHECK(0 == memcmp(ssd1306_host_get_ram(s_io), pixel, sizeof(pixel)), "pending frame not sent by the task");
+    oled_show_hline(40, 18, 11, 0);      // page 2 columns 40~50, merged with page 3 and sent from front[]
+    oled_show_hline(42, 26, 11, 0);      // page 3 columns 42~52
+    swap_and_wait();
+    TEST_CHECK(0 == memcmp(ssd1306_host_get_ram(s_io), pixel, sizeof(pixel)), "partial update after the task start");
+}
+
+// a second task that only hands frames over, the way an application redraws while the ui scrolls
+static void *swap_thread(void *arg)
+{
+    while (!s_swap_stop) {
+        oled_swap(1000);
+    }
+    return NULL;
+}
+
+// with the flush task running: a scroll the panel did not take holds nothing back, frames drawn while scrolling
+// wait for oled_scroll_stop, and no frame reaches the panel between the scroll state and the scroll commands
+static void test_scroll(void)
+{
+    uint8_t ram[128 * 8] = {0};
+    pthread_t thread;
+    uint32_t i = 0;
+
+    s_bus_fail = 1;
+    TEST_CHECK(ESP_OK != oled_scroll_horizontal(1, 2, 3, 0), "scroll start on a dead bus");
+    s_bus_fail = 0;
+    oled_show_string(0, 0, "after nak", 1);
+    swap_and_wait();
+    TEST_CHECK(0 == memcmp(ssd1306_host_get_ram(s_io), pixel, sizeof(pixel)), "frame held back by a scroll that never started");
+
+    TEST_CHECK(ESP_OK == oled_scroll_horizontal(1, 2, 3, 0), "scroll start error");
+    TEST_CHECK(ESP_ERR_INVALID_STATE == oled_scroll_horizontal(0, 2, 3, 0), "second scroll started");
+    memcpy(ram, ssd1306_host_get_ram(s_io), sizeof(ram));
+    oled_show_string(0, 0, "scrolling", 1);
+    oled_show_string(0, 2, "scrolled page", 1);
+    swap_and_wait();
+    TEST_CHECK(0 == memcmp(ssd1306_host_get_ram(s_io), ram, sizeof(ram)), "frame sent while scrolling");
+    TEST_CHECK(ESP_OK == oled_scroll_stop(), "scroll stop error");
+    swap_and_wait();
+    TEST_CHECK(0 == memcmp(ssd1306_host_get_ram(s_io), pixel, sizeof(pixel)), "held back frame after the stop");
+
+    pthread_create(&thread, NULL, swap_thread, NULL);
+    for (i = 0; i < SCROLL_CYCLES; i++) {
+        oled_scroll_horizontal(i & 1, 2, 3, 0);
+        vTaskDelay(1);
+        oled_scroll_stop();
+    }
+    s_swap_stop = 1;
+    pthread_join(thread, NULL);
+    swap_and_wait();
+    TEST_CHECK(0 == s_bus_refused, "%u transfers sent while the panel was scrolling", s_bus_refused);
+    TEST_CHECK(0 == memcmp(ssd1306_host_get_ram(s_io), pixel, sizeof(pixel)), "start and stop with a second task swapping");
+}
+
+// drawing only, no flush, so the numbers do not depend on a bus
+static void bench_primitives(void)
+{
+    int64_t start = 0;
+    uint32_t i = 0;
+
+    start = esp_timer_get_time();
+    for (i = 0; i < BENCH_CNT; i++) {
+        oled_show_line(0, 0, 127, 63, i & 1);
+    }
+    bench_report("line", BENCH_CNT, start);
+    start = esp_timer_get_time();
+    for (i = 0; i < BENCH_CNT; i++) {
+        oled_show_hline(0, i & 63, 128, 1);
+    }
+    bench_report("hline", BENCH_CNT, start);
+    start = esp_timer_get_time();
+    for (i = 0; i < BENCH_CNT; i++) {
+        oled_fill_rect(10, 5, 64, 32, i & 1);
+    }
+    bench_report("fill rect", BENCH_CNT, start);
+    start = esp_timer_get_time();
+    for (i = 0; i < BENCH_CNT; i++) {
+        oled_show_circle(64, 32, 30, i & 1);
+    }
+    bench_report("circle", BENCH_CNT, start);
+    start = esp_timer_get_time();
+    for (i = 0; i < BENCH_CNT; i++) {
+        oled_fill_circle(64, 32, 30, i & 1);
+    }
+    bench_report("fill circle", BENCH_CNT, start);
+}
+
+// utf-8 text in the proportional font, most glyphs come from the glyph cache
+static void bench_text(void)
+{
+    const char *text = "Hello 陈安晴, 27.5C 64%";
+    oled_font_t font = {0};
+    uint32_t i = 0, hit = 0, miss = 0;
+    int64_t start = 0;
+
+    if (ESP_OK != oled_font_load(oled_font16, oled_font16_size, &font)) {
+        return;
+    }
+    start = esp_timer_get_time();
+    for (i = 0; i < BENCH_CNT; i++) {
+        oled_show_text(0, (i & 3) * 2, text, &font);
+    }
+    bench_report("text string", BENCH_CNT, start);
+    oled_font_get_cache_stats(&hit, &miss);
+    oled_font_unload(&font);
+    printf("glyph cache hit %u miss %u\n", hit, miss);
+}
+
+// a 32*32 logo at unaligned rows, and a 128*64 gradient dithered to 1 bit
+static void bench_blit(void)
+{
+    const char *names[] = {"blit copy", "blit or", "blit and", "blit xor"};
+    static uint8_t logo[32 * 4] = {0};
+    static uint8_t gray[128 * 64] = {0};
+    static uint8_t mono[128 * 8] = {0};
+    uint32_t i = 0, j = 0;
+    int64_t start = 0;
+
+    for (i = 0; i < sizeof(logo); i++) {
+        logo[i] = i * 37;
+    }
+    for (j = 0; j < 4; j++) {
+        start = esp_timer_get_time();
+        for (i = 0; i < BENCH_CNT; i++) {
+            oled_blit(i & 63, (i >> 6) & 31, logo, 32, 32, j);
+        }
+        bench_report(names[j], BENCH_CNT, start);
+    }
+    for (i = 0; i < sizeof(gray); i++) {
+        gray[i] = (i % 128) * 2;
+    }
+    start = esp_timer_get_time();
+    for (i = 0; i < BENCH_CNT / 10; i++) {
+        oled_gray_to_mono(gray, 128, 64, mono, OLED_DITHER_BAYER);
+    }
+    bench_report("bayer frame", BENCH_CNT / 10, start);
+    start = esp_timer_get_time();
+    for (i = 0; i < BENCH_CNT / 10; i++) {
+        oled_gray_to_mono(gray, 128, 64, mono, OLED_DITHER_FLOYD);
+    }
+    bench_report("floyd frame", BENCH_CNT / 10, start);
+}
+
+// test_ssd1306 [bench]
+int main(int argc, char **argv)
+{
+    s_bus.tx = bus_tx;
+    s_bus.wait = bus_wait;
+    s_bus.del = bus_del;
+    if (ESP_OK != ssd1306_new_host_io(&s_io) || ESP_OK != oled_init(&s_bus)) {
+        printf("host io init error\n");
+        return 1;
+    }
+    oled_flush();
+    if (argc > 1 && 0 == strcmp(argv[1], "bench")) {
+        bench_primitives();
+        bench_text();
+        bench_blit();
+        return 0;
+    }
+    test_primitives();
+    test_text();
+    test_blit();
+    test_dither();
+    test_window_merge();
+    test_flush_task();
+    test_scroll();
+    return test_result("ssd1306");
+}
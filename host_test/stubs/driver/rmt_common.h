@@ -0,0 +1,17 @@
+#pragma once
+
+#include "driver/rmt_types.h"
+
+typedef struct {
+    uint32_t frequency_hz;
+    float duty_cycle;
+    struct {
+        uint32_t polarity_active_low : 1;
+        uint32_t always_on : 1;
+    } flags;
+} rmt_carrier_config_t;
+
+esp_err_t rmt_enable(rmt_channel_handle_t channel);
+esp_err_t rmt_disable(rmt_channel_handle_t channel);
+esp_err_t rmt_del_channel(rmt_channel_handle_t channel);
+esp_err_t rmt_apply_carrier(rmt_channel_handle_t channel, const rmt_carrier_config_t *config);
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "driver/rmt_common.h"
+
+typedef struct {
+    int gpio_num;
+    rmt_clock_source_t clk_src;
+    uint32_t resolution_hz;
+    size_t mem_block_symbols;
+    int intr_priority;
+    struct {
+        uint32_t invert_in : 1;
+        uint32_t with_dma : 1;
+    } flags;
+} rmt_rx_channel_config_t;
+
+typedef struct {
+    uint32_t signal_range_min_ns;
+    uint32_t signal_range_max_ns;
+    struct {
+        uint32_t en_partial_rx : 1;
+    } flags;
+} rmt_receive_config_t;
+
+typedef struct {
+    rmt_rx_done_callback_t on_recv_done;
+} rmt_rx_event_callbacks_t;
+
+esp_err_t rmt_new_rx_channel(const rmt_rx_channel_config_t *config, rmt_channel_handle_t *ret_chan);
+esp_err_t rmt_receive(rmt_channel_handle_t rx_channel, void *buffer, size_t buffer_size, const rmt_receive_config_t *config);
+esp_err_t rmt_rx_register_event_callbacks(rmt_channel_handle_t rx_channel, const rmt_rx_event_callbacks_t *cbs, void *user_data);
+
+// a capture reaches the last rx channel created, the done callback runs in the calling thread as the isr
+// with en_partial_rx it is handed over in chunks of the buffer, without it the symbols past the buffer are lost
+// returns the buffer of rmt_receive() the capture went to, NULL if none was armed and the capture is lost
+rmt_symbol_word_t *host_rmt_rx_capture(const rmt_symbol_word_t *symbols, size_t num);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "driver/rmt_common.h"
+#include "driver/rmt_encoder.h"
+
+// the encoders run in rmt_transmit(), the line is modelled in time: a frame starts when the ones
+// before it are over, so the start times are those of the pin, not of the calls
+
+typedef struct {
+    int gpio_num;
+    rmt_clock_source_t clk_src;
+    uint32_t resolution_hz;
+    size_t mem_block_symbols;
+    size_t trans_queue_depth;
+    int intr_priority;
+    struct {
+        uint32_t invert_out : 1;
+        uint32_t with_dma : 1;
+    } flags;
+} rmt_tx_channel_config_t;
+
+typedef struct {
+    int loop_count;
+    struct {
+        uint32_t eot_level : 1;
+        uint32_t queue_nonblocking : 1;
+    } flags;
+} rmt_transmit_config_t;
+
+typedef struct {
+    rmt_tx_done_callback_t on_trans_done;
+} rmt_tx_event_callbacks_t;
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t *config, rmt_channel_handle_t *ret_chan);
+esp_err_t rmt_transmit(rmt_channel_handle_t tx_channel, rmt_encoder_handle_t encoder, const void *payload, size_t payload_bytes, const rmt_transmit_config_t *config);
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t tx_channel, int timeout_ms);
+esp_err_t rmt_tx_register_event_callbacks(rmt_channel_handle_t tx_channel, const rmt_tx_event_callbacks_t *cbs, void *user_data);
+
+#define HOST_RMT_TX_SYMBOLS                 16384
+#define HOST_RMT_TX_FRAMES                  256
+
+typedef struct {
+    int64_t start;                      // us, esp_timer time the first symbol goes out
+    uint32_t first;                     // index of the first symbol in the log
+    uint32_t num;
+    uint32_t refills;                   // RMT_ENCODING_MEM_FULL returns, half of the channel memory each
+} host_rmt_tx_frame_t;
+
+// the transmissions since the last reset, symbols in the order sent, the log stops when full
+uint32_t host_rmt_tx_frames(const host_rmt_tx_frame_t **frames, const rmt_symbol_word_t **symbols);
+// waits until the line is idle first
+void host_rmt_tx_reset(void);
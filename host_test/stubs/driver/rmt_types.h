@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// the layout of a symbol in the rmt memory, bit fields in the order of the ESP32
+typedef union {
+    struct {
+        uint32_t duration0 : 15;
+        uint32_t level0 : 1;
+        uint32_t duration1 : 15;
+        uint32_t level1 : 1;
+    };
+    uint32_t val;
+} rmt_symbol_word_t;
+
+typedef struct rmt_channel_t *rmt_channel_handle_t;
+typedef struct rmt_encoder_t *rmt_encoder_handle_t;
+
+typedef enum {
+    RMT_CLK_SRC_APB = 4,
+    RMT_CLK_SRC_DEFAULT = 4,
+} rmt_clock_source_t;
+
+typedef struct {
+    size_t num_symbols;
+} rmt_tx_done_event_data_t;
+
+typedef struct {
+    rmt_symbol_word_t *received_symbols;
+    size_t num_symbols;
+    struct {
+        uint32_t is_last : 1;           // partial receive, the last chunk of the capture
+    } flags;
+} rmt_rx_done_event_data_t;
+
+typedef bool (*rmt_tx_done_callback_t)(rmt_channel_handle_t tx_chan, const rmt_tx_done_event_data_t *edata, void *user_ctx);
+typedef bool (*rmt_rx_done_callback_t)(rmt_channel_handle_t rx_chan, const rmt_rx_done_event_data_t *edata, void *user_ctx);
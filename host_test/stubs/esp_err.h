@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK                              0
+#define ESP_FAIL                            -1
+#define ESP_ERR_NO_MEM                      0x101
+#define ESP_ERR_INVALID_ARG                 0x102
+#define ESP_ERR_INVALID_STATE               0x103
+#define ESP_ERR_INVALID_SIZE                0x104
+#define ESP_ERR_NOT_FOUND                   0x105
+#define ESP_ERR_NOT_SUPPORTED               0x106
+#define ESP_ERR_TIMEOUT                     0x107
+#define ESP_ERR_INVALID_RESPONSE            0x108
+#define ESP_ERR_INVALID_CRC                 0x109
+#define ESP_ERR_INVALID_VERSION             0x10A
+#define ESP_ERR_NOT_FINISHED                0x10C
+#define ESP_ERR_NVS_NOT_FOUND               0x1102
+#define ESP_ERR_NVS_NO_FREE_PAGES           0x110D
+#define ESP_ERR_NVS_NEW_VERSION_FOUND       0x1110
+
+#ifndef __containerof
+#define __containerof(ptr, type, member)    ((type *)((char *)(ptr) - __builtin_offsetof(type, member)))
+#endif
@@ -0,0 +1,9 @@
+#pragma once
+
+#define ESP_IDF_VERSION_VAL(major, minor, patch)    (((major) << 16) | ((minor) << 8) | (patch))
+// the version the examples are built with on the device, HOST_IDF_VERSION picks another one
+#ifdef HOST_IDF_VERSION
+#define ESP_IDF_VERSION                             HOST_IDF_VERSION
+#else
+#define ESP_IDF_VERSION                             ESP_IDF_VERSION_VAL(5, 2, 2)
+#endif
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stdio.h>
+
+// HOST_TEST_QUIET=1 in the environment keeps the info logs of a benchmark loop out of the output
+int host_log_enabled(char level);
+
+#define ESP_LOGE(tag, format, ...) do { if (host_log_enabled('E')) printf("E %s: " format "\n", tag, ##__VA_ARGS__); } while (0)
+#define ESP_LOGW(tag, format, ...) do { if (host_log_enabled('W')) printf("W %s: " format "\n", tag, ##__VA_ARGS__); } while (0)
+#define ESP_LOGI(tag, format, ...) do { if (host_log_enabled('I')) printf("I %s: " format "\n", tag, ##__VA_ARGS__); } while (0)
+#define ESP_LOGD(tag, format, ...) do { if (0) printf("D %s: " format "\n", tag, ##__VA_ARGS__); } while (0)
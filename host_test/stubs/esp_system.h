@@ -0,0 +1,4 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_random.h"
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdint.h>
+
+typedef void (*esp_timer_cb_t)(void *arg);
+
+typedef struct {
+    esp_timer_cb_t callback;
+    void *arg;
+    int dispatch_method;
+    const char *name;
+    int skip_unhandled_events;
+} esp_timer_create_args_t;
+
+typedef struct esp_timer *esp_timer_handle_t;
+
+// us since the process started, CLOCK_MONOTONIC
+int64_t esp_timer_get_time(void);
+// one shot timers, the callback runs on a thread of its own
+int esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out);
+int esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
+int esp_timer_stop(esp_timer_handle_t timer);
@@ -0,0 +1,491 @@
+#define _GNU_SOURCE // recursive mutex initializer
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <errno.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+typedef struct {
+    TaskFunction_t func;
+    void *arg;
+} task_start_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    unsigned count;
+    unsigned max;
+} sem_t_;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    unsigned len;
+    unsigned size;
+    unsigned head;
+    unsigned count;
+    uint8_t *buf;
+} queue_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    EventBits_t bits;
+} group_t;
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint64_t deadline;  // us, 0 - stopped
+    int running;
+};
+
+static pthread_mutex_t s_critical = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+int host_log_enabled(char level)
+{
+    static int quiet = -1;
+
+    if (quiet < 0) {
+        quiet = getenv("HOST_TEST_QUIET") ? atoi(getenv("HOST_TEST_QUIET")) : 0;
+    }
+    return !quiet || 'E' == level;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// absolute CLOCK_MONOTONIC time ticks from now, NULL for portMAX_DELAY
+static struct timespec *deadline(struct timespec *ts, TickType_t ticks)
+{
+    if (portMAX_DELAY == ticks) {
+        return NULL;
+    }
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec += ticks / 1000;
+    ts->tv_nsec += (ticks % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+static void cond_init(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+// 0 on timeout
+static int cond_wait(pthread_cond_t *cond, pthread_mutex_t *lock, const struct timespec *until)
+{
+    if (NULL == until) {
+        pthread_cond_wait(cond, lock);
+        return 1;
+    }
+    return ETIMEDOUT != pthread_cond_timedwait(cond, lock, until);
+}
+
+static void *task_entry(void *arg)
+{
+    task_start_t start = *(task_start_t *)arg;
+
+    free(arg);
+    start.func(start.arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t func, const char *name, uint32_t stack, void *arg, UBaseType_t priority, TaskHandle_t *handle)
+{
+    task_start_t *start = malloc(sizeof(task_start_t));
+    pthread_t thread;
+
+    start->func = func;
+    start->arg = arg;
+    if (pthread_create(&thread, NULL, task_entry, start)) {
+        free(start);
+        return pdFAIL;
+    }
+    pthread_detach(thread);
+    if (handle) {
+        *handle = (TaskHandle_t)thread;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t func, const char *name, uint32_t stack, void *arg, UBaseType_t priority, TaskHandle_t *handle, int core)
+{
+    return xTaskCreate(func, name, stack, arg, priority, handle);
+}
+
+void vTaskDelete(TaskHandle_t handle)
+{
+    if (NULL == handle) {
+        pthread_exit(NULL);
+    }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec ts = {ticks / 1000, (ticks % 1000) * 1000000L};
+
+    nanosleep(&ts, NULL);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return esp_timer_get_time() / 1000;
+}
+
+static void *sem_new(unsigned count, unsigned max)
+{
+    sem_t_ *sem = calloc(1, sizeof(sem_t_));
+
+    pthread_mutex_init(&sem->lock, NULL);
+    cond_init(&sem->cond);
+    sem->count = count;
+    sem->max = max;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return sem_new(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return sem_new(0, 1);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t handle, TickType_t ticks)
+{
+    sem_t_ *sem = handle;
+    struct timespec ts;
+    const struct timespec *until = deadline(&ts, ticks);
+
+    pthread_mutex_lock(&sem->lock);
+    while (0 == sem->count) {
+        if (0 == ticks || !cond_wait(&sem->cond, &sem->lock, until)) {
+            pthread_mutex_unlock(&sem->lock);
+            return pdFALSE;
+        }
+    }
+    sem->count--;
+    pthread_mutex_unlock(&sem->lock);
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t handle)
+{
+    sem_t_ *sem = handle;
+    BaseType_t ret = pdFALSE;
+
+    pthread_mutex_lock(&sem->lock);
+    if (sem->count < sem->max) {
+        sem->count++;
+        ret = pdTRUE;
+    }
+    pthread_cond_broadcast(&sem->cond);
+    pthread_mutex_unlock(&sem->lock);
+    return ret;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t handle, BaseType_t *woken)
+{
+    return xSemaphoreGive(handle);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t handle)
+{
+    free(handle);
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t len, UBaseType_t size)
+{
+    queue_t *queue = calloc(1, sizeof(queue_t));
+
+    pthread_mutex_init(&queue->lock, NULL);
+    cond_init(&queue->cond);
+    queue->len = len;
+    queue->size = size;
+    queue->buf = calloc(len, size);
+    return queue;
+}
+
+static BaseType_t queue_put(queue_t *queue, const void *item, TickType_t ticks, int front)
+{
+    struct timespec ts;
+    const struct timespec *until = deadline(&ts, ticks);
+    unsigned index = 0;
+
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == queue->len) {
+        if (0 == ticks || !cond_wait(&queue->cond, &queue->lock, until)) {
+            pthread_mutex_unlock(&queue->lock);
+            return pdFALSE;
+        }
+    }
+    if (front) {
+        queue->head = (queue->head + queue->len - 1) % queue->len;
+        index = queue->head;
+    } else {
+        index = (queue->head + queue->count) % queue->len;
+    }
+    memcpy(queue->buf + index * queue->size, item, queue->size);
+    queue->count++;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+static BaseType_t queue_get(queue_t *queue, void *item, TickType_t ticks, int peek)
+{
+    struct timespec ts;
+    const struct timespec *until = deadline(&ts, ticks);
+
+    pthread_mutex_lock(&queue->lock);
+    while (0 == queue->count) {
+        if (0 == ticks || !cond_wait(&queue->cond, &queue->lock, until)) {
+            pthread_mutex_unlock(&queue->lock);
+            return pdFALSE;
+        }
+    }
+    memcpy(item, queue->buf + queue->head * queue->size, queue->size);
+    if (!peek) {
+        queue->head = (queue->head + 1) % queue->len;
+        queue->count--;
+    }
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    return queue_put(queue, item, ticks, 0);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void *item, TickType_t ticks)
+{
+    return queue_put(queue, item, ticks, 1);
+}
+
+// queues of one item only, as in FreeRTOS
+BaseType_t xQueueOverwrite(QueueHandle_t handle, const void *item)
+{
+    queue_t *queue = handle;
+
+    pthread_mutex_lock(&queue->lock);
+    memcpy(queue->buf + queue->head * queue->size, item, queue->size);
+    queue->count = 1;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *woken)
+{
+    return queue_put(queue, item, 0, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    return queue_get(queue, item, ticks, 0);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    return queue_get(queue, item, ticks, 1);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t handle)
+{
+    queue_t *queue = handle;
+    UBaseType_t count = 0;
+
+    pthread_mutex_lock(&queue->lock);
+    count = queue->count;
+    pthread_mutex_unlock(&queue->lock);
+    return count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t handle)
+{
+    return ((queue_t *)handle)->len - uxQueueMessagesWaiting(handle);
+}
+
+BaseType_t xQueueReset(QueueHandle_t handle)
+{
+    queue_t *queue = handle;
+
+    pthread_mutex_lock(&queue->lock);
+    queue->count = 0;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+    return pdTRUE;
+}
+
+void vQueueDelete(QueueHandle_t handle)
+{
+    queue_t *queue = handle;
+
+    free(queue->buf);
+    free(queue);
+}
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    group_t *group = calloc(1, sizeof(group_t));
+
+    pthread_mutex_init(&group->lock, NULL);
+    cond_init(&group->cond);
+    return group;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t handle, EventBits_t bits)
+{
+    group_t *group = handle;
+    EventBits_t ret = 0;
+
+    pthread_mutex_lock(&group->lock);
+    group->bits |= bits;
+    ret = group->bits;
+    pthread_cond_broadcast(&group->cond);
+    pthread_mutex_unlock(&group->lock);
+    return ret;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t handle, EventBits_t bits)
+{
+    group_t *group = handle;
+    EventBits_t ret = 0;
+
+    pthread_mutex_lock(&group->lock);
+    ret = group->bits;
+    group->bits &= ~bits;
+    pthread_mutex_unlock(&group->lock);
+    return ret;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t handle, EventBits_t bits, BaseType_t clear, BaseType_t all, TickType_t ticks)
+{
+    group_t *group = handle;
+    struct timespec ts;
+    const struct timespec *until = deadline(&ts, ticks);
+    EventBits_t ret = 0;
+
+    pthread_mutex_lock(&group->lock);
+    while (!(all ? (group->bits & bits) == bits : (group->bits & bits))) {
+        if (0 == ticks || !cond_wait(&group->cond, &group->lock, until)) {
+            break;
+        }
+    }
+    ret = group->bits;
+    if (clear && (all ? (ret & bits) == bits : (ret & bits))) {
+        group->bits &= ~bits;
+    }
+    pthread_mutex_unlock(&group->lock);
+    return ret;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t handle)
+{
+    group_t *group = handle;
+    EventBits_t ret = 0;
+
+    pthread_mutex_lock(&group->lock);
+    ret = group->bits;
+    pthread_mutex_unlock(&group->lock);
+    return ret;
+}
+
+void vEventGroupDelete(EventGroupHandle_t handle)
+{
+    free(handle);
+}
+
+void host_critical_enter(void)
+{
+    pthread_mutex_lock(&s_critical);
+}
+
+void host_critical_exit(void)
+{
+    pthread_mutex_unlock(&s_critical);
+}
+
+// one thread per timer, it sleeps until the deadline or a restart
+static void *timer_thread(void *arg)
+{
+    esp_timer_handle_t timer = arg;
+    struct timespec ts;
+    uint64_t due = 0;
+
+    pthread_mutex_lock(&timer->lock);
+    while (1) {
+        if (0 == timer->deadline) {
+            pthread_cond_wait(&timer->cond, &timer->lock);
+            continue;
+        }
+        due = timer->deadline;
+        ts.tv_sec = due / 1000000;
+        ts.tv_nsec = (due % 1000000) * 1000;
+        if (cond_wait(&timer->cond, &timer->lock, &ts) || timer->deadline != due) {
+            continue; // restarted or stopped
+        }
+        timer->deadline = 0;
+        pthread_mutex_unlock(&timer->lock);
+        timer->callback(timer->arg);
+        pthread_mutex_lock(&timer->lock);
+    }
+    return NULL;
+}
+
+int esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out)
+{
+    esp_timer_handle_t timer = calloc(1, sizeof(struct esp_timer));
+    pthread_t thread;
+
+    timer->callback = args->callback;
+    timer->arg = args->arg;
+    pthread_mutex_init(&timer->lock, NULL);
+    cond_init(&timer->cond);
+    pthread_create(&thread, NULL, timer_thread, timer);
+    pthread_detach(thread);
+    *out = timer;
+    return 0;
+}
+
+int esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    pthread_mutex_lock(&timer->lock);
+    timer->deadline = esp_timer_get_time() + (timeout_us ? timeout_us : 1);
+    pthread_cond_broadcast(&timer->cond);
+    pthread_mutex_unlock(&timer->lock);
+    return 0;
+}
+
+int esp_timer_stop(esp_timer_handle_t timer)
+{
+    pthread_mutex_lock(&timer->lock);
+    timer->deadline = 0;
+    pthread_cond_broadcast(&timer->cond);
+    pthread_mutex_unlock(&timer->lock);
+    return 0;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+// FreeRTOS on pthreads, 1ms ticks, tasks are threads, an "ISR" is any thread calling the FromISR functions
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t EventBits_t;
+typedef void (*TaskFunction_t)(void *);
+typedef void *TaskHandle_t;
+typedef void *SemaphoreHandle_t;
+typedef void *QueueHandle_t;
+typedef void *EventGroupHandle_t;
+typedef struct {
+    int unused;
+} portMUX_TYPE;
+
+#define pdTRUE                              1
+#define pdFALSE                             0
+#define pdPASS                              1
+#define pdFAIL                              0
+#define portMAX_DELAY                       0xFFFFFFFFu
+#define configTICK_RATE_HZ                  1000
+#define portTICK_PERIOD_MS                  1
+#define pdMS_TO_TICKS(ms)                   ((TickType_t)(ms))
+#define portMUX_INITIALIZER_UNLOCKED        {0}
+#define portYIELD_FROM_ISR(woken)           (void)(woken)
+
+BaseType_t xTaskCreate(TaskFunction_t func, const char *name, uint32_t stack, void *arg, UBaseType_t priority, TaskHandle_t *handle);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t func, const char *name, uint32_t stack, void *arg, UBaseType_t priority, TaskHandle_t *handle, int core);
+void vTaskDelete(TaskHandle_t handle);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *woken);
+void vSemaphoreDelete(SemaphoreHandle_t sem);
+
+QueueHandle_t xQueueCreate(UBaseType_t len, UBaseType_t size);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks);
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void *item, TickType_t ticks);
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item);
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *woken);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks);
+BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t ticks);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue);
+BaseType_t xQueueReset(QueueHandle_t queue);
+void vQueueDelete(QueueHandle_t queue);
+#define xQueueSendToBack xQueueSend
+
+EventGroupHandle_t xEventGroupCreate(void);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear, BaseType_t all, TickType_t ticks);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group);
+void vEventGroupDelete(EventGroupHandle_t group);
+
+// one lock for every critical section, like a single core with interrupts off
+void host_critical_enter(void);
+void host_critical_exit(void);
+#define portENTER_CRITICAL(mux)             ((void)(mux), host_critical_enter())
+#define portEXIT_CRITICAL(mux)              ((void)(mux), host_critical_exit())
+#define portENTER_CRITICAL_ISR(mux)         ((void)(mux), host_critical_enter())
+#define portEXIT_CRITICAL_ISR(mux)          ((void)(mux), host_critical_exit())
+#define taskENTER_CRITICAL(mux)             ((void)(mux), host_critical_enter())
+#define taskEXIT_CRITICAL(mux)              ((void)(mux), host_critical_exit())
@@ -0,0 +1,34 @@
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <string.h>
+
+// no lwip/sockets.h here, its macros would call these functions from themselves
+int host_bind(int fd, const struct sockaddr *addr, socklen_t len);
+int host_setsockopt(int fd, int level, int name, const void *value, socklen_t len);
+
+int host_bind(int fd, const struct sockaddr *addr, socklen_t len)
+{
+    int one = 1;
+    struct in_addr lo = {.s_addr = htonl(INADDR_LOOPBACK)};
+
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(fd, IPPROTO_IP, IP_MULTICAST_IF, &lo, sizeof(lo));
+    return bind(fd, addr, len);
+}
+
+int host_setsockopt(int fd, int level, int name, const void *value, socklen_t len)
+{
+    unsigned char loop = 1;
+    struct ip_mreq mreq = {0};
+
+    if (IPPROTO_IP == level && IP_MULTICAST_LOOP == name) {
+        return setsockopt(fd, level, name, &loop, sizeof(loop));
+    }
+    if (IPPROTO_IP == level && IP_ADD_MEMBERSHIP == name && len >= sizeof(mreq)) {
+        memcpy(&mreq, value, sizeof(mreq));
+        mreq.imr_interface.s_addr = htonl(INADDR_LOOPBACK);
+        return setsockopt(fd, level, name, &mreq, sizeof(mreq));
+    }
+    return setsockopt(fd, level, name, value, len);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+// lwip has the BSD socket API, the host sockets stand in for it
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+// the tests play the other hosts of the link on lo: every socket sends its multicast there and
+// hears it back, and several of them share port 5353, as the responders of a real link do
+int host_bind(int fd, const struct sockaddr *addr, socklen_t len);
+int host_setsockopt(int fd, int level, int name, const void *value, socklen_t len);
+
+#define bind        host_bind
+#define setsockopt  host_setsockopt
+#define closesocket close
@@ -0,0 +1,289 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nvs.h"
+
+#define HOST_NVS_ITEMS                      64
+#define HOST_NVS_NAMESPACES                 8
+#define HOST_NVS_VALUE_MAX                  512
+#define HOST_NVS_ENTRY_SIZE                 32
+#define HOST_NVS_TOTAL_ENTRIES              630 // 5 data pages of 126 entries, the default 24KB partition
+
+typedef struct {
+    uint8_t ns;                         // index in s_namespaces + 1, 0 - free
+    nvs_type_t type;
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    uint8_t value[HOST_NVS_VALUE_MAX];
+    size_t length;
+} host_nvs_item_t;
+
+struct host_nvs_iterator {
+    uint8_t ns;
+    nvs_type_t type;
+    int pos;
+};
+
+// handles are the namespace index + 1, they are never really closed
+static char s_namespaces[HOST_NVS_NAMESPACES][16] = {{0}};
+static host_nvs_item_t s_items[HOST_NVS_ITEMS] = {0};
+static esp_err_t s_write_err = ESP_OK;
+static bool s_hold_writes = false;
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_hold_cond = PTHREAD_COND_INITIALIZER;
+
+// a string is its head entry and the data, a blob an index entry, a chunk header and the data
+static size_t item_entries(const host_nvs_item_t *item)
+{
+    if (NVS_TYPE_STR == item->type) {
+        return 1 + (item->length + HOST_NVS_ENTRY_SIZE - 1) / HOST_NVS_ENTRY_SIZE;
+    }
+    return 2 + (item->length + HOST_NVS_ENTRY_SIZE - 1) / HOST_NVS_ENTRY_SIZE;
+}
+
+static host_nvs_item_t *find_item(nvs_handle_t handle, const char *key)
+{
+    int i = 0;
+
+    for (i = 0; i < HOST_NVS_ITEMS; i++) {
+        if (s_items[i].ns == handle && 0 == strcmp(s_items[i].key, key)) {
+            return &s_items[i];
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t set_item(nvs_handle_t handle, nvs_type_t type, const char *key, const void *value, size_t length)
+{
+    host_nvs_item_t *item = NULL;
+    int i = 0;
+    esp_err_t err = ESP_OK;
+
+    if (0 == handle || handle > HOST_NVS_NAMESPACES || strlen(key) >= NVS_KEY_NAME_MAX_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (length > HOST_NVS_VALUE_MAX) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    pthread_mutex_lock(&s_lock);
+    while (s_hold_writes) {
+        pthread_cond_wait(&s_hold_cond, &s_lock);
+    }
+    err = s_write_err;
+    item = find_item(handle, key);
+    for (i = 0; ESP_OK == err && NULL == item && i < HOST_NVS_ITEMS; i++) {
+        if (0 == s_items[i].ns) {
+            item = &s_items[i];
+        }
+    }
+    if (ESP_OK == err && NULL == item) {
+        err = ESP_ERR_NVS_NO_FREE_PAGES;
+    }
+    if (ESP_OK == err) {
+        item->ns = handle;
+        item->type = type;
+        strcpy(item->key, key);
+        memcpy(item->value, value, length);
+        item->length = length;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return err;
+}
+
+static esp_err_t get_item(nvs_handle_t handle, nvs_type_t type, const char *key, void *out_value, size_t *length)
+{
+    host_nvs_item_t *item = NULL;
+    esp_err_t err = ESP_OK;
+
+    pthread_mutex_lock(&s_lock);
+    item = find_item(handle, key);
+    if (NULL == item || item->type != type) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else if (out_value && *length < item->length) {
+        err = ESP_ERR_INVALID_SIZE;
+    } else if (out_value) {
+        memcpy(out_value, item->value, item->length);
+    }
+    if (item && ESP_ERR_NVS_NOT_FOUND != err) {
+        *length = item->length;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return err;
+}
+
+esp_err_t nvs_open(const char *namespace_name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle)
+{
+    int i = 0;
+    esp_err_t err = ESP_ERR_NVS_NOT_FOUND;
+
+    pthread_mutex_lock(&s_lock);
+    for (i = 0; i < HOST_NVS_NAMESPACES && s_namespaces[i][0]; i++) {
+        if (0 == strcmp(s_namespaces[i], namespace_name)) {
+            break;
+        }
+    }
+    if (i < HOST_NVS_NAMESPACES && s_namespaces[i][0]) {
+        err = ESP_OK;
+    } else if (NVS_READWRITE == open_mode && i < HOST_NVS_NAMESPACES) {
+        strncpy(s_namespaces[i], namespace_name, sizeof(s_namespaces[i]) - 1);
+        err = ESP_OK;
+    } else if (NVS_READWRITE == open_mode) {
+        err = ESP_ERR_NVS_NO_FREE_PAGES;
+    }
+    pthread_mutex_unlock(&s_lock);
+    *out_handle = ESP_OK == err ? i + 1 : 0;
+    return err;
+}
+
+void nvs_close(nvs_handle_t handle)
+{
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle)
+{
+    return s_write_err;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length)
+{
+    return set_item(handle, NVS_TYPE_BLOB, key, value, length);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length)
+{
+    return get_item(handle, NVS_TYPE_BLOB, key, out_value, length);
+}
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char *key, const char *value)
+{
+    return set_item(handle, NVS_TYPE_STR, key, value, strlen(value) + 1);
+}
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out_value, size_t *length)
+{
+    return get_item(handle, NVS_TYPE_STR, key, out_value, length);
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key)
+{
+    host_nvs_item_t *item = NULL;
+
+    pthread_mutex_lock(&s_lock);
+    item = find_item(handle, key);
+    if (item) {
+        memset(item, 0, sizeof(*item));
+    }
+    pthread_mutex_unlock(&s_lock);
+    return item ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_get_stats(const char *part_name, nvs_stats_t *nvs_stats)
+{
+    int i = 0;
+
+    memset(nvs_stats, 0, sizeof(*nvs_stats));
+    pthread_mutex_lock(&s_lock);
+    for (i = 0; i < HOST_NVS_NAMESPACES && s_namespaces[i][0]; i++) {
+        nvs_stats->namespace_count++;
+        nvs_stats->used_entries++;
+    }
+    for (i = 0; i < HOST_NVS_ITEMS; i++) {
+        if (s_items[i].ns) {
+            nvs_stats->used_entries += item_entries(&s_items[i]);
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    nvs_stats->total_entries = HOST_NVS_TOTAL_ENTRIES;
+    nvs_stats->free_entries = HOST_NVS_TOTAL_ENTRIES - nvs_stats->used_entries;
+    nvs_stats->available_entries = nvs_stats->free_entries;
+    return ESP_OK;
+}
+
+static bool iterator_seek(nvs_iterator_t iterator)
+{
+    for (; iterator->pos < HOST_NVS_ITEMS; iterator->pos++) {
+        if (s_items[iterator->pos].ns == iterator->ns
+            && (NVS_TYPE_ANY == iterator->type || s_items[iterator->pos].type == iterator->type)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+esp_err_t nvs_entry_find(const char *part_name, const char *namespace_name, nvs_type_t type, nvs_iterator_t *output_iterator)
+{
+    nvs_iterator_t iterator = NULL;
+    nvs_handle_t handle = 0;
+    bool found = false;
+
+    *output_iterator = NULL;
+    if (ESP_OK != nvs_open(namespace_name, NVS_READONLY, &handle)) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    iterator = calloc(1, sizeof(*iterator));
+    iterator->ns = handle;
+    iterator->type = type;
+    pthread_mutex_lock(&s_lock);
+    found = iterator_seek(iterator);
+    pthread_mutex_unlock(&s_lock);
+    if (!found) {
+        free(iterator);
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    *output_iterator = iterator;
+    return ESP_OK;
+}
+
+// as in esp-idf, the iterator is released and set to NULL once it runs past the last entry
+esp_err_t nvs_entry_next(nvs_iterator_t *iterator)
+{
+    bool found = false;
+
+    pthread_mutex_lock(&s_lock);
+    (*iterator)->pos++;
+    found = iterator_seek(*iterator);
+    pthread_mutex_unlock(&s_lock);
+    if (!found) {
+        free(*iterator);
+        *iterator = NULL;
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t nvs_entry_info(const nvs_iterator_t iterator, nvs_entry_info_t *out_info)
+{
+    pthread_mutex_lock(&s_lock);
+    strcpy(out_info->namespace_name, s_namespaces[iterator->ns - 1]);
+    strcpy(out_info->key, s_items[iterator->pos].key);
+    out_info->type = s_items[iterator->pos].type;
+    pthread_mutex_unlock(&s_lock);
+    return ESP_OK;
+}
+
+void nvs_release_iterator(nvs_iterator_t iterator)
+{
+    free(iterator);
+}
+
+void host_nvs_erase_all(void)
+{
+    pthread_mutex_lock(&s_lock);
+    memset(s_namespaces, 0, sizeof(s_namespaces));
+    memset(s_items, 0, sizeof(s_items));
+    s_write_err = ESP_OK;
+    pthread_mutex_unlock(&s_lock);
+}
+
+void host_nvs_fail_writes(esp_err_t err)
+{
+    s_write_err = err;
+}
+
+void host_nvs_hold_writes(bool hold)
+{
+    pthread_mutex_lock(&s_lock);
+    s_hold_writes = hold;
+    pthread_cond_broadcast(&s_hold_cond);
+    pthread_mutex_unlock(&s_lock);
+}
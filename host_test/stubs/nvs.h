@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+// nvs in ram, blobs and strings only, the entries are counted the way the flash layout spends them
+
+#define NVS_DEFAULT_PART_NAME               "nvs"
+#define NVS_KEY_NAME_MAX_SIZE               16
+
+typedef uint32_t nvs_handle_t;
+typedef struct host_nvs_iterator *nvs_iterator_t;
+
+typedef enum {
+    NVS_READONLY,
+    NVS_READWRITE,
+} nvs_open_mode_t;
+
+typedef enum {
+    NVS_TYPE_STR = 0x21,
+    NVS_TYPE_BLOB = 0x42,
+    NVS_TYPE_ANY = 0xFF,
+} nvs_type_t;
+
+typedef struct {
+    char namespace_name[16];
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    nvs_type_t type;
+} nvs_entry_info_t;
+
+typedef struct {
+    size_t used_entries;
+    size_t free_entries;
+    size_t available_entries;
+    size_t total_entries;
+    size_t namespace_count;
+} nvs_stats_t;
+
+esp_err_t nvs_open(const char *namespace_name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle);
+void nvs_close(nvs_handle_t handle);
+esp_err_t nvs_commit(nvs_handle_t handle);
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length);
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length);
+esp_err_t nvs_set_str(nvs_handle_t handle, const char *key, const char *value);
+esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out_value, size_t *length);
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key);
+esp_err_t nvs_get_stats(const char *part_name, nvs_stats_t *nvs_stats);
+esp_err_t nvs_entry_find(const char *part_name, const char *namespace_name, nvs_type_t type, nvs_iterator_t *output_iterator);
+esp_err_t nvs_entry_next(nvs_iterator_t *iterator);
+esp_err_t nvs_entry_info(const nvs_iterator_t iterator, nvs_entry_info_t *out_info);
+void nvs_release_iterator(nvs_iterator_t iterator);
+
+// the tests start from an erased partition, and make the next writes fail as a full or worn flash would
+void host_nvs_erase_all(void);
+// err for each nvs_set_* and nvs_commit from now on, ESP_OK - writes work again
+void host_nvs_fail_writes(esp_err_t err);
+// true - nvs_set_* blocks until called again with false, the writer stalls as on a slow flash erase
+void host_nvs_hold_writes(bool hold);
@@ -0,0 +1,345 @@
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include "driver/rmt_tx.h"
+#include "driver/rmt_rx.h"
+#include "esp_timer.h"
+
+struct rmt_channel_t {
+    bool tx;
+    size_t mem_block_symbols;
+    uint32_t resolution_hz;
+    void *user_data;
+    // rx
+    rmt_rx_done_callback_t on_recv_done;
+    rmt_symbol_word_t *buffer;
+    size_t buffer_symbols;
+    rmt_receive_config_t config;
+    bool armed;
+    // tx
+    rmt_tx_done_callback_t on_trans_done;
+    size_t mem_free;                    // symbols the encoder may write before it has to wait for a refill
+    int64_t busy_until;                 // us, the end of the last frame queued
+};
+
+typedef struct {
+    rmt_encoder_t base;
+    size_t pos;                         // symbols of the data already written
+} host_copy_encoder_t;
+
+typedef struct {
+    rmt_encoder_t base;
+    rmt_bytes_encoder_config_t config;
+    size_t bit;                         // bits of the data already written
+} host_bytes_encoder_t;
+
+static host_rmt_tx_frame_t s_tx_frames[HOST_RMT_TX_FRAMES] = {0};
+static rmt_symbol_word_t s_tx_symbols[HOST_RMT_TX_SYMBOLS] = {0};
+static uint32_t s_tx_frame_num = 0;
+static uint32_t s_tx_symbol_num = 0;
+static pthread_mutex_t s_tx_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t s_rx_lock = PTHREAD_MUTEX_INITIALIZER;
+static rmt_channel_handle_t s_rx_channel = NULL;
+static rmt_channel_handle_t s_tx_channel = NULL;
+
+static void sleep_us(int64_t us)
+{
+    struct timespec ts = {.tv_sec = us / 1000000, .tv_nsec = us % 1000000 * 1000};
+
+    if (us > 0) {
+        nanosleep(&ts, NULL);
+    }
+}
+
+// the encoders write into the channel memory through here, false when it is full
+// as in esp-idf they set *ret_state rather than add to it, a caller may pass the state of its last call
+static bool mem_write(rmt_channel_handle_t channel, rmt_symbol_word_t symbol)
+{
+    if (0 == channel->mem_free) {
+        return false;
+    }
+    channel->mem_free--;
+    if (s_tx_symbol_num < HOST_RMT_TX_SYMBOLS) {
+        s_tx_symbols[s_tx_symbol_num++] = symbol;
+    }
+    return true;
+}
+
+static size_t copy_encode(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state)
+{
+    host_copy_encoder_t *copy_encoder = __containerof(encoder, host_copy_encoder_t, base);
+    const rmt_symbol_word_t *symbols = primary_data;
+    size_t num = data_size / sizeof(rmt_symbol_word_t), encoded = 0;
+
+    while (copy_encoder->pos < num) {
+        if (!mem_write(channel, symbols[copy_encoder->pos])) {
+            *ret_state = RMT_ENCODING_MEM_FULL;
+            return encoded;
+        }
+        copy_encoder->pos++;
+        encoded++;
+    }
+    copy_encoder->pos = 0;
+    *ret_state = RMT_ENCODING_COMPLETE;
+    return encoded;
+}
+
+static esp_err_t copy_reset(rmt_encoder_t *encoder)
+{
+    __containerof(encoder, host_copy_encoder_t, base)->pos = 0;
+    return ESP_OK;
+}
+
+static size_t bytes_encode(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state)
+{
+    host_bytes_encoder_t *bytes_encoder = __containerof(encoder, host_bytes_encoder_t, base);
+    const uint8_t *data = primary_data;
+    size_t encoded = 0;
+    uint8_t shift = 0;
+
+    while (bytes_encoder->bit < data_size * 8) {
+        shift = bytes_encoder->config.flags.msb_first ? 7 - bytes_encoder->bit % 8 : bytes_encoder->bit % 8;
+        if (!mem_write(channel, (data[bytes_encoder->bit / 8] >> shift) & 1 ? bytes_encoder->config.bit1 : bytes_encoder->config.bit0)) {
+            *ret_state = RMT_ENCODING_MEM_FULL;
+            return encoded;
+        }
+        bytes_encoder->bit++;
+        encoded++;
+    }
+    bytes_encoder->bit = 0;
+    *ret_state = RMT_ENCODING_COMPLETE;
+    return encoded;
+}
+
+static esp_err_t bytes_reset(rmt_encoder_t *encoder)
+{
+    __containerof(encoder, host_bytes_encoder_t, base)->bit = 0;
+    return ESP_OK;
+}
+
+static esp_err_t encoder_del(rmt_encoder_t *encoder)
+{
+    free(encoder);
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+{
+    host_copy_encoder_t *copy_encoder = calloc(1, sizeof(host_copy_encoder_t));
+
+    copy_encoder->base.encode = copy_encode;
+    copy_encoder->base.reset = copy_reset;
+    copy_encoder->base.del = encoder_del;
+    *ret_encoder = &copy_encoder->base;
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_bytes_encoder(const rmt_bytes_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+{
+    host_bytes_encoder_t *bytes_encoder = calloc(1, sizeof(host_bytes_encoder_t));
+
+    bytes_encoder->config = *config;
+    bytes_encoder->base.encode = bytes_encode;
+    bytes_encoder->base.reset = bytes_reset;
+    bytes_encoder->base.del = encoder_del;
+    *ret_encoder = &bytes_encoder->base;
+    return ESP_OK;
+}
+
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder)
+{
+    return encoder->del(encoder);
+}
+
+esp_err_t rmt_encoder_reset(rmt_encoder_handle_t encoder)
+{
+    return encoder->reset(encoder);
+}
+
+void *rmt_alloc_encoder_mem(size_t size)
+{
+    return calloc(1, size);
+}
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t *config, rmt_channel_handle_t *ret_chan)
+{
+    rmt_channel_handle_t channel = calloc(1, sizeof(struct rmt_channel_t));
+
+    channel->tx = true;
+    channel->mem_block_symbols = config->mem_block_symbols;
+    channel->resolution_hz = config->resolution_hz;
+    *ret_chan = channel;
+    s_tx_channel = channel;
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_rx_channel(const rmt_rx_channel_config_t *config, rmt_channel_handle_t *ret_chan)
+{
+    rmt_channel_handle_t channel = calloc(1, sizeof(struct rmt_channel_t));
+
+    channel->mem_block_symbols = config->mem_block_symbols;
+    channel->resolution_hz = config->resolution_hz;
+    *ret_chan = channel;
+    s_rx_channel = channel;
+    return ESP_OK;
+}
+
+esp_err_t rmt_enable(rmt_channel_handle_t channel)
+{
+    return ESP_OK;
+}
+
+esp_err_t rmt_disable(rmt_channel_handle_t channel)
+{
+    return ESP_OK;
+}
+
+esp_err_t rmt_del_channel(rmt_channel_handle_t channel)
+{
+    if (s_rx_channel == channel) {
+        s_rx_channel = NULL;
+    }
+    if (s_tx_channel == channel) {
+        s_tx_channel = NULL;
+    }
+    free(channel);
+    return ESP_OK;
+}
+
+esp_err_t rmt_apply_carrier(rmt_channel_handle_t channel, const rmt_carrier_config_t *config)
+{
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_register_event_callbacks(rmt_channel_handle_t tx_channel, const rmt_tx_event_callbacks_t *cbs, void *user_data)
+{
+    tx_channel->on_trans_done = cbs->on_trans_done;
+    tx_channel->user_data = user_data;
+    return ESP_OK;
+}
+
+esp_err_t rmt_rx_register_event_callbacks(rmt_channel_handle_t rx_channel, const rmt_rx_event_callbacks_t *cbs, void *user_data)
+{
+    rx_channel->on_recv_done = cbs->on_recv_done;
+    rx_channel->user_data = user_data;
+    return ESP_OK;
+}
+
+// the channel starts with its whole memory, each RMT_ENCODING_MEM_FULL waits for half of it to be sent
+esp_err_t rmt_transmit(rmt_channel_handle_t tx_channel, rmt_encoder_handle_t encoder, const void *payload, size_t payload_bytes, const rmt_transmit_config_t *config)
+{
+    host_rmt_tx_frame_t frame = {0};
+    rmt_tx_done_event_data_t edata = {0};
+    rmt_encode_state_t state = RMT_ENCODING_RESET;
+    int64_t now = esp_timer_get_time();
+    uint32_t i = 0;
+
+    if (!tx_channel->tx || NULL == payload || 0 == payload_bytes) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&s_tx_lock);
+    frame.start = tx_channel->busy_until > now ? tx_channel->busy_until : now;
+    frame.first = s_tx_symbol_num;
+    tx_channel->mem_free = tx_channel->mem_block_symbols;
+    while (1) {
+        state = RMT_ENCODING_RESET;
+        encoder->encode(encoder, tx_channel, payload, payload_bytes, &state);
+        if (!(state & RMT_ENCODING_MEM_FULL)) {
+            break;
+        }
+        frame.refills++;
+        tx_channel->mem_free = tx_channel->mem_block_symbols / 2;
+    }
+    frame.num = s_tx_symbol_num - frame.first;
+    tx_channel->busy_until = frame.start;
+    for (i = frame.first; i < s_tx_symbol_num; i++) {
+        tx_channel->busy_until += (s_tx_symbols[i].duration0 + s_tx_symbols[i].duration1) * 1000000LL / tx_channel->resolution_hz;
+    }
+    if (s_tx_frame_num < HOST_RMT_TX_FRAMES) {
+        s_tx_frames[s_tx_frame_num++] = frame;
+    }
+    pthread_mutex_unlock(&s_tx_lock);
+    if (tx_channel->on_trans_done) {
+        edata.num_symbols = frame.num;
+        tx_channel->on_trans_done(tx_channel, &edata, tx_channel->user_data);
+    }
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t tx_channel, int timeout_ms)
+{
+    int64_t left = tx_channel->busy_until - esp_timer_get_time();
+
+    if (timeout_ms >= 0 && left > timeout_ms * 1000LL) {
+        sleep_us(timeout_ms * 1000LL);
+        return ESP_ERR_TIMEOUT;
+    }
+    sleep_us(left);
+    return ESP_OK;
+}
+
+uint32_t host_rmt_tx_frames(const host_rmt_tx_frame_t **frames, const rmt_symbol_word_t **symbols)
+{
+    *frames = s_tx_frames;
+    if (symbols) {
+        *symbols = s_tx_symbols;
+    }
+    return s_tx_frame_num;
+}
+
+void host_rmt_tx_reset(void)
+{
+    if (s_tx_channel) {
+        rmt_tx_wait_all_done(s_tx_channel, -1);
+    }
+    pthread_mutex_lock(&s_tx_lock);
+    s_tx_frame_num = 0;
+    s_tx_symbol_num = 0;
+    pthread_mutex_unlock(&s_tx_lock);
+}
+
+esp_err_t rmt_receive(rmt_channel_handle_t rx_channel, void *buffer, size_t buffer_size, const rmt_receive_config_t *config)
+{
+    if (rx_channel->tx || rx_channel->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    rx_channel->buffer = buffer;
+    rx_channel->buffer_symbols = buffer_size / sizeof(rmt_symbol_word_t);
+    rx_channel->config = *config;
+    __atomic_store_n(&rx_channel->armed, true, __ATOMIC_SEQ_CST);
+    return ESP_OK;
+}
+
+rmt_symbol_word_t *host_rmt_rx_capture(const rmt_symbol_word_t *symbols, size_t num)
+{
+    rmt_channel_handle_t channel = s_rx_channel;
+    rmt_rx_done_event_data_t edata = {0};
+    rmt_symbol_word_t *buffer = NULL;
+    size_t n = 0;
+
+    pthread_mutex_lock(&s_rx_lock);
+    if (NULL == channel || !__atomic_load_n(&channel->armed, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_unlock(&s_rx_lock);
+        return NULL;
+    }
+    buffer = channel->buffer;
+    while (channel->config.flags.en_partial_rx && num > channel->buffer_symbols) {
+        memcpy(channel->buffer, symbols, channel->buffer_symbols * sizeof(rmt_symbol_word_t));
+        edata.received_symbols = channel->buffer;
+        edata.num_symbols = channel->buffer_symbols;
+        edata.flags.is_last = 0;
+        channel->on_recv_done(channel, &edata, channel->user_data);
+        symbols += channel->buffer_symbols;
+        num -= channel->buffer_symbols;
+    }
+    n = num < channel->buffer_symbols ? num : channel->buffer_symbols;
+    memcpy(channel->buffer, symbols, n * sizeof(rmt_symbol_word_t));
+    // the receive is over before the callback, which may arm the next one
+    __atomic_store_n(&channel->armed, false, __ATOMIC_SEQ_CST);
+    edata.received_symbols = channel->buffer;
+    edata.num_symbols = n;
+    edata.flags.is_last = 1;
+    channel->on_recv_done(channel, &edata, channel->user_data);
+    pthread_mutex_unlock(&s_rx_lock);
+    return buffer;
+}
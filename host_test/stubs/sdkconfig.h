@@ -0,0 +1,5 @@
+#pragma once
+
+// the components take their linux target paths, no flash partition, no rtc memory
+#define CONFIG_IDF_TARGET_LINUX             1
+#define CONFIG_FREERTOS_HZ                  1000
@@ -0,0 +1,8 @@
+#pragma once
+
+// an ESP32 by default, HOST_RMT_PINGPONG=1 stands for the chips with rx ping-pong
+#ifdef HOST_RMT_PINGPONG
+#define SOC_RMT_SUPPORT_RX_PINGPONG         HOST_RMT_PINGPONG
+#else
+#define SOC_RMT_SUPPORT_RX_PINGPONG         0
+#endif
@@ -5,20 +5,14 @@
 #include "driver/rmt_tx.h"
 #include "driver/rmt_rx.h"
 #include "ir_nec_encoder.h"
+#include "ir_proto.h"
 
 #define EXAMPLE_IR_RESOLUTION_HZ     1000000 // 1MHz, 1 tick = 1us
 #define EXAMPLE_IR_TX_GPIO_NUM       18
 #define EXAMPLE_IR_RX_GPIO_NUM       19
-#define EXAMPLE_IR_NEC_DECODE_MARGIN 200
-
-#define NEC_LEADING_CODE_DURATION_0  9000
-#define NEC_LEADING_CODE_DURATION_1  4500
-#define NEC_PAYLOAD_ZERO_DURATION_0  560
-#define NEC_PAYLOAD_ZERO_DURATION_1  560
-#define NEC_PAYLOAD_ONE_DURATION_0   560
-#define NEC_PAYLOAD_ONE_DURATION_1   1690
-#define NEC_REPEAT_CODE_DURATION_0   9000
-#define NEC_REPEAT_CODE_DURATION_1   2250
+#define EXAMPLE_IR_RX_SYMBOLS        64 // standard NEC frame 34 symbols
+#define EXAMPLE_IR_RX_QUEUE_LEN      8
+#define EXAMPLE_IR_RX_BUFFERS        (EXAMPLE_IR_RX_QUEUE_LEN + 2) // the queued ones, the one being parsed and the one being filled
 
 static const char *TAG = "ir_nec";
 
@@ -26,75 +20,61 @@ static rmt_channel_handle_t hd_rx_channel = NULL;
 static rmt_channel_handle_t hd_tx_channel = NULL;
 static QueueHandle_t hd_queue = NULL;
 static rmt_encoder_handle_t hd_nec_encoder = NULL;
-static uint16_t nec_address = 0;
-static uint16_t nec_command = 0;
-
+// the callback arms the next buffer at once, frames arriving while one is parsed and logged are not lost
+static rmt_symbol_word_t rx_buffers[EXAMPLE_IR_RX_BUFFERS][EXAMPLE_IR_RX_SYMBOLS] = {0};
+static uint8_t rx_next = 0;
+static volatile uint32_t rx_dropped = 0;
+static const rmt_receive_config_t receive_cfg = {
+    .signal_range_min_ns = 1250,     // the shortest duration for NEC signal is 560us, valid signal won't be treated as noise
+    .signal_range_max_ns = 12000000, // the longest duration for NEC signal is 9000us, the receive won't stop early
+};
 
-static inline bool nec_check_in_range(uint32_t signal_duration, uint32_t spec_duration)
-{
-    return (signal_duration < (spec_duration + EXAMPLE_IR_NEC_DECODE_MARGIN)) &&
-           (signal_duration > (spec_duration - EXAMPLE_IR_NEC_DECODE_MARGIN));
-}
-
-static bool nec_parse_logic0(rmt_symbol_word_t *rmt_nec_symbols)
-{
-    return nec_check_in_range(rmt_nec_symbols->duration0, NEC_PAYLOAD_ZERO_DURATION_0) &&
-           nec_check_in_range(rmt_nec_symbols->duration1, NEC_PAYLOAD_ZERO_DURATION_1);
-}
-
-static bool nec_parse_logic1(rmt_symbol_word_t *rmt_nec_symbols)
-{
-    return nec_check_in_range(rmt_nec_symbols->duration0, NEC_PAYLOAD_ONE_DURATION_0) &&
-           nec_check_in_range(rmt_nec_symbols->duration1, NEC_PAYLOAD_ONE_DURATION_1);
-}
 
 static bool nec_recv_done_cb(rmt_channel_handle_t channel, const rmt_rx_done_event_data_t *edata, void *user_data)
 {
     BaseType_t high_task_wakeup = pdFALSE;
-    xQueueSendFromISR(hd_queue, edata, &high_task_wakeup);
+
+    // a full queue drops the frame and keeps its buffer
+    if (pdTRUE == xQueueSendFromISR(hd_queue, edata, &high_task_wakeup)) {
+        rx_next = (rx_next + 1) % EXAMPLE_IR_RX_BUFFERS;
+    } else {
+        rx_dropped++;
+    }
+    rmt_receive(channel, rx_buffers[rx_next], sizeof(rx_buffers[0]), &receive_cfg);
     return high_task_wakeup == pdTRUE;
 }
 
-void nec_frame_parse(rmt_symbol_word_t *rmt_nec_symbols, size_t symbol_num)
+void ir_frame_parse(rmt_symbol_word_t *rmt_symbols, size_t symbol_num)
 {
+    ir_proto_stream_t stream = {0};
+    ir_proto_frame_t frame = {0};
+    esp_err_t err = ESP_ERR_NOT_FOUND, ret = ESP_OK;
+    uint32_t frames = 0;
     size_t i = 0;
 
-    ESP_LOGI(TAG, "NEC symbols");
+    ESP_LOGI(TAG, "IR symbols");
     for (i = 0; i < symbol_num; i++) {
-        ESP_LOGI(TAG, "%02d: {%d:%d},{%d:%d}", i, rmt_nec_symbols[i].level0, rmt_nec_symbols[i].duration0, rmt_nec_symbols[i].level1, rmt_nec_symbols[i].duration1);
+        ESP_LOGI(TAG, "%02d: {%d:%d},{%d:%d}", i, rmt_symbols[i].level0, rmt_symbols[i].duration0, rmt_symbols[i].level1, rmt_symbols[i].duration1);
     }
 
-    if (34 == symbol_num) {
-        if (!(nec_check_in_range(rmt_nec_symbols->duration0, NEC_LEADING_CODE_DURATION_0) && nec_check_in_range(rmt_nec_symbols->duration1, NEC_LEADING_CODE_DURATION_1))) {
-            ESP_LOGE(TAG, "invalid leading symbol");
-            return;
-        }
-        rmt_nec_symbols++;
-        for (i = 0; i < 16; i++) {
-            if (nec_parse_logic1(rmt_nec_symbols)) {
-                nec_address |= 1 << i;
-            } else if (nec_parse_logic0(rmt_nec_symbols)) {
-                nec_address &= ~(1 << i);
-            } else {
-                ESP_LOGE(TAG, "invalid address symbol:%u", i);
-                return;
+    // a held key may send the next frame before the receive times out, every frame in the capture is decoded
+    for (i = 0; i < symbol_num; i++) {
+        ret = ir_proto_stream_feed(&stream, rmt_symbols[i], &frame);
+        if (ESP_OK != ret) {
+            if (ESP_ERR_NOT_FOUND != ret && ESP_ERR_NOT_FINISHED != ret) {
+                err = ret;
             }
-            rmt_nec_symbols++;
+            continue;
         }
-        for (i = 0; i < 16; i++) {
-            if (nec_parse_logic1(rmt_nec_symbols)) {
-                nec_command |= 1 << i;
-            } else if (nec_parse_logic0(rmt_nec_symbols)) {
-                nec_command &= ~(1 << i);
-            } else {
-                ESP_LOGE(TAG, "invalid command symbol:%u", i);
-                return;
-            }
-            rmt_nec_symbols++;
+        frames++;
+        if (frame.repeat) {
+            ESP_LOGI(TAG, "%s repeat", ir_proto_name(frame.protocol));
+        } else {
+            ESP_LOGI(TAG, "%s frame: address=0x%04X, command=0x%04X, toggle=%u", ir_proto_name(frame.protocol), frame.address, frame.command, frame.toggle);
         }
-        ESP_LOGI(TAG, "NEC frame: address=0x%04X, command=0x%04X", nec_address, nec_command);
-    } else {
-        ESP_LOGE(TAG, "Unknown NEC frame");
+    }
+    if (0 == frames) {
+        ESP_LOGE(TAG, "Unknown IR frame, err:%d", stream.timing ? ESP_ERR_INVALID_SIZE : err);
     }
 }
 
@@ -131,15 +111,10 @@ void app_main(void) {
         .duty_cycle = 0.33,
         .frequency_hz = 38000,
     };
-    rmt_receive_config_t receive_cfg = {
-        .signal_range_min_ns = 1250,     // the shortest duration for NEC signal is 560us, valid signal won't be treated as noise
-        .signal_range_max_ns = 12000000, // the longest duration for NEC signal is 9000us, the receive won't stop early
-    };
-    rmt_symbol_word_t raw_symbols[64] = {0}; // standard NEC frame 34 symbols
     rmt_rx_done_event_data_t rx_data = {0};
-    uint32_t i = 0;
+    uint32_t i = 0, dropped = 0;
 
-    hd_queue = xQueueCreate(1, sizeof(rmt_rx_done_event_data_t));
+    hd_queue = xQueueCreate(EXAMPLE_IR_RX_QUEUE_LEN, sizeof(rmt_rx_done_event_data_t));
     rmt_new_ir_nec_encoder(EXAMPLE_IR_RESOLUTION_HZ, &hd_nec_encoder);
 
     rmt_new_rx_channel(&rx_channel_cfg, &hd_rx_channel);
@@ -149,13 +124,16 @@ void app_main(void) {
     rmt_enable(hd_tx_channel);
     rmt_enable(hd_rx_channel);
     
-    rmt_receive(hd_rx_channel, raw_symbols, sizeof(raw_symbols), &receive_cfg);
+    rmt_receive(hd_rx_channel, rx_buffers[rx_next], sizeof(rx_buffers[0]), &receive_cfg);
     while (1) {
         if (xQueueReceive(hd_queue, &rx_data, (1000 / portTICK_PERIOD_MS)) == pdPASS) {
-            nec_frame_parse(rx_data.received_symbols, rx_data.num_symbols);
-            rmt_receive(hd_rx_channel, raw_symbols, sizeof(raw_symbols), &receive_cfg);
+            ir_frame_parse(rx_data.received_symbols, rx_data.num_symbols);
         } else {
             ESP_LOGI(TAG, "%lu", i++);
         }
+        if (dropped != rx_dropped) {
+            dropped = rx_dropped;
+            ESP_LOGW(TAG, "rx queue full, %lu frames dropped", dropped);
+        }
     }
 }
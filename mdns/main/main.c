@@ -5,6 +5,8 @@
 #include "esp_event.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "esp_timer.h"
 #include "lwip/err.h"
 #include "lwip/sockets.h"
 #include "lwip/sys.h"
@@ -19,15 +21,35 @@
 #define CONFIG_MDNS_TRANSPORT               "_udp"
 #define CONFIG_MDNS_UDP_PORT                60001
 
+#define QUERY_SRV_DONE                      (0x01 << 0)
+#define QUERY_TXT_DONE                      (0x01 << 1)
+#define QUERY_A_DONE                        (0x01 << 2)
+
 
 static const char *TAG = "main";
+static EventGroupHandle_t query_evt = NULL;
+
+static void mdns_query_done_cb(uint32_t query_id, esp_err_t err, mdns_result_t *result, void *arg) {
+    ESP_LOGI(TAG, "async query done, id:%lu type:0x%04x err:%d", query_id, result ? result->type : 0, err);
+    xEventGroupSetBits(query_evt, (EventBits_t)arg);
+}
+
+static void mdns_browse_add_cb(mdns_ptr_t *instance, void *arg) {
+    ESP_LOGI(TAG, "browse add, ins_name:%s", instance->ins_name);
+}
+
+static void mdns_browse_remove_cb(mdns_ptr_t *instance, void *arg) {
+    ESP_LOGI(TAG, "browse remove, ins_name:%s", instance->ins_name);
+}
 
 static void mdns_test_cb(void *pvParameters) {
     esp_err_t err = ESP_OK;
     mdns_ptr_t ret_ptr = {0};
     mdns_srv_t ret_srv = {0};
     mdns_txt_t ret_txt[5] = {0};
-    uint32_t txt_cnt = 0;
+    uint32_t txt_cnt = 0, cache_hit = 0, cache_miss = 0;
+    int64_t start_time = 0;
+    char name[128] = {0};
     mdns_a_t ret_a = {0};
     mdns_aaaa_t ret_aaaa = {0};
     uint32_t ip_addr = *((uint32_t *)pvParameters);
@@ -60,6 +82,16 @@ static void mdns_test_cb(void *pvParameters) {
     }
     vTaskDelay(pdMS_TO_TICKS(1000));
 
+    // resolve SRV, TXT and A in one round-trip, the blocking queries below are answered from cache
+    query_evt = xEventGroupCreate();
+    start_time = esp_timer_get_time();
+    snprintf(name, sizeof(name), "%s.%s.%s.local", ret_ptr.ins_name, CONFIG_MDNS_SRVTYPE, CONFIG_MDNS_TRANSPORT);
+    mdns_query_async(name, MDNS_QUERY_TYPE_SRV, mdns_query_done_cb, (void *)QUERY_SRV_DONE, NULL);
+    mdns_query_async(name, MDNS_QUERY_TYPE_TXT, mdns_query_done_cb, (void *)QUERY_TXT_DONE, NULL);
+    mdns_query_async(name, MDNS_QUERY_TYPE_A, mdns_query_done_cb, (void *)QUERY_A_DONE, NULL);
+    xEventGroupWaitBits(query_evt, QUERY_SRV_DONE | QUERY_TXT_DONE | QUERY_A_DONE, pdTRUE, pdTRUE, portMAX_DELAY);
+    ESP_LOGI(TAG, "async query SRV/TXT/A cost:%lldus", esp_timer_get_time() - start_time);
+
     ESP_LOGI(TAG, "send query SRV, %s.%s.%s.local", ret_ptr.ins_name, CONFIG_MDNS_SRVTYPE, CONFIG_MDNS_TRANSPORT);
     err = mdns_query_srv(ret_ptr.ins_name, CONFIG_MDNS_SRVTYPE, CONFIG_MDNS_TRANSPORT, &ret_srv);
     if (ESP_OK == err) {
@@ -91,6 +123,12 @@ static void mdns_test_cb(void *pvParameters) {
     }
     vTaskDelay(pdMS_TO_TICKS(1000));
 
+    start_time = esp_timer_get_time();
+    err = mdns_query_a(ret_ptr.ins_name, CONFIG_MDNS_SRVTYPE, CONFIG_MDNS_TRANSPORT, &ret_a);
+    mdns_cache_get_stats(&cache_hit, &cache_miss);
+    ESP_LOGI(TAG, "query A again, err:%d cost:%lldus cache_hit:%lu cache_miss:%lu",
+        err, esp_timer_get_time() - start_time, cache_hit, cache_miss);
+
     ESP_LOGI(TAG, "send query AAAA, %s.%s.%s.local", ret_ptr.ins_name, CONFIG_MDNS_SRVTYPE, CONFIG_MDNS_TRANSPORT);
     err = mdns_query_aaaa(ret_ptr.ins_name, CONFIG_MDNS_SRVTYPE, CONFIG_MDNS_TRANSPORT, &ret_aaaa);
     if (ESP_OK == err) {
@@ -106,6 +144,7 @@ static void mdns_test_cb(void *pvParameters) {
 
     mdns_add_srv(CONFIG_MDNS_INSNAME, CONFIG_MDNS_SRVTYPE, CONFIG_MDNS_TRANSPORT, CONFIG_MDNS_UDP_PORT, &ser_ipV4, NULL, ser_txt, sizeof(ser_txt) / sizeof(ser_txt[0]));
     mdns_start_server();
+    mdns_browse_start(CONFIG_MDNS_SRVTYPE, CONFIG_MDNS_TRANSPORT, mdns_browse_add_cb, mdns_browse_remove_cb, NULL);
 
     vTaskDelete(NULL);
 }
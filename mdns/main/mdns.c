@@ -5,68 +5,190 @@
 #include "esp_event.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_random.h"
 #include "lwip/err.h"
 #include "lwip/sockets.h"
 #include "lwip/sys.h"
 #include <lwip/netdb.h>
+#include <strings.h>
+#include <sys/param.h>
 #include "mdns.h"
+#include "mdns_parser.h"
+
+#define MDNS_NAME_MAX_LEN                           128
+#define MDNS_QUERY_MAX_LEN                          (12 + MDNS_NAME_MAX_LEN + 2 + 4)
+#define MDNS_BROWSE_REFRESH_CNT                     4 // at 80%, 85%, 90% and 95% of the TTL (RFC 6762 5.2)
+
+typedef struct {
+    uint8_t srv_idx;
+    uint16_t type;
+} mdns_answer_t;
+
+typedef struct {
+    char name[MDNS_NAME_MAX_LEN];
+    uint32_t ttl; // seconds
+    int64_t update_time; // us
+    uint8_t refresh_sent;
+    uint8_t wanted; // read since the last update, only these are refreshed
+    uint8_t used;
+    mdns_result_t result;
+} mdns_cache_entry_t;
+
+typedef struct {
+    uint8_t used;
+    uint32_t id;
+    char name[MDNS_NAME_MAX_LEN];
+    uint16_t type;
+    int64_t deadline; // us
+    mdns_query_cb_t cb;
+    void *arg;
+} mdns_pending_t;
+
+typedef struct {
+    uint8_t used;
+    char ins_name[32];
+    uint32_t ttl; // seconds
+    int64_t update_time; // us
+    uint8_t refresh_cnt; // maintenance queries sent since the last update
+} mdns_browse_ins_t;
+
+typedef struct {
+    uint8_t used;
+    char name[MDNS_NAME_MAX_LEN];
+    uint32_t interval; // seconds
+    int64_t next_query; // us
+    mdns_browse_cb_t add_cb;
+    mdns_browse_cb_t remove_cb;
+    void *arg;
+    mdns_browse_ins_t ins[CONFIG_MDNS_BROWSE_MAX_INSTANCE];
+} mdns_browse_t;
+
+typedef struct {
+    SemaphoreHandle_t done;
+    esp_err_t err;
+    mdns_result_t *result;
+} mdns_sync_ctx_t;
+
+typedef struct {
+    uint8_t *buf;
+    uint32_t ttl; // seconds
+    uint16_t type_offset[CONFIG_MDNS_MAX_SERVICE]; // name compression, 0 if not written yet
+    uint16_t ins_offset[CONFIG_MDNS_MAX_SERVICE];
+} mdns_resp_ctx_t;
 
 static const char *TAG = "mdns";
-static int sock = 0;
-static uint8_t req[256] = {0};
-static uint8_t resp[1024] = {0};
+static int srv_sock = -1; // port 5353 multicast member, owned by mdns_srv: responder, browse and cache refresh
+static uint8_t srv_req[512] = {0};
+static uint8_t srv_resp[1024] = {0};
+static uint8_t srv_query[512] = {0}; // cache refresh, all due entries in one query
+static int query_sock = -1; // ephemeral port, owned by mdns_rx: one-shot queries and their unicast responses
+static uint8_t query_buf[1024] = {0};
 static mdns_service_t g_srv[CONFIG_MDNS_MAX_SERVICE] = {0};
 static uint8_t srv_cnt = 0;
-
-esp_err_t mdns_init() {
-    int err = 0;
+static mdns_cache_entry_t g_cache[CONFIG_MDNS_CACHE_SIZE] = {0};
+static SemaphoreHandle_t cache_mutex = NULL;
+static uint32_t cache_hit = 0;
+static uint32_t cache_miss = 0;
+static mdns_pending_t g_pending[CONFIG_MDNS_MAX_PENDING] = {0};
+static SemaphoreHandle_t pending_mutex = NULL;
+static uint32_t pending_id = 0;
+static uint8_t server_started = 0;
+static mdns_answer_t g_delayed[CONFIG_MDNS_MAX_ANSWER] = {0}; // multicast response waiting for its random delay
+static uint32_t delayed_cnt = 0;
+static int64_t delayed_deadline = 0;
+static int64_t g_last_multicast[CONFIG_MDNS_MAX_SERVICE][4] = {0}; // PTR, SRV, TXT, A
+static mdns_server_stats_t server_stats = {0};
+static portMUX_TYPE server_stats_lock = portMUX_INITIALIZER_UNLOCKED; // written by mdns_srv, read by any task
+static mdns_browse_t g_browse[CONFIG_MDNS_MAX_BROWSE] = {0};
+static SemaphoreHandle_t browse_mutex = NULL;
+
+static void mdns_rx_task(void *pvParameters);
+static void mdns_srv_task(void *pvParameters);
+static void mdns_browse_update(mdns_cache_entry_t *record);
+
+// port 0 binds an ephemeral port, only the responder socket joins the multicast group
+static int mdns_create_socket(uint16_t port, uint8_t join_group) {
+    int fd = -1, err = 0;
     struct sockaddr_in local_addr = {0};
     uint8_t ttl = 3;
     uint8_t loopback = 0;
     struct ip_mreq imreq = {0};
-    struct timeval tv = {
-        .tv_sec = CONFIG_MDNS_RECV_TIMEOUT / 1000,
-        .tv_usec = (CONFIG_MDNS_RECV_TIMEOUT % 1000) * 1000
-    };
 
-    sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
-    if (sock < 0) {
+    fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+    if (fd < 0) {
         ESP_LOGE(TAG, "socket create failed:%d", errno);
-        goto exit;
+        return -1;
     }
 
     local_addr.sin_family = AF_INET;
     local_addr.sin_addr.s_addr = htonl(INADDR_ANY);
-    local_addr.sin_port = htons(MDNS_UPD_PORT);
-    err = bind(sock, (struct sockaddr *)&local_addr, sizeof(local_addr));
+    local_addr.sin_port = htons(port);
+    err = bind(fd, (struct sockaddr *)&local_addr, sizeof(local_addr));
     if (err != 0) {
         ESP_LOGE(TAG, "socket bind failed:%d", errno);
         goto exit;
     }
 
-    err = setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+    err = setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
     if (err < 0) {
         ESP_LOGE(TAG, "socket set IP_MULTICAST_TTL failed:%d", errno);
         goto exit;
     }
 
-    err = setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP, &loopback, sizeof(loopback));
+    err = setsockopt(fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loopback, sizeof(loopback));
     if (err < 0) {
         ESP_LOGE(TAG, "socket set IP_MULTICAST_LOOP failed:%d", errno);
         goto exit;
     }
 
-    imreq.imr_multiaddr.s_addr = inet_addr(MDNS_UPD_IP);
-    imreq.imr_interface.s_addr = htonl(INADDR_ANY);
-    err = setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &imreq, sizeof(imreq));
-    if (err < 0) {
-        ESP_LOGE(TAG, "socket set IP_ADD_MEMBERSHIP failed:%d", errno);
+    if (join_group) {
+        imreq.imr_multiaddr.s_addr = inet_addr(MDNS_UPD_IP);
+        imreq.imr_interface.s_addr = htonl(INADDR_ANY);
+        err = setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &imreq, sizeof(imreq));
+        if (err < 0) {
+            ESP_LOGE(TAG, "socket set IP_ADD_MEMBERSHIP failed:%d", errno);
+            goto exit;
+        }
+    }
+
+    return fd;
+
+exit:
+    close(fd);
+    return -1;
+}
+
+esp_err_t mdns_init() {
+    TaskHandle_t srv_task = NULL;
+    int err = 0;
+
+    cache_mutex = xSemaphoreCreateMutex();
+    pending_mutex = xSemaphoreCreateMutex();
+    browse_mutex = xSemaphoreCreateMutex();
+    if (!cache_mutex || !pending_mutex || !browse_mutex) {
+        ESP_LOGE(TAG, "xSemaphoreCreateMutex failed");
+        err = ESP_ERR_NO_MEM;
         goto exit;
     }
 
-    err = setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-    if (err < 0) {
-        ESP_LOGE(TAG, "socket set SO_RCVTIMEO failed:%d", errno);
+    srv_sock = mdns_create_socket(MDNS_UPD_PORT, 1);
+    query_sock = mdns_create_socket(0, 0);
+    if (srv_sock < 0 || query_sock < 0) {
+        err = ESP_FAIL;
+        goto exit;
+    }
+
+    if (pdPASS != xTaskCreate(mdns_srv_task, "mdns_srv", CONFIG_MDNS_TASK_STACK_SIZE, NULL, CONFIG_MDNS_TASK_PRIORITY, &srv_task)) {
+        ESP_LOGE(TAG, "xTaskCreate mdns_srv failed");
+        err = ESP_ERR_NO_MEM;
+        goto exit;
+    }
+
+    if (pdPASS != xTaskCreate(mdns_rx_task, "mdns_rx", CONFIG_MDNS_TASK_STACK_SIZE, NULL, CONFIG_MDNS_TASK_PRIORITY, NULL)) {
+        ESP_LOGE(TAG, "xTaskCreate mdns_rx failed");
+        err = ESP_ERR_NO_MEM;
         goto exit;
     }
 
@@ -75,346 +197,811 @@ esp_err_t mdns_init() {
 
 exit:
     ESP_LOGE(TAG, "mdns socket init failed:%d", err);
+    // everything made so far, a retry starts from nothing and can bind 5353 again
+    if (srv_task) {
+        vTaskDelete(srv_task); // before the socket and the mutexes it uses
+    }
+    if (srv_sock >= 0) {
+        close(srv_sock);
+        srv_sock = -1;
+    }
+    if (query_sock >= 0) {
+        close(query_sock);
+        query_sock = -1;
+    }
+    if (cache_mutex) {
+        vSemaphoreDelete(cache_mutex);
+        cache_mutex = NULL;
+    }
+    if (pending_mutex) {
+        vSemaphoreDelete(pending_mutex);
+        pending_mutex = NULL;
+    }
+    if (browse_mutex) {
+        vSemaphoreDelete(browse_mutex);
+        browse_mutex = NULL;
+    }
     return err;
 }
 
-esp_err_t mdns_query_ptr(char *srv_type, char *trans_type, mdns_ptr_t *result) {
-    uint32_t req_len = 0, i = 0;
-    int resp_len = 0;
-    char *domain = "local";
-    struct sockaddr_in remote_addr = {0};
-    socklen_t addr_len = sizeof(remote_addr);
+static mdns_cache_entry_t *mdns_cache_find(const char *name, uint16_t type) {
+    uint32_t i = 0;
+    int64_t now = esp_timer_get_time();
+
+    for (i = 0; i < CONFIG_MDNS_CACHE_SIZE; i++) {
+        if (!g_cache[i].used) {
+            continue;
+        }
+        if (now - g_cache[i].update_time >= (int64_t)g_cache[i].ttl * 1000000) { // expired
+            g_cache[i].used = 0;
+            continue;
+        }
+        if (g_cache[i].result.type == type && 0 == strcasecmp(g_cache[i].name, name)) {
+            return &g_cache[i];
+        }
+    }
 
-    req[req_len++] = 0;
-    req[req_len++] = 0; // trans_id
-    req[req_len++] = 0;
-    req[req_len++] = 0; // flags: standard query
-    req[req_len++] = 0;
-    req[req_len++] = 1; // question
-    req[req_len++] = 0;
-    req[req_len++] = 0; // answer
-    req[req_len++] = 0;
-    req[req_len++] = 0; // authority
-    req[req_len++] = 0;
-    req[req_len++] = 0; // additional
-
-    req[req_len++] = strlen(srv_type);
-    memcpy(&req[req_len], srv_type, strlen(srv_type));
-    req_len += strlen(srv_type);
-    req[req_len++] = strlen(trans_type);
-    memcpy(&req[req_len], trans_type, strlen(trans_type));
-    req_len += strlen(trans_type);
-    req[req_len++] = strlen(domain);
-    memcpy(&req[req_len], domain, strlen(domain));
-    req_len += strlen(domain);
-    req[req_len++] = 0;
-
-    req[req_len++] = 0;
-    req[req_len++] = MDNS_QUERY_TYPE_PTR; // type
-    req[req_len++] = 0;
-    req[req_len++] = 0x01; // class, multicase response
+    return NULL;
+}
 
-    remote_addr.sin_family = AF_INET;
-    remote_addr.sin_addr.s_addr = inet_addr(MDNS_UPD_IP);
-    remote_addr.sin_port = htons(MDNS_UPD_PORT);
-    sendto(sock, req, req_len, 0, (struct sockaddr *)&remote_addr, addr_len);
+static void mdns_cache_put(mdns_cache_entry_t *record) {
+    uint32_t i = 0, victim = 0;
+    int64_t now = esp_timer_get_time(), remain = 0, min_remain = INT64_MAX;
 
-    resp_len = recvfrom(sock, resp, sizeof(resp), 0, (struct sockaddr *)&remote_addr, &addr_len);
-    if (resp_len < 0) {
-        ESP_LOGE(TAG, "socket recv timeout");
-        return ESP_ERR_TIMEOUT;
+    for (i = 0; i < CONFIG_MDNS_CACHE_SIZE; i++) {
+        if (g_cache[i].used && g_cache[i].result.type == record->result.type && 0 == strcasecmp(g_cache[i].name, record->name)) {
+            if (MDNS_QUERY_TYPE_PTR != record->result.type || 0 == strcmp(g_cache[i].result.data.ptr.ins_name, record->result.data.ptr.ins_name)) {
+                victim = i;
+                break;
+            }
+        }
+
+        // replace the empty or expired entry first, then the one closest to expire
+        remain = g_cache[i].used ? (int64_t)g_cache[i].ttl * 1000000 - (now - g_cache[i].update_time) : INT64_MIN;
+        if (remain < min_remain) {
+            min_remain = remain;
+            victim = i;
+        }
     }
 
-    i = 12; // skip trans_id(2B), flags(2B), question(2B), answer(2B), authority(2B), additional(2B)
-    while (resp[i]) { // skip name
-        i += resp[i] + 1;
+    if (0 == record->ttl) { // goodbye
+        if (i < CONFIG_MDNS_CACHE_SIZE) {
+            g_cache[victim].used = 0;
+        }
+        return;
     }
-    i++;
-    i += 10; // skip type(2B), class(2B), TTL(4B), length(2B)
 
-    memcpy(result->ins_name, &resp[i + 1], resp[i]);
+    memcpy(&g_cache[victim], record, sizeof(mdns_cache_entry_t));
+    g_cache[victim].update_time = now;
+    g_cache[victim].refresh_sent = 0;
+    g_cache[victim].used = 1;
+}
 
-    return ESP_OK;
+// decode a record for the cache, 0 if the type is not cached or the rdata is malformed
+static uint8_t mdns_cache_parse_record(const mdns_cursor_t *cur, const mdns_rr_t *rr, mdns_cache_entry_t *record) {
+    const uint8_t *rdata = &cur->buf[rr->rdata_offset];
+    const uint8_t *label = NULL;
+    mdns_name_t target = {0};
+    uint8_t kv_len = 0, label_len = 0;
+    const char *kv = NULL, *equal = NULL;
+    mdns_txt_t *txt = NULL;
+    uint32_t i = 0;
+
+    memset(record, 0, sizeof(mdns_cache_entry_t));
+    record->ttl = rr->ttl;
+    switch (rr->type) {
+    case MDNS_QUERY_TYPE_PTR:
+        if (ESP_OK != mdns_parse_rdata_name(cur, rr, 0, &target)) {
+            return 0;
+        }
+        mdns_name_first_label(&target, &label, &label_len); // instance label only
+        memcpy(record->result.data.ptr.ins_name, label, MIN(label_len, sizeof(record->result.data.ptr.ins_name) - 1));
+        break;
+    case MDNS_QUERY_TYPE_SRV:
+        if (rr->rdata_len < 7 || ESP_OK != mdns_parse_rdata_name(cur, rr, 6, &target) ||
+            ESP_OK != mdns_name_to_str(&target, record->result.data.srv.target, sizeof(record->result.data.srv.target))) {
+            return 0;
+        }
+        record->result.data.srv.priority = rdata[0] << 8 | rdata[1];
+        record->result.data.srv.weight = rdata[2] << 8 | rdata[3];
+        record->result.data.srv.port = rdata[4] << 8 | rdata[5];
+        break;
+    case MDNS_QUERY_TYPE_TXT:
+        for (i = 0; i < rr->rdata_len && record->result.data.txt.cnt < CONFIG_MDNS_SERVICE_MAX_TXT; i += kv_len + 1) {
+            kv_len = rdata[i];
+            if (i + 1 + kv_len > rr->rdata_len) {
+                break;
+            }
+            if (0 == kv_len) {
+                continue;
+            }
+            kv = (const char *)&rdata[i + 1];
+            equal = memchr(kv, '=', kv_len);
+            if (!equal) { // boolean attribute
+                equal = kv + kv_len;
+            }
+            txt = &record->result.data.txt.txt[record->result.data.txt.cnt++];
+            memcpy(txt->key, kv, MIN(equal - kv, sizeof(txt->key) - 1));
+            if (equal < kv + kv_len) {
+                memcpy(txt->value, equal + 1, MIN(kv + kv_len - equal - 1, sizeof(txt->value) - 1));
+            }
+        }
+        break;
+    case MDNS_QUERY_TYPE_A:
+        if (4 != rr->rdata_len) {
+            return 0;
+        }
+        memcpy(record->result.data.a.ip, rdata, 4);
+        break;
+    case MDNS_QUERY_TYPE_AAAA:
+        if (16 != rr->rdata_len) {
+            return 0;
+        }
+        memcpy(record->result.data.aaaa.ip, rdata, 16);
+        break;
+    default:
+        return 0;
+    }
+
+    // the owner name outlives the packet, this is the only copy made
+    if (ESP_OK != mdns_name_to_str(&rr->name, record->name, sizeof(record->name))) {
+        return 0;
+    }
+    record->result.type = rr->type;
+    return 1;
 }
 
-esp_err_t mdns_query_srv(char *ins_name, char *srv_type, char *trans_type, mdns_srv_t *result) {
-    uint32_t req_len = 0, i = 0;
-    int resp_len = 0;
-    char *domain = "local";
+static esp_err_t mdns_skip_questions(mdns_cursor_t *cur, uint16_t question_cnt) {
+    mdns_question_t question = {0};
+    esp_err_t err = ESP_OK;
+    uint32_t i = 0;
+
+    for (i = 0; i < question_cnt && ESP_OK == err; i++) {
+        err = mdns_parse_question(cur, &question);
+    }
+    return err;
+}
+
+// every response seen on the socket feeds the cache, solicited or not
+static void mdns_cache_add_packet(mdns_cursor_t cur, const mdns_header_t *header) {
+    mdns_cache_entry_t record = {0};
+    mdns_rr_t rr = {0};
+    uint32_t record_cnt = 0, i = 0;
+
+    if (ESP_OK != mdns_skip_questions(&cur, header->question_cnt)) {
+        return;
+    }
+    record_cnt = header->answer_cnt + header->authority_cnt + header->additional_cnt;
+
+    for (i = 0; i < record_cnt; i++) {
+        if (ESP_OK != mdns_parse_rr(&cur, &rr)) {
+            break;
+        }
+        if (!mdns_cache_parse_record(&cur, &rr, &record)) {
+            continue;
+        }
+        xSemaphoreTake(cache_mutex, portMAX_DELAY);
+        mdns_cache_put(&record);
+        xSemaphoreGive(cache_mutex);
+        if (MDNS_QUERY_TYPE_PTR == record.result.type) {
+            mdns_browse_update(&record);
+        }
+    }
+}
+
+// appends a QM question at buf[len], returns the new length, the caller updates the question count
+static uint32_t mdns_build_question(uint8_t *buf, uint32_t len, const char *name, uint16_t type) {
+    const char *label = name, *dot = NULL;
+
+    while (*label) {
+        dot = strchr(label, '.');
+        if (!dot) {
+            dot = label + strlen(label);
+        }
+        buf[len++] = dot - label;
+        memcpy(&buf[len], label, dot - label);
+        len += dot - label;
+        label = *dot ? dot + 1 : dot;
+    }
+    buf[len++] = 0;
+
+    buf[len++] = type >> 8;
+    buf[len++] = type; // type
+    buf[len++] = 0;
+    buf[len++] = 0x01; // class, multicase response
+
+    return len;
+}
+
+static uint32_t mdns_build_query(uint8_t *buf, const char *name, uint16_t type) {
+    memset(buf, 0, MDNS_HEADER_LEN); // trans_id 0, standard query
+    buf[5] = 1; // question
+
+    return mdns_build_question(buf, MDNS_HEADER_LEN, name, type);
+}
+
+// one-shot queries go out of query_sock and get unicast responses, continuous querying must use port 5353 (RFC 6762 5.2)
+// the responders cap the TTL of these answers at 10s (RFC 6762 6.7), an entry read again is refreshed from port 5353
+// before that runs out and the multicast answer brings the real TTL
+static void mdns_send_query(int fd, const char *name, uint16_t type) {
+    uint8_t query[MDNS_QUERY_MAX_LEN] = {0}; // callers run in any task, the static buffers belong to mdns_srv and mdns_rx
     struct sockaddr_in remote_addr = {0};
-    socklen_t addr_len = sizeof(remote_addr);
-    uint32_t target_len = 0, offset = 0;
-
-    req[req_len++] = 0;
-    req[req_len++] = 0; // trans_id
-    req[req_len++] = 0;
-    req[req_len++] = 0; // flags: standard query
-    req[req_len++] = 0;
-    req[req_len++] = 1; // question
-    req[req_len++] = 0;
-    req[req_len++] = 0; // answer
-    req[req_len++] = 0;
-    req[req_len++] = 0; // authority
-    req[req_len++] = 0;
-    req[req_len++] = 0; // additional
-
-    req[req_len++] = strlen(ins_name);
-    memcpy(&req[req_len], ins_name, strlen(ins_name));
-    req_len += strlen(ins_name);
-    req[req_len++] = strlen(srv_type);
-    memcpy(&req[req_len], srv_type, strlen(srv_type));
-    req_len += strlen(srv_type);
-    req[req_len++] = strlen(trans_type);
-    memcpy(&req[req_len], trans_type, strlen(trans_type));
-    req_len += strlen(trans_type);
-    req[req_len++] = strlen(domain);
-    memcpy(&req[req_len], domain, strlen(domain));
-    req_len += strlen(domain);
-    req[req_len++] = 0;
-
-    req[req_len++] = 0;
-    req[req_len++] = MDNS_QUERY_TYPE_SRV; // type
-    req[req_len++] = 0;
-    req[req_len++] = 0x01; // class, multicase response
+    uint32_t query_len = 0;
 
+    query_len = mdns_build_query(query, name, type);
     remote_addr.sin_family = AF_INET;
     remote_addr.sin_addr.s_addr = inet_addr(MDNS_UPD_IP);
     remote_addr.sin_port = htons(MDNS_UPD_PORT);
-    sendto(sock, req, req_len, 0, (struct sockaddr *)&remote_addr, addr_len);
+    sendto(fd, query, query_len, 0, (struct sockaddr *)&remote_addr, sizeof(remote_addr));
+}
 
-    resp_len = recvfrom(sock, resp, sizeof(resp), 0, (struct sockaddr *)&remote_addr, &addr_len);
-    if (resp_len < 0) {
-        ESP_LOGE(TAG, "socket recv timeout");
-        return ESP_ERR_TIMEOUT;
-    }
+// a hit marks the entry as wanted, mdns_srv refreshes it at CONFIG_MDNS_CACHE_REFRESH_PERCENT of its TTL
+static uint8_t mdns_cache_lookup(const char *name, uint16_t type, mdns_result_t *result) {
+    mdns_cache_entry_t *entry = NULL;
 
-    i = 12; // skip trans_id(2B), flags(2B), question(2B), answer(2B), authority(2B), additional(2B)
-    while (resp[i]) { // skip name
-        i += resp[i] + 1;
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    entry = mdns_cache_find(name, type);
+    if (entry) {
+        memcpy(result, &entry->result, sizeof(mdns_result_t));
+        entry->wanted = 1;
     }
-    i++;
-    i += 10; // skip type(2B), class(2B), TTL(4B), length(2B)
+    xSemaphoreGive(cache_mutex);
+
+    return entry ? 1 : 0;
+}
 
-    result->priority = resp[i] << 8 | resp[i + 1];
-    result->weight = resp[i + 2] << 8 | resp[i + 3];
-    result->port = resp[i + 4] << 8 | resp[i + 5];
-    if (0xc0 == resp[i + 6]) {
-        offset = resp[i + 7];
+// the queries run in any task
+static void mdns_cache_count(uint8_t hit) {
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    if (hit) {
+        cache_hit++;
     } else {
-        offset = i + 6;
+        cache_miss++;
     }
-    while (resp[offset]) {
-        memcpy(result->target + target_len, &resp[offset + 1], resp[offset]);
-        target_len += resp[offset];
-        result->target[target_len] = '.';
-        target_len += 1;
-        offset += resp[offset] + 1;
+    xSemaphoreGive(cache_mutex);
+}
+
+static int64_t mdns_cache_refresh_time(const mdns_cache_entry_t *entry) {
+    return entry->update_time + (int64_t)entry->ttl * 10000 * CONFIG_MDNS_CACHE_REFRESH_PERCENT;
+}
+
+// ms until the next wanted entry is due for refresh, capped by CONFIG_MDNS_RX_POLL_INTERVAL
+static uint32_t mdns_cache_next_timeout() {
+    uint32_t i = 0;
+    int64_t now = esp_timer_get_time(), next = now + CONFIG_MDNS_RX_POLL_INTERVAL * 1000;
+
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    for (i = 0; i < CONFIG_MDNS_CACHE_SIZE; i++) {
+        if (g_cache[i].used && g_cache[i].wanted && !g_cache[i].refresh_sent && mdns_cache_refresh_time(&g_cache[i]) < next) {
+            next = mdns_cache_refresh_time(&g_cache[i]);
+        }
     }
-    result->target[target_len - 1] = 0; // delete the last char "."
+    xSemaphoreGive(cache_mutex);
 
-    return ESP_OK;
+    return next > now ? (next - now + 999) / 1000 : 0;
 }
 
-esp_err_t mdns_query_txt(char *ins_name, char *srv_type, char *trans_type, mdns_txt_t *result, uint32_t *cnt) {
-    uint32_t req_len = 0, i = 0;
-    int resp_len = 0;
-    char *domain = "local";
+// runs in mdns_srv: requery the wanted entries before they expire, the multicast response updates them,
+// the entries due together go out as one query, a PTR/SRV/TXT/A resolve costs one packet
+static void mdns_cache_process() {
+    uint32_t i = 0, len = 0, question_cnt = 0;
     struct sockaddr_in remote_addr = {0};
-    socklen_t addr_len = sizeof(remote_addr);
-    uint16_t total_data_len = 0, data_len = 0, kv_len = 0;
-    char kv[64] = {0};
-    uint32_t kv_cnt = 0;
-    char *equal = NULL;
-
-    req[req_len++] = 0;
-    req[req_len++] = 0; // trans_id
-    req[req_len++] = 0;
-    req[req_len++] = 0; // flags: standard query
-    req[req_len++] = 0;
-    req[req_len++] = 1; // question
-    req[req_len++] = 0;
-    req[req_len++] = 0; // answer
-    req[req_len++] = 0;
-    req[req_len++] = 0; // authority
-    req[req_len++] = 0;
-    req[req_len++] = 0; // additional
-
-    req[req_len++] = strlen(ins_name);
-    memcpy(&req[req_len], ins_name, strlen(ins_name));
-    req_len += strlen(ins_name);
-    req[req_len++] = strlen(srv_type);
-    memcpy(&req[req_len], srv_type, strlen(srv_type));
-    req_len += strlen(srv_type);
-    req[req_len++] = strlen(trans_type);
-    memcpy(&req[req_len], trans_type, strlen(trans_type));
-    req_len += strlen(trans_type);
-    req[req_len++] = strlen(domain);
-    memcpy(&req[req_len], domain, strlen(domain));
-    req_len += strlen(domain);
-    req[req_len++] = 0;
-
-    req[req_len++] = 0;
-    req[req_len++] = MDNS_QUERY_TYPE_TXT; // type
-    req[req_len++] = 0;
-    req[req_len++] = 0x01; // class, multicase response
+    int64_t now = 0;
 
     remote_addr.sin_family = AF_INET;
     remote_addr.sin_addr.s_addr = inet_addr(MDNS_UPD_IP);
     remote_addr.sin_port = htons(MDNS_UPD_PORT);
-    sendto(sock, req, req_len, 0, (struct sockaddr *)&remote_addr, addr_len);
 
-    resp_len = recvfrom(sock, resp, sizeof(resp), 0, (struct sockaddr *)&remote_addr, &addr_len);
-    if (resp_len < 0) {
-        ESP_LOGE(TAG, "socket recv timeout");
-        return ESP_ERR_TIMEOUT;
+    do {
+        memset(srv_query, 0, MDNS_HEADER_LEN); // trans_id 0, standard query
+        len = MDNS_HEADER_LEN;
+        question_cnt = 0;
+        now = esp_timer_get_time();
+        xSemaphoreTake(cache_mutex, portMAX_DELAY);
+        for (i = 0; i < CONFIG_MDNS_CACHE_SIZE; i++) {
+            if (!g_cache[i].used || !g_cache[i].wanted || g_cache[i].refresh_sent || now < mdns_cache_refresh_time(&g_cache[i])) {
+                continue;
+            }
+            if (len + strlen(g_cache[i].name) + 2 + 4 > sizeof(srv_query)) {
+                break; // the rest go in the next packet
+            }
+            g_cache[i].refresh_sent = 1;
+            len = mdns_build_question(srv_query, len, g_cache[i].name, g_cache[i].result.type);
+            question_cnt++;
+        }
+        xSemaphoreGive(cache_mutex);
+
+        if (!question_cnt) {
+            return;
+        }
+        srv_query[4] = question_cnt >> 8;
+        srv_query[5] = question_cnt;
+        ESP_LOGI(TAG, "refresh cache, question:%lu", question_cnt);
+        sendto(srv_sock, srv_query, len, 0, (struct sockaddr *)&remote_addr, sizeof(remote_addr)); // refreshes every cache on the link
+    } while (i < CONFIG_MDNS_CACHE_SIZE);
+}
+
+esp_err_t mdns_query_async(char *name, uint16_t type, mdns_query_cb_t cb, void *arg, uint32_t *query_id) {
+    mdns_result_t result = {0};
+    mdns_pending_t *pending = NULL;
+    uint32_t i = 0, id = 0;
+
+    if (!name || !cb || strlen(name) >= MDNS_NAME_MAX_LEN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(pending_mutex, portMAX_DELAY);
+    id = ++pending_id;
+    xSemaphoreGive(pending_mutex);
+    if (query_id) {
+        *query_id = id;
     }
 
-    i = 12; // skip trans_id(2B), flags(2B), question(2B), answer(2B), authority(2B), additional(2B)
-    while (resp[i]) { // skip name
-        i += resp[i] + 1;
+    if (mdns_cache_lookup(name, type, &result)) {
+        mdns_cache_count(1);
+        cb(id, ESP_OK, &result, arg);
+        return ESP_OK;
     }
-    i++;
-    i += 8; // skip type(2B), class(2B), TTL(4B)
+    mdns_cache_count(0);
+
+    xSemaphoreTake(pending_mutex, portMAX_DELAY);
+    for (i = 0; i < CONFIG_MDNS_MAX_PENDING; i++) {
+        if (!g_pending[i].used) {
+            pending = &g_pending[i];
+            break;
+        }
+    }
+    if (pending) {
+        strcpy(pending->name, name);
+        pending->type = type;
+        pending->id = id;
+        pending->deadline = esp_timer_get_time() + CONFIG_MDNS_RECV_TIMEOUT * 1000;
+        pending->cb = cb;
+        pending->arg = arg;
+        pending->used = 1;
+    }
+    xSemaphoreGive(pending_mutex);
 
-    total_data_len = resp[i] << 8 | resp[i + 1];
-    while (data_len < total_data_len) {
-        kv_len = resp[i + 2];
-        memcpy(kv, &resp[i + 3], kv_len);
-        kv[kv_len] = 0;
-        equal = strchr(kv, '=');
-        memcpy(result[kv_cnt].key, kv, equal - kv);
-        memcpy(result[kv_cnt].value, equal + 1, kv_len - (equal - kv + 1));
-        kv_cnt++;
-        data_len += kv_len + 1;
-        i += kv_len + 1;
+    if (!pending) {
+        ESP_LOGE(TAG, "pending query is full, max cnt:%u", CONFIG_MDNS_MAX_PENDING);
+        return ESP_ERR_NO_MEM;
     }
-    *cnt = kv_cnt;
 
+    mdns_send_query(query_sock, name, type);
     return ESP_OK;
 }
 
-esp_err_t mdns_query_a(char *ins_name, char *srv_type, char *trans_type, mdns_a_t *result) {
-    uint32_t req_len = 0, i = 0;
-    int resp_len = 0;
-    char *domain = "local";
-    struct sockaddr_in remote_addr = {0};
-    socklen_t addr_len = sizeof(remote_addr);
+// complete the pending queries answered by the cache or timed out, callbacks run without any lock held
+static void mdns_pending_process() {
+    mdns_result_t result = {0};
+    mdns_query_cb_t cb = NULL;
+    void *arg = NULL;
+    uint32_t i = 0, id = 0;
+    esp_err_t err = ESP_OK;
+    int64_t now = 0;
 
-    req[req_len++] = 0;
-    req[req_len++] = 0; // trans_id
-    req[req_len++] = 0;
-    req[req_len++] = 0; // flags: standard query
-    req[req_len++] = 0;
-    req[req_len++] = 1; // question
-    req[req_len++] = 0;
-    req[req_len++] = 0; // answer
-    req[req_len++] = 0;
-    req[req_len++] = 0; // authority
-    req[req_len++] = 0;
-    req[req_len++] = 0; // additional
-
-    req[req_len++] = strlen(ins_name);
-    memcpy(&req[req_len], ins_name, strlen(ins_name));
-    req_len += strlen(ins_name);
-    req[req_len++] = strlen(srv_type);
-    memcpy(&req[req_len], srv_type, strlen(srv_type));
-    req_len += strlen(srv_type);
-    req[req_len++] = strlen(trans_type);
-    memcpy(&req[req_len], trans_type, strlen(trans_type));
-    req_len += strlen(trans_type);
-    req[req_len++] = strlen(domain);
-    memcpy(&req[req_len], domain, strlen(domain));
-    req_len += strlen(domain);
-    req[req_len++] = 0;
-
-    req[req_len++] = 0;
-    req[req_len++] = MDNS_QUERY_TYPE_A; // type
-    req[req_len++] = 0;
-    req[req_len++] = 0x01; // class, multicase response
+    while (1) {
+        cb = NULL;
+        now = esp_timer_get_time();
+        xSemaphoreTake(pending_mutex, portMAX_DELAY);
+        for (i = 0; i < CONFIG_MDNS_MAX_PENDING; i++) {
+            if (!g_pending[i].used) {
+                continue;
+            }
+            if (mdns_cache_lookup(g_pending[i].name, g_pending[i].type, &result)) {
+                err = ESP_OK;
+            } else if (now >= g_pending[i].deadline) {
+                ESP_LOGW(TAG, "query timeout, id:%lu name:%s type:0x%04x", g_pending[i].id, g_pending[i].name, g_pending[i].type);
+                err = ESP_ERR_TIMEOUT;
+            } else {
+                continue;
+            }
+            id = g_pending[i].id;
+            cb = g_pending[i].cb;
+            arg = g_pending[i].arg;
+            g_pending[i].used = 0;
+            break;
+        }
+        xSemaphoreGive(pending_mutex);
+
+        if (!cb) {
+            return;
+        }
+        cb(id, err, ESP_OK == err ? &result : NULL, arg);
+    }
+}
 
-    remote_addr.sin_family = AF_INET;
-    remote_addr.sin_addr.s_addr = inet_addr(MDNS_UPD_IP);
-    remote_addr.sin_port = htons(MDNS_UPD_PORT);
-    sendto(sock, req, req_len, 0, (struct sockaddr *)&remote_addr, addr_len);
+// ms until the closest pending query times out, capped by CONFIG_MDNS_RX_POLL_INTERVAL
+static uint32_t mdns_pending_next_timeout() {
+    uint32_t i = 0;
+    int64_t now = esp_timer_get_time(), next = now + CONFIG_MDNS_RX_POLL_INTERVAL * 1000;
 
-    resp_len = recvfrom(sock, resp, sizeof(resp), 0, (struct sockaddr *)&remote_addr, &addr_len);
-    if (resp_len < 0) {
-        ESP_LOGE(TAG, "socket recv timeout");
-        return ESP_ERR_TIMEOUT;
+    xSemaphoreTake(pending_mutex, portMAX_DELAY);
+    for (i = 0; i < CONFIG_MDNS_MAX_PENDING; i++) {
+        if (g_pending[i].used && g_pending[i].deadline < next) {
+            next = g_pending[i].deadline;
+        }
     }
+    xSemaphoreGive(pending_mutex);
+
+    return next > now ? (next - now + 999) / 1000 : 0;
+}
 
-    i = 12; // skip trans_id(2B), flags(2B), question(2B), answer(2B), authority(2B), additional(2B)
-    while (resp[i]) { // skip name
-        i += resp[i] + 1;
+static void mdns_query_sync_cb(uint32_t query_id, esp_err_t err, mdns_result_t *result, void *arg) {
+    mdns_sync_ctx_t *ctx = (mdns_sync_ctx_t *)arg;
+
+    ctx->err = err;
+    if (ESP_OK == err) {
+        memcpy(ctx->result, result, sizeof(mdns_result_t));
+    }
+    if (ctx->done) {
+        xSemaphoreGive(ctx->done);
     }
-    i++;
-    i += 10; // skip type(2B), class(2B), TTL(4B), length(2B)
+}
 
-    memcpy(result->ip, &resp[i], 4);
+static esp_err_t mdns_query(char *name, uint16_t type, mdns_result_t *result) {
+    mdns_sync_ctx_t ctx = {
+        .done = NULL,
+        .err = ESP_ERR_TIMEOUT,
+        .result = result
+    };
+    mdns_result_t cached = {0};
+    esp_err_t err = ESP_OK;
 
-    return ESP_OK;
+    if (mdns_cache_lookup(name, type, &cached)) { // no semaphore needed for a hit
+        mdns_cache_count(1);
+        memcpy(result, &cached, sizeof(mdns_result_t));
+        return ESP_OK;
+    }
+
+    ctx.done = xSemaphoreCreateBinary();
+    if (!ctx.done) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    err = mdns_query_async(name, type, mdns_query_sync_cb, &ctx, NULL);
+    if (ESP_OK == err) {
+        xSemaphoreTake(ctx.done, portMAX_DELAY); // mdns_rx always completes the query, at the latest on timeout
+        err = ctx.err;
+    }
+    vSemaphoreDelete(ctx.done);
+
+    return err;
+}
+
+esp_err_t mdns_query_ptr(char *srv_type, char *trans_type, mdns_ptr_t *result) {
+    char name[MDNS_NAME_MAX_LEN] = {0};
+    mdns_result_t record = {0};
+    esp_err_t err = ESP_OK;
+
+    snprintf(name, sizeof(name), "%s.%s.local", srv_type, trans_type);
+    err = mdns_query(name, MDNS_QUERY_TYPE_PTR, &record);
+    if (ESP_OK == err) {
+        memcpy(result, &record.data.ptr, sizeof(mdns_ptr_t));
+    }
+    return err;
+}
+
+esp_err_t mdns_query_srv(char *ins_name, char *srv_type, char *trans_type, mdns_srv_t *result) {
+    char name[MDNS_NAME_MAX_LEN] = {0};
+    mdns_result_t record = {0};
+    esp_err_t err = ESP_OK;
+
+    snprintf(name, sizeof(name), "%s.%s.%s.local", ins_name, srv_type, trans_type);
+    err = mdns_query(name, MDNS_QUERY_TYPE_SRV, &record);
+    if (ESP_OK == err) {
+        memcpy(result, &record.data.srv, sizeof(mdns_srv_t));
+    }
+    return err;
+}
+
+esp_err_t mdns_query_txt(char *ins_name, char *srv_type, char *trans_type, mdns_txt_t *result, uint32_t *cnt) {
+    char name[MDNS_NAME_MAX_LEN] = {0};
+    mdns_result_t record = {0};
+    esp_err_t err = ESP_OK;
+
+    snprintf(name, sizeof(name), "%s.%s.%s.local", ins_name, srv_type, trans_type);
+    err = mdns_query(name, MDNS_QUERY_TYPE_TXT, &record);
+    if (ESP_OK == err) {
+        memcpy(result, record.data.txt.txt, record.data.txt.cnt * sizeof(mdns_txt_t));
+        *cnt = record.data.txt.cnt;
+    }
+    return err;
+}
+
+esp_err_t mdns_query_a(char *ins_name, char *srv_type, char *trans_type, mdns_a_t *result) {
+    char name[MDNS_NAME_MAX_LEN] = {0};
+    mdns_result_t record = {0};
+    esp_err_t err = ESP_OK;
+
+    snprintf(name, sizeof(name), "%s.%s.%s.local", ins_name, srv_type, trans_type);
+    err = mdns_query(name, MDNS_QUERY_TYPE_A, &record);
+    if (ESP_OK == err) {
+        memcpy(result, &record.data.a, sizeof(mdns_a_t));
+    }
+    return err;
 }
 
 esp_err_t mdns_query_aaaa(char *ins_name, char *srv_type, char *trans_type, mdns_aaaa_t *result) {
-    uint32_t req_len = 0, i = 0;
-    int resp_len = 0;
-    char *domain = "local";
-    struct sockaddr_in remote_addr = {0};
-    socklen_t addr_len = sizeof(remote_addr);
+    char name[MDNS_NAME_MAX_LEN] = {0};
+    mdns_result_t record = {0};
+    esp_err_t err = ESP_OK;
+
+    snprintf(name, sizeof(name), "%s.%s.%s.local", ins_name, srv_type, trans_type);
+    err = mdns_query(name, MDNS_QUERY_TYPE_AAAA, &record);
+    if (ESP_OK == err) {
+        memcpy(result, &record.data.aaaa, sizeof(mdns_aaaa_t));
+    }
+    return err;
+}
+
+esp_err_t mdns_browse_start(char *srv_type, char *trans_type, mdns_browse_cb_t add_cb, mdns_browse_cb_t remove_cb, void *arg) {
+    mdns_browse_t *browse = NULL;
+    uint32_t i = 0;
+
+    if (!srv_type || !trans_type) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(browse_mutex, portMAX_DELAY);
+    for (i = 0; i < CONFIG_MDNS_MAX_BROWSE; i++) {
+        if (!g_browse[i].used) {
+            browse = &g_browse[i];
+            break;
+        }
+    }
+    if (browse) {
+        memset(browse, 0, sizeof(mdns_browse_t));
+        snprintf(browse->name, sizeof(browse->name), "%s.%s.local", srv_type, trans_type);
+        browse->interval = 1;
+        browse->next_query = esp_timer_get_time(); // first query right away
+        browse->add_cb = add_cb;
+        browse->remove_cb = remove_cb;
+        browse->arg = arg;
+        browse->used = 1;
+    }
+    xSemaphoreGive(browse_mutex);
+
+    if (!browse) {
+        ESP_LOGE(TAG, "browse is full, max cnt:%u", CONFIG_MDNS_MAX_BROWSE);
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "browse start, name:%s", browse->name);
+    return ESP_OK;
+}
+
+esp_err_t mdns_browse_stop(char *srv_type, char *trans_type) {
+    char name[MDNS_NAME_MAX_LEN] = {0};
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    uint32_t i = 0;
+
+    snprintf(name, sizeof(name), "%s.%s.local", srv_type, trans_type);
+    xSemaphoreTake(browse_mutex, portMAX_DELAY);
+    for (i = 0; i < CONFIG_MDNS_MAX_BROWSE; i++) {
+        if (g_browse[i].used && 0 == strcasecmp(g_browse[i].name, name)) {
+            g_browse[i].used = 0;
+            err = ESP_OK;
+        }
+    }
+    xSemaphoreGive(browse_mutex);
+
+    return err;
+}
+
+// add or refresh an instance from a PTR record, TTL=0 is a goodbye
+static void mdns_browse_update(mdns_cache_entry_t *record) {
+    mdns_browse_t *browse = NULL;
+    mdns_browse_ins_t *ins = NULL;
+    mdns_browse_cb_t cb = NULL;
+    mdns_ptr_t instance = {0};
+    void *arg = NULL;
+    uint32_t i = 0, j = 0;
+
+    xSemaphoreTake(browse_mutex, portMAX_DELAY);
+    for (i = 0; i < CONFIG_MDNS_MAX_BROWSE && !cb; i++) {
+        browse = &g_browse[i];
+        if (!browse->used || strcasecmp(browse->name, record->name)) {
+            continue;
+        }
+
+        ins = NULL;
+        for (j = 0; j < CONFIG_MDNS_BROWSE_MAX_INSTANCE; j++) {
+            if (browse->ins[j].used && 0 == strcmp(browse->ins[j].ins_name, record->result.data.ptr.ins_name)) {
+                ins = &browse->ins[j];
+                break;
+            }
+        }
+
+        if (0 == record->ttl) {
+            if (ins) {
+                ins->used = 0;
+                cb = browse->remove_cb;
+            }
+        } else if (ins) {
+            ins->ttl = record->ttl;
+            ins->update_time = esp_timer_get_time();
+            ins->refresh_cnt = 0;
+        } else {
+            for (j = 0; j < CONFIG_MDNS_BROWSE_MAX_INSTANCE; j++) {
+                if (!browse->ins[j].used) {
+                    ins = &browse->ins[j];
+                    break;
+                }
+            }
+            if (!ins) {
+                ESP_LOGW(TAG, "browse instance is full, drop:%s", record->result.data.ptr.ins_name);
+                break;
+            }
+            strcpy(ins->ins_name, record->result.data.ptr.ins_name);
+            ins->ttl = record->ttl;
+            ins->update_time = esp_timer_get_time();
+            ins->refresh_cnt = 0;
+            ins->used = 1;
+            cb = browse->add_cb;
+        }
+        arg = browse->arg;
+    }
+    xSemaphoreGive(browse_mutex);
+
+    if (cb) {
+        strcpy(instance.ins_name, record->result.data.ptr.ins_name);
+        cb(&instance, arg);
+    }
+}
+
+// the backoff alone may leave a gap longer than the TTL, each live instance is queried before it expires
+static int64_t mdns_browse_refresh_time(const mdns_browse_ins_t *ins) {
+    if (ins->refresh_cnt >= MDNS_BROWSE_REFRESH_CNT) {
+        return INT64_MAX; // gone unless it answers, removed at the end of its TTL
+    }
+    return ins->update_time + (int64_t)ins->ttl * 10000 * (CONFIG_MDNS_CACHE_REFRESH_PERCENT + 5 * ins->refresh_cnt);
+}
+
+// 1 if a live instance is due for a maintenance query, every due instance counts the query as sent
+static uint8_t mdns_browse_refresh_due(mdns_browse_t *browse, int64_t now) {
+    uint32_t j = 0;
+    uint8_t due = 0;
+
+    for (j = 0; j < CONFIG_MDNS_BROWSE_MAX_INSTANCE; j++) {
+        if (browse->ins[j].used && now >= mdns_browse_refresh_time(&browse->ins[j])) {
+            browse->ins[j].refresh_cnt++;
+            due = 1;
+        }
+    }
+    return due;
+}
+
+// ms until the next browse query is due or an instance expires, capped by CONFIG_MDNS_RX_POLL_INTERVAL
+static uint32_t mdns_browse_next_timeout() {
+    uint32_t i = 0, j = 0;
+    int64_t now = esp_timer_get_time(), next = now + CONFIG_MDNS_RX_POLL_INTERVAL * 1000;
+
+    xSemaphoreTake(browse_mutex, portMAX_DELAY);
+    for (i = 0; i < CONFIG_MDNS_MAX_BROWSE; i++) {
+        if (!g_browse[i].used) {
+            continue;
+        }
+        next = MIN(next, g_browse[i].next_query);
+        for (j = 0; j < CONFIG_MDNS_BROWSE_MAX_INSTANCE; j++) {
+            if (g_browse[i].ins[j].used) { // the next maintenance query, or the end of the TTL after the last one
+                next = MIN(next, mdns_browse_refresh_time(&g_browse[i].ins[j]));
+                next = MIN(next, g_browse[i].ins[j].update_time + (int64_t)g_browse[i].ins[j].ttl * 1000000);
+            }
+        }
+    }
+    xSemaphoreGive(browse_mutex);
+
+    return next > now ? (next - now + 999) / 1000 : 0;
+}
 
-    req[req_len++] = 0;
-    req[req_len++] = 0; // trans_id
-    req[req_len++] = 0;
-    req[req_len++] = 0; // flags: standard query
-    req[req_len++] = 0;
-    req[req_len++] = 1; // question
-    req[req_len++] = 0;
-    req[req_len++] = 0; // answer
-    req[req_len++] = 0;
-    req[req_len++] = 0; // authority
-    req[req_len++] = 0;
-    req[req_len++] = 0; // additional
-
-    req[req_len++] = strlen(ins_name);
-    memcpy(&req[req_len], ins_name, strlen(ins_name));
-    req_len += strlen(ins_name);
-    req[req_len++] = strlen(srv_type);
-    memcpy(&req[req_len], srv_type, strlen(srv_type));
-    req_len += strlen(srv_type);
-    req[req_len++] = strlen(trans_type);
-    memcpy(&req[req_len], trans_type, strlen(trans_type));
-    req_len += strlen(trans_type);
-    req[req_len++] = strlen(domain);
-    memcpy(&req[req_len], domain, strlen(domain));
-    req_len += strlen(domain);
-    req[req_len++] = 0;
-
-    req[req_len++] = 0;
-    req[req_len++] = MDNS_QUERY_TYPE_AAAA; // type
-    req[req_len++] = 0;
-    req[req_len++] = 0x01; // class, multicase response
+// PTR query carrying the known instances, so that settled responders stay quiet (RFC 6762 7.1)
+static uint32_t mdns_browse_build_query(uint8_t *buf, uint32_t size, mdns_browse_t *browse, int64_t now) {
+    uint32_t len = 0, j = 0, ins_len = 0, answer_cnt = 0;
+    int64_t remain = 0;
+
+    len = mdns_build_query(buf, browse->name, MDNS_QUERY_TYPE_PTR);
+    for (j = 0; j < CONFIG_MDNS_BROWSE_MAX_INSTANCE; j++) {
+        if (!browse->ins[j].used) {
+            continue;
+        }
+        remain = (int64_t)browse->ins[j].ttl - (now - browse->ins[j].update_time) / 1000000;
+        if (remain <= browse->ins[j].ttl / 2) { // let the responder refresh it
+            continue;
+        }
+        ins_len = strlen(browse->ins[j].ins_name);
+        if (len + 12 + 1 + ins_len + 2 > size) {
+            break;
+        }
+
+        buf[len++] = 0xc0;
+        buf[len++] = 0x0c; // name, same as the question
+        buf[len++] = 0;
+        buf[len++] = MDNS_QUERY_TYPE_PTR; // type
+        buf[len++] = 0x00;
+        buf[len++] = 0x01; // class
+        buf[len++] = remain >> 24;
+        buf[len++] = remain >> 16;
+        buf[len++] = remain >> 8;
+        buf[len++] = remain; // TTL
+        buf[len++] = 0;
+        buf[len++] = ins_len + 3; // data_len
+        buf[len++] = ins_len;
+        memcpy(&buf[len], browse->ins[j].ins_name, ins_len);
+        len += ins_len;
+        buf[len++] = 0xc0;
+        buf[len++] = 0x0c;
+        answer_cnt++;
+    }
+    buf[6] = answer_cnt >> 8;
+    buf[7] = answer_cnt; // answer
+
+    return len;
+}
+
+// runs in mdns_srv: send the due queries with 1s, 2s, 4s... backoff, the maintenance queries of the live instances,
+// and expire the silent instances
+static void mdns_browse_process(uint8_t *buf, uint32_t size) {
+    mdns_browse_t *browse = NULL;
+    mdns_browse_cb_t cb = NULL;
+    mdns_ptr_t instance = {0};
+    struct sockaddr_in remote_addr = {0};
+    void *arg = NULL;
+    uint32_t i = 0, j = 0, len = 0;
+    int64_t now = 0;
 
     remote_addr.sin_family = AF_INET;
     remote_addr.sin_addr.s_addr = inet_addr(MDNS_UPD_IP);
     remote_addr.sin_port = htons(MDNS_UPD_PORT);
-    sendto(sock, req, req_len, 0, (struct sockaddr *)&remote_addr, addr_len);
 
-    resp_len = recvfrom(sock, resp, sizeof(resp), 0, (struct sockaddr *)&remote_addr, &addr_len);
-    if (resp_len < 0) {
-        ESP_LOGE(TAG, "socket recv timeout");
-        return ESP_ERR_TIMEOUT;
-    }
+    while (1) {
+        cb = NULL;
+        len = 0;
+        now = esp_timer_get_time();
+        xSemaphoreTake(browse_mutex, portMAX_DELAY);
+        for (i = 0; i < CONFIG_MDNS_MAX_BROWSE && !cb && !len; i++) {
+            browse = &g_browse[i];
+            if (!browse->used) {
+                continue;
+            }
 
-    i = 12; // skip trans_id(2B), flags(2B), question(2B), answer(2B), authority(2B), additional(2B)
-    while (resp[i]) { // skip name
-        i += resp[i] + 1;
-    }
-    i++;
-    i += 10; // skip type(2B), class(2B), TTL(4B), length(2B)
+            for (j = 0; j < CONFIG_MDNS_BROWSE_MAX_INSTANCE; j++) {
+                if (browse->ins[j].used && now - browse->ins[j].update_time >= (int64_t)browse->ins[j].ttl * 1000000) {
+                    browse->ins[j].used = 0;
+                    strcpy(instance.ins_name, browse->ins[j].ins_name);
+                    cb = browse->remove_cb;
+                    arg = browse->arg;
+                    break;
+                }
+            }
 
-    memcpy(result->ip, &resp[i], 16);
+            if (!cb && now >= browse->next_query) {
+                mdns_browse_refresh_due(browse, now); // this query refreshes them as well
+                len = mdns_browse_build_query(buf, size, browse, now);
+                ESP_LOGI(TAG, "browse query, name:%s interval:%lus", browse->name, browse->interval);
+                browse->next_query = now + (int64_t)browse->interval * 1000000;
+                browse->interval = MIN(browse->interval * 2, CONFIG_MDNS_BROWSE_MAX_INTERVAL);
+            } else if (!cb && mdns_browse_refresh_due(browse, now)) {
+                len = mdns_browse_build_query(buf, size, browse, now); // the due instances are past half TTL, not listed
+                ESP_LOGI(TAG, "browse maintenance query, name:%s", browse->name);
+            }
+        }
+        xSemaphoreGive(browse_mutex);
+
+        if (len) {
+            sendto(srv_sock, buf, len, 0, (struct sockaddr *)&remote_addr, sizeof(remote_addr));
+        } else if (cb) {
+            cb(&instance, arg);
+        } else {
+            return;
+        }
+    }
+}
 
-    return ESP_OK;
+void mdns_cache_get_stats(uint32_t *hit, uint32_t *miss) {
+    xSemaphoreTake(cache_mutex, portMAX_DELAY);
+    *hit = cache_hit;
+    *miss = cache_miss;
+    xSemaphoreGive(cache_mutex);
 }
 
 esp_err_t mdns_add_srv(char *ins_name, char *srv_type, char *trans_type, uint16_t port,
@@ -449,192 +1036,494 @@ esp_err_t mdns_add_srv(char *ins_name, char *srv_type, char *trans_type, uint16_
     return ESP_OK;
 }
 
-esp_err_t mdns_start_server() {
-    struct sockaddr_in remote_addr = {0};
-    socklen_t addr_len = sizeof(remote_addr);
-    int req_len = 0;
-    uint32_t resp_len = 0, i = 0, j = 0, k = 0;
-    char ins_name[32] = {0};
-    char srv_type[32] = {0};
-    char trans_type[16] = {0};
-    char *domain = "local";
-    uint32_t ins_name_len = 0, srv_type_len = 0, trans_type_len = 0;
-    uint16_t query_type = 0;
-    uint8_t is_unicast_resp = 0;
-    uint16_t data_len = 0;
+static uint8_t mdns_is_type_name(const mdns_name_t *name, mdns_service_t *srv) {
+    const char *labels[] = {srv->srv_type, srv->trans_type, "local"};
 
-    while (1) {
-        req_len = recvfrom(sock, req, sizeof(req), 0, (struct sockaddr *)&remote_addr, &addr_len);
-        if (req_len > 0) {
-            if (req[2] & 0x80) { // response, not query
-                continue;
-            }
+    return mdns_name_equal_labels(name, labels, 3);
+}
 
-            i = 12; // skip trans_id(2B), flags(2B), question(2B), answer(2B), authority(2B), additional(2B)
-            while (req[i]) { // skip name
-                i += req[i] + 1;
-            }
-            i++;
+static uint8_t mdns_is_ins_name(const mdns_name_t *name, mdns_service_t *srv) {
+    const char *labels[] = {srv->ins_name, srv->srv_type, srv->trans_type, "local"};
 
-            query_type = (req[i] << 8) | req[i + 1];
-            if (req[i + 2] & 0x80) {
-                is_unicast_resp = 1;
-            } else {
-                is_unicast_resp = 0;
-            }
+    return mdns_name_equal_labels(name, labels, 4);
+}
 
-            resp[0] = req[0];
-            resp[1] = req[1]; // trans_id
-            resp[2] = 0x84;
-            resp[3] = 0x00;   // flags: standard query response
-            resp[4] = 0;
-            resp[5] = 0;      // question
-            resp[6] = 0;
-            resp[7] = 1;      // answer
-            resp[8] = 0;
-            resp[9] = 0;      // authority
-            resp[10] = 0;
-            resp[11] = 0;     // additional
-            resp_len = 12;
+static void mdns_add_answer(mdns_answer_t *answers, uint32_t *cnt, uint8_t srv_idx, uint16_t type) {
+    uint32_t i = 0;
+
+    for (i = 0; i < *cnt; i++) {
+        if (answers[i].srv_idx == srv_idx && answers[i].type == type) { // asked by several questions
+            return;
+        }
+    }
 
+    if (CONFIG_MDNS_MAX_ANSWER == *cnt) {
+        ESP_LOGW(TAG, "answer is full, max cnt:%u", CONFIG_MDNS_MAX_ANSWER);
+        return;
+    }
+
+    answers[*cnt].srv_idx = srv_idx;
+    answers[*cnt].type = type;
+    (*cnt)++;
+}
+
+static void mdns_match_question(const mdns_name_t *name, uint16_t query_type, mdns_answer_t *answers, uint32_t *cnt) {
+    uint32_t j = 0;
+
+    for (j = 0; j < srv_cnt; j++) {
+        if (mdns_is_type_name(name, &g_srv[j])) {
+            if (MDNS_QUERY_TYPE_PTR == query_type || MDNS_QUERY_TYPE_ANY == query_type) {
+                mdns_add_answer(answers, cnt, j, MDNS_QUERY_TYPE_PTR);
+            }
+            continue;
+        }
+
+        if (mdns_is_ins_name(name, &g_srv[j])) {
             switch (query_type) {
-            case MDNS_QUERY_TYPE_PTR:
-                srv_type_len = req[12];
-                memcpy(srv_type, &req[13], srv_type_len);
-                trans_type_len = req[13 + srv_type_len];
-                memcpy(trans_type, &req[14 + srv_type_len], trans_type_len);
-                ESP_LOGI(TAG, "query_type:0x%04x srv_type:%s trans_type:%s", query_type, srv_type, trans_type);
-
-                for (j = 0; j < srv_cnt; j++) {
-                    if (strlen(g_srv[j].srv_type) == srv_type_len && strncmp(g_srv[j].srv_type, srv_type, srv_type_len) == 0) {
-                        if (strlen(g_srv[j].trans_type) == trans_type_len && strncmp(g_srv[j].trans_type, trans_type, trans_type_len) == 0) {
-                            resp[resp_len++] = srv_type_len;
-                            memcpy(&resp[resp_len], srv_type, srv_type_len);
-                            resp_len += srv_type_len;
-                            resp[resp_len++] = trans_type_len;
-                            memcpy(&resp[resp_len], trans_type, trans_type_len);
-                            resp_len += trans_type_len;
-                            resp[resp_len++] = strlen(domain);
-                            memcpy(&resp[resp_len], domain, strlen(domain));
-                            resp_len += strlen(domain);
-                            resp[resp_len++] = 0;
-
-                            resp[resp_len++] = query_type >> 8;
-                            resp[resp_len++] = query_type;
-                            resp[resp_len++] = 0x00;
-                            resp[resp_len++] = 0x01; // class
-                            resp[resp_len++] = CONFIG_MDNS_TTL >> 24;
-                            resp[resp_len++] = CONFIG_MDNS_TTL >> 16;
-                            resp[resp_len++] = CONFIG_MDNS_TTL >> 8;
-                            resp[resp_len++] = (uint8_t)CONFIG_MDNS_TTL; // TTL
-                            resp[resp_len++] = (strlen(g_srv[j].ins_name) + 3) >> 8;
-                            resp[resp_len++] = strlen(g_srv[j].ins_name) + 3; // data_len
-                            resp[resp_len++] = strlen(g_srv[j].ins_name);
-                            memcpy(&resp[resp_len], g_srv[j].ins_name, strlen(g_srv[j].ins_name));
-                            resp_len += strlen(g_srv[j].ins_name);
-                            resp[resp_len++] = 0xc0;
-                            resp[resp_len++] = 0x0c;
-
-                            if (!is_unicast_resp) {
-                                remote_addr.sin_family = AF_INET;
-                                remote_addr.sin_addr.s_addr = inet_addr(MDNS_UPD_IP);
-                                remote_addr.sin_port = htons(MDNS_UPD_PORT);
-                            }                               
-                            sendto(sock, resp, resp_len, 0, (struct sockaddr *)&remote_addr, addr_len);
-                            break;
-                        }
-                    }
-                }
-                break;
             case MDNS_QUERY_TYPE_SRV:
             case MDNS_QUERY_TYPE_TXT:
             case MDNS_QUERY_TYPE_A:
-                ins_name_len = req[12];
-                memcpy(ins_name, &req[13], ins_name_len);
-                srv_type_len = req[13 + ins_name_len];
-                memcpy(srv_type, &req[14 + ins_name_len], srv_type_len);
-                trans_type_len = req[14 + ins_name_len + srv_type_len];
-                memcpy(trans_type, &req[15 + ins_name_len + srv_type_len], trans_type_len);
-                ESP_LOGI(TAG, "query_type:0x%04x ins_name:%s srv_type:%s trans_type:%s", query_type, ins_name, srv_type, trans_type);
-
-                for (j = 0; j < srv_cnt; j++) {
-                    if (strlen(g_srv[j].ins_name) == ins_name_len && strncmp(g_srv[j].ins_name, ins_name, ins_name_len) == 0) {
-                        if (strlen(g_srv[j].srv_type) == srv_type_len && strncmp(g_srv[j].srv_type, srv_type, srv_type_len) == 0) {
-                            if (strlen(g_srv[j].trans_type) == trans_type_len && strncmp(g_srv[j].trans_type, trans_type, trans_type_len) == 0) {
-                                resp[resp_len++] = ins_name_len;
-                                memcpy(&resp[resp_len], ins_name, ins_name_len);
-                                resp_len += ins_name_len;
-                                resp[resp_len++] = srv_type_len;
-                                memcpy(&resp[resp_len], srv_type, srv_type_len);
-                                resp_len += srv_type_len;
-                                resp[resp_len++] = trans_type_len;
-                                memcpy(&resp[resp_len], trans_type, trans_type_len);
-                                resp_len += trans_type_len;
-                                resp[resp_len++] = strlen(domain);
-                                memcpy(&resp[resp_len], domain, strlen(domain));
-                                resp_len += strlen(domain);
-                                resp[resp_len++] = 0;
-
-                                resp[resp_len++] = query_type >> 8;
-                                resp[resp_len++] = query_type;
-                                resp[resp_len++] = 0x00;
-                                resp[resp_len++] = 0x01; // class
-                                resp[resp_len++] = CONFIG_MDNS_TTL >> 24;
-                                resp[resp_len++] = CONFIG_MDNS_TTL >> 16;
-                                resp[resp_len++] = CONFIG_MDNS_TTL >> 8;
-                                resp[resp_len++] = (uint8_t)CONFIG_MDNS_TTL; // TTL
-
-                                if (MDNS_QUERY_TYPE_SRV == query_type) {
-                                    resp[resp_len++] = 0;
-                                    resp[resp_len++] = 8; // data_len
-                                    resp[resp_len++] = g_srv[j].priority >> 8;
-                                    resp[resp_len++] = g_srv[j].priority;
-                                    resp[resp_len++] = g_srv[j].weight >> 8;
-                                    resp[resp_len++] = g_srv[j].weight;
-                                    resp[resp_len++] = g_srv[j].port >> 8;
-                                    resp[resp_len++] = g_srv[j].port;
-                                    resp[resp_len++] = 0xc0;
-                                    resp[resp_len++] = 0x0c;                                    
-                                } else if (MDNS_QUERY_TYPE_TXT == query_type) {
-                                    for (k = 0; k < g_srv[j].txt_cnt; k++) {
-                                        data_len += 1;
-                                        data_len += strlen(g_srv[j].txt[k].key) + 1 + strlen(g_srv[j].txt[k].value);
-                                    }
-                                    resp[resp_len++] = data_len >> 8;
-                                    resp[resp_len++] = data_len; // data_len
-                                    for (k = 0; k < g_srv[j].txt_cnt; k++) {
-                                        resp[resp_len++] = strlen(g_srv[j].txt[k].key) + 1 + strlen(g_srv[j].txt[k].value);
-                                        memcpy(&resp[resp_len], g_srv[j].txt[k].key, strlen(g_srv[j].txt[k].key));
-                                        resp_len += strlen(g_srv[j].txt[k].key);
-                                        resp[resp_len++] = '=';
-                                        memcpy(&resp[resp_len], g_srv[j].txt[k].value, strlen(g_srv[j].txt[k].value));
-                                        resp_len += strlen(g_srv[j].txt[k].value);
-                                    }  
-                                } else if (MDNS_QUERY_TYPE_A == query_type) {
-                                    resp[resp_len++] = 0;
-                                    resp[resp_len++] = 4; // data_len
-                                    resp[resp_len++] = g_srv[j].ipV4.ip[3];
-                                    resp[resp_len++] = g_srv[j].ipV4.ip[2];
-                                    resp[resp_len++] = g_srv[j].ipV4.ip[1];
-                                    resp[resp_len++] = g_srv[j].ipV4.ip[0];
-                                }
-
-                                if (!is_unicast_resp) {
-                                    remote_addr.sin_family = AF_INET;
-                                    remote_addr.sin_addr.s_addr = inet_addr(MDNS_UPD_IP);
-                                    remote_addr.sin_port = htons(MDNS_UPD_PORT);
-                                }                               
-                                sendto(sock, resp, resp_len, 0, (struct sockaddr *)&remote_addr, addr_len);
-                                break;
-                            }
-                        }
-                    }
-                }
+                mdns_add_answer(answers, cnt, j, query_type);
+                break;
+            case MDNS_QUERY_TYPE_ANY:
+                mdns_add_answer(answers, cnt, j, MDNS_QUERY_TYPE_SRV);
+                mdns_add_answer(answers, cnt, j, MDNS_QUERY_TYPE_TXT);
+                mdns_add_answer(answers, cnt, j, MDNS_QUERY_TYPE_A);
                 break;
             default:
                 ESP_LOGW(TAG, "unsupported query type:0x%04x", query_type);
                 break;
             }
-        }        
+        }
+    }
+}
+
+// RFC 6762 7.1, the querier already holds this record with at least half of its TTL remaining
+static uint8_t mdns_is_known_answer(mdns_answer_t *answer, const mdns_cursor_t *cur, const mdns_rr_t *rr) {
+    mdns_service_t *srv = &g_srv[answer->srv_idx];
+    const uint8_t *rdata = &cur->buf[rr->rdata_offset];
+    mdns_name_t target = {0};
+
+    if (answer->type != rr->type || rr->ttl <= CONFIG_MDNS_TTL / 2) {
+        return 0;
+    }
+
+    if (MDNS_QUERY_TYPE_PTR == rr->type) {
+        return mdns_is_type_name(&rr->name, srv) && ESP_OK == mdns_parse_rdata_name(cur, rr, 0, &target) &&
+               mdns_is_ins_name(&target, srv);
+    }
+
+    if (!mdns_is_ins_name(&rr->name, srv)) {
+        return 0;
     }
+    if (MDNS_QUERY_TYPE_A == rr->type) {
+        return 4 == rr->rdata_len && rdata[0] == srv->ipV4.ip[3] && rdata[1] == srv->ipV4.ip[2] &&
+               rdata[2] == srv->ipV4.ip[1] && rdata[3] == srv->ipV4.ip[0];
+    }
+    return 1; // SRV and TXT are unique per instance name
+}
+
+static uint32_t mdns_append_label(uint8_t *buf, uint32_t len, const char *label) {
+    buf[len++] = strlen(label);
+    memcpy(&buf[len], label, strlen(label));
+    return len + strlen(label);
+}
+
+static uint32_t mdns_append_ptr(uint8_t *buf, uint32_t len, uint16_t offset) {
+    buf[len++] = 0xc0 | (offset >> 8);
+    buf[len++] = offset;
+    return len;
+}
+
+static uint32_t mdns_append_type_name(mdns_resp_ctx_t *ctx, uint32_t len, uint8_t srv_idx) {
+    mdns_service_t *srv = &g_srv[srv_idx];
+
+    if (ctx->type_offset[srv_idx]) {
+        return mdns_append_ptr(ctx->buf, len, ctx->type_offset[srv_idx]);
+    }
+
+    ctx->type_offset[srv_idx] = len;
+    len = mdns_append_label(ctx->buf, len, srv->srv_type);
+    len = mdns_append_label(ctx->buf, len, srv->trans_type);
+    len = mdns_append_label(ctx->buf, len, "local");
+    ctx->buf[len++] = 0;
+    return len;
+}
+
+static uint32_t mdns_append_ins_name(mdns_resp_ctx_t *ctx, uint32_t len, uint8_t srv_idx) {
+    if (ctx->ins_offset[srv_idx]) {
+        return mdns_append_ptr(ctx->buf, len, ctx->ins_offset[srv_idx]);
+    }
+
+    ctx->ins_offset[srv_idx] = len;
+    len = mdns_append_label(ctx->buf, len, g_srv[srv_idx].ins_name);
+    return mdns_append_type_name(ctx, len, srv_idx);
+}
+
+// worst case length of a record, without name compression
+static uint32_t mdns_record_max_len(mdns_service_t *srv, uint16_t type) {
+    uint32_t name_len = strlen(srv->ins_name) + strlen(srv->srv_type) + strlen(srv->trans_type) + strlen("local") + 5;
+    uint32_t len = name_len + 10; // name, type(2B), class(2B), TTL(4B), length(2B)
+    uint32_t k = 0;
+
+    switch (type) {
+    case MDNS_QUERY_TYPE_PTR:
+        len += name_len;
+        break;
+    case MDNS_QUERY_TYPE_SRV:
+        len += 6 + name_len;
+        break;
+    case MDNS_QUERY_TYPE_TXT:
+        for (k = 0; k < srv->txt_cnt; k++) {
+            len += 1 + strlen(srv->txt[k].key) + 1 + strlen(srv->txt[k].value);
+        }
+        break;
+    case MDNS_QUERY_TYPE_A:
+        len += 4;
+        break;
+    default:
+        break;
+    }
+    return len;
+}
+
+static uint32_t mdns_append_record(mdns_resp_ctx_t *ctx, uint32_t len, mdns_answer_t *answer) {
+    mdns_service_t *srv = &g_srv[answer->srv_idx];
+    uint16_t data_len = 0;
+    uint32_t data_offset = 0, k = 0;
+
+    if (MDNS_QUERY_TYPE_PTR == answer->type) {
+        len = mdns_append_type_name(ctx, len, answer->srv_idx);
+    } else {
+        len = mdns_append_ins_name(ctx, len, answer->srv_idx);
+    }
+
+    ctx->buf[len++] = answer->type >> 8;
+    ctx->buf[len++] = answer->type;
+    ctx->buf[len++] = 0x00;
+    ctx->buf[len++] = 0x01; // class
+    ctx->buf[len++] = ctx->ttl >> 24;
+    ctx->buf[len++] = ctx->ttl >> 16;
+    ctx->buf[len++] = ctx->ttl >> 8;
+    ctx->buf[len++] = ctx->ttl; // TTL
+    data_offset = len;
+    len += 2; // data_len, filled below
+
+    switch (answer->type) {
+    case MDNS_QUERY_TYPE_PTR:
+        len = mdns_append_ins_name(ctx, len, answer->srv_idx);
+        break;
+    case MDNS_QUERY_TYPE_SRV:
+        ctx->buf[len++] = srv->priority >> 8;
+        ctx->buf[len++] = srv->priority;
+        ctx->buf[len++] = srv->weight >> 8;
+        ctx->buf[len++] = srv->weight;
+        ctx->buf[len++] = srv->port >> 8;
+        ctx->buf[len++] = srv->port;
+        len = mdns_append_ins_name(ctx, len, answer->srv_idx); // target
+        break;
+    case MDNS_QUERY_TYPE_TXT:
+        for (k = 0; k < srv->txt_cnt; k++) {
+            ctx->buf[len++] = strlen(srv->txt[k].key) + 1 + strlen(srv->txt[k].value);
+            memcpy(&ctx->buf[len], srv->txt[k].key, strlen(srv->txt[k].key));
+            len += strlen(srv->txt[k].key);
+            ctx->buf[len++] = '=';
+            memcpy(&ctx->buf[len], srv->txt[k].value, strlen(srv->txt[k].value));
+            len += strlen(srv->txt[k].value);
+        }
+        break;
+    case MDNS_QUERY_TYPE_A:
+        ctx->buf[len++] = srv->ipV4.ip[3];
+        ctx->buf[len++] = srv->ipV4.ip[2];
+        ctx->buf[len++] = srv->ipV4.ip[1];
+        ctx->buf[len++] = srv->ipV4.ip[0];
+        break;
+    default:
+        break;
+    }
+
+    data_len = len - data_offset - 2;
+    ctx->buf[data_offset] = data_len >> 8;
+    ctx->buf[data_offset + 1] = data_len;
+    return len;
+}
+
+// drop the answers already held by the querier or multicast by another responder, RFC 6762 7.1 and 7.4
+static uint32_t mdns_suppress_answers(mdns_cursor_t *cur, uint32_t record_cnt, mdns_answer_t *answers, uint32_t *ans_cnt) {
+    mdns_rr_t rr = {0};
+    uint32_t suppress_cnt = 0, i = 0, k = 0;
+
+    for (i = 0; i < record_cnt && *ans_cnt; i++) {
+        if (ESP_OK != mdns_parse_rr(cur, &rr)) {
+            break;
+        }
+        for (k = 0; k < *ans_cnt; k++) {
+            if (mdns_is_known_answer(&answers[k], cur, &rr)) {
+                answers[k--] = answers[--(*ans_cnt)];
+                suppress_cnt++;
+            }
+        }
+    }
+
+    return suppress_cnt;
+}
+
+static uint32_t mdns_record_slot(uint16_t type) {
+    switch (type) {
+    case MDNS_QUERY_TYPE_PTR:
+        return 0;
+    case MDNS_QUERY_TYPE_SRV:
+        return 1;
+    case MDNS_QUERY_TYPE_TXT:
+        return 2;
+    default:
+        return 3; // MDNS_QUERY_TYPE_A
+    }
+}
+
+// unicast_addr is NULL for a multicast response, which must not repeat a record within 1s (RFC 6762 6)
+// legacy is the query from a port other than 5353, its id and questions are echoed back (RFC 6762 6.7)
+static void mdns_send_answers(mdns_answer_t *answers, uint32_t ans_cnt, struct sockaddr_in *unicast_addr, socklen_t addr_len,
+                              uint16_t trans_id, const mdns_cursor_t *legacy) {
+    struct sockaddr_in remote_addr = {0};
+    mdns_resp_ctx_t ctx = {0};
+    int64_t now = esp_timer_get_time(), *last_time = NULL;
+    uint32_t resp_len = 0, question_len = 0, k = 0;
+
+    if (!unicast_addr) {
+        for (k = 0; k < ans_cnt; k++) {
+            last_time = &g_last_multicast[answers[k].srv_idx][mdns_record_slot(answers[k].type)];
+            if (*last_time && now - *last_time < CONFIG_MDNS_MULTICAST_INTERVAL * 1000) {
+                answers[k--] = answers[--ans_cnt];
+                taskENTER_CRITICAL(&server_stats_lock);
+                server_stats.record_rate_limited++;
+                taskEXIT_CRITICAL(&server_stats_lock);
+            }
+        }
+        if (!ans_cnt) {
+            return;
+        }
+    }
+
+    srv_resp[0] = trans_id >> 8;
+    srv_resp[1] = trans_id; // trans_id
+    srv_resp[2] = 0x84;
+    srv_resp[3] = 0x00;   // flags: standard query response
+    srv_resp[4] = 0;
+    srv_resp[5] = 0;      // question
+    srv_resp[6] = 0;
+    srv_resp[7] = 0;      // answer, filled below
+    srv_resp[8] = 0;
+    srv_resp[9] = 0;      // authority
+    srv_resp[10] = 0;
+    srv_resp[11] = 0;     // additional
+    resp_len = 12;
+
+    ctx.buf = srv_resp;
+    ctx.ttl = CONFIG_MDNS_TTL;
+    if (legacy) { // the questions sit at the same offset in both packets, their compression pointers stay valid
+        question_len = legacy->offset - MDNS_HEADER_LEN;
+        memcpy(&srv_resp[resp_len], &legacy->buf[MDNS_HEADER_LEN], question_len);
+        resp_len += question_len;
+        srv_resp[4] = legacy->buf[4];
+        srv_resp[5] = legacy->buf[5]; // question
+        ctx.ttl = MIN(CONFIG_MDNS_TTL, 10);
+    }
+    for (k = 0; k < ans_cnt; k++) {
+        if (resp_len + mdns_record_max_len(&g_srv[answers[k].srv_idx], answers[k].type) > sizeof(srv_resp)) {
+            ESP_LOGW(TAG, "resp is full, drop answer:%lu", ans_cnt - k);
+            break;
+        }
+        resp_len = mdns_append_record(&ctx, resp_len, &answers[k]);
+        if (!unicast_addr) {
+            g_last_multicast[answers[k].srv_idx][mdns_record_slot(answers[k].type)] = now;
+        }
+    }
+    srv_resp[6] = k >> 8;
+    srv_resp[7] = k;
+
+    if (unicast_addr) {
+        memcpy(&remote_addr, unicast_addr, sizeof(remote_addr));
+    } else {
+        remote_addr.sin_family = AF_INET;
+        remote_addr.sin_addr.s_addr = inet_addr(MDNS_UPD_IP);
+        remote_addr.sin_port = htons(MDNS_UPD_PORT);
+        addr_len = sizeof(remote_addr);
+    }
+    ESP_LOGI(TAG, "send resp, answer:%lu %s", k, legacy ? "legacy unicast" : (unicast_addr ? "unicast" : "multicast"));
+    sendto(srv_sock, srv_resp, resp_len, 0, (struct sockaddr *)&remote_addr, addr_len);
+    taskENTER_CRITICAL(&server_stats_lock);
+    server_stats.resp_sent++;
+    taskEXIT_CRITICAL(&server_stats_lock);
+}
+
+static void mdns_handle_query(mdns_cursor_t cur, const mdns_header_t *header, struct sockaddr_in *remote_addr, socklen_t addr_len) {
+    mdns_answer_t answers[CONFIG_MDNS_MAX_ANSWER] = {0};
+    mdns_question_t question = {0};
+    mdns_cursor_t legacy = {0};
+    uint32_t ans_cnt = 0, suppress_cnt = 0, unicast_cnt = 0, i = 0, k = 0;
+    uint8_t is_shared = 0;
+
+    for (i = 0; i < header->question_cnt; i++) {
+        if (ESP_OK != mdns_parse_question(&cur, &question)) {
+            ESP_LOGW(TAG, "malformed question:%lu", i);
+            return;
+        }
+        if (question.class & 0x8000) {
+            unicast_cnt++;
+        }
+        ESP_LOGD(TAG, "question:%lu type:0x%04x", i, question.type);
+        mdns_match_question(&question.name, question.type, answers, &ans_cnt);
+    }
+    legacy = cur;
+
+    // known answers, only the records which still match the answer list matter
+    suppress_cnt = mdns_suppress_answers(&cur, header->answer_cnt, answers, &ans_cnt);
+    taskENTER_CRITICAL(&server_stats_lock);
+    server_stats.record_suppressed += suppress_cnt;
+    taskEXIT_CRITICAL(&server_stats_lock);
+    if (!ans_cnt) {
+        if (suppress_cnt) {
+            ESP_LOGI(TAG, "all answers known by querier, suppressed:%lu", suppress_cnt);
+        }
+        return;
+    }
+
+    if (ntohs(remote_addr->sin_port) != MDNS_UPD_PORT) { // one-shot querier, it only listens on its own port
+        mdns_send_answers(answers, ans_cnt, remote_addr, addr_len, header->trans_id, &legacy);
+        return;
+    }
+
+    if (unicast_cnt == header->question_cnt) { // QU is honored only if every question asks for it
+        mdns_send_answers(answers, ans_cnt, remote_addr, addr_len, header->trans_id, NULL);
+        return;
+    }
+
+    for (k = 0; k < ans_cnt; k++) {
+        if (MDNS_QUERY_TYPE_PTR == answers[k].type) {
+            is_shared = 1;
+        }
+    }
+    if (!is_shared && !delayed_cnt) { // unique records only, no need to wait for other responders
+        mdns_send_answers(answers, ans_cnt, NULL, 0, 0, NULL);
+        return;
+    }
+
+    // shared records wait 20-120ms, queries arriving meanwhile join the same response
+    if (delayed_cnt) {
+        taskENTER_CRITICAL(&server_stats_lock);
+        server_stats.query_aggregated++;
+        taskEXIT_CRITICAL(&server_stats_lock);
+    } else {
+        delayed_deadline = esp_timer_get_time() + (CONFIG_MDNS_RESP_DELAY_MIN + esp_random() % (CONFIG_MDNS_RESP_DELAY_MAX - CONFIG_MDNS_RESP_DELAY_MIN)) * 1000;
+    }
+    for (k = 0; k < ans_cnt; k++) {
+        mdns_add_answer(g_delayed, &delayed_cnt, answers[k].srv_idx, answers[k].type);
+    }
+}
+
+// ms until the delayed response is due, capped by CONFIG_MDNS_RX_POLL_INTERVAL
+static uint32_t mdns_server_next_timeout() {
+    int64_t now = esp_timer_get_time();
+
+    if (!delayed_cnt) {
+        return CONFIG_MDNS_RX_POLL_INTERVAL;
+    }
+    return delayed_deadline > now ? MIN((delayed_deadline - now + 999) / 1000, CONFIG_MDNS_RX_POLL_INTERVAL) : 0;
+}
+
+static void mdns_server_process() {
+    if (delayed_cnt && esp_timer_get_time() >= delayed_deadline) {
+        mdns_send_answers(g_delayed, delayed_cnt, NULL, 0, 0, NULL);
+        delayed_cnt = 0;
+    }
+}
+
+// another responder multicast some of our delayed answers, no need to repeat them
+static void mdns_server_suppress(mdns_cursor_t cur, const mdns_header_t *header) {
+    uint32_t suppress_cnt = 0;
+
+    if (!delayed_cnt || ESP_OK != mdns_skip_questions(&cur, header->question_cnt)) {
+        return;
+    }
+    suppress_cnt = mdns_suppress_answers(&cur, header->answer_cnt, g_delayed, &delayed_cnt);
+    taskENTER_CRITICAL(&server_stats_lock);
+    server_stats.record_suppressed += suppress_cnt;
+    taskEXIT_CRITICAL(&server_stats_lock);
+}
+
+void mdns_server_get_stats(mdns_server_stats_t *stats) {
+    taskENTER_CRITICAL(&server_stats_lock);
+    memcpy(stats, &server_stats, sizeof(mdns_server_stats_t));
+    taskEXIT_CRITICAL(&server_stats_lock);
+}
+
+// port 5353: answers the queries once the server is started, every response on the link feeds the cache
+static void mdns_srv_task(void *pvParameters) {
+    struct sockaddr_in remote_addr = {0};
+    socklen_t addr_len = sizeof(remote_addr);
+    int req_len = 0;
+    uint32_t timeout = 0;
+    struct timeval tv = {0};
+    mdns_cursor_t cur = {0};
+    mdns_header_t header = {0};
+    fd_set rfds;
+
+    while (1) {
+        timeout = MIN(MIN(mdns_browse_next_timeout(), mdns_server_next_timeout()), mdns_cache_next_timeout());
+        tv.tv_sec = timeout / 1000;
+        tv.tv_usec = (timeout % 1000) * 1000;
+        FD_ZERO(&rfds);
+        FD_SET(srv_sock, &rfds);
+        if (select(srv_sock + 1, &rfds, NULL, NULL, &tv) > 0) {
+            addr_len = sizeof(remote_addr);
+            req_len = recvfrom(srv_sock, srv_req, sizeof(srv_req), 0, (struct sockaddr *)&remote_addr, &addr_len);
+            if (req_len > 0 && ESP_OK == mdns_parse_header(&cur, srv_req, req_len, &header)) {
+                if (header.flags & 0x8000) {
+                    mdns_cache_add_packet(cur, &header);
+                    mdns_server_suppress(cur, &header);
+                    mdns_pending_process(); // answers to the other queriers may complete ours as well
+                } else if (server_started) {
+                    mdns_handle_query(cur, &header, &remote_addr, addr_len);
+                }
+            }
+        }
+        mdns_browse_process(srv_resp, sizeof(srv_resp));
+        mdns_cache_process();
+        mdns_server_process();
+    }
+}
+
+// ephemeral port: unicast responses to the one-shot queries, wakes up the pending queries
+static void mdns_rx_task(void *pvParameters) {
+    struct sockaddr_in remote_addr = {0};
+    socklen_t addr_len = sizeof(remote_addr);
+    int resp_len = 0;
+    uint32_t timeout = 0;
+    struct timeval tv = {0};
+    mdns_cursor_t cur = {0};
+    mdns_header_t header = {0};
+    fd_set rfds;
+
+    while (1) {
+        timeout = mdns_pending_next_timeout();
+        tv.tv_sec = timeout / 1000;
+        tv.tv_usec = (timeout % 1000) * 1000;
+        FD_ZERO(&rfds);
+        FD_SET(query_sock, &rfds);
+        if (select(query_sock + 1, &rfds, NULL, NULL, &tv) > 0) {
+            addr_len = sizeof(remote_addr);
+            resp_len = recvfrom(query_sock, query_buf, sizeof(query_buf), 0, (struct sockaddr *)&remote_addr, &addr_len);
+            if (resp_len > 0 && ESP_OK == mdns_parse_header(&cur, query_buf, resp_len, &header) && (header.flags & 0x8000)) {
+                mdns_cache_add_packet(cur, &header);
+            }
+        }
+        mdns_pending_process();
+    }
+}
+
+esp_err_t mdns_start_server() {
+    server_started = 1;
+    ESP_LOGI(TAG, "mdns server started, service cnt:%u", srv_cnt);
+    return ESP_OK;
 }
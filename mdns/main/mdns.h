@@ -7,6 +7,19 @@
 #define CONFIG_MDNS_TTL                             4500
 #define CONFIG_MDNS_MAX_SERVICE                     10
 #define CONFIG_MDNS_SERVICE_MAX_TXT                 5
+#define CONFIG_MDNS_MAX_ANSWER                      16
+#define CONFIG_MDNS_CACHE_SIZE                      16
+#define CONFIG_MDNS_CACHE_REFRESH_PERCENT           80
+#define CONFIG_MDNS_MAX_PENDING                     8
+#define CONFIG_MDNS_RX_POLL_INTERVAL                1000
+#define CONFIG_MDNS_MAX_BROWSE                      2
+#define CONFIG_MDNS_BROWSE_MAX_INSTANCE             8
+#define CONFIG_MDNS_BROWSE_MAX_INTERVAL             3600
+#define CONFIG_MDNS_RESP_DELAY_MIN                  20
+#define CONFIG_MDNS_RESP_DELAY_MAX                  120
+#define CONFIG_MDNS_MULTICAST_INTERVAL              1000
+#define CONFIG_MDNS_TASK_STACK_SIZE                 4096
+#define CONFIG_MDNS_TASK_PRIORITY                   5
 
 
 typedef enum {
@@ -15,6 +28,7 @@ typedef enum {
     MDNS_QUERY_TYPE_TXT = 0x10,
     MDNS_QUERY_TYPE_AAAA = 0x1C,
     MDNS_QUERY_TYPE_SRV = 0x21,
+    MDNS_QUERY_TYPE_ANY = 0xFF,
 } mdns_query_type_t;
 
 typedef struct {
@@ -54,7 +68,35 @@ typedef struct {
     mdns_aaaa_t ipV6;
 } mdns_service_t;
 
+typedef struct {
+    uint16_t type;
+    union {
+        mdns_ptr_t ptr;
+        mdns_srv_t srv;
+        struct {
+            mdns_txt_t txt[CONFIG_MDNS_SERVICE_MAX_TXT];
+            uint8_t cnt;
+        } txt;
+        mdns_a_t a;
+        mdns_aaaa_t aaaa;
+    } data;
+} mdns_result_t;
+
+// called from mdns_rx or mdns_srv task, or from the caller on cache hit, result is NULL on error
+typedef void (*mdns_query_cb_t)(uint32_t query_id, esp_err_t err, mdns_result_t *result, void *arg);
+
+typedef struct {
+    uint32_t resp_sent;
+    uint32_t query_aggregated; // joined a delayed response instead of sending its own
+    uint32_t record_rate_limited; // multicast less than 1s ago
+    uint32_t record_suppressed; // known by the querier or sent by another responder
+} mdns_server_stats_t;
+
+// called from mdns_rx or mdns_srv task, must not block
+typedef void (*mdns_browse_cb_t)(mdns_ptr_t *instance, void *arg);
+
 esp_err_t mdns_init();
+esp_err_t mdns_query_async(char *name, uint16_t type, mdns_query_cb_t cb, void *arg, uint32_t *query_id);
 esp_err_t mdns_query_ptr(char *srv_type, char *trans_type, mdns_ptr_t *result);
 esp_err_t mdns_query_srv(char *ins_name, char *srv_type, char *trans_type, mdns_srv_t *result);
 esp_err_t mdns_query_txt(char *ins_name, char *srv_type, char *trans_type, mdns_txt_t *result, uint32_t *cnt);
@@ -62,4 +104,8 @@ esp_err_t mdns_query_a(char *ins_name, char *srv_type, char *trans_type, mdns_a_
 esp_err_t mdns_query_aaaa(char *ins_name, char *srv_type, char *trans_type, mdns_aaaa_t *result);
 esp_err_t mdns_add_srv(char *ins_name, char *srv_type, char *trans_type, uint16_t port,
                        mdns_a_t *ipV4, mdns_aaaa_t *ipV6, mdns_txt_t *txt, uint32_t cnt);
-esp_err_t mdns_start_server();
\ No newline at end of file
+esp_err_t mdns_start_server();
+void mdns_server_get_stats(mdns_server_stats_t *stats);
+void mdns_cache_get_stats(uint32_t *hit, uint32_t *miss);
+esp_err_t mdns_browse_start(char *srv_type, char *trans_type, mdns_browse_cb_t add_cb, mdns_browse_cb_t remove_cb, void *arg);
+esp_err_t mdns_browse_stop(char *srv_type, char *trans_type);
\ No newline at end of file
@@ -0,0 +1,206 @@
+#include <string.h>
+#include <strings.h>
+#include "mdns_parser.h"
+
+static uint16_t mdns_get_u16(const uint8_t *p) {
+    return p[0] << 8 | p[1];
+}
+
+static uint32_t mdns_get_u32(const uint8_t *p) {
+    return (uint32_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+}
+
+// next label of a validated name, follows compression pointers, returns 0 at the root label
+static uint8_t mdns_name_next_label(const mdns_name_t *name, uint16_t *offset, const uint8_t **label) {
+    uint8_t label_len = name->buf[*offset];
+
+    while (0xc0 == (label_len & 0xc0)) {
+        *offset = ((label_len & 0x3f) << 8) | name->buf[*offset + 1];
+        label_len = name->buf[*offset];
+    }
+    *label = &name->buf[*offset + 1];
+    *offset += label_len + 1;
+    return label_len;
+}
+
+esp_err_t mdns_parse_header(mdns_cursor_t *cur, const uint8_t *buf, uint16_t len, mdns_header_t *header) {
+    cur->buf = buf;
+    cur->len = len;
+    cur->offset = 0;
+    if (len < MDNS_HEADER_LEN) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    header->trans_id = mdns_get_u16(&buf[0]);
+    header->flags = mdns_get_u16(&buf[2]);
+    header->question_cnt = mdns_get_u16(&buf[4]);
+    header->answer_cnt = mdns_get_u16(&buf[6]);
+    header->authority_cnt = mdns_get_u16(&buf[8]);
+    header->additional_cnt = mdns_get_u16(&buf[10]);
+    cur->offset = MDNS_HEADER_LEN;
+    return ESP_OK;
+}
+
+// validates the whole name once, so that the accessors below can walk it without checks
+esp_err_t mdns_parse_name(mdns_cursor_t *cur, mdns_name_t *name) {
+    uint16_t offset = cur->offset, next = 0, wire_len = 0;
+    uint32_t jumps = 0;
+    uint8_t label_len = 0;
+
+    name->buf = cur->buf;
+    name->len = cur->len;
+    name->offset = cur->offset;
+
+    while (1) {
+        if (offset >= cur->len) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        label_len = cur->buf[offset];
+
+        if (0xc0 == (label_len & 0xc0)) { // compression pointer, loops are cut by the jump limit
+            if (offset + 1 >= cur->len || ++jumps > MDNS_NAME_MAX_JUMPS) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            if (!next) {
+                next = offset + 2;
+            }
+            offset = ((label_len & 0x3f) << 8) | cur->buf[offset + 1];
+            continue;
+        }
+        if (label_len & 0xc0) { // extended label types are not used by mDNS
+            return ESP_ERR_INVALID_RESPONSE;
+        }
+
+        wire_len += label_len + 1;
+        if (wire_len > MDNS_NAME_MAX_WIRE_LEN || offset + 1 + label_len > cur->len) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        if (0 == label_len) {
+            break;
+        }
+        offset += label_len + 1;
+    }
+
+    cur->offset = next ? next : offset + 1;
+    return ESP_OK;
+}
+
+esp_err_t mdns_parse_question(mdns_cursor_t *cur, mdns_question_t *question) {
+    esp_err_t err = mdns_parse_name(cur, &question->name);
+
+    if (ESP_OK != err) {
+        return err;
+    }
+    if (cur->offset + 4 > cur->len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    question->type = mdns_get_u16(&cur->buf[cur->offset]);
+    question->class = mdns_get_u16(&cur->buf[cur->offset + 2]);
+    cur->offset += 4; // type(2B), class(2B)
+    return ESP_OK;
+}
+
+esp_err_t mdns_parse_rr(mdns_cursor_t *cur, mdns_rr_t *rr) {
+    esp_err_t err = mdns_parse_name(cur, &rr->name);
+
+    if (ESP_OK != err) {
+        return err;
+    }
+    if (cur->offset + 10 > cur->len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    rr->type = mdns_get_u16(&cur->buf[cur->offset]);
+    rr->class = mdns_get_u16(&cur->buf[cur->offset + 2]);
+    rr->ttl = mdns_get_u32(&cur->buf[cur->offset + 4]);
+    rr->rdata_len = mdns_get_u16(&cur->buf[cur->offset + 8]);
+    rr->rdata_offset = cur->offset + 10; // type(2B), class(2B), TTL(4B), length(2B)
+    if (rr->rdata_offset + rr->rdata_len > cur->len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    cur->offset = rr->rdata_offset + rr->rdata_len;
+    return ESP_OK;
+}
+
+esp_err_t mdns_parse_rdata_name(const mdns_cursor_t *cur, const mdns_rr_t *rr, uint16_t skip, mdns_name_t *name) {
+    mdns_cursor_t rdata = {
+        .buf = cur->buf,
+        .len = cur->len,
+        .offset = rr->rdata_offset + skip
+    };
+    esp_err_t err = ESP_OK;
+
+    if (skip >= rr->rdata_len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    err = mdns_parse_name(&rdata, name);
+    if (ESP_OK == err && rdata.offset > rr->rdata_offset + rr->rdata_len) { // inline labels must stay in rdata
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return err;
+}
+
+uint8_t mdns_name_equal_labels(const mdns_name_t *name, const char **labels, uint32_t cnt) {
+    uint16_t offset = name->offset;
+    const uint8_t *label = NULL;
+    uint8_t label_len = 0;
+    uint32_t i = 0;
+
+    for (i = 0; i < cnt; i++) {
+        label_len = mdns_name_next_label(name, &offset, &label);
+        if (0 == label_len || label_len != strlen(labels[i]) || strncasecmp((const char *)label, labels[i], label_len)) {
+            return 0;
+        }
+    }
+    return 0 == mdns_name_next_label(name, &offset, &label);
+}
+
+uint8_t mdns_name_equal_str(const mdns_name_t *name, const char *str) {
+    uint16_t offset = name->offset;
+    const uint8_t *label = NULL;
+    const char *dot = NULL;
+    uint8_t label_len = 0;
+
+    while (*str) {
+        dot = strchr(str, '.');
+        if (!dot) {
+            dot = str + strlen(str);
+        }
+        label_len = mdns_name_next_label(name, &offset, &label);
+        if (0 == label_len || label_len != dot - str || strncasecmp((const char *)label, str, label_len)) {
+            return 0;
+        }
+        str = *dot ? dot + 1 : dot;
+    }
+    return 0 == mdns_name_next_label(name, &offset, &label);
+}
+
+void mdns_name_first_label(const mdns_name_t *name, const uint8_t **label, uint8_t *len) {
+    uint16_t offset = name->offset;
+
+    *len = mdns_name_next_label(name, &offset, label);
+}
+
+esp_err_t mdns_name_to_str(const mdns_name_t *name, char *str, uint32_t size) {
+    uint16_t offset = name->offset;
+    const uint8_t *label = NULL;
+    uint8_t label_len = 0;
+    uint32_t str_len = 0;
+
+    if (!size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    while ((label_len = mdns_name_next_label(name, &offset, &label))) {
+        if (str_len + label_len + 1 > size) {
+            str[0] = 0;
+            return ESP_ERR_INVALID_SIZE;
+        }
+        memcpy(&str[str_len], label, label_len);
+        str_len += label_len;
+        str[str_len++] = '.';
+    }
+    str[str_len ? str_len - 1 : 0] = 0; // delete the last char "."
+    return ESP_OK;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#define MDNS_HEADER_LEN                             12
+#define MDNS_NAME_MAX_WIRE_LEN                      255
+#define MDNS_NAME_MAX_JUMPS                         16
+
+// read position in a received message, every access is checked against len
+typedef struct {
+    const uint8_t *buf;
+    uint16_t len;
+    uint16_t offset;
+} mdns_cursor_t;
+
+// name inside the message, compression pointers are resolved on access, nothing is copied
+typedef struct {
+    const uint8_t *buf;
+    uint16_t len;
+    uint16_t offset;
+} mdns_name_t;
+
+typedef struct {
+    uint16_t trans_id;
+    uint16_t flags;
+    uint16_t question_cnt;
+    uint16_t answer_cnt;
+    uint16_t authority_cnt;
+    uint16_t additional_cnt;
+} mdns_header_t;
+
+typedef struct {
+    mdns_name_t name;
+    uint16_t type;
+    uint16_t class; // bit15 - unicast response
+} mdns_question_t;
+
+typedef struct {
+    mdns_name_t name;
+    uint16_t type;
+    uint16_t class; // bit15 - cache flush
+    uint32_t ttl;
+    uint16_t rdata_offset;
+    uint16_t rdata_len;
+} mdns_rr_t;
+
+esp_err_t mdns_parse_header(mdns_cursor_t *cur, const uint8_t *buf, uint16_t len, mdns_header_t *header);
+esp_err_t mdns_parse_name(mdns_cursor_t *cur, mdns_name_t *name);
+esp_err_t mdns_parse_question(mdns_cursor_t *cur, mdns_question_t *question);
+esp_err_t mdns_parse_rr(mdns_cursor_t *cur, mdns_rr_t *rr);
+// name inside rdata, starting skip bytes after rdata_offset
+esp_err_t mdns_parse_rdata_name(const mdns_cursor_t *cur, const mdns_rr_t *rr, uint16_t skip, mdns_name_t *name);
+// case-insensitive compare with a label list, e.g. {"_http", "_tcp", "local"}
+uint8_t mdns_name_equal_labels(const mdns_name_t *name, const char **labels, uint32_t cnt);
+uint8_t mdns_name_equal_str(const mdns_name_t *name, const char *str);
+void mdns_name_first_label(const mdns_name_t *name, const uint8_t **label, uint8_t *len);
+// dotted copy, only for names which outlive the message
+esp_err_t mdns_name_to_str(const mdns_name_t *name, char *str, uint32_t size);
@@ -1,17 +1,139 @@
+#include <stdio.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/spi_master.h"
 #include "ssd1306.h"
 
+#define EXAMPLE_SPI_PIN_CS          5
+#define EXAMPLE_SPI_PIN_MOSI        23
+#define EXAMPLE_SPI_PIN_CLK         18
+#define EXAMPLE_SPI_PIN_RST         2
+#define EXAMPLE_SPI_PIN_DC          4
+#define EXAMPLE_SPI_MASTER_NUM      HSPI_HOST
+#define EXAMPLE_SPI_CLOCK_HZ        (10 * 1000 * 1000) // ssd1306 serial clock cycle is 100ns at least
+#define FPS_TEST_FRAMES     100
+#define APP_LOOP_MS         40   // the rest of a 25Hz application loop, sensors and so on
+
+static const char *TAG = "main";
+
+// full - redraw every page each frame, otherwise only a frame counter changes
+static void oled_fps_test(uint8_t full)
+{
+    char text[22] = {0};
+    uint32_t i = 0, j = 0;
+    int64_t start = 0, cost = 0;
+
+    start = esp_timer_get_time();
+    for (i = 0; i < FPS_TEST_FRAMES; i++) {
+        if (full) {
+            oled_clear();
+            for (j = 0; j < 8; j++) {
+                snprintf(text, sizeof(text), "frame:%lu line:%lu", i, j);
+                oled_show_string(0, j, text, 1);
+            }
+        } else {
+            snprintf(text, sizeof(text), "frame:%lu", i);
+            oled_show_string(0, 0, text, 1);
+        }
+        oled_flush();
+    }
+    cost = esp_timer_get_time() - start;
+
+    ESP_LOGI(TAG, "%s update, %lld us/frame, fps:%lld", full ? "full screen" : "partial",
+             cost / FPS_TEST_FRAMES, FPS_TEST_FRAMES * 1000000LL / cost);
+}
+
+// 1KB frame each time, queued DMA transfers against one blocking transaction at a time
+static void oled_throughput_test(void)
+{
+    uint32_t i = 0, j = 0;
+    int64_t start = 0, cost = 0;
+
+    for (j = 0; j < 2; j++) {
+        start = esp_timer_get_time();
+        for (i = 0; i < FPS_TEST_FRAMES; i++) {
+            oled_clear();
+            if (j) {
+                oled_flush();
+            } else {
+                oled_flush_polling();
+            }
+        }
+        cost = esp_timer_get_time() - start;
+
+        ESP_LOGI(TAG, "%s flush, %lld us/frame, %lld KB/s", j ? "queued" : "polling",
+                 cost / FPS_TEST_FRAMES, FPS_TEST_FRAMES * 1000000LL / cost);
+    }
+}
+
+// how long a 25Hz application loop is held by the display each frame, swap - hand frames to the flush task
+static void oled_block_test(uint8_t swap)
+{
+    char text[22] = {0};
+    uint32_t i = 0, j = 0;
+    int64_t start = 0, cost = 0, total = 0, max = 0;
+
+    for (i = 0; i < FPS_TEST_FRAMES; i++) {
+        start = esp_timer_get_time();
+        oled_clear();
+        for (j = 0; j < 8; j++) {
+            snprintf(text, sizeof(text), "frame:%lu line:%lu", i, j);
+            oled_show_string(0, j, text, 1);
+        }
+        if (swap) {
+            oled_swap(APP_LOOP_MS);
+        } else {
+            oled_flush();
+        }
+        cost = esp_timer_get_time() - start;
+        total += cost;
+        if (cost > max) {
+            max = cost;
+        }
+        vTaskDelay(APP_LOOP_MS / portTICK_PERIOD_MS);
+    }
+
+    ESP_LOGI(TAG, "%s, caller blocked %lld us/frame, %lld us at most", swap ? "oled_swap" : "oled_flush",
+             total / FPS_TEST_FRAMES, max);
+}
 
 void app_main(void)
 {
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
+    ssd1306_io_handle_t io = NULL;
+    ssd1306_spi_config_t spi_config = {
+        .host = EXAMPLE_SPI_MASTER_NUM,
+        .pin_mosi = EXAMPLE_SPI_PIN_MOSI,
+        .pin_clk = EXAMPLE_SPI_PIN_CLK,
+        .pin_cs = EXAMPLE_SPI_PIN_CS,
+        .pin_dc = EXAMPLE_SPI_PIN_DC,
+        .pin_rst = EXAMPLE_SPI_PIN_RST,
+        .clock_hz = EXAMPLE_SPI_CLOCK_HZ,
+    };
 
     uint8_t hzline1_1[] = {0, 1, 2};
     uint8_t hzline1_2[] = {3, 4, 5};
     uint8_t hzline2[] = {6, 7, 8, 9, 10, 11};
 
-    oled_init();
+    if (ESP_OK != ssd1306_new_spi_io(&spi_config, &io)) {
+        ESP_LOGE(TAG, "ssd1306 spi io create error");
+        return;
+    }
+    oled_init(io);
+    oled_show_string(0, 0, "spi ready", 2);
+    oled_flush();
+    // esp_timer starts with the app, the bootloader before it is not counted
+    ESP_LOGI(TAG, "first frame %lld us after boot, panel %s", esp_timer_get_time(), oled_panel_kept() ? "kept" : "initialized");
+    oled_fps_test(1);
+    oled_fps_test(0);
+    oled_block_test(0);
+    oled_throughput_test();
+    if (ESP_OK != oled_start_flush_task(0, 5)) {
+        return;
+    }
+    oled_block_test(1);
+
     oled_clear();
     oled_show_char(0, 0, 'a', 1);
     oled_show_char(121, 0, 'Z', 1);
@@ -30,6 +152,8 @@ void app_main(void)
     oled_show_line(20, 20, 20, 30, 1);
     oled_show_line(50, 35, 75, 45, 1);
     oled_show_line(50, 45, 75, 35, 1);
+    oled_swap(1000);
+    oled_scroll_horizontal(1, 0, 0, 0); // the first line runs on its own, no bus traffic per step
 
     while (1) {
         vTaskDelay(1000 / portTICK_PERIOD_MS);
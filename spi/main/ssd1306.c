@@ -1,490 +0,0 @@
-#include <stdio.h>
-#include "driver/spi_master.h"
-#include "driver/gpio.h"
-#include "driver/i2c.h"
-#include "esp_log.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "ssd1306.h"
-
-#define EXAMPLE_SPI_PIN_CS          5
-#define EXAMPLE_SPI_PIN_MISO        19
-#define EXAMPLE_SPI_PIN_MOSI        23
-#define EXAMPLE_SPI_PIN_CLK         18
-#define EXAMPLE_SPI_PIN_RST         2
-#define EXAMPLE_SPI_PIN_DC          4
-#define EXAMPLE_SPI_MASTER_NUM      HSPI_HOST
-
-const static char *TAG = "spi";
-uint8_t pixel[128 * 8] = {0}; // ssd1306 not support read operation, so use ram to save every pixel value
-
-const uint8_t F6x8[][6] = {
-    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // sp
-    {0x00, 0x00, 0x00, 0x2f, 0x00, 0x00}, // !
-    {0x00, 0x00, 0x07, 0x00, 0x07, 0x00}, // "
-    {0x00, 0x14, 0x7f, 0x14, 0x7f, 0x14}, // #
-    {0x00, 0x24, 0x2a, 0x7f, 0x2a, 0x12}, // $
-    {0x00, 0x62, 0x64, 0x08, 0x13, 0x23}, // %
-    {0x00, 0x36, 0x49, 0x55, 0x22, 0x50}, // &
-    {0x00, 0x00, 0x05, 0x03, 0x00, 0x00}, // '
-    {0x00, 0x00, 0x1c, 0x22, 0x41, 0x00}, // (
-    {0x00, 0x00, 0x41, 0x22, 0x1c, 0x00}, // )
-    {0x00, 0x14, 0x08, 0x3E, 0x08, 0x14}, // *
-    {0x00, 0x08, 0x08, 0x3E, 0x08, 0x08}, // +
-    {0x00, 0x00, 0x00, 0xA0, 0x60, 0x00}, // ,
-    {0x00, 0x08, 0x08, 0x08, 0x08, 0x08}, // -
-    {0x00, 0x00, 0x60, 0x60, 0x00, 0x00}, // .
-    {0x00, 0x20, 0x10, 0x08, 0x04, 0x02}, // /
-    {0x00, 0x3E, 0x51, 0x49, 0x45, 0x3E}, // 0
-    {0x00, 0x00, 0x42, 0x7F, 0x40, 0x00}, // 1
-    {0x00, 0x42, 0x61, 0x51, 0x49, 0x46}, // 2
-    {0x00, 0x21, 0x41, 0x45, 0x4B, 0x31}, // 3
-    {0x00, 0x18, 0x14, 0x12, 0x7F, 0x10}, // 4
-    {0x00, 0x27, 0x45, 0x45, 0x45, 0x39}, // 5
-    {0x00, 0x3C, 0x4A, 0x49, 0x49, 0x30}, // 6
-    {0x00, 0x01, 0x71, 0x09, 0x05, 0x03}, // 7
-    {0x00, 0x36, 0x49, 0x49, 0x49, 0x36}, // 8
-    {0x00, 0x06, 0x49, 0x49, 0x29, 0x1E}, // 9
-    {0x00, 0x00, 0x36, 0x36, 0x00, 0x00}, // :
-    {0x00, 0x00, 0x56, 0x36, 0x00, 0x00}, // ;
-    {0x00, 0x08, 0x14, 0x22, 0x41, 0x00}, // <
-    {0x00, 0x14, 0x14, 0x14, 0x14, 0x14}, // =
-    {0x00, 0x00, 0x41, 0x22, 0x14, 0x08}, // >
-    {0x00, 0x02, 0x01, 0x51, 0x09, 0x06}, // ?
-    {0x00, 0x32, 0x49, 0x59, 0x51, 0x3E}, // @
-    {0x00, 0x7C, 0x12, 0x11, 0x12, 0x7C}, // A
-    {0x00, 0x7F, 0x49, 0x49, 0x49, 0x36}, // B
-    {0x00, 0x3E, 0x41, 0x41, 0x41, 0x22}, // C
-    {0x00, 0x7F, 0x41, 0x41, 0x22, 0x1C}, // D
-    {0x00, 0x7F, 0x49, 0x49, 0x49, 0x41}, // E
-    {0x00, 0x7F, 0x09, 0x09, 0x09, 0x01}, // F
-    {0x00, 0x3E, 0x41, 0x49, 0x49, 0x7A}, // G
-    {0x00, 0x7F, 0x08, 0x08, 0x08, 0x7F}, // H
-    {0x00, 0x00, 0x41, 0x7F, 0x41, 0x00}, // I
-    {0x00, 0x20, 0x40, 0x41, 0x3F, 0x01}, // J
-    {0x00, 0x7F, 0x08, 0x14, 0x22, 0x41}, // K
-    {0x00, 0x7F, 0x40, 0x40, 0x40, 0x40}, // L
-    {0x00, 0x7F, 0x02, 0x0C, 0x02, 0x7F}, // M
-    {0x00, 0x7F, 0x04, 0x08, 0x10, 0x7F}, // N
-    {0x00, 0x3E, 0x41, 0x41, 0x41, 0x3E}, // O
-    {0x00, 0x7F, 0x09, 0x09, 0x09, 0x06}, // P
-    {0x00, 0x3E, 0x41, 0x51, 0x21, 0x5E}, // Q
-    {0x00, 0x7F, 0x09, 0x19, 0x29, 0x46}, // R
-    {0x00, 0x46, 0x49, 0x49, 0x49, 0x31}, // S
-    {0x00, 0x01, 0x01, 0x7F, 0x01, 0x01}, // T
-    {0x00, 0x3F, 0x40, 0x40, 0x40, 0x3F}, // U
-    {0x00, 0x1F, 0x20, 0x40, 0x20, 0x1F}, // V
-    {0x00, 0x3F, 0x40, 0x38, 0x40, 0x3F}, // W
-    {0x00, 0x63, 0x14, 0x08, 0x14, 0x63}, // X
-    {0x00, 0x07, 0x08, 0x70, 0x08, 0x07}, // Y
-    {0x00, 0x61, 0x51, 0x49, 0x45, 0x43}, // Z
-    {0x00, 0x00, 0x7F, 0x41, 0x41, 0x00}, // [
-    {0x00, 0x55, 0x2A, 0x55, 0x2A, 0x55}, // 55
-    {0x00, 0x00, 0x41, 0x41, 0x7F, 0x00}, // ]
-    {0x00, 0x04, 0x02, 0x01, 0x02, 0x04}, // ^
-    {0x00, 0x40, 0x40, 0x40, 0x40, 0x40}, // _
-    {0x00, 0x00, 0x01, 0x02, 0x04, 0x00}, // '
-    {0x00, 0x20, 0x54, 0x54, 0x54, 0x78}, // a
-    {0x00, 0x7F, 0x48, 0x44, 0x44, 0x38}, // b
-    {0x00, 0x38, 0x44, 0x44, 0x44, 0x20}, // c
-    {0x00, 0x38, 0x44, 0x44, 0x48, 0x7F}, // d
-    {0x00, 0x38, 0x54, 0x54, 0x54, 0x18}, // e
-    {0x00, 0x08, 0x7E, 0x09, 0x01, 0x02}, // f
-    {0x00, 0x18, 0xA4, 0xA4, 0xA4, 0x7C}, // g
-    {0x00, 0x7F, 0x08, 0x04, 0x04, 0x78}, // h
-    {0x00, 0x00, 0x44, 0x7D, 0x40, 0x00}, // i
-    {0x00, 0x40, 0x80, 0x84, 0x7D, 0x00}, // j
-    {0x00, 0x7F, 0x10, 0x28, 0x44, 0x00}, // k
-    {0x00, 0x00, 0x41, 0x7F, 0x40, 0x00}, // l
-    {0x00, 0x7C, 0x04, 0x18, 0x04, 0x78}, // m
-    {0x00, 0x7C, 0x08, 0x04, 0x04, 0x78}, // n
-    {0x00, 0x38, 0x44, 0x44, 0x44, 0x38}, // o
-    {0x00, 0xFC, 0x24, 0x24, 0x24, 0x18}, // p
-    {0x00, 0x18, 0x24, 0x24, 0x18, 0xFC}, // q
-    {0x00, 0x7C, 0x08, 0x04, 0x04, 0x08}, // r
-    {0x00, 0x48, 0x54, 0x54, 0x54, 0x20}, // s
-    {0x00, 0x04, 0x3F, 0x44, 0x40, 0x20}, // t
-    {0x00, 0x3C, 0x40, 0x40, 0x20, 0x7C}, // u
-    {0x00, 0x1C, 0x20, 0x40, 0x20, 0x1C}, // v
-    {0x00, 0x3C, 0x40, 0x30, 0x40, 0x3C}, // w
-    {0x00, 0x44, 0x28, 0x10, 0x28, 0x44}, // x
-    {0x00, 0x1C, 0xA0, 0xA0, 0xA0, 0x7C}, // y
-    {0x00, 0x44, 0x64, 0x54, 0x4C, 0x44}, // z
-    {0x14, 0x14, 0x14, 0x14, 0x14, 0x14}, // horiz lines
-};
-
-const uint8_t F8X16[] = {
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0
-    0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x33, 0x30, 0x00, 0x00, 0x00, //! 1
-    0x00, 0x10, 0x0C, 0x06, 0x10, 0x0C, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //" 2
-    0x40, 0xC0, 0x78, 0x40, 0xC0, 0x78, 0x40, 0x00, 0x04, 0x3F, 0x04, 0x04, 0x3F, 0x04, 0x04, 0x00, //# 3
-    0x00, 0x70, 0x88, 0xFC, 0x08, 0x30, 0x00, 0x00, 0x00, 0x18, 0x20, 0xFF, 0x21, 0x1E, 0x00, 0x00, //$ 4
-    0xF0, 0x08, 0xF0, 0x00, 0xE0, 0x18, 0x00, 0x00, 0x00, 0x21, 0x1C, 0x03, 0x1E, 0x21, 0x1E, 0x00, //% 5
-    0x00, 0xF0, 0x08, 0x88, 0x70, 0x00, 0x00, 0x00, 0x1E, 0x21, 0x23, 0x24, 0x19, 0x27, 0x21, 0x10, //& 6
-    0x10, 0x16, 0x0E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //' 7
-    0x00, 0x00, 0x00, 0xE0, 0x18, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00, 0x07, 0x18, 0x20, 0x40, 0x00, //( 8
-    0x00, 0x02, 0x04, 0x18, 0xE0, 0x00, 0x00, 0x00, 0x00, 0x40, 0x20, 0x18, 0x07, 0x00, 0x00, 0x00, //) 9
-    0x40, 0x40, 0x80, 0xF0, 0x80, 0x40, 0x40, 0x00, 0x02, 0x02, 0x01, 0x0F, 0x01, 0x02, 0x02, 0x00, //* 10
-    0x00, 0x00, 0x00, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x1F, 0x01, 0x01, 0x01, 0x00, //+ 11
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0xB0, 0x70, 0x00, 0x00, 0x00, 0x00, 0x00, //, 12
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, //- 13
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, //. 14
-    0x00, 0x00, 0x00, 0x00, 0x80, 0x60, 0x18, 0x04, 0x00, 0x60, 0x18, 0x06, 0x01, 0x00, 0x00, 0x00, /// 15
-    0x00, 0xE0, 0x10, 0x08, 0x08, 0x10, 0xE0, 0x00, 0x00, 0x0F, 0x10, 0x20, 0x20, 0x10, 0x0F, 0x00, // 0 16
-    0x00, 0x10, 0x10, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x20, 0x3F, 0x20, 0x20, 0x00, 0x00, // 1 17
-    0x00, 0x70, 0x08, 0x08, 0x08, 0x88, 0x70, 0x00, 0x00, 0x30, 0x28, 0x24, 0x22, 0x21, 0x30, 0x00, // 2 18
-    0x00, 0x30, 0x08, 0x88, 0x88, 0x48, 0x30, 0x00, 0x00, 0x18, 0x20, 0x20, 0x20, 0x11, 0x0E, 0x00, // 3 19
-    0x00, 0x00, 0xC0, 0x20, 0x10, 0xF8, 0x00, 0x00, 0x00, 0x07, 0x04, 0x24, 0x24, 0x3F, 0x24, 0x00, // 4 20
-    0x00, 0xF8, 0x08, 0x88, 0x88, 0x08, 0x08, 0x00, 0x00, 0x19, 0x21, 0x20, 0x20, 0x11, 0x0E, 0x00, // 5 21
-    0x00, 0xE0, 0x10, 0x88, 0x88, 0x18, 0x00, 0x00, 0x00, 0x0F, 0x11, 0x20, 0x20, 0x11, 0x0E, 0x00, // 6 22
-    0x00, 0x38, 0x08, 0x08, 0xC8, 0x38, 0x08, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00, // 7 23
-    0x00, 0x70, 0x88, 0x08, 0x08, 0x88, 0x70, 0x00, 0x00, 0x1C, 0x22, 0x21, 0x21, 0x22, 0x1C, 0x00, // 8 24
-    0x00, 0xE0, 0x10, 0x08, 0x08, 0x10, 0xE0, 0x00, 0x00, 0x00, 0x31, 0x22, 0x22, 0x11, 0x0F, 0x00, // 9 25
-    0x00, 0x00, 0x00, 0xC0, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x00, 0x00, 0x00, //: 26
-    0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x60, 0x00, 0x00, 0x00, 0x00, //; 27
-    0x00, 0x00, 0x80, 0x40, 0x20, 0x10, 0x08, 0x00, 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x00, //< 28
-    0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x00, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, //= 29
-    0x00, 0x08, 0x10, 0x20, 0x40, 0x80, 0x00, 0x00, 0x00, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, //> 30
-    0x00, 0x70, 0x48, 0x08, 0x08, 0x08, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x30, 0x36, 0x01, 0x00, 0x00, //? 31
-    0xC0, 0x30, 0xC8, 0x28, 0xE8, 0x10, 0xE0, 0x00, 0x07, 0x18, 0x27, 0x24, 0x23, 0x14, 0x0B, 0x00, //@ 32
-    0x00, 0x00, 0xC0, 0x38, 0xE0, 0x00, 0x00, 0x00, 0x20, 0x3C, 0x23, 0x02, 0x02, 0x27, 0x38, 0x20, // A 33
-    0x08, 0xF8, 0x88, 0x88, 0x88, 0x70, 0x00, 0x00, 0x20, 0x3F, 0x20, 0x20, 0x20, 0x11, 0x0E, 0x00, // B 34
-    0xC0, 0x30, 0x08, 0x08, 0x08, 0x08, 0x38, 0x00, 0x07, 0x18, 0x20, 0x20, 0x20, 0x10, 0x08, 0x00, // C 35
-    0x08, 0xF8, 0x08, 0x08, 0x08, 0x10, 0xE0, 0x00, 0x20, 0x3F, 0x20, 0x20, 0x20, 0x10, 0x0F, 0x00, // D 36
-    0x08, 0xF8, 0x88, 0x88, 0xE8, 0x08, 0x10, 0x00, 0x20, 0x3F, 0x20, 0x20, 0x23, 0x20, 0x18, 0x00, // E 37
-    0x08, 0xF8, 0x88, 0x88, 0xE8, 0x08, 0x10, 0x00, 0x20, 0x3F, 0x20, 0x00, 0x03, 0x00, 0x00, 0x00, // F 38
-    0xC0, 0x30, 0x08, 0x08, 0x08, 0x38, 0x00, 0x00, 0x07, 0x18, 0x20, 0x20, 0x22, 0x1E, 0x02, 0x00, // G 39
-    0x08, 0xF8, 0x08, 0x00, 0x00, 0x08, 0xF8, 0x08, 0x20, 0x3F, 0x21, 0x01, 0x01, 0x21, 0x3F, 0x20, // H 40
-    0x00, 0x08, 0x08, 0xF8, 0x08, 0x08, 0x00, 0x00, 0x00, 0x20, 0x20, 0x3F, 0x20, 0x20, 0x00, 0x00, // I 41
-    0x00, 0x00, 0x08, 0x08, 0xF8, 0x08, 0x08, 0x00, 0xC0, 0x80, 0x80, 0x80, 0x7F, 0x00, 0x00, 0x00, // J 42
-    0x08, 0xF8, 0x88, 0xC0, 0x28, 0x18, 0x08, 0x00, 0x20, 0x3F, 0x20, 0x01, 0x26, 0x38, 0x20, 0x00, // K 43
-    0x08, 0xF8, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x3F, 0x20, 0x20, 0x20, 0x20, 0x30, 0x00, // L 44
-    0x08, 0xF8, 0xF8, 0x00, 0xF8, 0xF8, 0x08, 0x00, 0x20, 0x3F, 0x00, 0x3F, 0x00, 0x3F, 0x20, 0x00, // M 45
-    0x08, 0xF8, 0x30, 0xC0, 0x00, 0x08, 0xF8, 0x08, 0x20, 0x3F, 0x20, 0x00, 0x07, 0x18, 0x3F, 0x00, // N 46
-    0xE0, 0x10, 0x08, 0x08, 0x08, 0x10, 0xE0, 0x00, 0x0F, 0x10, 0x20, 0x20, 0x20, 0x10, 0x0F, 0x00, // O 47
-    0x08, 0xF8, 0x08, 0x08, 0x08, 0x08, 0xF0, 0x00, 0x20, 0x3F, 0x21, 0x01, 0x01, 0x01, 0x00, 0x00, // P 48
-    0xE0, 0x10, 0x08, 0x08, 0x08, 0x10, 0xE0, 0x00, 0x0F, 0x18, 0x24, 0x24, 0x38, 0x50, 0x4F, 0x00, // Q 49
-    0x08, 0xF8, 0x88, 0x88, 0x88, 0x88, 0x70, 0x00, 0x20, 0x3F, 0x20, 0x00, 0x03, 0x0C, 0x30, 0x20, // R 50
-    0x00, 0x70, 0x88, 0x08, 0x08, 0x08, 0x38, 0x00, 0x00, 0x38, 0x20, 0x21, 0x21, 0x22, 0x1C, 0x00, // S 51
-    0x18, 0x08, 0x08, 0xF8, 0x08, 0x08, 0x18, 0x00, 0x00, 0x00, 0x20, 0x3F, 0x20, 0x00, 0x00, 0x00, // T 52
-    0x08, 0xF8, 0x08, 0x00, 0x00, 0x08, 0xF8, 0x08, 0x00, 0x1F, 0x20, 0x20, 0x20, 0x20, 0x1F, 0x00, // U 53
-    0x08, 0x78, 0x88, 0x00, 0x00, 0xC8, 0x38, 0x08, 0x00, 0x00, 0x07, 0x38, 0x0E, 0x01, 0x00, 0x00, // V 54
-    0xF8, 0x08, 0x00, 0xF8, 0x00, 0x08, 0xF8, 0x00, 0x03, 0x3C, 0x07, 0x00, 0x07, 0x3C, 0x03, 0x00, // W 55
-    0x08, 0x18, 0x68, 0x80, 0x80, 0x68, 0x18, 0x08, 0x20, 0x30, 0x2C, 0x03, 0x03, 0x2C, 0x30, 0x20, // X 56
-    0x08, 0x38, 0xC8, 0x00, 0xC8, 0x38, 0x08, 0x00, 0x00, 0x00, 0x20, 0x3F, 0x20, 0x00, 0x00, 0x00, // Y 57
-    0x10, 0x08, 0x08, 0x08, 0xC8, 0x38, 0x08, 0x00, 0x20, 0x38, 0x26, 0x21, 0x20, 0x20, 0x18, 0x00, // Z 58
-    0x00, 0x00, 0x00, 0xFE, 0x02, 0x02, 0x02, 0x00, 0x00, 0x00, 0x00, 0x7F, 0x40, 0x40, 0x40, 0x00, //[ 59
-    0x00, 0x0C, 0x30, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x06, 0x38, 0xC0, 0x00, //\ 60
-    0x00, 0x02, 0x02, 0x02, 0xFE, 0x00, 0x00, 0x00, 0x00, 0x40, 0x40, 0x40, 0x7F, 0x00, 0x00, 0x00, //] 61
-    0x00, 0x00, 0x04, 0x02, 0x02, 0x02, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //^ 62
-    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, //_ 63
-    0x00, 0x02, 0x02, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //` 64
-    0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x19, 0x24, 0x22, 0x22, 0x22, 0x3F, 0x20, // a 65
-    0x08, 0xF8, 0x00, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x11, 0x20, 0x20, 0x11, 0x0E, 0x00, // b 66
-    0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x0E, 0x11, 0x20, 0x20, 0x20, 0x11, 0x00, // c 67
-    0x00, 0x00, 0x00, 0x80, 0x80, 0x88, 0xF8, 0x00, 0x00, 0x0E, 0x11, 0x20, 0x20, 0x10, 0x3F, 0x20, // d 68
-    0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x1F, 0x22, 0x22, 0x22, 0x22, 0x13, 0x00, // e 69
-    0x00, 0x80, 0x80, 0xF0, 0x88, 0x88, 0x88, 0x18, 0x00, 0x20, 0x20, 0x3F, 0x20, 0x20, 0x00, 0x00, // f 70
-    0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x6B, 0x94, 0x94, 0x94, 0x93, 0x60, 0x00, // g 71
-    0x08, 0xF8, 0x00, 0x80, 0x80, 0x80, 0x00, 0x00, 0x20, 0x3F, 0x21, 0x00, 0x00, 0x20, 0x3F, 0x20, // h 72
-    0x00, 0x80, 0x98, 0x98, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x20, 0x3F, 0x20, 0x20, 0x00, 0x00, // i 73
-    0x00, 0x00, 0x00, 0x80, 0x98, 0x98, 0x00, 0x00, 0x00, 0xC0, 0x80, 0x80, 0x80, 0x7F, 0x00, 0x00, // j 74
-    0x08, 0xF8, 0x00, 0x00, 0x80, 0x80, 0x80, 0x00, 0x20, 0x3F, 0x24, 0x02, 0x2D, 0x30, 0x20, 0x00, // k 75
-    0x00, 0x08, 0x08, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x20, 0x3F, 0x20, 0x20, 0x00, 0x00, // l 76
-    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x20, 0x3F, 0x20, 0x00, 0x3F, 0x20, 0x00, 0x3F, // m 77
-    0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0x00, 0x00, 0x20, 0x3F, 0x21, 0x00, 0x00, 0x20, 0x3F, 0x20, // n 78
-    0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x1F, 0x20, 0x20, 0x20, 0x20, 0x1F, 0x00, // o 79
-    0x80, 0x80, 0x00, 0x80, 0x80, 0x00, 0x00, 0x00, 0x80, 0xFF, 0xA1, 0x20, 0x20, 0x11, 0x0E, 0x00, // p 80
-    0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x0E, 0x11, 0x20, 0x20, 0xA0, 0xFF, 0x80, // q 81
-    0x80, 0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0x00, 0x20, 0x20, 0x3F, 0x21, 0x20, 0x00, 0x01, 0x00, // r 82
-    0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x33, 0x24, 0x24, 0x24, 0x24, 0x19, 0x00, // s 83
-    0x00, 0x80, 0x80, 0xE0, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x20, 0x20, 0x00, 0x00, // t 84
-    0x80, 0x80, 0x00, 0x00, 0x00, 0x80, 0x80, 0x00, 0x00, 0x1F, 0x20, 0x20, 0x20, 0x10, 0x3F, 0x20, // u 85
-    0x80, 0x80, 0x80, 0x00, 0x00, 0x80, 0x80, 0x80, 0x00, 0x01, 0x0E, 0x30, 0x08, 0x06, 0x01, 0x00, // v 86
-    0x80, 0x80, 0x00, 0x80, 0x00, 0x80, 0x80, 0x80, 0x0F, 0x30, 0x0C, 0x03, 0x0C, 0x30, 0x0F, 0x00, // w 87
-    0x00, 0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0x00, 0x00, 0x20, 0x31, 0x2E, 0x0E, 0x31, 0x20, 0x00, // x 88
-    0x80, 0x80, 0x80, 0x00, 0x00, 0x80, 0x80, 0x80, 0x80, 0x81, 0x8E, 0x70, 0x18, 0x06, 0x01, 0x00, // y 89
-    0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x21, 0x30, 0x2C, 0x22, 0x21, 0x30, 0x00, // z 90
-    0x00, 0x00, 0x00, 0x00, 0x80, 0x7C, 0x02, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x40, 0x40, //{ 91
-    0x00, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0x00, //| 92
-    0x00, 0x02, 0x02, 0x7C, 0x80, 0x00, 0x00, 0x00, 0x00, 0x40, 0x40, 0x3F, 0x00, 0x00, 0x00, 0x00, //} 93
-    0x00, 0x06, 0x01, 0x01, 0x02, 0x02, 0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //~ 94
-};
-
-const uint8_t Hzk[][32] = {
-    {0x00,0xFE,0x22,0x5A,0x86,0x08,0x88,0x68,0x18,0x0F,0xE8,0x08,0x08,0x08,0x08,0x00},
-    {0x00,0xFF,0x04,0x08,0x07,0x20,0x11,0x0D,0x41,0x81,0x7F,0x01,0x05,0x09,0x30,0x00},/*"陈",0*/
-
-    {0x80,0x90,0x8C,0x84,0x84,0x84,0xF5,0x86,0x84,0x84,0x84,0x84,0x94,0x8C,0x80,0x00},
-    {0x00,0x80,0x80,0x84,0x46,0x49,0x28,0x10,0x10,0x2C,0x23,0x40,0x80,0x00,0x00,0x00},/*"安",1*/
-
-    {0x00,0xFC,0x84,0x84,0xFC,0x00,0x44,0x54,0x54,0x54,0x7F,0x54,0x54,0x54,0x44,0x00},
-    {0x00,0x3F,0x10,0x10,0x3F,0x00,0x00,0xFF,0x15,0x15,0x15,0x55,0x95,0x7F,0x00,0x00},/*"晴",2*/
-
-    {0x00,0x00,0x00,0xE0,0x00,0x00,0x00,0xFF,0x00,0x00,0x00,0x20,0x40,0x80,0x00,0x00},
-    {0x08,0x04,0x03,0x00,0x00,0x40,0x80,0x7F,0x00,0x00,0x00,0x00,0x00,0x01,0x0E,0x00},/*"小",3*/
-
-    {0x00,0x40,0x42,0x44,0x58,0x40,0xC0,0xFF,0xC0,0x40,0x50,0x48,0x46,0x40,0x00,0x00},
-    {0x20,0x20,0x10,0x08,0x04,0x03,0x00,0xFF,0x00,0x03,0x04,0x08,0x10,0x20,0x20,0x00},/*"米",4*/
-
-    {0x40,0x44,0x58,0xC0,0xFF,0x50,0x4C,0x10,0x90,0x10,0x11,0x16,0x10,0xD0,0x10,0x00},
-    {0x10,0x08,0x06,0x01,0xFF,0x01,0x06,0x40,0x41,0x5E,0x40,0x70,0x4E,0x41,0x40,0x00},/*"粒",5*/
-
-    {0x00,0x00,0xE2,0x24,0x28,0x20,0x20,0x3F,0x20,0x20,0x28,0x24,0xE2,0x00,0x00,0x00},
-    {0x00,0x00,0xFF,0x00,0x00,0x1F,0x11,0x11,0x11,0x1F,0x40,0x80,0x7F,0x00,0x00,0x00},/*"尚",6*/
-
-    {0x10,0x60,0x02,0x0C,0xC0,0x10,0x08,0xF7,0x14,0x54,0x94,0x14,0xF4,0x04,0x00,0x00},
-    {0x04,0x04,0x7C,0x03,0x00,0x01,0x1D,0x13,0x11,0x55,0x99,0x51,0x3F,0x11,0x01,0x00},/*"海",7*/
-
-    {0x10,0x60,0x02,0x8C,0x24,0x94,0x84,0xBD,0x86,0x84,0xBC,0x84,0x14,0x24,0x00,0x00},
-    {0x04,0x04,0x7E,0x01,0x00,0x0E,0x0A,0x0A,0x0A,0x4A,0x8A,0x4B,0x38,0x00,0x00,0x00},/*"湾",8*/
-
-    {0x40,0x70,0x4C,0x43,0xC0,0x30,0x00,0x10,0x10,0xFF,0x10,0x10,0x10,0xF0,0x00,0x00},
-    {0x10,0x38,0x14,0x13,0x14,0xB8,0x40,0x30,0x0E,0x01,0x40,0x80,0x40,0x3F,0x00,0x00},/*"幼",9*/
-
-    {0x00,0x00,0x00,0x00,0xFF,0x00,0x00,0x00,0x00,0xFF,0x00,0x00,0x00,0x00,0x00,0x00},
-    {0x80,0x40,0x20,0x18,0x07,0x00,0x00,0x00,0x00,0x3F,0x40,0x40,0x40,0x40,0x78,0x00},/*"儿",10*/
-
-    {0x00,0xFE,0x02,0x42,0x4A,0xCA,0x4A,0x4A,0xCA,0x4A,0x4A,0x42,0x02,0xFE,0x00,0x00},
-    {0x00,0xFF,0x40,0x50,0x4C,0x43,0x40,0x40,0x4F,0x50,0x50,0x5C,0x40,0xFF,0x00,0x00},/*"园",11*/
-};
-
-
-static spi_device_handle_t spi_handle;
-
-static esp_err_t spi_bus_init(void)
-{
-    spi_bus_config_t conf = {
-        .miso_io_num = -1,
-        .mosi_io_num = EXAMPLE_SPI_PIN_MOSI,
-        .sclk_io_num = EXAMPLE_SPI_PIN_CLK,
-        .quadhd_io_num = -1,
-        .quadwp_io_num = -1,
-        .max_transfer_sz = 32,
-    };
-
-    return spi_bus_initialize(EXAMPLE_SPI_MASTER_NUM, &conf, SPI_DMA_CH_AUTO);
-}
-
-static esp_err_t spi_write_cmd(const uint8_t value)
-{
-    gpio_set_level(EXAMPLE_SPI_PIN_DC, 0);
-
-    esp_err_t ret = ESP_OK;
-    spi_transaction_t t = {0};
-    t.length = 1 * 8;
-    t.flags = SPI_TRANS_USE_TXDATA;
-    t.tx_data[0] = value;
-    ret = spi_device_polling_transmit(spi_handle, &t);
-    return ret;
-}
-
-static esp_err_t spi_write_data(const uint8_t value)
-{
-    gpio_set_level(EXAMPLE_SPI_PIN_DC, 1);
-
-    esp_err_t ret = ESP_OK;
-    spi_transaction_t t = {0};
-    t.length = 1 * 8;
-    t.flags = SPI_TRANS_USE_TXDATA;
-    t.tx_data[0] = value;
-    ret = spi_device_polling_transmit(spi_handle, &t);
-    return ret;
-}
-
-void oled_init(void)
-{
-    esp_err_t ret = ESP_OK;
-
-    gpio_config_t io_conf = {
-        .intr_type = GPIO_INTR_DISABLE,
-        .mode = GPIO_MODE_OUTPUT,
-        .pin_bit_mask = (1ULL << EXAMPLE_SPI_PIN_DC) | (1ULL << EXAMPLE_SPI_PIN_RST),
-        .pull_up_en = GPIO_PULLUP_ENABLE,
-    };
-    ret = gpio_config(&io_conf);
-    if (ESP_OK != ret) {
-        ESP_LOGE(TAG, "gpio conf error");
-    }
-
-    gpio_set_level(EXAMPLE_SPI_PIN_RST, 0);
-    vTaskDelay(100 / portTICK_PERIOD_MS);
-    gpio_set_level(EXAMPLE_SPI_PIN_RST, 1);
-    vTaskDelay(100 / portTICK_PERIOD_MS);
-
-    ret = spi_bus_init();
-    if (ESP_OK != ret) {
-        ESP_LOGE(TAG, "spi bus init error");
-    }
-
-    spi_device_interface_config_t dev_conf = {
-        .clock_speed_hz = 2 * 1000 * 1000,
-        .mode = 0,
-        .spics_io_num = EXAMPLE_SPI_PIN_CS,
-        .queue_size = 1,
-    };
-    ret = spi_bus_add_device(EXAMPLE_SPI_MASTER_NUM, &dev_conf, &spi_handle);
-    if (ESP_OK != ret) {
-        ESP_LOGE(TAG, "spi bus add dev error");
-    }
-
-    spi_write_cmd(0xAE); // display on/off, 0xAE - off, 0xAF - on
-    spi_write_cmd(0xA8); // set multiplex ratio, 0xA8 + bit[5:0]
-    spi_write_cmd(0x3F); // bit[5:0]
-    spi_write_cmd(0xD3); // set display offset, 0xD3 + bit[5:0]
-    spi_write_cmd(0x00); // bit[5:0]
-    spi_write_cmd(0x40); // set display RAM start line address, 0x40 + bit[5:0]
-    spi_write_cmd(0xA1); // set segment remap, 0xA0 + bit[0], 0xA0 - column 0 map to SEG0, 0xA1 - column 127 map to SEG0
-    spi_write_cmd(0xC8); // set Com output scan direction, 0xC0 + bit[3], 0xC0 - normal mode, 0xC8 - inverse mode
-    spi_write_cmd(0xDA); // set com pin configuartion, 0xDA + bit[5:4] + 0x02
-    spi_write_cmd(0x12); // bit[5:4] + 0x02
-    spi_write_cmd(0x81); // set contract control, 0x81 + bit[7:0]
-    spi_write_cmd(0x7F); // bit[7:0]
-    spi_write_cmd(0xA4); // set Entire Display ON, 0xA4 + bit[0], 0xA4 - resume RAM content, 0xA5 - ignore RAM content
-    spi_write_cmd(0xA6); // set normal/inverse display, 0xA6 + bit[0], 0xA6 - normal, 0xA7 - inverse
-    spi_write_cmd(0xD5); // set clk divide ratio/osc freq, 0xD5 + bit[7:0]
-    spi_write_cmd(0x80); // bit[7:0]
-    spi_write_cmd(0x8D); // set Charge Pump, 0x8D + 0x10 + bit[2]
-    spi_write_cmd(0x14); // 0x10 + bit[2]
-    spi_write_cmd(0xD9); // set Pre-Charge Period, 0xD9 + bit[7:0]
-    spi_write_cmd(0x22); // bit[7:0]
-    spi_write_cmd(0xDB); // set Vcomh deselect level, 0xDB + bit[6:4]
-    spi_write_cmd(0x20); // bit[6:4]
-    spi_write_cmd(0xAF); // display on/off, 0xAE - off, 0xAF - on
-}
-
-// x - 0~127, y - 0~7
-static void oled_set_pos(uint8_t x, uint8_t y)
-{
-    spi_write_cmd(0xB0 + y);                   // start page address, 0xB0 + bit[2:0]
-    spi_write_cmd(((x & 0xF0) >> 4) | 0x10);   // start column address, higher part, 0x10 + bit[3:0]
-    spi_write_cmd(x & 0x0F);                   // start column address, lower part, 0x00 + bit[3:0]
-}
-
-void oled_clear(void)
-{
-    uint8_t i = 0, j = 0;
-
-    for (i = 0; i < 8; i++) {
-        oled_set_pos(0, i);
-        for (j = 0; j < 128; j++) {
-            spi_write_data(0x00);
-            pixel[i * 128 + j] = 0x00;
-        }
-    }
-}
-
-void oled_show_char(uint8_t x, uint8_t y, uint8_t ch, uint8_t size)
-{
-    uint8_t i = 0;
-
-    ch = ch - ' ';
-    if (1 == size) {
-        oled_set_pos(x, y);
-        for (i = 0; i < 6; i++) {
-            spi_write_data(F6x8[ch][i]);
-            pixel[y * 128 + x + i] = F6x8[ch][i];
-        }
-    } else {
-        oled_set_pos(x, y);
-        for (i = 0; i < 8; i++) {
-            spi_write_data(F8X16[ch * 16 + i]);
-            pixel[y * 128 + x + i] = F8X16[ch * 16 + i];
-        }
-        oled_set_pos(x, y + 1);
-        for (i = 0; i < 8; i++) {
-            spi_write_data(F8X16[ch * 16 + 8 + i]);
-            pixel[(y + 1) * 128 + x + i] = F8X16[ch * 16 + 8 + i];
-        }
-    }
-}
-
-void oled_show_string(uint8_t x, uint8_t y, char *string, uint8_t size)
-{
-    uint8_t i = 0;
-
-    while (string[i] != '\0') {
-        oled_show_char(x, y, string[i], size);
-
-        if (1 == size) {
-            x += 6;
-            if (x > 122) {
-                x = 0;
-                y += 1;
-            }
-        } else {
-            x += 8;
-            if (x > 120) {
-                x = 0;
-                y += 2;
-            }
-        }
-        i++;
-    }
-}
-
-void oled_show_chinese(uint8_t x, uint8_t y, uint8_t* index, uint8_t num)
-{
-    uint8_t i = 0, j = 0;
-
-    for (j = 0; j < num; j++) {
-        oled_set_pos(x, y);
-        for (i = 0; i < 16; i++) {
-            spi_write_data(Hzk[2 * index[j]][i]);
-            pixel[y * 128 + x + i] = Hzk[2 * index[j]][i];
-        }
-        oled_set_pos(x, y + 1);
-        for (i = 0; i < 16; i++) {
-            spi_write_data(Hzk[2 * index[j] + 1][i]);
-            pixel[(y + 1) * 128 + x + i] = Hzk[2 * index[j] + 1][i];
-        }
-
-        x += 16;
-        if (x > 112) {
-            x = 0;
-            y += 2;
-        }
-    }
-}
-
-void oled_show_point(uint8_t x, uint8_t y, uint8_t value)
-{
-    uint8_t row = y / 8;
-    uint8_t bit = y % 8;
-    uint8_t mask = 0;
-
-    if (0 == value) {
-        mask = ~(1 << bit);
-        pixel[row * 128 + x] &= mask;
-    } else {
-        mask = 1 << bit;
-        pixel[row * 128 + x] |= mask;
-    }
-
-    oled_set_pos(x, row);
-    spi_write_data(pixel[row * 128 + x]);
-}
-
-void oled_show_line(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, uint8_t value)
-{
-    uint8_t x = 0, y = 0;
-
-    if (x1 == x2) {
-        for (y = y1; y <= y2; y++) {
-            oled_show_point(x1, y, value);
-        }
-        return;
-    }
-
-    if (y1 == y2) {
-        for (x = x1; x <= x2; x++) {
-            oled_show_point(x, y1, value);
-        }
-        return;
-    } 
-
-    for (x = x1; x <= x2; x++) {
-        y = y1 + ((((x - x1) * 1000) / (x2 - x1)) * (y2 - y1)) / 1000;
-        oled_show_point(x, y, value);
-    }
-}